@@ -53,6 +53,14 @@ find_package(ZLIB REQUIRED)
 find_package(BZip2 REQUIRED)
 list(APPEND ZLIB_LIBRARIES ${BZIP2_LIBRARIES})
 
+if(WITH_ZSTD)
+  set(ZSTD_ROOT_DIR ${LIBDIR}/zstd)
+  find_package(Zstd)
+  if(NOT ZSTD_FOUND)
+    set(WITH_ZSTD OFF)
+  endif()
+endif()
+
 if(WITH_OPENAL)
   find_package(OpenAL)
   if(NOT OPENAL_FOUND)
@@ -221,6 +221,13 @@ if(WITH_OPENCOLLADA)
   endif()
 endif()
 
+if(WITH_ZSTD)
+  find_package_wrapper(Zstd)
+  if(NOT ZSTD_FOUND)
+    set(WITH_ZSTD OFF)
+  endif()
+endif()
+
 if(WITH_MEM_JEMALLOC)
   find_package_wrapper(JeMalloc)
   if(NOT JEMALLOC_FOUND)
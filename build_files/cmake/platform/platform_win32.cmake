@@ -569,6 +569,15 @@ if(WITH_IMAGE_OPENJPEG)
   set(OPENJPEG_LIBRARIES ${OPENJPEG}/lib/openjp2.lib)
 endif()
 
+if(WITH_ZSTD)
+  if(EXISTS ${LIBDIR}/zstd)
+    set(ZSTD_INCLUDE_DIRS ${LIBDIR}/zstd/include)
+    set(ZSTD_LIBRARIES ${LIBDIR}/zstd/lib/zstd_static.lib)
+  else()
+    set(WITH_ZSTD OFF)
+  endif()
+endif()
+
 if(WITH_OPENSUBDIV)
   set(OPENSUBDIV_INCLUDE_DIRS ${LIBDIR}/opensubdiv/include)
   set(OPENSUBDIV_LIBPATH ${LIBDIR}/opensubdiv/lib)
@@ -24,7 +24,9 @@
 /**
  * \section MEM_CacheLimiter
  * This class defines a generic memory cache management system
- * to limit memory usage to a fixed global maximum.
+ * to limit memory usage to a fixed global maximum, and optionally
+ * to a budget per cache. Elements are destroyed in least recently
+ * used order, unless a priority function is set.
  *
  * \note Please use the C-API in MEM_CacheLimiterC-Api.h for code written in C.
  *
@@ -55,8 +57,6 @@
 
 #include "MEM_Allocator.h"
 #include <list>
-#include <queue>
-#include <vector>
 
 template<class T> class MEM_CacheLimiter;
 
@@ -71,8 +71,11 @@ bool MEM_CacheLimiter_is_disabled(void);
 
 template<class T> class MEM_CacheLimiterHandle {
  public:
+  typedef std::list<MEM_CacheLimiterHandle<T> *, MEM_Allocator<MEM_CacheLimiterHandle<T> *>>
+      MEM_CacheQueue;
+
   explicit MEM_CacheLimiterHandle(T *data_, MEM_CacheLimiter<T> *parent_)
-      : data(data_), refcount(0), parent(parent_)
+      : data(data_), refcount(0), size(0), parent(parent_)
   {
   }
 
@@ -132,7 +135,10 @@ template<class T> class MEM_CacheLimiterHandle {
 
   T *data;
   int refcount;
-  int pos;
+  /* Size of data when it was inserted or last touched, see #MEM_CacheLimiter::memory_in_use. */
+  size_t size;
+  /* Position in the least recently used order of the parent. */
+  typename MEM_CacheQueue::iterator pos;
   MEM_CacheLimiter<T> *parent;
 };
 
@@ -142,60 +148,79 @@ template<class T> class MEM_CacheLimiter {
   typedef int (*MEM_CacheLimiter_ItemPriority_Func)(void *item, int default_priority);
   typedef bool (*MEM_CacheLimiter_ItemDestroyable_Func)(void *item);
 
-  MEM_CacheLimiter(MEM_CacheLimiter_DataSize_Func data_size_func) : data_size_func(data_size_func)
+  MEM_CacheLimiter(MEM_CacheLimiter_DataSize_Func data_size_func)
+      : data_size_func(data_size_func),
+        item_priority_func(NULL),
+        item_destroyable_func(NULL),
+        memory_in_use(0),
+        budget(0)
   {
   }
 
   ~MEM_CacheLimiter()
   {
-    int i;
-    for (i = 0; i < queue.size(); i++) {
-      delete queue[i];
+    for (iterator it = queue.begin(); it != queue.end(); it++) {
+      delete *it;
     }
   }
 
   MEM_CacheLimiterHandle<T> *insert(T *elem)
   {
-    queue.push_back(new MEM_CacheLimiterHandle<T>(elem, this));
-    queue.back()->pos = queue.size() - 1;
-    return queue.back();
+    MEM_CacheElementPtr handle = new MEM_CacheLimiterHandle<T>(elem, this);
+    handle->pos = queue.insert(queue.end(), handle);
+    update_size(handle);
+    return handle;
   }
 
   void unmanage(MEM_CacheLimiterHandle<T> *handle)
   {
-    int pos = handle->pos;
-    queue[pos] = queue.back();
-    queue[pos]->pos = pos;
-    queue.pop_back();
+    memory_in_use -= handle->size;
+    queue.erase(handle->pos);
     delete handle;
   }
 
+  /* Sizes are measured when elements are inserted or touched, so this doesn't need to iterate
+   * over all elements. */
   size_t get_memory_in_use()
   {
-    size_t size = 0;
     if (data_size_func) {
-      int i;
-      for (i = 0; i < queue.size(); i++) {
-        size += data_size_func(queue[i]->get()->get_data());
-      }
-    }
-    else {
-      size = MEM_get_memory_in_use();
+      return memory_in_use;
     }
-    return size;
+    return MEM_get_memory_in_use();
+  }
+
+  /* Maximum memory used by this cache, 0 to only use the global maximum. */
+  void set_budget(size_t budget)
+  {
+    this->budget = budget;
+  }
+
+  size_t get_budget() const
+  {
+    return budget;
   }
 
   void enforce_limits()
   {
     size_t max = MEM_CacheLimiter_get_maximum();
-    bool is_disabled = MEM_CacheLimiter_is_disabled();
-    size_t mem_in_use, cur_size;
 
-    if (is_disabled) {
+    if (max == 0) {
       return;
     }
+    if (budget != 0 && budget < max) {
+      max = budget;
+    }
 
-    if (max == 0) {
+    reduce_memory(max);
+  }
+
+  /* Destroy elements until the memory in use is at most max, ignoring the limits. */
+  void reduce_memory(size_t max)
+  {
+    bool is_disabled = MEM_CacheLimiter_is_disabled();
+    size_t mem_in_use, cur_size;
+
+    if (is_disabled) {
       return;
     }
 
@@ -212,7 +237,7 @@ template<class T> class MEM_CacheLimiter {
         break;
 
       if (data_size_func) {
-        cur_size = data_size_func(elem->get()->get_data());
+        cur_size = elem->size;
       }
       else {
         cur_size = mem_in_use;
@@ -231,17 +256,9 @@ template<class T> class MEM_CacheLimiter {
 
   void touch(MEM_CacheLimiterHandle<T> *handle)
   {
-    /* If we're using custom priority callback re-arranging the queue
-     * doesn't make much sense because we'll iterate it all to get
-     * least priority element anyway.
-     */
-    if (item_priority_func == NULL) {
-      queue[handle->pos] = queue.back();
-      queue[handle->pos]->pos = handle->pos;
-      queue.pop_back();
-      queue.push_back(handle);
-      handle->pos = queue.size() - 1;
-    }
+    /* Move to the most recently used end, iterators stay valid. */
+    queue.splice(queue.end(), queue, handle->pos);
+    update_size(handle);
   }
 
   void set_item_priority_func(MEM_CacheLimiter_ItemPriority_Func item_priority_func)
@@ -256,9 +273,19 @@ template<class T> class MEM_CacheLimiter {
 
  private:
   typedef MEM_CacheLimiterHandle<T> *MEM_CacheElementPtr;
-  typedef std::vector<MEM_CacheElementPtr, MEM_Allocator<MEM_CacheElementPtr>> MEM_CacheQueue;
+  typedef typename MEM_CacheLimiterHandle<T>::MEM_CacheQueue MEM_CacheQueue;
   typedef typename MEM_CacheQueue::iterator iterator;
 
+  /* Size of data can change while it's cached, so it's measured again on touch. */
+  void update_size(MEM_CacheElementPtr handle)
+  {
+    if (data_size_func) {
+      memory_in_use -= handle->size;
+      handle->size = data_size_func(handle->get()->get_data());
+      memory_in_use += handle->size;
+    }
+  }
+
   /* Check whether element can be destroyed when enforcing cache limits */
   bool can_destroy_element(MEM_CacheElementPtr &elem)
   {
@@ -281,6 +308,7 @@ template<class T> class MEM_CacheLimiter {
     MEM_CacheElementPtr best_match_elem = NULL;
 
     if (!item_priority_func) {
+      /* Least recently used first, skipping over only elements that can't be destroyed. */
       for (iterator it = queue.begin(); it != queue.end(); it++) {
         MEM_CacheElementPtr elem = *it;
         if (!can_destroy_element(elem))
@@ -291,10 +319,10 @@ template<class T> class MEM_CacheLimiter {
     }
     else {
       int best_match_priority = 0;
-      int i;
+      int i = 0;
 
-      for (i = 0; i < queue.size(); i++) {
-        MEM_CacheElementPtr elem = queue[i];
+      for (iterator it = queue.begin(); it != queue.end(); it++, i++) {
+        MEM_CacheElementPtr elem = *it;
 
         if (!can_destroy_element(elem))
           continue;
@@ -319,6 +347,9 @@ template<class T> class MEM_CacheLimiter {
   MEM_CacheLimiter_DataSize_Func data_size_func;
   MEM_CacheLimiter_ItemPriority_Func item_priority_func;
   MEM_CacheLimiter_ItemDestroyable_Func item_destroyable_func;
+  /* Sum of the sizes of all elements, when data_size_func is set. */
+  size_t memory_in_use;
+  size_t budget;
 };
 
 #endif  // __MEM_CACHELIMITER_H__
@@ -90,6 +90,24 @@ MEM_CacheLimiterHandleC *MEM_CacheLimiter_insert(MEM_CacheLimiterC *This, void *
 
 void MEM_CacheLimiter_enforce_limits(MEM_CacheLimiterC *This);
 
+/**
+ * Set maximum memory used by the objects of this limiter.
+ * The global maximum still applies.
+ *
+ * \param This: "This" pointer.
+ * \param budget: maximum in bytes, 0 to only use the global maximum.
+ */
+
+void MEM_CacheLimiter_set_budget(MEM_CacheLimiterC *This, size_t budget);
+
+/**
+ * Free objects until at most max bytes are in use, regardless of the limits.
+ *
+ * \param This: "This" pointer.
+ */
+
+void MEM_CacheLimiter_reduce_memory(MEM_CacheLimiterC *This, size_t max);
+
 /**
  * Unmanage object previously inserted object.
  * Does _not_ delete managed object!
@@ -101,6 +119,7 @@ void MEM_CacheLimiter_unmanage(MEM_CacheLimiterHandleC *handle);
 
 /**
  * Raise priority of object (put it at the tail of the deletion chain)
+ * and measure its size again.
  *
  * \param handle: of object.
  */
@@ -181,6 +181,16 @@ void MEM_CacheLimiter_enforce_limits(MEM_CacheLimiterC *This)
   cast(This)->get_cache()->enforce_limits();
 }
 
+void MEM_CacheLimiter_set_budget(MEM_CacheLimiterC *This, size_t budget)
+{
+  cast(This)->get_cache()->set_budget(budget);
+}
+
+void MEM_CacheLimiter_reduce_memory(MEM_CacheLimiterC *This, size_t max)
+{
+  cast(This)->get_cache()->reduce_memory(max);
+}
+
 void MEM_CacheLimiter_unmanage(MEM_CacheLimiterHandleC *handle)
 {
   cast(handle)->unmanage();
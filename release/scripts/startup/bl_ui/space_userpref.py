@@ -613,6 +613,13 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
 
         layout.separator()
 
+        col = layout.column()
+        col.prop(system, "compositor_cache_limit", text="Compositor Cache Limit")
+        col.prop(system, "memory_cache_limit_image", text="Image Cache Limit")
+        col.prop(system, "memory_cache_limit_clip", text="Movie Clip Cache Limit")
+
+        layout.separator()
+
         col = layout.column()
         col.prop(system, "texture_time_out", text="Texture Time Out")
         col.prop(system, "texture_collection_rate", text="Garbage Collection Rate")
@@ -633,6 +640,8 @@ class USERPREF_PT_system_video_sequencer(SystemPanel, CenterAlignMixIn, Panel):
         edit = prefs.edit
 
         layout.prop(system, "memory_cache_limit")
+        layout.prop(system, "use_sequencer_parallel_render")
+        layout.prop(system, "sequencer_prefetch_threads")
 
         layout.separator()
 
@@ -694,6 +703,9 @@ class USERPREF_PT_viewport_quality(ViewportPanel, CenterAlignMixIn, Panel):
         col.prop(system, "use_overlay_smooth_wire", text="Overlay")
         col.prop(system, "use_edit_mode_smooth_wire", text="Edit Mode")
 
+        col = layout.column()
+        col.prop(system, "use_baked_display_transform")
+
 
 class USERPREF_PT_viewport_textures(ViewportPanel, CenterAlignMixIn, Panel):
     bl_label = "Textures"
@@ -1347,6 +1359,7 @@ class USERPREF_PT_saveload_blend(SaveLoadPanel, CenterAlignMixIn, Panel):
         col = layout.column(heading="Save")
         col.prop(view, "use_save_prompt")
         col.prop(paths, "use_save_preview_images")
+        col.prop(paths, "use_file_incremental")
 
         col = layout.column(heading="Default to")
         col.prop(paths, "use_relative_paths")
@@ -97,7 +97,11 @@ IFACEMETHODIMP CBlendThumb::Initialize(IStream *pStream, DWORD)
 #include "Wincodec.h"
 #include <math.h>
 #include <zlib.h>
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+#endif
 const unsigned char gzip_magic[3] = {0x1f, 0x8b, 0x08};
+const unsigned char zstd_magic[4] = {0x28, 0xb5, 0x2f, 0xfd};
 
 // IThumbnailProvider
 IFACEMETHODIMP CBlendThumb::GetThumbnail(UINT cx, HBITMAP *phbmp, WTS_ALPHATYPE *pdwAlpha)
@@ -107,14 +111,54 @@ IFACEMETHODIMP CBlendThumb::GetThumbnail(UINT cx, HBITMAP *phbmp, WTS_ALPHATYPE
   LARGE_INTEGER SeekPos;
 
   // Compressed?
-  unsigned char in_magic[3];
-  _pStream->Read(&in_magic, 3, &BytesRead);
+  unsigned char in_magic[4];
+  _pStream->Read(&in_magic, 4, &BytesRead);
   bool gzipped = true;
   for (int i = 0; i < 3; i++)
     if (in_magic[i] != gzip_magic[i]) {
       gzipped = false;
       break;
     }
+  bool zstd_compressed = (BytesRead == 4) && (memcmp(in_magic, zstd_magic, 4) == 0);
+
+  if (zstd_compressed) {
+#ifdef WITH_ZSTD
+    // Get compressed file length
+    SeekPos.QuadPart = 0;
+    _pStream->Seek(SeekPos, STREAM_SEEK_END, NULL);
+
+    // Same as gzip: the thumbnail is expected inside the first 70KB of the uncompressed file.
+    size_t dest_size = 1024 * 70;
+    size_t source_size = (size_t)max(SeekPos.QuadPart, dest_size);
+
+    char *src = new char[source_size];
+    char *dest = new char[dest_size];
+
+    SeekPos.QuadPart = 0;
+    _pStream->Seek(SeekPos, STREAM_SEEK_SET, NULL);
+    _pStream->Read(src, (ULONG)source_size, &BytesRead);
+
+    // The file is made of multiple frames, stream until the output buffer is full.
+    ZSTD_DCtx *dctx = ZSTD_createDCtx();
+    ZSTD_inBuffer input = {src, BytesRead, 0};
+    ZSTD_outBuffer output = {dest, dest_size, 0};
+    while (output.pos < output.size && input.pos < input.size) {
+      if (ZSTD_isError(ZSTD_decompressStream(dctx, &output, &input))) {
+        break;
+      }
+    }
+    ZSTD_freeDCtx(dctx);
+
+    // Replace the IStream, which is read-only
+    _pStream->Release();
+    _pStream = SHCreateMemStream((const BYTE *)dest, (UINT)output.pos);
+
+    delete[] src;
+    delete[] dest;
+#else
+    return S_FALSE;
+#endif
+  }
 
   if (gzipped) {
     // Zlib inflate
@@ -156,6 +156,12 @@ enum {
   G_DEBUG_XR_TIME = (1 << 22),               /* XR/OpenXR timing messages */
 
   G_DEBUG_GHOST = (1 << 23), /* Debug GHOST module. */
+
+  /* Evaluate depsgraph operations in the order they become ready, not by critical path. */
+  G_DEBUG_DEPSGRAPH_NO_PRIORITY = (1 << 24),
+
+  /* Compare incremental relations updates against a full depsgraph build. */
+  G_DEBUG_DEPSGRAPH_VALIDATE_INCREMENTAL = (1 << 25),
 };
 
 #define G_DEBUG_ALL \
@@ -176,6 +182,11 @@ enum {
   /** On read, use #FileGlobal.filename instead of the real location on-disk,
    * needed for recovering temp files so relative paths resolve */
   G_FILE_RECOVER = (1 << 23),
+  /** Only read heavy data-blocks when they are needed, see #BLO_READ_LAZY_DATA. */
+  G_FILE_LAZY_LOAD = (1 << 24),
+  /** Use Zstandard instead of gzip for #G_FILE_COMPRESS (older versions can't read these files).
+   * Was only used as a run-time flag in the past (`G_FILE_HISTORY`), never written to files. */
+  G_FILE_COMPRESS_ZSTD = (1 << 25),
   /** BMesh option to save as older mesh format */
   /* #define G_FILE_MESH_COMPAT       (1 << 26) */
   /* #define G_FILE_GLSL_NO_ENV_LIGHTING (1 << 28) */ /* deprecated */
@@ -185,7 +196,7 @@ enum {
  * Run-time only #G.fileflags which are never read or written to/from Blend files.
  * This means we can change the values without worrying about do-versions.
  */
-#define G_FILE_FLAG_ALL_RUNTIME (G_FILE_NO_UI)
+#define G_FILE_FLAG_ALL_RUNTIME (G_FILE_NO_UI | G_FILE_LAZY_LOAD)
 
 /** ENDIAN_ORDER: indicates what endianness the platform where the file was written had. */
 #if !defined(__BIG_ENDIAN__) && !defined(__LITTLE_ENDIAN__)
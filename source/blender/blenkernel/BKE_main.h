@@ -50,6 +50,7 @@ struct GHash;
 struct GSet;
 struct ImBuf;
 struct Library;
+struct Main;
 struct MainLock;
 
 /* Blender thumbnail, as written on file (width, height, and data as char RGBA). */
@@ -83,6 +84,25 @@ enum {
   MAINIDRELATIONS_INCLUDE_UI = 1 << 0,
 };
 
+/**
+ * Data-blocks which are read from their blend-file on first access,
+ * tagged with #LIB_TAG_LAZY_LOAD until then.
+ *
+ * Until they are read, such ID's are empty placeholders. RNA property access, the depsgraph and
+ * the BKE/editor entry points to their contents (#BKE_mesh_from_object, image buffers, volume
+ * grids, edit-mode and modifier apply) read them first. Other code accessing their contents
+ * directly must call #BKE_main_lazy_load_ensure_id, changes made to a placeholder are lost when
+ * it's read.
+ */
+typedef struct MainLazyLoad {
+  /** Read the contents of the given ID's, all lazy loaded ID's when `ids` is NULL. */
+  void (*ensure_fn)(struct Main *bmain, struct ID **ids, int ids_len, void *user_data);
+  void (*free_fn)(void *user_data);
+  void *user_data;
+  /** Set when ID's were freed from Main, references to them must not be resolved anymore. */
+  bool ids_freed;
+} MainLazyLoad;
+
 typedef struct Main {
   struct Main *next, *prev;
   char name[1024];                   /* 1024 = FILE_MAX */
@@ -161,6 +181,9 @@ typedef struct Main {
    */
   struct MainIDRelations *relations;
 
+  /** Set when some ID's still have to be read from the file, see #BKE_main_lazy_load_ensure_id. */
+  struct MainLazyLoad *lazy_load;
+
   struct MainLock *lock;
 } Main;
 
@@ -170,6 +193,10 @@ void BKE_main_free(struct Main *mainvar);
 void BKE_main_lock(struct Main *bmain);
 void BKE_main_unlock(struct Main *bmain);
 
+void BKE_main_lazy_load_ensure_id(struct Main *bmain, struct ID *id);
+void BKE_main_lazy_load_ensure_all(struct Main *bmain);
+void BKE_main_lazy_load_free(struct Main *bmain);
+
 void BKE_main_relations_create(struct Main *bmain, const short flag);
 void BKE_main_relations_free(struct Main *bmain);
 void BKE_main_relations_ID_remove(struct Main *bmain, struct ID *id);
@@ -867,6 +867,9 @@ bool BKE_blendfile_write_partial(Main *bmain_src,
    * (otherwise main->name will not be set at read time). */
   BLI_strncpy(bmain_dst->name, bmain_src->name, sizeof(bmain_dst->name));
 
+  /* Expanding needs the ID pointers of all data-blocks. */
+  BKE_main_lazy_load_ensure_all(bmain_src);
+
   BLO_main_expander(blendfile_write_partial_cb);
   BLO_expand_main(NULL, bmain_src);
 
@@ -381,6 +381,7 @@ static void imagecache_put(Image *image, int index, ImBuf *ibuf)
 
     image->cache = IMB_moviecache_create(
         "Image Datablock Cache", sizeof(ImageCacheKey), imagecache_hashhash, imagecache_hashcmp);
+    IMB_moviecache_set_budget(image->cache, IMB_MOVIECACHE_BUDGET_IMAGE);
     IMB_moviecache_set_getdata_callback(image->cache, imagecache_keydata);
   }
 
@@ -5054,6 +5055,11 @@ ImBuf *BKE_image_acquire_ibuf(Image *ima, ImageUser *iuser, void **r_lock)
 {
   ImBuf *ibuf;
 
+  /* Packed files, sources and settings of lazily loaded images are read with their contents. */
+  if (ima != NULL) {
+    BKE_main_lazy_load_ensure_id(G_MAIN, &ima->id);
+  }
+
   BLI_mutex_lock(image_mutex);
 
   ibuf = image_acquire_ibuf(ima, iuser, r_lock);
@@ -575,6 +575,10 @@ ID *BKE_id_copy_ex(Main *bmain, const ID *id, ID **r_newid, const int flag)
       return NULL;
     }
 
+    if (bmain != NULL) {
+      BKE_main_lazy_load_ensure_id(bmain, (ID *)id);
+    }
+
     BKE_libblock_copy_ex(bmain, id, &newid, flag);
 
     if (idtype_info->copy_data != NULL) {
@@ -1737,6 +1741,9 @@ void BKE_main_id_refcount_recompute(struct Main *bmain, const bool do_linked_onl
 {
   ID *id;
 
+  /* References from the contents of lazily loaded ID's can't be counted without reading them. */
+  BKE_main_lazy_load_ensure_all(bmain);
+
   FOREACH_MAIN_ID_BEGIN (bmain, id) {
     if (!ID_IS_LINKED(id) && do_linked_only) {
       continue;
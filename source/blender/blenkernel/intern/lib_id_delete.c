@@ -131,6 +131,10 @@ void BKE_id_free_ex(Main *bmain, void *idv, int flag, const bool use_flag_from_i
 
   const short type = GS(id->name);
 
+  if (bmain && bmain->lazy_load && (flag & LIB_ID_FREE_NO_MAIN) == 0) {
+    bmain->lazy_load->ids_freed = true;
+  }
+
   if (bmain && (flag & LIB_ID_FREE_NO_DEG_TAG) == 0) {
     BLI_assert(bmain->is_locked_for_linking == false);
 
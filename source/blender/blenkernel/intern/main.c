@@ -42,6 +42,9 @@
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+/* Reading lazily loaded ID's uses the blend-file of their Main, one read at a time. */
+static ThreadMutex lazy_load_mutex = BLI_MUTEX_INITIALIZER;
+
 Main *BKE_main_new(void)
 {
   Main *bmain = MEM_callocN(sizeof(Main), "new main");
@@ -62,6 +65,7 @@ void BKE_main_free(Main *mainvar)
                          LIB_ID_FREE_NO_USER_REFCOUNT | LIB_ID_FREE_NO_DEG_TAG);
 
   MEM_SAFE_FREE(mainvar->blen_thumb);
+  BKE_main_lazy_load_free(mainvar);
 
   a = set_listbasepointers(mainvar, lbarray);
   while (a--) {
@@ -209,6 +213,60 @@ void BKE_main_unlock(struct Main *bmain)
   BLI_spin_unlock((SpinLock *)bmain->lock);
 }
 
+/**
+ * Read the contents of \a id from its blend-file, if it was not read yet
+ * (when the file was opened with #BLO_READ_LAZY_DATA).
+ *
+ * Must be called before accessing the contents of such ID's, reading them later overwrites the
+ * placeholder. Thread-safe, the tag is only cleared once the contents are read.
+ */
+void BKE_main_lazy_load_ensure_id(Main *bmain, ID *id)
+{
+  if ((id->tag & LIB_TAG_LAZY_LOAD) == 0) {
+    return;
+  }
+  BLI_mutex_lock(&lazy_load_mutex);
+  BLI_assert(bmain->lazy_load != NULL);
+  if (bmain->lazy_load != NULL) {
+    bmain->lazy_load->ensure_fn(bmain, &id, 1, bmain->lazy_load->user_data);
+  }
+  BLI_mutex_unlock(&lazy_load_mutex);
+}
+
+static void main_lazy_load_free(Main *bmain)
+{
+  bmain->lazy_load->free_fn(bmain->lazy_load->user_data);
+  MEM_freeN(bmain->lazy_load);
+  bmain->lazy_load = NULL;
+}
+
+/**
+ * Read the contents of all ID's that were not read yet, this also closes the blend-file.
+ * Needed before operations working on all data, like writing a file.
+ */
+void BKE_main_lazy_load_ensure_all(Main *bmain)
+{
+  if (bmain->lazy_load == NULL) {
+    return;
+  }
+  BLI_mutex_lock(&lazy_load_mutex);
+  if (bmain->lazy_load != NULL) {
+    bmain->lazy_load->ensure_fn(bmain, NULL, 0, bmain->lazy_load->user_data);
+    main_lazy_load_free(bmain);
+  }
+  BLI_mutex_unlock(&lazy_load_mutex);
+}
+
+void BKE_main_lazy_load_free(Main *bmain)
+{
+  if (bmain->lazy_load == NULL) {
+    return;
+  }
+  BLI_mutex_lock(&lazy_load_mutex);
+  main_lazy_load_free(bmain);
+  BLI_mutex_unlock(&lazy_load_mutex);
+}
+
 static int main_relations_create_idlink_cb(LibraryIDLinkCallbackData *cb_data)
 {
   MainIDRelations *rel = cb_data->user_data;
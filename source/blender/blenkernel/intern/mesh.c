@@ -1247,6 +1247,8 @@ Mesh *BKE_mesh_from_object(Object *ob)
     return NULL;
   }
   if (ob->type == OB_MESH) {
+    /* Callers access the mesh contents, read them first for lazily loaded meshes. */
+    BKE_main_lazy_load_ensure_id(G_MAIN, ob->data);
     return ob->data;
   }
 
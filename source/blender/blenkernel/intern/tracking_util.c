@@ -1019,6 +1019,7 @@ TrackingImageAccessor *tracking_image_accessor_new(MovieClip *clips[MAX_ACCESSOR
 
   accessor->cache = IMB_moviecache_create(
       "frame access cache", sizeof(AccessCacheKey), accesscache_hashhash, accesscache_hashcmp);
+  IMB_moviecache_set_budget(accessor->cache, IMB_MOVIECACHE_BUDGET_CLIP);
 
   memcpy(accessor->clips, clips, num_clips * sizeof(MovieClip *));
   accessor->num_clips = num_clips;
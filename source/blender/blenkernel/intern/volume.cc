@@ -755,6 +755,9 @@ bool BKE_volume_is_loaded(const Volume *volume)
 bool BKE_volume_load(Volume *volume, Main *bmain)
 {
 #ifdef WITH_OPENVDB
+  /* The file path and grid settings are read with the contents. */
+  BKE_main_lazy_load_ensure_id(bmain, &volume->id);
+
   VolumeGridVector &grids = *volume->runtime.grids;
 
   if (volume->runtime.frame == VOLUME_FRAME_NONE) {
@@ -28,6 +28,7 @@ extern "C" {
 
 int BLI_cpu_support_sse2(void);
 int BLI_cpu_support_sse41(void);
+int BLI_cpu_support_avx2(void);
 void BLI_system_backtrace(FILE *fp);
 
 /* Get CPU brand, result is to be MEM_freeN()-ed. */
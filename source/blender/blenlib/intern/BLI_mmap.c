@@ -0,0 +1,224 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include "BLI_mmap.h"
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+#include "MEM_guardedalloc.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#ifndef WIN32
+#  include <signal.h>
+#  include <stdio.h>
+#  include <stdlib.h>
+#  include <sys/mman.h> /* For mmap. */
+#  include <unistd.h>   /* For read close. */
+#else
+#  include "BLI_winstuff.h"
+#  include "mmap_win.h"
+#  include <io.h> /* For open close read. */
+#endif
+
+struct BLI_mmap_file {
+  /* The address to which the file was mapped. */
+  char *memory;
+
+  /* The length of the file (and therefore the mapped region). */
+  size_t length;
+
+  /* Flag to indicate IO errors. Needs to be volatile since it's being set from
+   * within the signal handler, which is not part of the normal execution flow. */
+  volatile bool io_error;
+};
+
+#ifndef WIN32
+/* When a file is memory-mapped and the underlying file becomes unavailable (the file is
+ * truncated, a network drive disconnects, ...), accessing the memory raises `SIGBUS`.
+ * The handler below catches this for mapped files: it flags the file as failed and replaces
+ * the mapping with zeros, so the access that caused the error can complete and the caller
+ * checks the error flag afterwards. */
+
+static struct error_handler_data {
+  ListBase open_mmaps;
+  bool configured;
+  void (*next_handler)(int, siginfo_t *, void *);
+} error_handler = {{NULL, NULL}, false, NULL};
+
+/* Files can be mapped from multiple threads. */
+static ThreadMutex error_handler_mutex = BLI_MUTEX_INITIALIZER;
+
+static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
+{
+  /* We only handle SIGBUS here for now. */
+  BLI_assert(sig == SIGBUS);
+
+  char *error_addr = (char *)siginfo->si_addr;
+  /* Find the file that this error belongs to. */
+  LISTBASE_FOREACH (LinkData *, link, &error_handler.open_mmaps) {
+    BLI_mmap_file *file = link->data;
+
+    /* Is the address where the error occurred in this file's mapped range? */
+    if (error_addr >= file->memory && error_addr < file->memory + file->length) {
+      file->io_error = true;
+
+      /* Replace the mapped memory with zeroes. */
+      const void *mapped_memory = mmap(
+          file->memory, file->length, PROT_READ, MAP_FIXED | MAP_PRIVATE | MAP_ANON, -1, 0);
+      if (mapped_memory == MAP_FAILED) {
+        fprintf(stderr, "SIGBUS handler: Error replacing mapped file with zeros\n");
+      }
+
+      return;
+    }
+  }
+
+  /* Fall back to other handler if there was one. */
+  if (error_handler.next_handler) {
+    error_handler.next_handler(sig, siginfo, ptr);
+  }
+  else {
+    fprintf(stderr, "Unhandled SIGBUS caught\n");
+    abort();
+  }
+}
+
+/* Ensures that the error handler is set up and ready. */
+static bool sigbus_handler_setup(void)
+{
+  BLI_mutex_lock(&error_handler_mutex);
+  if (!error_handler.configured) {
+    struct sigaction newact = {0}, oldact = {0};
+
+    newact.sa_sigaction = sigbus_handler;
+    newact.sa_flags = SA_SIGINFO;
+
+    if (sigaction(SIGBUS, &newact, &oldact)) {
+      BLI_mutex_unlock(&error_handler_mutex);
+      return false;
+    }
+
+    /* Remember the previously configured handler to fall back to it if the error
+     * does not belong to any of the mapped files. */
+    error_handler.next_handler = (oldact.sa_flags & SA_SIGINFO) ? oldact.sa_sigaction : NULL;
+    error_handler.configured = true;
+  }
+  BLI_mutex_unlock(&error_handler_mutex);
+
+  return true;
+}
+
+/* Adds a file to the list that the error handler checks. */
+static void sigbus_handler_add(BLI_mmap_file *file)
+{
+  LinkData *link = BLI_genericNodeN(file);
+  BLI_mutex_lock(&error_handler_mutex);
+  BLI_addtail(&error_handler.open_mmaps, link);
+  BLI_mutex_unlock(&error_handler_mutex);
+}
+
+/* Removes a file from the list that the error handler checks. */
+static void sigbus_handler_remove(BLI_mmap_file *file)
+{
+  BLI_mutex_lock(&error_handler_mutex);
+  LinkData *link = BLI_findptr(&error_handler.open_mmaps, file, offsetof(LinkData, data));
+  BLI_freelinkN(&error_handler.open_mmaps, link);
+  BLI_mutex_unlock(&error_handler_mutex);
+}
+#endif
+
+BLI_mmap_file *BLI_mmap_open(int fd)
+{
+  void *memory;
+  const size_t file_size = BLI_file_descriptor_size(fd);
+
+  /* Mapping an empty file (or one we failed to get the size of) isn't supported. */
+  if (file_size == 0 || file_size == (size_t)-1) {
+    return NULL;
+  }
+
+#ifndef WIN32
+  /* Ensure that the SIGBUS handler is configured. */
+  if (!sigbus_handler_setup()) {
+    return NULL;
+  }
+#endif
+
+  /* Map the given file to memory. */
+  memory = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (memory == MAP_FAILED) {
+    return NULL;
+  }
+
+  /* Now that the mapping was successful, allocate memory and set up the BLI_mmap_file. */
+  BLI_mmap_file *file = MEM_callocN(sizeof(BLI_mmap_file), __func__);
+  file->memory = memory;
+  file->length = file_size;
+
+#ifndef WIN32
+  /* Register the file with the error handler. */
+  sigbus_handler_add(file);
+#endif
+
+  return file;
+}
+
+bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length)
+{
+  /* If a previous read has already failed or we try to read past the end,
+   * don't even attempt to read any further. */
+  if (file->io_error || (offset > file->length) || (length > file->length - offset)) {
+    return false;
+  }
+
+  memcpy(dest, file->memory + offset, length);
+
+  /* Check whether the read was successful (the signal handler may have flagged an error). */
+  return !file->io_error;
+}
+
+const void *BLI_mmap_get_pointer(BLI_mmap_file *file)
+{
+  return file->memory;
+}
+
+size_t BLI_mmap_get_length(const BLI_mmap_file *file)
+{
+  return file->length;
+}
+
+bool BLI_mmap_any_io_error(const BLI_mmap_file *file)
+{
+  return file->io_error;
+}
+
+void BLI_mmap_free(BLI_mmap_file *file)
+{
+  munmap(file->memory, file->length);
+
+#ifndef WIN32
+  sigbus_handler_remove(file);
+#endif
+
+  MEM_freeN(file);
+}
@@ -162,6 +162,71 @@ int BLI_cpu_support_sse41(void)
   return 0;
 }
 
+#if !defined(_WIN32) || defined(FREE_WINDOWS)
+static void __cpuidex(
+    /* Cannot be const, because it is modified below.
+     * NOLINTNEXTLINE: readability-non-const-parameter. */
+    int data[4],
+    int selector,
+    int subselector)
+{
+#  if defined(__x86_64__)
+  asm("cpuid"
+      : "=a"(data[0]), "=b"(data[1]), "=c"(data[2]), "=d"(data[3])
+      : "a"(selector), "c"(subselector));
+#  elif defined(__i386__)
+  asm("pushl %%ebx    \n\t"
+      "cpuid          \n\t"
+      "movl %%ebx, %1 \n\t"
+      "popl %%ebx     \n\t"
+      : "=a"(data[0]), "=r"(data[1]), "=c"(data[2]), "=d"(data[3])
+      : "a"(selector), "c"(subselector)
+      : "ebx");
+#  else
+  (void)subselector;
+  data[0] = data[1] = data[2] = data[3] = 0;
+#  endif
+}
+#endif
+
+/* Register state enabled by the operating system, only valid when OSXSAVE is supported. */
+static unsigned long long cpu_xgetbv(void)
+{
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#elif defined(__x86_64__) || defined(__i386__)
+  unsigned int eax, edx;
+  asm(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((unsigned long long)edx << 32) | eax;
+#else
+  return 0;
+#endif
+}
+
+int BLI_cpu_support_avx2(void)
+{
+  int result[4], num;
+  __cpuid(result, 0);
+  num = result[0];
+
+  if (num < 7) {
+    return 0;
+  }
+
+  /* AVX and OSXSAVE, the operating system has to save the YMM registers on context switches. */
+  const int avx_osxsave = ((int)1 << 28) | ((int)1 << 27);
+  __cpuid(result, 0x00000001);
+  if ((result[2] & avx_osxsave) != avx_osxsave) {
+    return 0;
+  }
+  if ((cpu_xgetbv() & 0x6) != 0x6) {
+    return 0;
+  }
+
+  __cpuidex(result, 0x00000007, 0);
+  return (result[1] & ((int)1 << 5)) != 0;
+}
+
 void BLI_hostname_get(char *buffer, size_t bufsize)
 {
 #ifndef WIN32
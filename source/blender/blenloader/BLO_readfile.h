@@ -95,6 +95,12 @@ typedef enum eBLOReadSkip {
   BLO_READ_SKIP_DATA = (1 << 1),
   /** Do not attempt to re-use IDs from old bmain for unchanged ones in case of undo. */
   BLO_READ_SKIP_UNDO_OLD_MAIN = (1 << 2),
+  /**
+   * Only read meshes, images and volumes when they are first needed, see #LIB_TAG_LAZY_LOAD.
+   * Only used for files saved with the current version, others are always read fully.
+   * Writing a file or an undo step reads all of them, so this mainly helps background scripts.
+   */
+  BLO_READ_LAZY_DATA = (1 << 3),
 } eBLOReadSkip;
 #define BLO_READ_SKIP_ALL (BLO_READ_SKIP_USERDEF | BLO_READ_SKIP_DATA)
 
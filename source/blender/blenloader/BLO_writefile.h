@@ -57,6 +57,11 @@ struct BlendFileWriteParams {
   /** On write, restore paths after editing them (see #BLO_WRITE_PATH_REMAP_RELATIVE). */
   uint use_save_as_copy : 1;
   uint use_userdef : 1;
+  /**
+   * Re-use the data of unchanged IDs from the previous save of the same file
+   * (uncompressed files only).
+   */
+  uint use_incremental : 1;
   const struct BlendThumbnail *thumb;
 };
 
@@ -71,4 +76,6 @@ extern bool BLO_write_file_mem(struct Main *mainvar,
                                struct MemFile *current,
                                int write_flags);
 
+extern void BLO_write_file_incremental_free(void);
+
 /** \} */
@@ -0,0 +1,238 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup blenloader
+ *
+ * The #OldNewMap is split into shards, chosen by the high bits of the pointer hash,
+ * so each shard stays small and a shard can be filled while other shards are being filled
+ * or read from other threads.
+ *
+ * - Inserting is thread-safe, each shard has its own lock.
+ * - Looking up is lock-free, it may run concurrently with other lookups
+ *   (the user count is incremented atomically), but not with inserts into the same map.
+ */
+
+#include <cstdio>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_map.hh"
+#include "BLI_threads.h"
+
+#include "atomic_ops.h"
+
+#include "oldnewmap.h"
+
+/* Count lookups and the collisions they run into, printed by #blo_oldnewmap_print_stats.
+ * Off by default since counting collisions requires a second probe per lookup. */
+// #define USE_OLDNEWMAP_STATS
+
+namespace blender::io::blend {
+
+struct OldNew {
+  void *newp;
+  /* `nr` is "user count" for data, and ID code for libdata. */
+  int nr;
+};
+
+/* Should be a power of two. */
+static constexpr int SHARDS_NUM_EXP = 3;
+static constexpr int SHARDS_NUM = 1 << SHARDS_NUM_EXP;
+
+struct OldNewMapShard {
+  Map<const void *, OldNew> map;
+  SpinLock lock;
+};
+
+}  // namespace blender::io::blend
+
+using namespace blender::io::blend;
+
+struct OldNewMap {
+  OldNewMapShard shards[SHARDS_NUM];
+#ifdef USE_OLDNEWMAP_STATS
+  int64_t lookups_num = 0;
+  int64_t lookups_failed_num = 0;
+  int64_t lookups_collisions_num = 0;
+#endif
+
+  OldNewMapShard &shard_for(const void *addr)
+  {
+    return shards[shard_index(addr)];
+  }
+
+  const OldNewMapShard &shard_for(const void *addr) const
+  {
+    return shards[shard_index(addr)];
+  }
+
+  static int shard_index(const void *addr)
+  {
+    /* The lower bits of the hash pick the slot inside the shard's map,
+     * use the high bits of a multiplicative hash so they stay evenly distributed. */
+    const uint64_t hash = blender::DefaultHash<const void *>{}(addr);
+    return int((hash * 0x9E3779B97F4A7C15ull) >> (64 - SHARDS_NUM_EXP));
+  }
+
+  MEM_CXX_CLASS_ALLOC_FUNCS("OldNewMap")
+};
+
+OldNewMap *blo_oldnewmap_new(void)
+{
+  OldNewMap *onm = new OldNewMap();
+  for (OldNewMapShard &shard : onm->shards) {
+    BLI_spin_init(&shard.lock);
+  }
+  return onm;
+}
+
+void blo_oldnewmap_free(OldNewMap *onm)
+{
+  for (OldNewMapShard &shard : onm->shards) {
+    BLI_spin_end(&shard.lock);
+  }
+  delete onm;
+}
+
+/**
+ * Allocate space for \a entries_num entries up-front,
+ * avoiding to grow the map while inserting (e.g. from the number of blocks in a file).
+ */
+void blo_oldnewmap_reserve(OldNewMap *onm, int64_t entries_num)
+{
+  /* Leave some room for an uneven distribution over the shards. */
+  const int64_t shard_entries_num = (entries_num + entries_num / 4) / SHARDS_NUM;
+  for (OldNewMapShard &shard : onm->shards) {
+    shard.map.reserve(shard_entries_num);
+  }
+}
+
+void blo_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
+{
+  if (oldaddr == nullptr || newaddr == nullptr) {
+    return;
+  }
+
+  OldNewMapShard &shard = onm->shard_for(oldaddr);
+  BLI_spin_lock(&shard.lock);
+  shard.map.add_overwrite(oldaddr, {newaddr, nr});
+  BLI_spin_unlock(&shard.lock);
+}
+
+void *blo_oldnewmap_lookup(const OldNewMap *onm, const void *addr, int *r_nr)
+{
+  const OldNewMapShard &shard = onm->shard_for(addr);
+  const OldNew *entry = shard.map.lookup_ptr(addr);
+
+#ifdef USE_OLDNEWMAP_STATS
+  {
+    OldNewMap *onm_mut = const_cast<OldNewMap *>(onm);
+    atomic_add_and_fetch_int64(&onm_mut->lookups_num, 1);
+    atomic_add_and_fetch_int64(&onm_mut->lookups_collisions_num,
+                               shard.map.count_collisions(addr));
+    if (entry == nullptr) {
+      atomic_add_and_fetch_int64(&onm_mut->lookups_failed_num, 1);
+    }
+  }
+#endif
+
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  if (r_nr != nullptr) {
+    *r_nr = entry->nr;
+  }
+  return entry->newp;
+}
+
+void *blo_oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
+{
+  if (addr == nullptr) {
+    return nullptr;
+  }
+  if (!increase_users) {
+    return blo_oldnewmap_lookup(onm, addr, nullptr);
+  }
+
+  OldNewMapShard &shard = onm->shard_for(addr);
+  OldNew *entry = shard.map.lookup_ptr(addr);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  atomic_add_and_fetch_int32((int32_t *)&entry->nr, 1);
+  return entry->newp;
+}
+
+/**
+ * Free all new pointers that have never been looked up (their user count is zero),
+ * then remove all entries.
+ */
+void blo_oldnewmap_clear_and_free_unused(OldNewMap *onm)
+{
+  for (OldNewMapShard &shard : onm->shards) {
+    if (shard.map.is_empty()) {
+      continue;
+    }
+    for (OldNew &entry : shard.map.values()) {
+      if (entry.nr == 0) {
+        MEM_freeN(entry.newp);
+        entry.newp = nullptr;
+      }
+    }
+    shard.map.clear();
+  }
+}
+
+void blo_oldnewmap_foreach(OldNewMap *onm, OldNewMapForeachFn fn, void *user_data)
+{
+  for (OldNewMapShard &shard : onm->shards) {
+    for (auto item : shard.map.items()) {
+      fn(item.key, &item.value.newp, &item.value.nr, user_data);
+    }
+  }
+}
+
+int64_t blo_oldnewmap_size(const OldNewMap *onm)
+{
+  int64_t size = 0;
+  for (const OldNewMapShard &shard : onm->shards) {
+    size += shard.map.size();
+  }
+  return size;
+}
+
+/**
+ * Print the probe lengths (collisions) and memory usage of all shards.
+ */
+void blo_oldnewmap_print_stats(const OldNewMap *onm, const char *name)
+{
+  printf("OldNewMap '%s': %lld entries in %d shards\n",
+         name,
+         (long long)blo_oldnewmap_size(onm),
+         SHARDS_NUM);
+#ifdef USE_OLDNEWMAP_STATS
+  printf("  Lookups: %lld (failed: %lld), average collisions: %.3f\n",
+         (long long)onm->lookups_num,
+         (long long)onm->lookups_failed_num,
+         onm->lookups_num ? (double)onm->lookups_collisions_num / (double)onm->lookups_num : 0.0);
+#endif
+  for (int i = 0; i < SHARDS_NUM; i++) {
+    char shard_name[64];
+    snprintf(shard_name, sizeof(shard_name), "%s[%d]", name, i);
+    onm->shards[i].map.print_stats(shard_name);
+  }
+}
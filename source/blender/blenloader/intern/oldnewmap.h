@@ -0,0 +1,52 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup blenloader
+ *
+ * Mapping of pointers stored in a blend-file (old) to the memory they were read into (new).
+ */
+
+#pragma once
+
+#include "BLI_sys_types.h"
+#include "BLI_utildefines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct OldNewMap OldNewMap;
+
+/** Called for every entry, \a r_newp and \a r_nr can be modified. */
+typedef void (*OldNewMapForeachFn)(const void *oldp, void **r_newp, int *r_nr, void *user_data);
+
+struct OldNewMap *blo_oldnewmap_new(void);
+void blo_oldnewmap_free(struct OldNewMap *onm);
+
+void blo_oldnewmap_reserve(struct OldNewMap *onm, int64_t entries_num);
+void blo_oldnewmap_insert(struct OldNewMap *onm, const void *oldaddr, void *newaddr, int nr);
+void *blo_oldnewmap_lookup(const struct OldNewMap *onm, const void *addr, int *r_nr);
+void *blo_oldnewmap_lookup_and_inc(struct OldNewMap *onm, const void *addr, bool increase_users);
+void blo_oldnewmap_clear_and_free_unused(struct OldNewMap *onm);
+void blo_oldnewmap_foreach(struct OldNewMap *onm, OldNewMapForeachFn fn, void *user_data);
+
+int64_t blo_oldnewmap_size(const struct OldNewMap *onm);
+void blo_oldnewmap_print_stats(const struct OldNewMap *onm, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
@@ -316,8 +316,14 @@ BlendFileData *BLO_read_from_file(const char *filepath,
   if (fd) {
     fd->reports = reports;
     fd->skip_flags = skip_flags;
+    if (skip_flags & BLO_READ_LAZY_DATA) {
+      fd->lazy_id_bheads = BLI_ghash_ptr_new(__func__);
+      fd->lazy_id_users = BLI_ghash_int_new(__func__);
+    }
     bfd = blo_read_file_internal(fd, filepath);
-    blo_filedata_free(fd);
+    if (!(bfd && blo_lazy_load_register(fd, bfd->main))) {
+      blo_filedata_free(fd);
+    }
   }
 
   return bfd;
@@ -23,6 +23,10 @@
 
 #include "zlib.h"
 
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+#endif
+
 #include <ctype.h> /* for isdigit. */
 #include <fcntl.h> /* for open flags (O_BINARY, O_RDONLY). */
 #include <limits.h>
@@ -107,6 +111,8 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -115,6 +121,7 @@
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
 #include "BKE_armature.h"
+#include "BKE_blender_version.h"
 #include "BKE_brush.h"
 #include "BKE_collection.h"
 #include "BKE_colortools.h"
@@ -179,6 +186,7 @@
 
 #include "engines/eevee/eevee_lightcache.h"
 
+#include "oldnewmap.h"
 #include "readfile.h"
 
 #include <errno.h>
@@ -240,14 +248,32 @@
  * Delay reading blocks we might not use (especially applies to library linking).
  * which keeps large arrays in memory from data-blocks we may not even use.
  *
- * \note This is disabled when using compression,
+ * \note This is disabled when using gzip compression,
  * while zlib supports seek it's unusably slow, see: T61880.
+ * Zstandard compressed files are written with a seek table so they support it.
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
 /* use GHash for BHead name-based lookups (speeds up linking) */
 #define USE_GHASH_BHEAD
 
+/**
+ * When reading a whole file, reconstruct the DATA blocks of ID's on multiple threads
+ * before reading the ID's themselves (which has to be done in order),
+ * see #read_file_data_prepare_parallel.
+ *
+ * \note Only used when blocks can be read concurrently (memory-mapped or in-memory data).
+ */
+#define USE_PARALLEL_DATA_READ
+
+#ifdef USE_PARALLEL_DATA_READ
+/**
+ * Size of the DATA blocks reconstructed ahead of the ID's that use them. Bounds the memory of
+ * data that is reconstructed but not yet used, at least the data of one ID is reconstructed.
+ */
+#  define PARALLEL_DATA_READ_BATCH_SIZE (64 * 1024 * 1024)
+#endif
+
 /* Use GHash for restoring pointers by name */
 #define USE_GHASH_RESTORE_POINTER
 
@@ -281,6 +307,10 @@ typedef struct BHeadN {
   bool has_data;
 #endif
   bool is_memchunk_identical;
+#ifdef USE_PARALLEL_DATA_READ
+  /** Result of #read_struct computed ahead of time, owned by the #BHeadN until used. */
+  void *data_prepared;
+#endif
   struct BHead bhead;
 } BHeadN;
 
@@ -326,144 +356,9 @@ static const char *library_parent_filepath(Library *lib)
 /** \name OldNewMap API
  * \{ */
 
-typedef struct OldNew {
-  const void *oldp;
-  void *newp;
-  /* `nr` is "user count" for data, and ID code for libdata. */
-  int nr;
-} OldNew;
-
-typedef struct OldNewMap {
-  /* Array that stores the actual entries. */
-  OldNew *entries;
-  int nentries;
-  /* Hashmap that stores indices into the `entries` array. */
-  int32_t *map;
-
-  int capacity_exp;
-} OldNewMap;
-
-#define ENTRIES_CAPACITY(onm) (1ll << (onm)->capacity_exp)
-#define MAP_CAPACITY(onm) (1ll << ((onm)->capacity_exp + 1))
-#define SLOT_MASK(onm) (MAP_CAPACITY(onm) - 1)
-#define DEFAULT_SIZE_EXP 6
-#define PERTURB_SHIFT 5
-
-/* based on the probing algorithm used in Python dicts. */
-#define ITER_SLOTS(onm, KEY, SLOT_NAME, INDEX_NAME) \
-  uint32_t hash = BLI_ghashutil_ptrhash(KEY); \
-  uint32_t mask = SLOT_MASK(onm); \
-  uint perturb = hash; \
-  int SLOT_NAME = mask & hash; \
-  int INDEX_NAME = onm->map[SLOT_NAME]; \
-  for (;; SLOT_NAME = mask & ((5 * SLOT_NAME) + 1 + perturb), \
-          perturb >>= PERTURB_SHIFT, \
-          INDEX_NAME = onm->map[SLOT_NAME])
-
-static void oldnewmap_insert_index_in_map(OldNewMap *onm, const void *ptr, int index)
-{
-  ITER_SLOTS (onm, ptr, slot, stored_index) {
-    if (stored_index == -1) {
-      onm->map[slot] = index;
-      break;
-    }
-  }
-}
-
-static void oldnewmap_insert_or_replace(OldNewMap *onm, OldNew entry)
-{
-  ITER_SLOTS (onm, entry.oldp, slot, index) {
-    if (index == -1) {
-      onm->entries[onm->nentries] = entry;
-      onm->map[slot] = onm->nentries;
-      onm->nentries++;
-      break;
-    }
-    if (onm->entries[index].oldp == entry.oldp) {
-      onm->entries[index] = entry;
-      break;
-    }
-  }
-}
-
-static OldNew *oldnewmap_lookup_entry(const OldNewMap *onm, const void *addr)
-{
-  ITER_SLOTS (onm, addr, slot, index) {
-    if (index >= 0) {
-      OldNew *entry = &onm->entries[index];
-      if (entry->oldp == addr) {
-        return entry;
-      }
-    }
-    else {
-      return NULL;
-    }
-  }
-}
-
-static void oldnewmap_clear_map(OldNewMap *onm)
-{
-  memset(onm->map, 0xFF, MAP_CAPACITY(onm) * sizeof(*onm->map));
-}
-
-static void oldnewmap_increase_size(OldNewMap *onm)
-{
-  onm->capacity_exp++;
-  onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * ENTRIES_CAPACITY(onm));
-  onm->map = MEM_reallocN(onm->map, sizeof(*onm->map) * MAP_CAPACITY(onm));
-  oldnewmap_clear_map(onm);
-  for (int i = 0; i < onm->nentries; i++) {
-    oldnewmap_insert_index_in_map(onm, onm->entries[i].oldp, i);
-  }
-}
-
-/* Public OldNewMap API */
-
-static OldNewMap *oldnewmap_new(void)
-{
-  OldNewMap *onm = MEM_callocN(sizeof(*onm), "OldNewMap");
-
-  onm->capacity_exp = DEFAULT_SIZE_EXP;
-  onm->entries = MEM_malloc_arrayN(
-      ENTRIES_CAPACITY(onm), sizeof(*onm->entries), "OldNewMap.entries");
-  onm->map = MEM_malloc_arrayN(MAP_CAPACITY(onm), sizeof(*onm->map), "OldNewMap.map");
-  oldnewmap_clear_map(onm);
-
-  return onm;
-}
-
-static void oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
-{
-  if (oldaddr == NULL || newaddr == NULL) {
-    return;
-  }
-
-  if (UNLIKELY(onm->nentries == ENTRIES_CAPACITY(onm))) {
-    oldnewmap_increase_size(onm);
-  }
-
-  OldNew entry;
-  entry.oldp = oldaddr;
-  entry.newp = newaddr;
-  entry.nr = nr;
-  oldnewmap_insert_or_replace(onm, entry);
-}
-
 void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
 {
-  oldnewmap_insert(onm, oldaddr, newaddr, nr);
-}
-
-static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
-{
-  OldNew *entry = oldnewmap_lookup_entry(onm, addr);
-  if (entry == NULL) {
-    return NULL;
-  }
-  if (increase_users) {
-    entry->nr++;
-  }
-  return entry->newp;
+  blo_oldnewmap_insert(onm, oldaddr, newaddr, nr);
 }
 
 /* for libdata, OldNew.nr has ID code, no increment */
@@ -473,7 +368,7 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *l
     return NULL;
   }
 
-  ID *id = oldnewmap_lookup_and_inc(onm, addr, false);
+  ID *id = blo_oldnewmap_lookup_and_inc(onm, addr, false);
   if (id == NULL) {
     return NULL;
   }
@@ -483,35 +378,6 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *l
   return NULL;
 }
 
-static void oldnewmap_clear(OldNewMap *onm)
-{
-  /* Free unused data. */
-  for (int i = 0; i < onm->nentries; i++) {
-    OldNew *entry = &onm->entries[i];
-    if (entry->nr == 0) {
-      MEM_freeN(entry->newp);
-      entry->newp = NULL;
-    }
-  }
-
-  onm->capacity_exp = DEFAULT_SIZE_EXP;
-  oldnewmap_clear_map(onm);
-  onm->nentries = 0;
-}
-
-static void oldnewmap_free(OldNewMap *onm)
-{
-  MEM_freeN(onm->entries);
-  MEM_freeN(onm->map);
-  MEM_freeN(onm);
-}
-
-#undef ENTRIES_CAPACITY
-#undef MAP_CAPACITY
-#undef SLOT_MASK
-#undef DEFAULT_SIZE_EXP
-#undef PERTURB_SHIFT
-#undef ITER_SLOTS
 
 /** \} */
 
@@ -893,6 +759,9 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->file_offset = fd->file_offset;
           new_bhead->has_data = false;
           new_bhead->is_memchunk_identical = false;
+#ifdef USE_PARALLEL_DATA_READ
+          new_bhead->data_prepared = NULL;
+#endif
           new_bhead->bhead = bhead;
           off64_t seek_new = fd->seek(fd, bhead.len, SEEK_CUR);
           if (seek_new == -1) {
@@ -916,6 +785,9 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->has_data = true;
 #endif
           new_bhead->is_memchunk_identical = false;
+#ifdef USE_PARALLEL_DATA_READ
+          new_bhead->data_prepared = NULL;
+#endif
           new_bhead->bhead = bhead;
 
           readsize = fd->read(
@@ -1004,6 +876,13 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->mmap_file != NULL) {
+    /* Doesn't change the file position, so this is safe to use from multiple threads. */
+    return BLI_mmap_read(fd->mmap_file,
+                         buf,
+                         (size_t)new_bhead->file_offset,
+                         (size_t)new_bhead->bhead.len);
+  }
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -1020,6 +899,24 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   return success;
 }
 
+/**
+ * Access the data of a block that wasn't read yet directly in the memory-mapped file.
+ *
+ * \return NULL when the file isn't memory-mapped.
+ * \note The data is read-only, copy it when it needs to be modified (e.g. endian switching).
+ * Check #BLI_mmap_any_io_error after reading it.
+ */
+static const void *blo_bhead_data_mapped(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if ((fd->mmap_file == NULL) ||
+      ((size_t)new_bhead->file_offset + (size_t)thisblock->len > fd->buffersize)) {
+    return NULL;
+  }
+  return POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), new_bhead->file_offset);
+}
+
 static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
 {
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
@@ -1028,6 +925,9 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
   new_bhead_data->is_memchunk_identical = false;
+#ifdef USE_PARALLEL_DATA_READ
+  new_bhead_data->data_prepared = NULL;
+#endif
   if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
     MEM_freeN(new_bhead_data);
     return NULL;
@@ -1205,6 +1105,48 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+/* Memory-mapped file reading. */
+
+static ssize_t fd_read_from_mmap(FileData *filedata,
+                                 void *buffer,
+                                 size_t size,
+                                 bool *UNUSED(r_is_memchunck_identical))
+{
+  /* don't read more bytes than there are available in the file */
+  const size_t readsize = MIN2(size, filedata->buffersize - (size_t)filedata->file_offset);
+
+  if (!BLI_mmap_read(filedata->mmap_file, buffer, (size_t)filedata->file_offset, readsize)) {
+    return EOF;
+  }
+  filedata->file_offset += readsize;
+
+  return (ssize_t)readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t new_offset;
+  switch (whence) {
+    case SEEK_SET:
+      new_offset = offset;
+      break;
+    case SEEK_CUR:
+      new_offset = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_offset = (off64_t)filedata->buffersize + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if (new_offset < 0 || new_offset > (off64_t)filedata->buffersize) {
+    return -1;
+  }
+  filedata->file_offset = new_offset;
+  return new_offset;
+}
+
 /* GZip file reading. */
 
 static ssize_t fd_read_gzip_from_file(FileData *filedata,
@@ -1226,6 +1168,377 @@ static ssize_t fd_read_gzip_from_file(FileData *filedata,
   return readsize;
 }
 
+/* Zstandard file reading.
+ *
+ * Files written by Blender are split into independently compressed frames followed by a seek
+ * table (see `writefile.c`), so seeking only needs to decompress the frames holding the requested
+ * data, and reads spanning multiple frames decompress them in parallel.
+ * Other zstd files (e.g. compressed with the `zstd` command line tool) are read as a stream,
+ * without seeking support. */
+
+static bool blo_header_is_zstd(const char header[4])
+{
+  /* Frame magic number 0xFD2FB528, stored little endian. */
+  return ((uchar)header[0] == 0x28 && (uchar)header[1] == 0xB5 && (uchar)header[2] == 0x2F &&
+          (uchar)header[3] == 0xFD);
+}
+
+#ifdef WITH_ZSTD
+
+#  define ZSTD_SKIPPABLE_MAGIC 0x184D2A5E
+#  define ZSTD_SEEKABLE_MAGIC 0x8F92EAB1
+#  define ZSTD_SEEK_TABLE_FOOTER_SIZE 9
+
+typedef struct ZstdReadData {
+  ZSTD_DCtx *dctx;
+
+  /** Number of frames in the seek table, zero when reading as a stream. */
+  int frames_len;
+  /** Start of each frame in the compressed file (`frames_len + 1` items). */
+  off64_t *compressed_offset;
+  /** Start of each frame in the uncompressed data (`frames_len + 1` items). */
+  off64_t *uncompressed_offset;
+
+  /** Decompressed contents of the frame last read from (-1 for none), used for small reads. */
+  int frame_cached;
+  char *frame_buf;
+  size_t frame_buf_size;
+
+  /** Input buffer when reading as a stream. */
+  ZSTD_inBuffer stream_in;
+  char *stream_in_buf;
+  size_t stream_in_buf_size;
+} ZstdReadData;
+
+static uint32_t zstd_get_uint32(const uchar *buf)
+{
+  /* The seekable format is always little endian. */
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) |
+         ((uint32_t)buf[3] << 24);
+}
+
+static bool zstd_read_at(int filedes, off64_t offset, void *buffer, size_t size)
+{
+  if (BLI_lseek(filedes, offset, SEEK_SET) != offset) {
+    return false;
+  }
+  /* Large reads may be split by the OS. */
+  size_t done = 0;
+  while (done < size) {
+    const ssize_t readsize = read(filedes, POINTER_OFFSET(buffer, done), size - done);
+    if (readsize <= 0) {
+      return false;
+    }
+    done += (size_t)readsize;
+  }
+  return true;
+}
+
+/**
+ * Read the seek table from the end of the file.
+ * \return false when the file doesn't have a (valid) seek table.
+ */
+static bool zstd_read_seek_table(ZstdReadData *zd, int filedes)
+{
+  const off64_t file_size = BLI_lseek(filedes, 0, SEEK_END);
+  uchar footer[ZSTD_SEEK_TABLE_FOOTER_SIZE];
+  if ((file_size < ZSTD_SEEK_TABLE_FOOTER_SIZE + 8) ||
+      !zstd_read_at(filedes, file_size - ZSTD_SEEK_TABLE_FOOTER_SIZE, footer, sizeof(footer))) {
+    return false;
+  }
+
+  if (zstd_get_uint32(footer + 5) != ZSTD_SEEKABLE_MAGIC) {
+    return false;
+  }
+  const uint32_t frames_len = zstd_get_uint32(footer);
+  const uchar descriptor = footer[4];
+  /* Reserved bits must be zero, the highest bit marks per-frame checksums (unused here). */
+  if ((descriptor & 0x7C) != 0) {
+    return false;
+  }
+  const off64_t entry_size = (descriptor & 0x80) ? 12 : 8;
+  const off64_t table_size = (off64_t)frames_len * entry_size + ZSTD_SEEK_TABLE_FOOTER_SIZE;
+  if ((frames_len == 0) || (frames_len >= INT_MAX) || (table_size + 8 > file_size)) {
+    return false;
+  }
+
+  const off64_t table_offset = file_size - table_size - 8;
+  uchar *table = MEM_mallocN((size_t)table_size + 8, __func__);
+  if (!zstd_read_at(filedes, table_offset, table, (size_t)table_size + 8) ||
+      (zstd_get_uint32(table) != ZSTD_SKIPPABLE_MAGIC) ||
+      (zstd_get_uint32(table + 4) != (uint32_t)table_size)) {
+    MEM_freeN(table);
+    return false;
+  }
+
+  zd->frames_len = (int)frames_len;
+  zd->compressed_offset = MEM_malloc_arrayN(
+      zd->frames_len + 1, sizeof(*zd->compressed_offset), __func__);
+  zd->uncompressed_offset = MEM_malloc_arrayN(
+      zd->frames_len + 1, sizeof(*zd->uncompressed_offset), __func__);
+
+  off64_t compressed_offset = 0, uncompressed_offset = 0;
+  size_t uncompressed_size_max = 0;
+  const uchar *entry = table + 8;
+  for (int i = 0; i < zd->frames_len; i++, entry += entry_size) {
+    zd->compressed_offset[i] = compressed_offset;
+    zd->uncompressed_offset[i] = uncompressed_offset;
+    compressed_offset += zstd_get_uint32(entry);
+    uncompressed_offset += zstd_get_uint32(entry + 4);
+    uncompressed_size_max = MAX2(uncompressed_size_max, zstd_get_uint32(entry + 4));
+  }
+  zd->compressed_offset[zd->frames_len] = compressed_offset;
+  zd->uncompressed_offset[zd->frames_len] = uncompressed_offset;
+  MEM_freeN(table);
+
+  /* The frames must exactly fill the space before the seek table. */
+  if (compressed_offset != table_offset) {
+    zd->frames_len = 0;
+    MEM_SAFE_FREE(zd->compressed_offset);
+    MEM_SAFE_FREE(zd->uncompressed_offset);
+    return false;
+  }
+
+  zd->frame_buf_size = uncompressed_size_max;
+  zd->frame_buf = MEM_mallocN(MAX2(zd->frame_buf_size, 1), __func__);
+  return true;
+}
+
+static ZstdReadData *zstd_read_data_create(int filedes)
+{
+  ZstdReadData *zd = MEM_callocN(sizeof(*zd), __func__);
+  zd->dctx = ZSTD_createDCtx();
+  zd->frame_cached = -1;
+
+  if (!zstd_read_seek_table(zd, filedes)) {
+    /* Fall back to streaming. */
+    zd->stream_in_buf_size = ZSTD_DStreamInSize();
+    zd->stream_in_buf = MEM_mallocN(zd->stream_in_buf_size, __func__);
+    zd->stream_in.src = zd->stream_in_buf;
+  }
+  BLI_lseek(filedes, 0, SEEK_SET);
+  return zd;
+}
+
+static void zstd_read_data_free(ZstdReadData *zd)
+{
+  ZSTD_freeDCtx(zd->dctx);
+  MEM_SAFE_FREE(zd->compressed_offset);
+  MEM_SAFE_FREE(zd->uncompressed_offset);
+  MEM_SAFE_FREE(zd->frame_buf);
+  MEM_SAFE_FREE(zd->stream_in_buf);
+  MEM_freeN(zd);
+}
+
+/**
+ * \return The frame containing the uncompressed \a offset, -1 when past the end of the data.
+ */
+static int zstd_frame_find(const ZstdReadData *zd, off64_t offset)
+{
+  if (offset < 0 || offset >= zd->uncompressed_offset[zd->frames_len]) {
+    return -1;
+  }
+  int low = 0, high = zd->frames_len;
+  while (high - low > 1) {
+    const int mid = (low + high) / 2;
+    if (zd->uncompressed_offset[mid] <= offset) {
+      low = mid;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+typedef struct ZstdDecompressData {
+  const ZstdReadData *zd;
+  int frame_first;
+  /** Compressed data, starting with `frame_first`. */
+  const char *src;
+  /** Uncompressed output, starting with `frame_first`. */
+  char *dst;
+  bool error;
+} ZstdDecompressData;
+
+static void zstd_decompress_frame_cb(void *__restrict userdata,
+                                     const int iter,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ZstdDecompressData *data = userdata;
+  const ZstdReadData *zd = data->zd;
+  const int frame = data->frame_first + iter;
+
+  const off64_t src_offset = zd->compressed_offset[frame] -
+                             zd->compressed_offset[data->frame_first];
+  const off64_t dst_offset = zd->uncompressed_offset[frame] -
+                             zd->uncompressed_offset[data->frame_first];
+  const size_t src_size = (size_t)(zd->compressed_offset[frame + 1] - zd->compressed_offset[frame]);
+  const size_t dst_size = (size_t)(zd->uncompressed_offset[frame + 1] -
+                                   zd->uncompressed_offset[frame]);
+
+  const size_t len = ZSTD_decompress(
+      data->dst + dst_offset, dst_size, data->src + src_offset, src_size);
+  if (ZSTD_isError(len) || len != dst_size) {
+    data->error = true;
+  }
+}
+
+/**
+ * Decompress frames `[frame_first, frame_end)` into \a dst, using multiple threads
+ * when there is more than one frame.
+ */
+static bool zstd_decompress_frames(FileData *fd, int frame_first, int frame_end, char *dst)
+{
+  const ZstdReadData *zd = fd->zstd_data;
+  const off64_t src_offset = zd->compressed_offset[frame_first];
+  const size_t src_size = (size_t)(zd->compressed_offset[frame_end] - src_offset);
+  char *src = MEM_mallocN(MAX2(src_size, 1), __func__);
+
+  ZstdDecompressData data = {
+      .zd = zd,
+      .frame_first = frame_first,
+      .src = src,
+      .dst = dst,
+      .error = !zstd_read_at(fd->filedes, src_offset, src, src_size),
+  };
+
+  if (!data.error) {
+    if (frame_end - frame_first == 1) {
+      const size_t dst_size = (size_t)(zd->uncompressed_offset[frame_end] -
+                                       zd->uncompressed_offset[frame_first]);
+      const size_t len = ZSTD_decompressDCtx(zd->dctx, dst, dst_size, src, src_size);
+      data.error = ZSTD_isError(len) || (len != dst_size);
+    }
+    else {
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1;
+      BLI_task_parallel_range(0, frame_end - frame_first, &data, zstd_decompress_frame_cb, &settings);
+    }
+  }
+
+  MEM_freeN(src);
+  return !data.error;
+}
+
+static ssize_t fd_read_zstd_from_file(FileData *filedata,
+                                      void *buffer,
+                                      size_t size,
+                                      bool *UNUSED(r_is_memchunck_identical))
+{
+  ZstdReadData *zd = filedata->zstd_data;
+  char *dst = buffer;
+  size_t done = 0;
+
+  while (done < size) {
+    const off64_t offset = filedata->file_offset;
+    const int frame = zstd_frame_find(zd, offset);
+    if (frame == -1) {
+      break;
+    }
+    const size_t remaining = size - done;
+
+    if ((frame != zd->frame_cached) && (offset == zd->uncompressed_offset[frame])) {
+      /* Decompress whole frames directly into the output. */
+      int frame_end = frame;
+      while ((frame_end < zd->frames_len) &&
+             (zd->uncompressed_offset[frame_end + 1] - offset <= (off64_t)remaining)) {
+        frame_end++;
+      }
+      if (frame_end > frame) {
+        if (!zstd_decompress_frames(filedata, frame, frame_end, dst + done)) {
+          return EOF;
+        }
+        const size_t len = (size_t)(zd->uncompressed_offset[frame_end] - offset);
+        done += len;
+        filedata->file_offset += len;
+        continue;
+      }
+    }
+
+    if (frame != zd->frame_cached) {
+      zd->frame_cached = -1;
+      if (!zstd_decompress_frames(filedata, frame, frame + 1, zd->frame_buf)) {
+        return EOF;
+      }
+      zd->frame_cached = frame;
+    }
+
+    const size_t frame_offset = (size_t)(offset - zd->uncompressed_offset[frame]);
+    const size_t frame_size = (size_t)(zd->uncompressed_offset[frame + 1] -
+                                       zd->uncompressed_offset[frame]);
+    const size_t len = MIN2(remaining, frame_size - frame_offset);
+    memcpy(dst + done, zd->frame_buf + frame_offset, len);
+    done += len;
+    filedata->file_offset += len;
+  }
+
+  return (ssize_t)done;
+}
+
+static off64_t fd_seek_zstd_from_file(FileData *filedata, off64_t offset, int whence)
+{
+  const ZstdReadData *zd = filedata->zstd_data;
+  const off64_t size = zd->uncompressed_offset[zd->frames_len];
+  off64_t new_offset;
+
+  switch (whence) {
+    case SEEK_SET:
+      new_offset = offset;
+      break;
+    case SEEK_CUR:
+      new_offset = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_offset = size + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  /* Only the frames being read are decompressed, seeking itself doesn't touch the file. */
+  if (new_offset < 0 || new_offset > size) {
+    return -1;
+  }
+  filedata->file_offset = new_offset;
+  return new_offset;
+}
+
+static ssize_t fd_read_zstd_stream_from_file(FileData *filedata,
+                                             void *buffer,
+                                             size_t size,
+                                             bool *UNUSED(r_is_memchunck_identical))
+{
+  ZstdReadData *zd = filedata->zstd_data;
+  ZSTD_outBuffer output = {buffer, size, 0};
+
+  while (output.pos < output.size) {
+    if (zd->stream_in.pos == zd->stream_in.size) {
+      const ssize_t readsize = read(filedata->filedes, zd->stream_in_buf, zd->stream_in_buf_size);
+      if (readsize <= 0) {
+        break;
+      }
+      zd->stream_in.size = (size_t)readsize;
+      zd->stream_in.pos = 0;
+    }
+
+    const size_t ret = ZSTD_decompressStream(zd->dctx, &output, &zd->stream_in);
+    if (ZSTD_isError(ret)) {
+      return EOF;
+    }
+  }
+
+  filedata->file_offset += (off64_t)output.pos;
+  return (ssize_t)output.pos;
+}
+
+#  undef ZSTD_SKIPPABLE_MAGIC
+#  undef ZSTD_SEEKABLE_MAGIC
+#  undef ZSTD_SEEK_TABLE_FOOTER_SIZE
+
+#endif /* WITH_ZSTD */
+
 /* Memory reading. */
 
 static ssize_t fd_read_from_memory(FileData *filedata,
@@ -1333,9 +1646,9 @@ static FileData *filedata_new(void)
 
   fd->memsdna = DNA_sdna_current_get();
 
-  fd->datamap = oldnewmap_new();
-  fd->globmap = oldnewmap_new();
-  fd->libmap = oldnewmap_new();
+  fd->datamap = blo_oldnewmap_new();
+  fd->globmap = blo_oldnewmap_new();
+  fd->libmap = blo_oldnewmap_new();
 
   return fd;
 }
@@ -1388,9 +1701,19 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   BLI_lseek(file, 0, SEEK_SET);
 
   /* Regular file. */
+  BLI_mmap_file *mmap_file = NULL;
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    read_fn = fd_read_data_from_file;
-    seek_fn = fd_seek_data_from_file;
+    /* Prefer memory-mapped reading, blocks are then copied (or reconstructed) straight from the
+     * mapping, and the OS page cache is used instead of private read buffers. */
+    mmap_file = BLI_mmap_open(file);
+    if (mmap_file != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_from_mmap;
+    }
+    else {
+      read_fn = fd_read_data_from_file;
+      seek_fn = fd_seek_data_from_file;
+    }
   }
 
   /* Gzip file. */
@@ -1414,6 +1737,30 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
     file = -1;
   }
 
+  /* Zstd file. */
+#ifdef WITH_ZSTD
+  struct ZstdReadData *zstd_data = NULL;
+  if ((read_fn == NULL) && blo_header_is_zstd(header)) {
+    zstd_data = zstd_read_data_create(file);
+    if (zstd_data->frames_len != 0) {
+      read_fn = fd_read_zstd_from_file;
+      seek_fn = fd_seek_zstd_from_file;
+    }
+    else {
+      /* No seek table, 'seek_fn' can't be supported. */
+      read_fn = fd_read_zstd_stream_from_file;
+    }
+  }
+#else
+  if ((read_fn == NULL) && blo_header_is_zstd(header)) {
+    BKE_reportf(reports,
+                RPT_WARNING,
+                "Unable to read '%s': Zstandard compressed files are not supported in this build",
+                filepath);
+    return NULL;
+  }
+#endif
+
   if (read_fn == NULL) {
     BKE_reportf(reports, RPT_WARNING, "Unrecognized file format '%s'", filepath);
     return NULL;
@@ -1423,6 +1770,13 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  if (mmap_file != NULL) {
+    fd->mmap_file = mmap_file;
+    fd->buffersize = BLI_mmap_get_length(mmap_file);
+  }
+#ifdef WITH_ZSTD
+  fd->zstd_data = zstd_data;
+#endif
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1524,6 +1878,41 @@ static int fd_read_gzip_from_memory_init(FileData *fd)
   return 1;
 }
 
+#ifdef WITH_ZSTD
+static ssize_t fd_read_zstd_from_memory(FileData *filedata,
+                                        void *buffer,
+                                        size_t size,
+                                        bool *UNUSED(r_is_memchunck_identical))
+{
+  ZstdReadData *zd = filedata->zstd_data;
+  ZSTD_outBuffer output = {buffer, size, 0};
+
+  /* The whole file is the input buffer, the seek table frame is skipped by the decoder. */
+  while (output.pos < output.size && zd->stream_in.pos < zd->stream_in.size) {
+    const size_t ret = ZSTD_decompressStream(zd->dctx, &output, &zd->stream_in);
+    if (ZSTD_isError(ret)) {
+      printf("fd_read_zstd_from_memory: zstd error: %s\n", ZSTD_getErrorName(ret));
+      return 0;
+    }
+  }
+
+  filedata->file_offset += (off64_t)output.pos;
+  return (ssize_t)output.pos;
+}
+
+static void fd_read_zstd_from_memory_init(FileData *fd)
+{
+  ZstdReadData *zd = MEM_callocN(sizeof(*zd), __func__);
+  zd->dctx = ZSTD_createDCtx();
+  zd->frame_cached = -1;
+  zd->stream_in.src = fd->buffer;
+  zd->stream_in.size = fd->buffersize;
+
+  fd->zstd_data = zd;
+  fd->read = fd_read_zstd_from_memory;
+}
+#endif
+
 FileData *blo_filedata_from_memory(const void *mem, int memsize, ReportList *reports)
 {
   if (!mem || memsize < SIZEOFBLENDERHEADER) {
@@ -1544,6 +1933,18 @@ FileData *blo_filedata_from_memory(const void *mem, int memsize, ReportList *rep
       return NULL;
     }
   }
+  else if (blo_header_is_zstd(cp)) {
+#ifdef WITH_ZSTD
+    fd_read_zstd_from_memory_init(fd);
+#else
+    BKE_report(reports,
+               RPT_WARNING,
+               "Unable to read: Zstandard compressed files are not supported in this build");
+    fd->flags |= FD_FLAGS_NOT_MY_BUFFER;
+    blo_filedata_free(fd);
+    return NULL;
+#endif
+  }
   else {
     fd->read = fd_read_from_memory;
   }
@@ -1583,17 +1984,34 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->mmap_file != NULL) {
+      BLI_mmap_free(fd->mmap_file);
+    }
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
       }
     }
 
+#ifdef WITH_ZSTD
+    if (fd->zstd_data) {
+      zstd_read_data_free(fd->zstd_data);
+    }
+#endif
+
     if (fd->buffer && !(fd->flags & FD_FLAGS_NOT_MY_BUFFER)) {
       MEM_freeN((void *)fd->buffer);
       fd->buffer = NULL;
     }
 
+#ifdef USE_PARALLEL_DATA_READ
+    /* Free data that was prepared but not used (e.g. when reading its ID failed). */
+    LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+      MEM_SAFE_FREE(new_bhead->data_prepared);
+    }
+#endif
+
     /* Free all BHeadN data blocks */
 #ifndef NDEBUG
     BLI_freelistN(&fd->bhead_list);
@@ -1618,16 +2036,19 @@ void blo_filedata_free(FileData *fd)
     }
 
     if (fd->datamap) {
-      oldnewmap_free(fd->datamap);
+      blo_oldnewmap_free(fd->datamap);
     }
     if (fd->globmap) {
-      oldnewmap_free(fd->globmap);
+      blo_oldnewmap_free(fd->globmap);
     }
     if (fd->packedmap) {
-      oldnewmap_free(fd->packedmap);
+      blo_oldnewmap_free(fd->packedmap);
     }
     if (fd->libmap && !(fd->flags & FD_FLAGS_NOT_MY_LIBMAP)) {
-      oldnewmap_free(fd->libmap);
+      if (G.debug & G_DEBUG_IO) {
+        blo_oldnewmap_print_stats(fd->libmap, fd->relabase);
+      }
+      blo_oldnewmap_free(fd->libmap);
     }
     if (fd->old_idmap != NULL) {
       BKE_main_idmap_destroy(fd->old_idmap);
@@ -1643,6 +2064,13 @@ void blo_filedata_free(FileData *fd)
     }
 #endif
 
+    if (fd->lazy_id_bheads) {
+      BLI_ghash_free(fd->lazy_id_bheads, NULL, NULL);
+    }
+    if (fd->lazy_id_users) {
+      BLI_ghash_free(fd->lazy_id_users, NULL, NULL);
+    }
+
     MEM_freeN(fd);
   }
 }
@@ -1784,29 +2212,29 @@ BlendThumbnail *BLO_thumbnail_from_file(const char *filepath)
 /* only direct databocks */
 static void *newdataadr(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return blo_oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
 /* only direct databocks */
 static void *newdataadr_no_us(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
+  return blo_oldnewmap_lookup_and_inc(fd->datamap, adr, false);
 }
 
 /* direct datablocks with global linking */
 void *blo_read_get_new_globaldata_address(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->globmap, adr, true);
+  return blo_oldnewmap_lookup_and_inc(fd->globmap, adr, true);
 }
 
 /* used to restore packed data after undo */
 static void *newpackedadr(FileData *fd, const void *adr)
 {
   if (fd->packedmap && adr) {
-    return oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
+    return blo_oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
   }
 
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return blo_oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
 /* only lib data */
@@ -1821,21 +2249,32 @@ void *blo_do_versions_newlibadr(FileData *fd, const void *lib, const void *adr)
   return newlibadr(fd, lib, adr);
 }
 
-/* increases user number */
-static void change_link_placeholder_to_real_ID_pointer_fd(FileData *fd, const void *old, void *new)
-{
-  for (int i = 0; i < fd->libmap->nentries; i++) {
-    OldNew *entry = &fd->libmap->entries[i];
+typedef struct PlaceholderReplaceData {
+  const void *old;
+  void *new;
+} PlaceholderReplaceData;
 
-    if (old == entry->newp && entry->nr == ID_LINK_PLACEHOLDER) {
-      entry->newp = new;
-      if (new) {
-        entry->nr = GS(((ID *)new)->name);
-      }
+static void change_link_placeholder_to_real_ID_pointer_cb(const void *UNUSED(oldp),
+                                                          void **r_newp,
+                                                          int *r_nr,
+                                                          void *user_data)
+{
+  PlaceholderReplaceData *data = user_data;
+  if (data->old == *r_newp && *r_nr == ID_LINK_PLACEHOLDER) {
+    *r_newp = data->new;
+    if (data->new) {
+      *r_nr = GS(((ID *)data->new)->name);
     }
   }
 }
 
+/* increases user number */
+static void change_link_placeholder_to_real_ID_pointer_fd(FileData *fd, const void *old, void *new)
+{
+  PlaceholderReplaceData data = {old, new};
+  blo_oldnewmap_foreach(fd->libmap, change_link_placeholder_to_real_ID_pointer_cb, &data);
+}
+
 static void change_link_placeholder_to_real_ID_pointer(ListBase *mainlist,
                                                        FileData *basefd,
                                                        void *old,
@@ -1877,13 +2316,13 @@ void blo_clear_proxy_pointers_from_lib(Main *oldmain)
 
 static void insert_packedmap(FileData *fd, PackedFile *pf)
 {
-  oldnewmap_insert(fd->packedmap, pf, pf, 0);
-  oldnewmap_insert(fd->packedmap, pf->data, pf->data, 0);
+  blo_oldnewmap_insert(fd->packedmap, pf, pf, 0);
+  blo_oldnewmap_insert(fd->packedmap, pf->data, pf->data, 0);
 }
 
 void blo_make_packed_pointer_map(FileData *fd, Main *oldmain)
 {
-  fd->packedmap = oldnewmap_new();
+  fd->packedmap = blo_oldnewmap_new();
 
   LISTBASE_FOREACH (Image *, ima, &oldmain->images) {
     if (ima->packedfile) {
@@ -1922,18 +2361,22 @@ void blo_make_packed_pointer_map(FileData *fd, Main *oldmain)
   }
 }
 
+static void clear_restored_packed_pointer_cb(const void *UNUSED(oldp),
+                                             void **r_newp,
+                                             int *r_nr,
+                                             void *UNUSED(user_data))
+{
+  if (*r_nr > 0) {
+    *r_newp = NULL;
+  }
+}
+
 /* set old main packed data to zero if it has been restored */
 /* this works because freeing old main only happens after this call */
 void blo_end_packed_pointer_map(FileData *fd, Main *oldmain)
 {
-  OldNew *entry = fd->packedmap->entries;
-
   /* used entries were restored, so we put them to zero */
-  for (int i = 0; i < fd->packedmap->nentries; i++, entry++) {
-    if (entry->nr > 0) {
-      entry->newp = NULL;
-    }
-  }
+  blo_oldnewmap_foreach(fd->packedmap, clear_restored_packed_pointer_cb, NULL);
 
   LISTBASE_FOREACH (Image *, ima, &oldmain->images) {
     ima->packedfile = newpackedadr(fd, ima->packedfile);
@@ -1969,7 +2412,7 @@ void blo_add_library_pointer_map(ListBase *old_mainlist, FileData *fd)
     int i = set_listbasepointers(ptr, lbarray);
     while (i--) {
       LISTBASE_FOREACH (ID *, id, lbarray[i]) {
-        oldnewmap_insert(fd->libmap, id, id, GS(id->name));
+        blo_oldnewmap_insert(fd->libmap, id, id, GS(id->name));
       }
     }
   }
@@ -2149,7 +2592,13 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+/**
+ * Read (and convert to the current DNA when needed) the data of a block.
+ *
+ * \param r_error: Set when reading failed, the caller is responsible for flagging \a fd
+ * (so this can be used from multiple threads, see #USE_PARALLEL_DATA_READ).
+ */
+static void *read_struct_ex(FileData *fd, BHead *bh, const char *blockname, bool *r_error)
 {
   void *temp = NULL;
 
@@ -2164,7 +2613,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
         bh = blo_bhead_read_full(fd, bh);
         if (UNLIKELY(bh == NULL)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
+          *r_error = true;
           return NULL;
         }
       }
@@ -2174,16 +2623,27 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+          /* Reconstruct straight from the memory-mapped file, avoiding a temporary copy. */
+          data = blo_bhead_data_mapped(fd, bh);
+          if (data == NULL) {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              *r_error = true;
+              return NULL;
+            }
+            data = (bh + 1);
           }
         }
 #endif
-        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, data);
+        if (fd->mmap_file && UNLIKELY(BLI_mmap_any_io_error(fd->mmap_file))) {
+          *r_error = true;
+          MEM_freeN(temp);
+          temp = NULL;
+        }
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -2196,7 +2656,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
           if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_error = true;
             MEM_freeN(temp);
             temp = NULL;
           }
@@ -2217,6 +2677,26 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+#ifdef USE_PARALLEL_DATA_READ
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(bh);
+  if (new_bhead->data_prepared != NULL) {
+    /* Already read by #read_file_data_prepare_parallel, take ownership. */
+    void *temp = new_bhead->data_prepared;
+    new_bhead->data_prepared = NULL;
+    return temp;
+  }
+#endif
+
+  bool error = false;
+  void *temp = read_struct_ex(fd, bh, blockname, &error);
+  if (UNLIKELY(error)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+  return temp;
+}
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -2236,7 +2716,7 @@ static void link_glob_list(FileData *fd, ListBase *lb) /* for glob data */
   }
   poin = newdataadr(fd, lb->first);
   if (lb->first) {
-    oldnewmap_insert(fd->globmap, lb->first, poin, 0);
+    blo_oldnewmap_insert(fd->globmap, lb->first, poin, 0);
   }
   lb->first = poin;
 
@@ -2245,7 +2725,7 @@ static void link_glob_list(FileData *fd, ListBase *lb) /* for glob data */
   while (ln) {
     poin = newdataadr(fd, ln->next);
     if (ln->next) {
-      oldnewmap_insert(fd->globmap, ln->next, poin, 0);
+      blo_oldnewmap_insert(fd->globmap, ln->next, poin, 0);
     }
     ln->next = poin;
     ln->prev = prev;
@@ -2425,6 +2905,13 @@ static void direct_link_id_common(
 
   BKE_lib_libblock_session_uuid_ensure(id);
 
+  if (reader->fd->lazy_id_users != NULL) {
+    /* Stored user count, see #read_libblock_lazy_users_restore. */
+    BLI_ghash_insert(reader->fd->lazy_id_users,
+                     POINTER_FROM_UINT(id->session_uuid),
+                     POINTER_FROM_INT(id->us));
+  }
+
   id->lib = current_library;
   id->us = ID_FAKE_USERS(id);
   id->icon_id = 0;
@@ -5511,7 +5998,7 @@ static void direct_link_windowmanager(BlendDataReader *reader, wmWindowManager *
       /* We need to restore a pointer to this later when reading workspaces,
        * so store in global oldnew-map.
        * Note that this is only needed for versioning of older .blend files now.. */
-      oldnewmap_insert(reader->fd->globmap, hook, win->workspace_hook, 0);
+      blo_oldnewmap_insert(reader->fd->globmap, hook, win->workspace_hook, 0);
       /* Cleanup pointers to data outside of this data-block scope. */
       win->workspace_hook->act_layout = NULL;
       win->workspace_hook->temp_workspace_store = NULL;
@@ -6455,6 +6942,19 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
 {
   bhead = blo_bhead_next(fd, bhead);
 
+  /* Size the map up-front for ID's with many data-blocks (meshes, node-trees...),
+   * instead of growing it several times while inserting. */
+  {
+    int64_t data_num = 0;
+    for (BHead *bhead_iter = bhead; bhead_iter && bhead_iter->code == DATA;
+         bhead_iter = blo_bhead_next(fd, bhead_iter)) {
+      data_num++;
+    }
+    if (data_num > 64) {
+      blo_oldnewmap_reserve(fd->datamap, data_num);
+    }
+  }
+
   while (bhead && bhead->code == DATA) {
     /* The code below is useful for debugging leaks in data read from the blend file.
      * Without this the messages only tell us what ID-type the memory came from,
@@ -6474,7 +6974,7 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
 
     void *data = read_struct(fd, bhead, allocname);
     if (data) {
-      oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+      blo_oldnewmap_insert(fd->datamap, bhead->old, data, 0);
     }
 
     bhead = blo_bhead_next(fd, bhead);
@@ -6556,7 +7056,7 @@ static bool read_libblock_undo_restore_linked(FileData *fd, Main *main, const ID
     /* Even though we found our linked ID, there is no guarantee its address
      * is still the same. */
     if (id_old != bhead->old) {
-      oldnewmap_insert(fd->libmap, bhead->old, id_old, GS(id_old->name));
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id_old, GS(id_old->name));
     }
 
     /* No need to do anything else for ID_LINK_PLACEHOLDER, it's assumed
@@ -6706,7 +7206,7 @@ static bool read_libblock_undo_restore(
     /* Insert into library map for lookup by newly read datablocks (with pointer value bhead->old).
      * Note that existing datablocks in memory (which pointer value would be id_old) are not
      * remapped anymore, so no need to store this info here. */
-    oldnewmap_insert(fd->libmap, bhead->old, id_old, bhead->code);
+    blo_oldnewmap_insert(fd->libmap, bhead->old, id_old, bhead->code);
 
     *r_id_old = id_old;
     return true;
@@ -6730,6 +7230,81 @@ static bool read_libblock_undo_restore(
  * When reading for undo, libraries, linked datablocks and unchanged datablocks
  * will be restored from the old database. Only new or changed datablocks will
  * actually be read. */
+/* -------------------------------------------------------------------- */
+/** \name Lazy Loading
+ *
+ * With #BLO_READ_LAZY_DATA, meshes, images and volumes of the main file are added to Main as
+ * empty placeholders tagged with #LIB_TAG_LAZY_LOAD, without reading any of their data-blocks.
+ * The #FileData is then owned by the Main (#blo_lazy_load_register), and the contents are read
+ * into the placeholders on first access (#BKE_main_lazy_load_ensure_id).
+ *
+ * Lazy loaded ID's are not versioned, so this is only used for files saved with this version.
+ * \{ */
+
+typedef struct LazyLoad {
+  FileData *fd;
+  /** Placeholder ID -> #BHead of its contents in the file. */
+  GHash *id_bheads;
+  /** Old address of every ID the file can point to -> session UUID of the ID it was read into,
+   * so ID's freed since the file was read can't be accessed. */
+  GHash *old_session_uuids;
+  /** Lib-map built from `old_session_uuids`, kept until ID's are freed from Main. */
+  OldNewMap *libmap;
+} LazyLoad;
+
+static bool read_libblock_is_lazy_code(const FileData *fd, const short idcode)
+{
+  return (fd->lazy_id_bheads != NULL) && ELEM(idcode, ID_ME, ID_IM, ID_VO);
+}
+
+static bool read_libblock_is_lazy(const FileData *fd, const Main *main, const short idcode)
+{
+  return read_libblock_is_lazy_code(fd, idcode) && (main->curlib == NULL) &&
+         (main->versionfile == BLENDER_FILE_VERSION) &&
+         (main->subversionfile == BLENDER_FILE_SUBVERSION);
+}
+
+/**
+ * Replace the ID struct read from the file by an empty data-block of the same type,
+ * only keeping the generic ID data (name, flags). The rest of the ID header (ID-properties,
+ * library override) is moved in from the file with the contents, see #lazy_load_read_id.
+ */
+static ID *read_libblock_lazy_placeholder(ID *id_file, const int tag)
+{
+  ID *id = BKE_libblock_alloc_notest(GS(id_file->name));
+  BLI_strncpy(id->name, id_file->name, sizeof(id->name));
+  id->flag = id_file->flag & ~LIB_INDIRECT_WEAK_LINK;
+  id->us = ID_FAKE_USERS(id);
+  id->tag = tag | LIB_TAG_LAZY_LOAD;
+  BKE_libblock_init_empty(id);
+  BKE_lib_libblock_session_uuid_ensure(id);
+
+  MEM_freeN(id_file);
+  return id;
+}
+
+/**
+ * User counts are computed after reading, without the references from the contents of lazily
+ * loaded ID's. Keep the user counts stored in the file instead, so e.g. materials only used by
+ * lazily loaded meshes don't end up without users.
+ */
+static void read_libblock_lazy_users_restore(FileData *fd, Main *bmain)
+{
+  if ((fd->lazy_id_bheads == NULL) || (BLI_ghash_len(fd->lazy_id_bheads) == 0)) {
+    return;
+  }
+  ID *id;
+  FOREACH_MAIN_ID_BEGIN (bmain, id) {
+    void **users_p = BLI_ghash_lookup_p(fd->lazy_id_users, POINTER_FROM_UINT(id->session_uuid));
+    if (users_p != NULL) {
+      id->us = MAX2(id->us, POINTER_AS_INT(*users_p));
+    }
+  }
+  FOREACH_MAIN_ID_END;
+}
+
+/** \} */
+
 static BHead *read_libblock(FileData *fd,
                             Main *main,
                             BHead *bhead,
@@ -6772,6 +7347,12 @@ static BHead *read_libblock(FileData *fd,
     return blo_bhead_next(fd, bhead);
   }
 
+  const bool is_lazy = (bhead->code != ID_LINK_PLACEHOLDER) && (id_old == NULL) &&
+                       read_libblock_is_lazy(fd, main, idcode);
+  if (is_lazy) {
+    id = read_libblock_lazy_placeholder(id, tag | LIB_TAG_NEW);
+  }
+
   /* NOTE: id must be added to the list before direct_link_id(), since
    * direct_link_library() may remove it from there in case of duplicates. */
   BLI_addtail(lb, id);
@@ -6780,12 +7361,21 @@ static BHead *read_libblock(FileData *fd,
    * Note that existing datablocks in memory (which pointer value would be id_old) are not remapped
    * remapped anymore, so no need to store this info here. */
   ID *id_target = id_old ? id_old : id;
-  oldnewmap_insert(fd->libmap, bhead->old, id_target, bhead->code);
+  blo_oldnewmap_insert(fd->libmap, bhead->old, id_target, bhead->code);
 
   if (r_id) {
     *r_id = id_target;
   }
 
+  if (is_lazy) {
+    /* Skip the data-blocks, they are read with the ID. */
+    BLI_ghash_insert(fd->lazy_id_bheads, id, bhead);
+    do {
+      bhead = blo_bhead_next(fd, bhead);
+    } while (bhead && bhead->code == DATA);
+    return bhead;
+  }
+
   /* Set tag for new datablock to indicate lib linking and versioning needs
    * to be done still. */
   int id_tag = tag | LIB_TAG_NEED_LINK | LIB_TAG_NEW;
@@ -6812,7 +7402,7 @@ static BHead *read_libblock(FileData *fd,
   const char *allocname = dataname(idcode);
   bhead = read_data_into_datamap(fd, bhead, allocname);
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
-  oldnewmap_clear(fd->datamap);
+  blo_oldnewmap_clear_and_free_unused(fd->datamap);
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -7207,17 +7797,314 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
   user->edit_studio_light = 0;
 
   /* free fd->datamap again */
-  oldnewmap_clear(fd->datamap);
+  blo_oldnewmap_clear_and_free_unused(fd->datamap);
 
   return bhead;
 }
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Lazy Loading (Read on Access)
+ * \{ */
+
+static void lazy_load_store_session_uuid_cb(const void *oldp,
+                                            void **r_newp,
+                                            int *UNUSED(r_nr),
+                                            void *user_data)
+{
+  GHash *old_session_uuids = user_data;
+  const ID *id = *r_newp;
+  BLI_ghash_insert(old_session_uuids, (void *)oldp, POINTER_FROM_UINT(id->session_uuid));
+}
+
+static void lazy_load_read_id(LazyLoad *lazy, Main *bmain, ID *id)
+{
+  FileData *fd = lazy->fd;
+  BHead *bhead = BLI_ghash_popkey(lazy->id_bheads, id, NULL);
+  if (bhead == NULL) {
+    return;
+  }
+
+  ID *id_file = read_struct(fd, bhead, "lib block");
+  if (id_file == NULL) {
+    return;
+  }
+
+  read_data_into_datamap(fd, bhead, dataname(GS(id->name)));
+  const bool success = direct_link_id(fd, bmain, LIB_TAG_NO_MAIN, id_file, NULL);
+  blo_oldnewmap_clear_and_free_unused(fd->datamap);
+  if (!success) {
+    BKE_id_free_ex(bmain, id_file, LIB_ID_FREE_NO_MAIN | LIB_ID_FREE_NO_USER_REFCOUNT, false);
+    return;
+  }
+
+  BlendLibReader reader = {fd, bmain};
+  lib_link_id(&reader, id_file);
+  const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id_file);
+  if (id_type->blend_read_lib != NULL) {
+    id_type->blend_read_lib(&reader, id_file);
+  }
+
+  /* Move the contents into the placeholder, existing pointers to it remain valid.
+   * Pointers to itself were already resolved to the placeholder by the lib-map.
+   * Swapping keeps the ID header of the placeholder except for its ID-properties, move in the
+   * rest of the header data read from the file too. */
+  BKE_lib_id_swap(NULL, id, id_file);
+  SWAP(IDOverrideLibrary *, id->override_library, id_file->override_library);
+  BKE_id_free_ex(bmain,
+                 id_file,
+                 LIB_ID_FREE_NO_MAIN | LIB_ID_FREE_NO_USER_REFCOUNT | LIB_ID_FREE_NO_DEG_TAG |
+                     LIB_ID_FREE_NO_UI_USER,
+                 false);
+
+  /* User counts are not changed: the counts stored in the file were kept when reading
+   * (see #read_libblock_lazy_users_restore), they include the references of this ID. */
+}
+
+static void lazy_load_ensure_fn(Main *bmain, ID **ids, int ids_len, void *user_data)
+{
+  LazyLoad *lazy = user_data;
+  FileData *fd = lazy->fd;
+
+  /* Resolve ID pointers through the ID's currently in Main, pointers to ID's which were freed
+   * since the file was read are cleared. The lib-map is kept for following reads (which can be
+   * one ID at a time, e.g. while building a depsgraph), until ID's are freed. */
+  if (bmain->lazy_load->ids_freed && lazy->libmap != NULL) {
+    blo_oldnewmap_free(lazy->libmap);
+    lazy->libmap = NULL;
+  }
+  bmain->lazy_load->ids_freed = false;
+  if (lazy->libmap == NULL) {
+    IDNameLib_Map *idmap = BKE_main_idmap_create(bmain, false, NULL, MAIN_IDMAP_TYPE_UUID);
+    lazy->libmap = blo_oldnewmap_new();
+    blo_oldnewmap_reserve(lazy->libmap, BLI_ghash_len(lazy->old_session_uuids));
+    GHashIterator gh_iter;
+    GHASH_ITER (gh_iter, lazy->old_session_uuids) {
+      const uint session_uuid = POINTER_AS_UINT(BLI_ghashIterator_getValue(&gh_iter));
+      ID *id = BKE_main_idmap_lookup_uuid(idmap, session_uuid);
+      if (id != NULL) {
+        blo_oldnewmap_insert(lazy->libmap, BLI_ghashIterator_getKey(&gh_iter), id, GS(id->name));
+      }
+    }
+    BKE_main_idmap_destroy(idmap);
+  }
+  BLI_assert(fd->libmap == NULL);
+  fd->libmap = lazy->libmap;
+
+  /* The tag is only cleared once the contents are in place, other threads check it without
+   * locking (see #BKE_main_lazy_load_ensure_id). */
+  if (ids != NULL) {
+    for (int i = 0; i < ids_len; i++) {
+      if (ids[i]->tag & LIB_TAG_LAZY_LOAD) {
+        lazy_load_read_id(lazy, bmain, ids[i]);
+        ids[i]->tag &= ~LIB_TAG_LAZY_LOAD;
+      }
+    }
+  }
+  else {
+    ListBase *lbarray[] = {&bmain->meshes, &bmain->images, &bmain->volumes};
+    for (int i = 0; i < ARRAY_SIZE(lbarray); i++) {
+      LISTBASE_FOREACH (ID *, id, lbarray[i]) {
+        if (id->tag & LIB_TAG_LAZY_LOAD) {
+          lazy_load_read_id(lazy, bmain, id);
+          id->tag &= ~LIB_TAG_LAZY_LOAD;
+        }
+      }
+    }
+  }
+
+  fd->libmap = NULL;
+}
+
+static void lazy_load_free_fn(void *user_data)
+{
+  LazyLoad *lazy = user_data;
+  BLI_ghash_free(lazy->id_bheads, NULL, NULL);
+  BLI_ghash_free(lazy->old_session_uuids, NULL, NULL);
+  if (lazy->libmap != NULL) {
+    blo_oldnewmap_free(lazy->libmap);
+  }
+  blo_filedata_free(lazy->fd);
+  MEM_freeN(lazy);
+}
+
+/**
+ * When ID's were read lazily, hand over \a fd to \a bmain, which keeps it open
+ * to read them later on.
+ *
+ * \return true when \a fd is now owned by \a bmain (and must not be freed).
+ */
+bool blo_lazy_load_register(FileData *fd, Main *bmain)
+{
+  if ((fd->lazy_id_bheads == NULL) || (BLI_ghash_len(fd->lazy_id_bheads) == 0)) {
+    return false;
+  }
+  BLI_assert(bmain->lazy_load == NULL);
+
+  LazyLoad *lazy = MEM_callocN(sizeof(*lazy), __func__);
+  lazy->fd = fd;
+  lazy->id_bheads = fd->lazy_id_bheads;
+  fd->lazy_id_bheads = NULL;
+
+  /* Only keep what is needed to rebuild the lib-map when reading ID's. */
+  lazy->old_session_uuids = BLI_ghash_ptr_new_ex(__func__, blo_oldnewmap_size(fd->libmap));
+  blo_oldnewmap_foreach(fd->libmap, lazy_load_store_session_uuid_cb, lazy->old_session_uuids);
+  blo_oldnewmap_free(fd->libmap);
+  fd->libmap = NULL;
+  BLI_ghash_free(fd->lazy_id_users, NULL, NULL);
+  fd->lazy_id_users = NULL;
+  /* Owned by the caller. */
+  fd->reports = NULL;
+
+  MainLazyLoad *lazy_load = MEM_callocN(sizeof(*lazy_load), __func__);
+  lazy_load->ensure_fn = lazy_load_ensure_fn;
+  lazy_load->free_fn = lazy_load_free_fn;
+  lazy_load->user_data = lazy;
+  bmain->lazy_load = lazy_load;
+
+  return true;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Read File (Internal)
  * \{ */
 
+#ifdef USE_PARALLEL_DATA_READ
+
+typedef struct DataPrepareTaskData {
+  FileData *fd;
+  BHead **bheads;
+  const char **allocnames;
+  bool error;
+} DataPrepareTaskData;
+
+static void read_file_data_prepare_cb(void *__restrict userdata,
+                                      const int index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DataPrepareTaskData *data = userdata;
+  BHead *bhead = data->bheads[index];
+  bool error = false;
+
+  BHEADN_FROM_BHEAD(bhead)->data_prepared = read_struct_ex(
+      data->fd, bhead, data->allocnames[index], &error);
+  if (UNLIKELY(error)) {
+    data->error = true;
+  }
+}
+
+static bool read_file_data_prepare_is_supported(FileData *fd)
+{
+  /* Undo skips reading unchanged ID's, so there is nothing to gain there. */
+  if ((fd->memfile != NULL) || (fd->skip_flags & BLO_READ_SKIP_DATA)) {
+    return false;
+  }
+  /* Concurrent reads are only supported when they don't need to change the file position. */
+  if ((fd->seek != NULL) && (fd->mmap_file == NULL)) {
+    return false;
+  }
+  return BLI_system_thread_count() > 1;
+}
+
+/* Allocation name of the DATA blocks following bhead, NULL when they are not prepared. */
+static const char *read_file_data_prepare_allocname(FileData *fd, const BHead *bhead)
+{
+  switch (bhead->code) {
+    /* Only prepare data of ID's, other blocks (#USER, #GLOB, ...) read their data differently. */
+    case DNA1:
+    case TEST:
+    case REND:
+    case GLOB:
+    case USER:
+    case ENDB:
+    case ID_LINK_PLACEHOLDER:
+      return NULL;
+    default:
+      return read_libblock_is_lazy_code(fd, bhead->code) ?
+                 NULL :
+                 dataname(bhead->code == ID_SCRN ? ID_SCR : bhead->code);
+  }
+}
+
+/**
+ * Read the DATA blocks belonging to ID's in parallel, starting at \a bhead_start, up to
+ * #PARALLEL_DATA_READ_BATCH_SIZE bytes of the file.
+ *
+ * ID's themselves are still read in order afterwards (#read_libblock),
+ * taking the prepared data instead of reading it (see #read_struct),
+ * so the resulting #OldNewMap contents are the same as when reading sequentially.
+ *
+ * \return The block to start the next batch at, when the ID's before it are read.
+ */
+static BHead *read_file_data_prepare_parallel(FileData *fd, BHead *bhead_start)
+{
+  /* Find the end of the batch, it always ends before an ID so its data is prepared at once. */
+  int bheads_len = 0;
+  size_t batch_size = 0;
+  const char *allocname = NULL;
+  BHead *bhead_end = bhead_start;
+  for (; bhead_end && bhead_end->code != ENDB; bhead_end = blo_bhead_next(fd, bhead_end)) {
+    if (bhead_end->code != DATA) {
+      if (batch_size >= PARALLEL_DATA_READ_BATCH_SIZE) {
+        break;
+      }
+      allocname = read_file_data_prepare_allocname(fd, bhead_end);
+    }
+    else if (allocname != NULL) {
+      bheads_len++;
+      batch_size += (size_t)bhead_end->len;
+    }
+  }
+  if (bhead_end && bhead_end->code == ENDB) {
+    bhead_end = NULL;
+  }
+  if (bheads_len == 0) {
+    return bhead_end;
+  }
+
+  BHead **bheads = MEM_malloc_arrayN(bheads_len, sizeof(*bheads), __func__);
+  const char **allocnames = MEM_malloc_arrayN(bheads_len, sizeof(*allocnames), __func__);
+
+  int i = 0;
+  for (BHead *bhead = bhead_start; bhead != bhead_end; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code != DATA) {
+      allocname = read_file_data_prepare_allocname(fd, bhead);
+    }
+    else if (allocname != NULL) {
+      bheads[i] = bhead;
+      allocnames[i] = allocname;
+      i++;
+    }
+  }
+  BLI_assert(i == bheads_len);
+
+  DataPrepareTaskData data = {
+      .fd = fd,
+      .bheads = bheads,
+      .allocnames = allocnames,
+      .error = false,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, bheads_len, &data, read_file_data_prepare_cb, &settings);
+
+  if (data.error) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+
+  MEM_freeN(bheads);
+  MEM_freeN(allocnames);
+
+  return bhead_end;
+}
+
+#endif /* USE_PARALLEL_DATA_READ */
+
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 {
   BHead *bhead = blo_bhead_first(fd);
@@ -7263,7 +8150,29 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  /* All ID's of the file end up in the lib-map, pre-size it from the number of blocks. */
+  {
+    int64_t ids_num = 0;
+    for (BHead *bhead_iter = bhead; bhead_iter && bhead_iter->code != ENDB;
+         bhead_iter = blo_bhead_next(fd, bhead_iter)) {
+      if (bhead_iter->code != DATA && BKE_idtype_idcode_is_valid(bhead_iter->code)) {
+        ids_num++;
+      }
+    }
+    blo_oldnewmap_reserve(fd->libmap, ids_num);
+  }
+
+#ifdef USE_PARALLEL_DATA_READ
+  /* Data is prepared in batches, when reading reaches the start of the next one. */
+  BHead *bhead_prepare_next = read_file_data_prepare_is_supported(fd) ? bhead : NULL;
+#endif
+
   while (bhead) {
+#ifdef USE_PARALLEL_DATA_READ
+    if (bhead == bhead_prepare_next) {
+      bhead_prepare_next = read_file_data_prepare_parallel(fd, bhead);
+    }
+#endif
     switch (bhead->code) {
       case DATA:
       case DNA1:
@@ -7355,6 +8264,7 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
        * does not always properly handle user counts, and/or that function does not take into
        * account old, deprecated data. */
       BKE_main_id_refcount_recompute(bfd->main, false);
+      read_libblock_lazy_users_restore(fd, bfd->main);
 
       /* After all data has been read and versioned, uses LIB_TAG_NEW. */
       ntreeUpdateAllNew(bfd->main);
@@ -7596,7 +8506,7 @@ static void expand_doit_library(void *fdhandle, Main *mainvar, void *old)
        * (B) forest.blend: contains Forest collection linking in Tree from tree.blend.
        * (C) shot.blend: links in both Tree from tree.blend and Forest from forest.blend.
        */
-      oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
 
       /* If "id" is a real data-lock and not a placeholder, we need to
        * update fd->libmap to replace ID_LINK_PLACEHOLDER with the real
@@ -7638,7 +8548,7 @@ static void expand_doit_library(void *fdhandle, Main *mainvar, void *old)
       /* this is actually only needed on UI call? when ID was already read before,
        * and another append happens which invokes same ID...
        * in that case the lookup table needs this entry */
-      oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
       /* commented because this can print way too much */
       // if (G.debug & G_DEBUG) printf("expand: already read %s\n", id->name);
     }
@@ -8369,7 +9279,7 @@ static ID *link_named_part(
       if (G.debug) {
         printf("append: already linked\n");
       }
-      oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
       if (!force_indirect && (id->tag & LIB_TAG_INDIRECT)) {
         id->tag &= ~LIB_TAG_INDIRECT;
         id->flag &= ~LIB_INDIRECT_WEAK_LINK;
@@ -8915,10 +9825,10 @@ static FileData *read_library_file_data(FileData *basefd,
     fd->reports = basefd->reports;
 
     if (fd->libmap) {
-      oldnewmap_free(fd->libmap);
+      blo_oldnewmap_free(fd->libmap);
     }
 
-    fd->libmap = oldnewmap_new();
+    fd->libmap = blo_oldnewmap_new();
 
     mainptr->curlib->filedata = fd;
     mainptr->versionfile = fd->fileversion;
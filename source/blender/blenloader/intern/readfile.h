@@ -33,6 +33,7 @@
 #include "DNA_windowmanager_types.h" /* for ReportType */
 #include "zlib.h"
 
+struct BLI_mmap_file;
 struct BLOCacheStorage;
 struct GSet;
 struct IDNameLib_Map;
@@ -44,6 +45,7 @@ struct PartEff;
 struct ReportList;
 struct UserDef;
 struct View3D;
+struct ZstdReadData;
 
 typedef struct IDNameLib_Map IDNameLib_Map;
 
@@ -85,6 +87,8 @@ typedef struct FileData {
 
   /** Regular file reading. */
   int filedes;
+  /** Memory-mapped reading of uncompressed files (the size is stored in #buffersize). */
+  struct BLI_mmap_file *mmap_file;
 
   /** Variables needed for reading from memory / stream. */
   const char *buffer;
@@ -98,6 +102,8 @@ typedef struct FileData {
   gzFile gzfiledes;
   /** Gzip stream for memory decompression. */
   z_stream strm;
+  /** Zstandard file reading (uses #FileData.filedes), see `fd_read_zstd_from_file`. */
+  struct ZstdReadData *zstd_data;
 
   /** Now only in use for library appending. */
   char relabase[FILE_MAX];
@@ -130,6 +136,11 @@ typedef struct FileData {
   /** See: #USE_GHASH_BHEAD. */
   struct GHash *bhead_idname_hash;
 
+  /** With #BLO_READ_LAZY_DATA, placeholder ID's to their #BHead, see #blo_lazy_load_register. */
+  struct GHash *lazy_id_bheads;
+  /** With #BLO_READ_LAZY_DATA, session UUID of ID's to the user count stored in the file. */
+  struct GHash *lazy_id_users;
+
   ListBase *mainlist;
   /** Used for undo. */
   ListBase *old_mainlist;
@@ -146,6 +157,7 @@ void blo_join_main(ListBase *mainlist);
 void blo_split_main(ListBase *mainlist, struct Main *main);
 
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath);
+bool blo_lazy_load_register(FileData *fd, struct Main *bmain);
 
 FileData *blo_filedata_from_file(const char *filepath, struct ReportList *reports);
 FileData *blo_filedata_from_memory(const void *mem, int memsize, struct ReportList *reports);
@@ -88,6 +88,14 @@
 #  include <unistd.h> /* FreeBSD, for write() and close(). */
 #endif
 
+#ifdef __linux__
+#  include <sys/syscall.h> /* For copy_file_range(). */
+#endif
+
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+#endif
+
 #include "BLI_utildefines.h"
 
 /* allow writefile to use deprecated functionality (for forward compatibility code) */
@@ -124,7 +132,11 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
+#include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
 #include "BKE_action.h"
@@ -183,6 +195,17 @@
 /** Use if we want to store how many bytes have been written to the file. */
 // #define USE_WRITE_DATA_LEN
 
+/**
+ * Re-use the on-disk data of unchanged IDs from the previous save of the same file,
+ * see #BlendFileWriteParams.use_incremental.
+ *
+ * Only the kernel can share file ranges without copying them through user-space,
+ * other platforms would gain nothing from this.
+ */
+#if defined(__linux__) && defined(__NR_copy_file_range)
+#  define USE_WRITE_INCREMENTAL
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name Internal Write Wrapper's (Abstracts Compression)
  * \{ */
@@ -190,6 +213,9 @@
 typedef enum {
   WW_WRAP_NONE = 1,
   WW_WRAP_ZLIB,
+#ifdef WITH_ZSTD
+  WW_WRAP_ZSTD,
+#endif
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
@@ -206,6 +232,9 @@ struct WriteWrap {
   union {
     int file_handle;
     gzFile gz_handle;
+#ifdef WITH_ZSTD
+    struct ZstdWriteWrap *zstd_handle;
+#endif
   } _user_data;
 };
 
@@ -261,6 +290,224 @@ static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
+#ifdef WITH_ZSTD
+
+/* zstd
+ *
+ * Data is split into frames of #ZSTD_FRAME_SIZE uncompressed bytes, each one compressed
+ * independently so readers can seek by decompressing only the frames they need.
+ * The file ends with a seek table using the Zstandard "seekable format"
+ * (see `contrib/seekable_format` in the zstd sources), stored in a skippable frame
+ * so regular zstd decoders still decompress the file as a whole. */
+
+/** Uncompressed size of each frame. */
+#  define ZSTD_FRAME_SIZE (1 << 20)
+/** Favor save speed, matches the zlib level used for #WW_WRAP_ZLIB. */
+#  define ZSTD_COMPRESSION_LEVEL 1
+
+#  define ZSTD_SKIPPABLE_MAGIC 0x184D2A5E
+#  define ZSTD_SEEKABLE_MAGIC 0x8F92EAB1
+
+typedef struct ZstdFrameInfo {
+  uint32_t compressed_size;
+  uint32_t uncompressed_size;
+} ZstdFrameInfo;
+
+typedef struct ZstdWriteWrap {
+  int file_handle;
+
+  /** Uncompressed input, holds up to #batch_len frames which are compressed in parallel. */
+  char *in_buf;
+  size_t in_buf_used;
+  int batch_len;
+
+  /** One compression context and output buffer per frame of the batch. */
+  ZSTD_CCtx **cctx;
+  char **out_buf;
+  size_t *out_buf_used;
+  size_t out_buf_size;
+
+  /** Size of every frame written so far, used for the seek table. */
+  ZstdFrameInfo *frames;
+  int frames_len;
+  int frames_alloc;
+
+  bool error;
+} ZstdWriteWrap;
+
+#  define FILE_HANDLE(ww) (ww)->_user_data.zstd_handle
+
+static void ww_zstd_compress_frame_cb(void *__restrict userdata,
+                                      const int frame_index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ZstdWriteWrap *zww = userdata;
+  const size_t in_offset = (size_t)frame_index * ZSTD_FRAME_SIZE;
+  const size_t in_len = MIN2(zww->in_buf_used - in_offset, ZSTD_FRAME_SIZE);
+
+  const size_t out_len = ZSTD_compressCCtx(zww->cctx[frame_index],
+                                           zww->out_buf[frame_index],
+                                           zww->out_buf_size,
+                                           zww->in_buf + in_offset,
+                                           in_len,
+                                           ZSTD_COMPRESSION_LEVEL);
+  zww->out_buf_used[frame_index] = ZSTD_isError(out_len) ? 0 : out_len;
+}
+
+/**
+ * Compress all pending input (each frame on its own thread) and write the frames in order.
+ */
+static void ww_zstd_flush_batch(ZstdWriteWrap *zww)
+{
+  if (zww->in_buf_used == 0 || zww->error) {
+    return;
+  }
+
+  const int frames_num = (int)((zww->in_buf_used + ZSTD_FRAME_SIZE - 1) / ZSTD_FRAME_SIZE);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, frames_num, zww, ww_zstd_compress_frame_cb, &settings);
+
+  for (int i = 0; i < frames_num; i++) {
+    const size_t out_len = zww->out_buf_used[i];
+    if ((out_len == 0) ||
+        (write(zww->file_handle, zww->out_buf[i], out_len) != (ssize_t)out_len)) {
+      zww->error = true;
+      return;
+    }
+
+    if (zww->frames_len == zww->frames_alloc) {
+      zww->frames_alloc = MAX2(64, zww->frames_alloc * 2);
+      zww->frames = MEM_reallocN(zww->frames, sizeof(*zww->frames) * (size_t)zww->frames_alloc);
+    }
+    ZstdFrameInfo *frame = &zww->frames[zww->frames_len++];
+    frame->compressed_size = (uint32_t)out_len;
+    frame->uncompressed_size = (uint32_t)MIN2(zww->in_buf_used - (size_t)i * ZSTD_FRAME_SIZE,
+                                              ZSTD_FRAME_SIZE);
+  }
+
+  zww->in_buf_used = 0;
+}
+
+static void ww_zstd_put_uint32(uchar *buf, uint32_t value)
+{
+  /* The seekable format is always little endian. */
+  buf[0] = (uchar)(value & 0xff);
+  buf[1] = (uchar)((value >> 8) & 0xff);
+  buf[2] = (uchar)((value >> 16) & 0xff);
+  buf[3] = (uchar)((value >> 24) & 0xff);
+}
+
+/**
+ * Append the seek table: a skippable frame holding the compressed and uncompressed size
+ * of each frame, followed by the seekable format footer.
+ */
+static bool ww_zstd_write_seek_table(ZstdWriteWrap *zww)
+{
+  const size_t footer_size = 9;
+  const size_t table_size = (size_t)zww->frames_len * 8 + footer_size;
+  const size_t buf_size = 8 + table_size;
+  uchar *buf = MEM_mallocN(buf_size, __func__);
+
+  uchar *p = buf;
+  ww_zstd_put_uint32(p, ZSTD_SKIPPABLE_MAGIC);
+  ww_zstd_put_uint32(p + 4, (uint32_t)table_size);
+  p += 8;
+  for (int i = 0; i < zww->frames_len; i++) {
+    ww_zstd_put_uint32(p, zww->frames[i].compressed_size);
+    ww_zstd_put_uint32(p + 4, zww->frames[i].uncompressed_size);
+    p += 8;
+  }
+  ww_zstd_put_uint32(p, (uint32_t)zww->frames_len);
+  /* Seek table descriptor, no per-frame checksums. */
+  p[4] = 0;
+  ww_zstd_put_uint32(p + 5, ZSTD_SEEKABLE_MAGIC);
+
+  const bool ok = (write(zww->file_handle, buf, buf_size) == (ssize_t)buf_size);
+  MEM_freeN(buf);
+  return ok;
+}
+
+static void ww_zstd_free(ZstdWriteWrap *zww)
+{
+  for (int i = 0; i < zww->batch_len; i++) {
+    if (zww->cctx[i]) {
+      ZSTD_freeCCtx(zww->cctx[i]);
+    }
+    MEM_SAFE_FREE(zww->out_buf[i]);
+  }
+  MEM_freeN(zww->cctx);
+  MEM_freeN(zww->out_buf);
+  MEM_freeN(zww->out_buf_used);
+  MEM_SAFE_FREE(zww->frames);
+  MEM_freeN(zww->in_buf);
+  MEM_freeN(zww);
+}
+
+static bool ww_open_zstd(WriteWrap *ww, const char *filepath)
+{
+  int file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+  if (file == -1) {
+    return false;
+  }
+
+  ZstdWriteWrap *zww = MEM_callocN(sizeof(*zww), __func__);
+  zww->file_handle = file;
+  zww->batch_len = MAX2(1, BLI_system_thread_count());
+  zww->in_buf = MEM_mallocN((size_t)zww->batch_len * ZSTD_FRAME_SIZE, __func__);
+  zww->out_buf_size = ZSTD_compressBound(ZSTD_FRAME_SIZE);
+  zww->cctx = MEM_calloc_arrayN(zww->batch_len, sizeof(*zww->cctx), __func__);
+  zww->out_buf = MEM_calloc_arrayN(zww->batch_len, sizeof(*zww->out_buf), __func__);
+  zww->out_buf_used = MEM_calloc_arrayN(zww->batch_len, sizeof(*zww->out_buf_used), __func__);
+  for (int i = 0; i < zww->batch_len; i++) {
+    zww->cctx[i] = ZSTD_createCCtx();
+    zww->out_buf[i] = MEM_mallocN(zww->out_buf_size, __func__);
+  }
+
+  FILE_HANDLE(ww) = zww;
+  return true;
+}
+static bool ww_close_zstd(WriteWrap *ww)
+{
+  ZstdWriteWrap *zww = FILE_HANDLE(ww);
+
+  ww_zstd_flush_batch(zww);
+  bool ok = !zww->error && ww_zstd_write_seek_table(zww);
+  ok &= (close(zww->file_handle) != -1);
+
+  ww_zstd_free(zww);
+  FILE_HANDLE(ww) = NULL;
+  return ok;
+}
+static size_t ww_write_zstd(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+  ZstdWriteWrap *zww = FILE_HANDLE(ww);
+  const size_t in_buf_size = (size_t)zww->batch_len * ZSTD_FRAME_SIZE;
+  size_t written = 0;
+
+  while (written < buf_len) {
+    const size_t len = MIN2(buf_len - written, in_buf_size - zww->in_buf_used);
+    memcpy(zww->in_buf + zww->in_buf_used, buf + written, len);
+    zww->in_buf_used += len;
+    written += len;
+
+    if (zww->in_buf_used == in_buf_size) {
+      ww_zstd_flush_batch(zww);
+    }
+    if (zww->error) {
+      return 0;
+    }
+  }
+
+  return written;
+}
+#  undef FILE_HANDLE
+
+#endif /* WITH_ZSTD */
+
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -275,6 +522,16 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->use_buf = false;
       break;
     }
+#ifdef WITH_ZSTD
+    case WW_WRAP_ZSTD: {
+      r_ww->open = ww_open_zstd;
+      r_ww->close = ww_close_zstd;
+      r_ww->write = ww_write_zstd;
+      /* Input is already gathered into frames. */
+      r_ww->use_buf = false;
+      break;
+    }
+#endif
     default: {
       r_ww->open = ww_open_none;
       r_ww->close = ww_close_none;
@@ -287,6 +544,317 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Incremental File Writing
+ *
+ * Saving a file again after a small edit writes mostly the same bytes as the previous save.
+ * The data of every ID written to the file is also stored in a #MemFile, the same way undo steps
+ * are, with its offset in the file. When saving the same file again, the data of each ID is
+ * compared to the previous save's #MemFile: chunks which didn't change are flagged as
+ * #MemFileChunk.is_identical (sharing the previous buffer). IDs with only identical chunks are
+ * copied from the previous file using `copy_file_range`, which file-systems that support it
+ * resolve by sharing or copying extents in the kernel, without passing through user-space.
+ *
+ * The data of each ID is still generated, only writing it is avoided.
+ * The record is only trusted while the file on disk is the one written by the last save.
+ * \{ */
+
+typedef struct WriteIncremental WriteIncremental;
+
+#ifdef USE_WRITE_INCREMENTAL
+
+typedef struct WriteIncrementalChunk {
+  /** Position of the ID's data in the file. */
+  size_t offset;
+  size_t len;
+} WriteIncrementalChunk;
+
+typedef struct WriteIncrementalRecord {
+  struct WriteIncrementalRecord *next, *prev;
+  char filepath[FILE_MAX];
+  /** Set once the file has been moved into place, see #write_incremental_record_validate. */
+  bool is_valid;
+  /** Identifies the written file, so any other modification invalidates the record. */
+  BLI_stat_t file_stat;
+  /** Data of the IDs as written to the file (ID data only, in file order). */
+  MemFile memfile;
+  /** Map #ID.session_uuid to #WriteIncrementalChunk (allocated in `arena`). */
+  GHash *chunks;
+  MemArena *arena;
+} WriteIncrementalRecord;
+
+/**
+ * Records of the last incremental saves (most recent first), re-used when saving the same file
+ * again. Each one holds the data of a whole file, keep one for auto-save and the edited file.
+ */
+static ListBase g_write_incremental_records = {NULL, NULL};
+#define WRITE_INCREMENTAL_RECORDS_MAX 2
+
+struct WriteIncremental {
+  /** The previous save of the file (read-only), -1 when there is nothing to re-use. */
+  int file_prev;
+  WriteIncrementalRecord *record_prev;
+  /** Record of the file being written. */
+  WriteIncrementalRecord *record;
+  /** Number of bytes written to the file so far. */
+  size_t offset;
+
+  /** Writes the data of IDs into `record->memfile`, compared to `record_prev->memfile`. */
+  MemFileWriteData mem;
+  /** Data of the ID being written, held back in `mem` until we know whether it changed. */
+  bool id_active;
+  /** Last chunk before the ID being written (NULL when it's the first one). */
+  MemFileChunk *id_chunk_prev;
+  size_t id_len;
+  /** Some data of the ID being written doesn't match its data in the previous save. */
+  bool id_changed;
+
+  /** Statistics (for #G_DEBUG_IO). */
+  int reuse_count;
+  size_t reuse_len;
+};
+
+static void write_incremental_record_free(WriteIncrementalRecord *record)
+{
+  BLO_memfile_free(&record->memfile);
+  BLI_ghash_free(record->chunks, NULL, NULL);
+  BLI_memarena_free(record->arena);
+  MEM_freeN(record);
+}
+
+static WriteIncrementalRecord *write_incremental_record_find(const char *filepath)
+{
+  LISTBASE_FOREACH (WriteIncrementalRecord *, record, &g_write_incremental_records) {
+    if (BLI_path_cmp(record->filepath, filepath) == 0) {
+      return record;
+    }
+  }
+  return NULL;
+}
+
+static bool write_incremental_record_matches_file(const WriteIncrementalRecord *record, int file)
+{
+  BLI_stat_t st;
+  if (!record->is_valid || BLI_fstat(file, &st) == -1) {
+    return false;
+  }
+  return ((st.st_dev == record->file_stat.st_dev) && (st.st_ino == record->file_stat.st_ino) &&
+          (st.st_size == record->file_stat.st_size) &&
+          (st.st_mtim.tv_sec == record->file_stat.st_mtim.tv_sec) &&
+          (st.st_mtim.tv_nsec == record->file_stat.st_mtim.tv_nsec));
+}
+
+static WriteIncremental *write_incremental_begin(const char *filepath)
+{
+  WriteIncremental *incr = MEM_callocN(sizeof(*incr), __func__);
+
+  WriteIncrementalRecord *record = MEM_callocN(sizeof(*record), __func__);
+  BLI_strncpy(record->filepath, filepath, sizeof(record->filepath));
+  record->chunks = BLI_ghash_int_new(__func__);
+  record->arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+  incr->record = record;
+
+  incr->file_prev = -1;
+  WriteIncrementalRecord *record_prev = write_incremental_record_find(filepath);
+  if (record_prev != NULL) {
+    const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+    if (file != -1) {
+      if (write_incremental_record_matches_file(record_prev, file)) {
+        incr->file_prev = file;
+        incr->record_prev = record_prev;
+      }
+      else {
+        close(file);
+      }
+    }
+  }
+
+  BLO_memfile_write_init(
+      &incr->mem, &record->memfile, incr->record_prev ? &incr->record_prev->memfile : NULL);
+
+  return incr;
+}
+
+/**
+ * \param success: When true, the new record replaces the previous one,
+ * it's only used once validated by #write_incremental_record_validate.
+ */
+static void write_incremental_end(WriteIncremental *incr, const bool success)
+{
+  if (incr->file_prev != -1) {
+    close(incr->file_prev);
+  }
+  BLO_memfile_write_finalize(&incr->mem);
+
+  if (success) {
+    if (G.debug & G_DEBUG_IO) {
+      printf("Incremental save: %d unchanged ID(s) re-used (%zu of %zu bytes)\n",
+             incr->reuse_count,
+             incr->reuse_len,
+             incr->offset);
+    }
+    WriteIncrementalRecord *record_old = write_incremental_record_find(incr->record->filepath);
+    if (record_old != NULL) {
+      BLI_remlink(&g_write_incremental_records, record_old);
+      /* Hands over the buffers shared with the new record. */
+      BLO_memfile_merge(&record_old->memfile, &incr->record->memfile);
+      write_incremental_record_free(record_old);
+    }
+    BLI_addhead(&g_write_incremental_records, incr->record);
+    if (BLI_listbase_count_at_most(&g_write_incremental_records,
+                                   WRITE_INCREMENTAL_RECORDS_MAX + 1) >
+        WRITE_INCREMENTAL_RECORDS_MAX) {
+      WriteIncrementalRecord *record_last = g_write_incremental_records.last;
+      BLI_remlink(&g_write_incremental_records, record_last);
+      write_incremental_record_free(record_last);
+    }
+  }
+  else {
+    /* Only frees the buffers owned by the new record. */
+    write_incremental_record_free(incr->record);
+  }
+
+  MEM_freeN(incr);
+}
+
+/**
+ * Call once the written file has been moved to the path of the record.
+ */
+static void write_incremental_record_validate(const char *filepath)
+{
+  WriteIncrementalRecord *record = write_incremental_record_find(filepath);
+  if (record != NULL) {
+    record->is_valid = (BLI_stat(filepath, &record->file_stat) != -1);
+  }
+}
+
+static void write_incremental_id_begin(WriteIncremental *incr, const ID *id)
+{
+  MemFileWriteData *mem = &incr->mem;
+  mem->current_id_session_uuid = id->session_uuid;
+
+  /* Find the data of this ID in the previous save, its position may have changed. */
+  if (mem->id_session_uuid_mapping != NULL) {
+    MemFileChunk *ref = BLI_ghash_lookup(mem->id_session_uuid_mapping,
+                                         POINTER_FROM_UINT(id->session_uuid));
+    mem->reference_current_chunk = ref;
+  }
+
+  incr->id_active = true;
+  incr->id_chunk_prev = mem->written_memfile->chunks.last;
+  incr->id_len = 0;
+  incr->id_changed = (id->session_uuid == MAIN_ID_SESSION_UUID_UNSET);
+}
+
+static void write_incremental_id_data_add(WriteIncremental *incr, const void *mem, size_t memlen)
+{
+  MemFileChunk *chunk_ref = incr->mem.reference_current_chunk;
+  BLO_memfile_chunk_add(&incr->mem, mem, memlen);
+  const MemFileChunk *chunk = incr->mem.written_memfile->chunks.last;
+
+  /* Only identical to the data of the same ID counts, the previous save has its position. */
+  if (!chunk->is_identical || (chunk_ref->id_session_uuid != chunk->id_session_uuid)) {
+    incr->id_changed = true;
+  }
+  incr->id_len += memlen;
+}
+
+/**
+ * Copy a range of the previous file to the current position of the file being written.
+ *
+ * \return The number of bytes copied, less than `len` when the file-system (or kernel)
+ * doesn't support copying between these files, the caller must write the remaining data.
+ */
+static size_t write_incremental_copy_range(int file_src, size_t offset, int file_dst, size_t len)
+{
+  int64_t offset_src = (int64_t)offset;
+  size_t len_done = 0;
+  while (len_done < len) {
+    const long ret = syscall(
+        __NR_copy_file_range, file_src, &offset_src, file_dst, NULL, len - len_done, 0);
+    if (ret <= 0) {
+      break;
+    }
+    len_done += (size_t)ret;
+  }
+  return len_done;
+}
+
+/**
+ * Write the data of an ID held back since #write_incremental_id_begin,
+ * re-using the previous file's data when it's unchanged.
+ *
+ * \return false on error.
+ */
+static bool write_incremental_id_end(WriteIncremental *incr, WriteWrap *ww, const ID *id)
+{
+  incr->id_active = false;
+  incr->mem.current_id_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
+
+  const size_t len = incr->id_len;
+  if (len == 0) {
+    return true;
+  }
+
+  WriteIncrementalChunk *chunk = BLI_memarena_alloc(incr->record->arena, sizeof(*chunk));
+  chunk->offset = incr->offset;
+  chunk->len = len;
+  incr->offset += len;
+
+  if (id->session_uuid != MAIN_ID_SESSION_UUID_UNSET) {
+    BLI_ghash_reinsert(
+        incr->record->chunks, POINTER_FROM_UINT(id->session_uuid), chunk, NULL, NULL);
+  }
+
+  size_t len_done = 0;
+  if (!incr->id_changed && incr->record_prev != NULL) {
+    const WriteIncrementalChunk *chunk_prev = BLI_ghash_lookup(
+        incr->record_prev->chunks, POINTER_FROM_UINT(id->session_uuid));
+    if (chunk_prev && (chunk_prev->len == len)) {
+      len_done = write_incremental_copy_range(
+          incr->file_prev, chunk_prev->offset, ww->_user_data.file_handle, len);
+      if (len_done != 0) {
+        incr->reuse_count += 1;
+        incr->reuse_len += len_done;
+      }
+    }
+  }
+
+  /* Write what could not be copied from the previous file. */
+  const MemFileChunk *mem_chunk = incr->id_chunk_prev ? incr->id_chunk_prev->next :
+                                                        incr->mem.written_memfile->chunks.first;
+  size_t chunk_offset = 0;
+  for (; mem_chunk != NULL; mem_chunk = mem_chunk->next) {
+    const size_t chunk_end = chunk_offset + mem_chunk->size;
+    if (chunk_end > len_done) {
+      const size_t skip = (len_done > chunk_offset) ? len_done - chunk_offset : 0;
+      const size_t write_len = mem_chunk->size - skip;
+      if (ww->write(ww, mem_chunk->buf + skip, write_len) != write_len) {
+        return false;
+      }
+    }
+    chunk_offset = chunk_end;
+  }
+  return true;
+}
+
+#endif /* USE_WRITE_INCREMENTAL */
+
+/**
+ * Free the records of the last incremental saves.
+ */
+void BLO_write_file_incremental_free(void)
+{
+#ifdef USE_WRITE_INCREMENTAL
+  LISTBASE_FOREACH_MUTABLE (WriteIncrementalRecord *, record, &g_write_incremental_records) {
+    write_incremental_record_free(record);
+  }
+  BLI_listbase_clear(&g_write_incremental_records);
+#endif
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Write Data Type & Functions
  * \{ */
@@ -313,11 +881,16 @@ typedef struct {
   bool use_memfile;
 
   /**
-   * Wrap writing, so we can use zlib or
-   * other compression types later, see: G_FILE_COMPRESS
+   * Wrap writing, so we can use zlib or zstd compression,
+   * see: G_FILE_COMPRESS & G_FILE_COMPRESS_ZSTD
    * Will be NULL for UNDO.
    */
   WriteWrap *ww;
+
+#ifdef USE_WRITE_INCREMENTAL
+  /** Re-use unchanged data of the previous save (may be NULL). */
+  WriteIncremental *incr;
+#endif
 } WriteData;
 
 typedef struct BlendWriter {
@@ -359,6 +932,15 @@ static void writedata_do_write(WriteData *wd, const void *mem, size_t memlen)
     BLO_memfile_chunk_add(&wd->mem, mem, memlen);
   }
   else {
+#ifdef USE_WRITE_INCREMENTAL
+    if (wd->incr != NULL) {
+      if (wd->incr->id_active) {
+        write_incremental_id_data_add(wd->incr, mem, memlen);
+        return;
+      }
+      wd->incr->offset += memlen;
+    }
+#endif
     if (wd->ww->write(wd->ww, mem, memlen) != memlen) {
       wd->error = true;
     }
@@ -448,14 +1030,25 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
 /**
  * BeGiN initializer for mywrite
  * \param ww: File write wrapper.
+ * \param incr: Incremental writing state (can be NULL).
  * \param compare: Previous memory file (can be NULL).
  * \param current: The current memory file (can be NULL).
  * \warning Talks to other functions with global parameters
  */
-static WriteData *mywrite_begin(WriteWrap *ww, MemFile *compare, MemFile *current)
+static WriteData *mywrite_begin(WriteWrap *ww,
+                                WriteIncremental *incr,
+                                MemFile *compare,
+                                MemFile *current)
 {
   WriteData *wd = writedata_new(ww);
 
+#ifdef USE_WRITE_INCREMENTAL
+  wd->incr = incr;
+#else
+  BLI_assert(incr == NULL);
+  UNUSED_VARS_NDEBUG(incr);
+#endif
+
   if (current != NULL) {
     BLO_memfile_write_init(&wd->mem, current, compare);
     wd->use_memfile = true;
@@ -490,10 +1083,18 @@ static bool mywrite_end(WriteData *wd)
 /**
  * Start writing of data related to a single ID.
  *
- * Only does something when storing an undo step.
+ * Only does something when storing an undo step or writing incrementally.
  */
 static void mywrite_id_begin(WriteData *wd, ID *id)
 {
+#ifdef USE_WRITE_INCREMENTAL
+  if (wd->incr != NULL) {
+    /* Only this ID's data may end up in the held back data. */
+    mywrite_flush(wd);
+    write_incremental_id_begin(wd->incr, id);
+  }
+#endif
+
   if (wd->use_memfile) {
     wd->mem.current_id_session_uuid = id->session_uuid;
 
@@ -517,10 +1118,21 @@ static void mywrite_id_begin(WriteData *wd, ID *id)
 /**
  * Start writing of data related to a single ID.
  *
- * Only does something when storing an undo step.
+ * Only does something when storing an undo step or writing incrementally.
  */
-static void mywrite_id_end(WriteData *wd, ID *UNUSED(id))
+static void mywrite_id_end(WriteData *wd, ID *id)
 {
+#ifdef USE_WRITE_INCREMENTAL
+  if (wd->incr != NULL) {
+    mywrite_flush(wd);
+    if (!wd->error && !write_incremental_id_end(wd->incr, wd->ww, id)) {
+      wd->error = true;
+    }
+  }
+#else
+  UNUSED_VARS(id);
+#endif
+
   if (wd->use_memfile) {
     /* Very important to do it after every ID write now, otherwise we cannot know whether a
      * specific ID changed or not. */
@@ -2212,6 +2824,7 @@ static void write_thumb(WriteData *wd, const BlendThumbnail *thumb)
 /* if MemFile * there's filesave to memory */
 static bool write_file_handle(Main *mainvar,
                               WriteWrap *ww,
+                              WriteIncremental *incr,
                               MemFile *compare,
                               MemFile *current,
                               int write_flags,
@@ -2223,9 +2836,12 @@ static bool write_file_handle(Main *mainvar,
   char buf[16];
   WriteData *wd;
 
+  /* Placeholders of lazy loaded data-blocks would be written empty. */
+  BKE_main_lazy_load_ensure_all(mainvar);
+
   blo_split_main(&mainlist, mainvar);
 
-  wd = mywrite_begin(ww, compare, current);
+  wd = mywrite_begin(ww, incr, compare, current);
   BlendWriter writer = {wd};
 
   sprintf(buf,
@@ -2517,7 +3133,11 @@ bool BLO_write_file(Main *mainvar,
   BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
   if (write_flags & G_FILE_COMPRESS) {
+#ifdef WITH_ZSTD
+    ww_type = (write_flags & G_FILE_COMPRESS_ZSTD) ? WW_WRAP_ZSTD : WW_WRAP_ZLIB;
+#else
     ww_type = WW_WRAP_ZLIB;
+#endif
   }
   else {
     ww_type = WW_WRAP_NONE;
@@ -2531,6 +3151,15 @@ bool BLO_write_file(Main *mainvar,
     return 0;
   }
 
+  WriteIncremental *incr = NULL;
+#ifdef USE_WRITE_INCREMENTAL
+  /* Re-using data of the previous save needs offsets into uncompressed files. */
+  const bool use_incremental = params->use_incremental && (ww_type == WW_WRAP_NONE);
+  if (use_incremental) {
+    incr = write_incremental_begin(filepath);
+  }
+#endif
+
   /* Remapping of relative paths to new file location. */
   if (remap_mode != BLO_WRITE_PATH_REMAP_NONE) {
 
@@ -2593,9 +3222,18 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  bool err = write_file_handle(mainvar, &ww, incr, NULL, NULL, write_flags, use_userdef, thumb);
 
-  ww.close(&ww);
+  /* Compressed output may still be pending (written on close). */
+  if (ww.close(&ww) == false) {
+    err = true;
+  }
+
+#ifdef USE_WRITE_INCREMENTAL
+  if (incr != NULL) {
+    write_incremental_end(incr, !err);
+  }
+#endif
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -2624,6 +3262,12 @@ bool BLO_write_file(Main *mainvar,
     return 0;
   }
 
+#ifdef USE_WRITE_INCREMENTAL
+  if (use_incremental) {
+    write_incremental_record_validate(filepath);
+  }
+#endif
+
   if (G.debug & G_DEBUG_IO && mainvar->lock != NULL) {
     BKE_report(reports, RPT_INFO, "Checking sanity of current .blend file *AFTER* save to disk");
     BLO_main_validate_libraries(mainvar, reports);
@@ -2640,7 +3284,7 @@ bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int w
   bool use_userdef = false;
 
   const bool err = write_file_handle(
-      mainvar, NULL, compare, current, write_flags, use_userdef, NULL);
+      mainvar, NULL, NULL, compare, current, write_flags, use_userdef, NULL);
 
   return (err == 0);
 }
@@ -357,7 +357,13 @@ void COM_deinitialize(void);
  * \brief Clear all compositor caches. (Compositor system will still remain available).
  * To deinitialize the compositor use the COM_deinitialize method.
  */
-// void COM_clearCaches(void); // NOT YET WRITTEN
+void COM_clearCaches(void);
+
+/**
+ * \brief The data of an ID changed, cached results of nodes using it can't be used anymore.
+ * \note Can be called during execution.
+ */
+void COM_tagIDChanged(const struct ID *id);
 
 #ifdef __cplusplus
 }
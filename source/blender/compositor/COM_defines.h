@@ -58,6 +58,19 @@ typedef enum CompositorPriority {
   COM_PRIORITY_LOW = 0,
 } CompositorPriority;
 
+/**
+ * \brief Possible execution models
+ * \see CompositorContext.getExecutionModel
+ * \ingroup Execution
+ */
+typedef enum CompositorExecutionModel {
+  /** \brief Pixels are pulled one at a time through the operations of a chunk */
+  COM_EM_TILED = 0,
+  /** \brief Operations process the whole area of a chunk at once, see
+   * NodeOperation.update_memory_buffer */
+  COM_EM_FULL_FRAME = 1,
+} CompositorExecutionModel;
+
 // configurable items
 
 // chunk size determination
@@ -67,9 +80,15 @@ typedef enum CompositorPriority {
 
 // workscheduler threading models
 /**
- * COM_TM_QUEUE is a multi-threaded model, which uses the BLI_thread_queue pattern.
+ * COM_TM_TASK is a multi-threaded model, which uses the BLI_task scheduler. CPU work is
+ * interleaved with other Blender work and operations can use nested parallelism.
  * This is the default option.
  */
+#define COM_TM_TASK 2
+
+/**
+ * COM_TM_QUEUE is a multi-threaded model, which uses the BLI_thread_queue pattern.
+ */
 #define COM_TM_QUEUE 1
 
 /**
@@ -79,9 +98,9 @@ typedef enum CompositorPriority {
 #define COM_TM_NOTHREAD 0
 
 /**
- * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_QUEUE is currently default.
+ * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_TASK is currently default.
  */
-#define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+#define COM_CURRENT_THREADING_MODEL COM_TM_TASK
 // chunk order
 /**
  * \brief The order of chunks to be scheduled
@@ -107,3 +126,9 @@ typedef enum OrderOfChunks {
 #define COM_NUM_CHANNELS_COLOR 4
 
 #define COM_BLUR_BOKEH_PIXELS 512
+
+/**
+ * Maximum number of pixels computed at once by each operation in the full frame execution model,
+ * small enough for the intermediate buffers to stay in the CPU cache.
+ */
+#define COM_FULL_FRAME_BAND_PIXELS 4096
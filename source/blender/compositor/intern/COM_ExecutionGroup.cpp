@@ -59,6 +59,7 @@ ExecutionGroup::ExecutionGroup()
   this->m_chunksFinished = 0;
   BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
   this->m_executionStartTime = 0;
+  this->m_useCache = false;
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -162,6 +163,29 @@ void ExecutionGroup::deinitExecution()
   this->m_cachedReadOperations.clear();
   this->m_bTree = NULL;
 }
+void ExecutionGroup::set_all_chunks_executed()
+{
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+  }
+  this->m_chunksFinished = this->m_numberOfChunks;
+}
+
+bool ExecutionGroup::is_fully_executed() const
+{
+  if (this->m_viewerBorder.xmin != 0 || this->m_viewerBorder.ymin != 0 ||
+      this->m_viewerBorder.xmax != (int)this->m_width ||
+      this->m_viewerBorder.ymax != (int)this->m_height) {
+    return false;
+  }
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+      return false;
+    }
+  }
+  return this->m_numberOfChunks != 0;
+}
+
 void ExecutionGroup::determineResolution(unsigned int resolution[2])
 {
   NodeOperation *operation = this->getOutputOperation();
@@ -350,7 +374,8 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
         }
       }
       else if (state == COM_ES_SCHEDULED) {
-        finished = false;
+        /* Scheduled chunks finish in the background, the next group can already be scheduled
+         * while the last chunks of this group are being executed. */
         startEvaluated = true;
         numberEvaluated++;
       }
@@ -359,7 +384,15 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
       }
     }
 
-    WorkScheduler::finish();
+    if (index < this->m_numberOfChunks) {
+      /* Chunks after the evaluation window are not scheduled yet. */
+      finished = false;
+    }
+
+    /* Don't wait for all scheduled chunks, continue as soon as a device is available. */
+    if (!finished) {
+      WorkScheduler::wait_for_any();
+    }
 
     if (bTree->test_break && bTree->test_break(bTree->tbh)) {
       breaked = true;
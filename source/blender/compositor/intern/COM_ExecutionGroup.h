@@ -28,6 +28,7 @@
 #include "COM_MemoryProxy.h"
 #include "COM_Node.h"
 #include "COM_NodeOperation.h"
+#include "COM_ResultCache.h"
 #include <vector>
 
 using std::vector;
@@ -181,6 +182,17 @@ class ExecutionGroup {
    */
   double m_executionStartTime;
 
+  /**
+   * \brief key of the result of this group in the #ResultCache.
+   * \note only valid when m_useCache is set.
+   */
+  ResultHash m_cacheKey;
+
+  /**
+   * \brief is the result of this group stored in the #ResultCache.
+   */
+  bool m_useCache;
+
   // methods
   /**
    * \brief check whether parameter operation can be added to the execution group
@@ -439,6 +451,38 @@ class ExecutionGroup {
 
   void setRenderBorder(float xmin, float xmax, float ymin, float ymax);
 
+  /**
+   * \brief store the result of this group in the #ResultCache under \a key.
+   * \see NodeOperationBuilder.compute_cache_keys
+   */
+  void set_cache_key(const ResultHash &key)
+  {
+    this->m_cacheKey = key;
+    this->m_useCache = true;
+  }
+
+  bool use_cache() const
+  {
+    return this->m_useCache;
+  }
+
+  const ResultHash &get_cache_key() const
+  {
+    return this->m_cacheKey;
+  }
+
+  /**
+   * \brief mark all chunks as executed, when the result is already in the output buffer.
+   * \note only call between initExecution and the execution of the graph.
+   */
+  void set_all_chunks_executed();
+
+  /**
+   * \brief is the whole output calculated, not only the chunks inside the viewer border or
+   * the parts needed by other groups.
+   */
+  bool is_fully_executed() const;
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
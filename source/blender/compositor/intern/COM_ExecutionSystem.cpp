@@ -18,6 +18,8 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <algorithm>
+
 #include "BLI_utildefines.h"
 #include "PIL_time.h"
 
@@ -31,7 +33,9 @@
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
+#include "COM_WriteBufferOperation.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #  include "MEM_guardedalloc.h"
@@ -147,6 +151,11 @@ void ExecutionSystem::execute()
   }
   unsigned int index;
 
+  const CompositorExecutionModel execution_model = this->m_context.getExecutionModel();
+  for (index = 0; index < this->m_operations.size(); index++) {
+    this->m_operations[index]->setExecutionModel(execution_model);
+  }
+
   // First allocale all write buffer
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -177,6 +186,17 @@ void ExecutionSystem::execute()
     executionGroup->initExecution();
   }
 
+  /* Groups with a cached result don't need to be executed, nor the groups they depend on. */
+  vector<ExecutionGroup *> cachedGroups;
+  for (index = 0; index < this->m_groups.size(); index++) {
+    ExecutionGroup *executionGroup = this->m_groups[index];
+    if (executionGroup->use_cache() &&
+        ResultCache::lookup(executionGroup->get_cache_key(), get_output_buffer(executionGroup))) {
+      executionGroup->set_all_chunks_executed();
+      cachedGroups.push_back(executionGroup);
+    }
+  }
+
   WorkScheduler::start(this->m_context);
 
   executeGroups(COM_PRIORITY_HIGH);
@@ -188,6 +208,18 @@ void ExecutionSystem::execute()
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  /* Results of a canceled execution can be incomplete. */
+  if (!editingtree->test_break(editingtree->tbh)) {
+    for (index = 0; index < this->m_groups.size(); index++) {
+      ExecutionGroup *executionGroup = this->m_groups[index];
+      if (executionGroup->use_cache() && executionGroup->is_fully_executed() &&
+          std::find(cachedGroups.begin(), cachedGroups.end(), executionGroup) ==
+              cachedGroups.end()) {
+        ResultCache::store(executionGroup->get_cache_key(), get_output_buffer(executionGroup));
+      }
+    }
+  }
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -199,6 +231,12 @@ void ExecutionSystem::execute()
   }
 }
 
+MemoryBuffer *ExecutionSystem::get_output_buffer(ExecutionGroup *group)
+{
+  WriteBufferOperation *writeOperation = (WriteBufferOperation *)group->getOutputOperation();
+  return writeOperation->getMemoryProxy()->getBuffer();
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
   unsigned int index;
@@ -188,6 +188,11 @@ class ExecutionSystem {
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief the buffer written by a group that stores its result in the ResultCache.
+   */
+  static MemoryBuffer *get_output_buffer(ExecutionGroup *group);
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
@@ -104,6 +104,27 @@ void MemoryBuffer::clear()
   memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
 }
 
+void MemoryBuffer::fill(const rcti &area, const float *elem)
+{
+  const unsigned int num_channels = this->m_num_channels;
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = this->get_elem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++) {
+      memcpy(out, elem, sizeof(float) * num_channels);
+      out += num_channels;
+    }
+  }
+}
+
+void MemoryBuffer::move_to(const rcti &area)
+{
+  BLI_assert(this->m_state == COM_MB_TEMPORARILY);
+  BLI_assert(BLI_rcti_size_x(&area) == this->m_width);
+  BLI_assert(BLI_rcti_size_y(&area) <= this->m_height);
+  this->m_rect = area;
+  this->m_height = BLI_rcti_size_y(&area);
+}
+
 float MemoryBuffer::getMaximumValue()
 {
   float result = this->m_buffer[0];
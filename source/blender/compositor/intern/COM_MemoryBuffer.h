@@ -137,6 +137,28 @@ class MemoryBuffer {
     return this->m_buffer;
   }
 
+  /**
+   * \brief get the element at the given coordinates, which must be inside the rect of this buffer
+   * \note elements of a row are #get_num_channels apart.
+   */
+  float *get_elem(int x, int y)
+  {
+    BLI_assert(x >= m_rect.xmin && x < m_rect.xmax && y >= m_rect.ymin && y < m_rect.ymax);
+    return this->m_buffer +
+           ((size_t)(y - m_rect.ymin) * this->m_width + (x - m_rect.xmin)) * this->m_num_channels;
+  }
+
+  /**
+   * \brief fill an area of this buffer with a single element of #get_num_channels
+   */
+  void fill(const rcti &area, const float *elem);
+
+  /**
+   * \brief move this temporarily buffer to another area, reusing its memory
+   * \note \a area must have the same width and at most the height of the current rect.
+   */
+  void move_to(const rcti &area);
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
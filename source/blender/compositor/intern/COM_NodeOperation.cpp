@@ -36,6 +36,9 @@ NodeOperation::NodeOperation()
   this->m_height = 0;
   this->m_isResolutionSet = false;
   this->m_openCL = false;
+  this->m_fullFrame = false;
+  this->m_executionModel = COM_EM_TILED;
+  this->m_volatile = false;
   this->m_btree = NULL;
 }
 
@@ -149,6 +152,91 @@ NodeOperation *NodeOperation::getInputOperation(unsigned int inputSocketIndex)
   return NULL;
 }
 
+void NodeOperation::render_memory_buffer(MemoryBuffer *output, const rcti &area)
+{
+  /* Split the area in bands, so intermediate buffers of all operations stay in the CPU cache. */
+  const int width = max(BLI_rcti_size_x(&area), 1);
+  const int band_height = max(COM_FULL_FRAME_BAND_PIXELS / width, 1);
+
+  /* Intermediate buffers are allocated once for the first (largest) band and moved along for the
+   * following ones. They are stored in the order #render_memory_buffer_band visits the inputs. */
+  rcti band;
+  BLI_rcti_init(&band, area.xmin, area.xmax, area.ymin, min(area.ymin + band_height, area.ymax));
+  std::vector<MemoryBuffer *> buffers;
+  this->alloc_memory_buffer_inputs(band, buffers);
+
+  for (int ymin = area.ymin; ymin < area.ymax; ymin += band_height) {
+    BLI_rcti_init(&band, area.xmin, area.xmax, ymin, min(ymin + band_height, area.ymax));
+    MemoryBuffer **band_buffers = buffers.data();
+    this->render_memory_buffer_band(output, band, band_buffers);
+    if (isBraked()) {
+      break;
+    }
+  }
+
+  for (MemoryBuffer *buffer : buffers) {
+    delete buffer;
+  }
+}
+
+bool NodeOperation::use_memory_buffer_update()
+{
+  if (!this->isFullFrame()) {
+    return false;
+  }
+  for (unsigned int i = 0; i < this->getNumberOfInputSockets(); i++) {
+    /* Buffers are passed as they are, without data-type conversion. */
+    const NodeOperationInput *input = this->getInputSocket(i);
+    if (!input->isConnected() || input->getLink()->getDataType() != input->getDataType()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void NodeOperation::alloc_memory_buffer_inputs(const rcti &area,
+                                               std::vector<MemoryBuffer *> &buffers)
+{
+  if (!this->use_memory_buffer_update()) {
+    return;
+  }
+  rcti input_area = area;
+  for (unsigned int i = 0; i < this->getNumberOfInputSockets(); i++) {
+    NodeOperationOutput *link = this->getInputSocket(i)->getLink();
+    buffers.push_back(new MemoryBuffer(link->getDataType(), &input_area));
+    link->getOperation().alloc_memory_buffer_inputs(area, buffers);
+  }
+}
+
+void NodeOperation::render_memory_buffer_band(MemoryBuffer *output,
+                                              const rcti &area,
+                                              MemoryBuffer **&buffers)
+{
+  if (!this->use_memory_buffer_update()) {
+    const int num_channels = output->get_num_channels();
+    for (int y = area.ymin; y < area.ymax; y++) {
+      float *out = output->get_elem(area.xmin, y);
+      for (int x = area.xmin; x < area.xmax; x++) {
+        this->readSampled(out, x, y, COM_PS_NEAREST);
+        out += num_channels;
+      }
+    }
+    return;
+  }
+
+  /* Inputs are all read at the same coordinates as the output is written. */
+  const unsigned int num_inputs = this->getNumberOfInputSockets();
+  std::vector<MemoryBuffer *> inputs(num_inputs);
+  for (unsigned int i = 0; i < num_inputs; i++) {
+    NodeOperationOutput *link = this->getInputSocket(i)->getLink();
+    inputs[i] = *buffers++;
+    inputs[i]->move_to(area);
+    link->getOperation().render_memory_buffer_band(inputs[i], area, buffers);
+  }
+
+  this->update_memory_buffer(output, area, inputs.data());
+}
+
 void NodeOperation::getConnectedInputSockets(Inputs *sockets)
 {
   for (Inputs::const_iterator it = m_inputs.begin(); it != m_inputs.end(); ++it) {
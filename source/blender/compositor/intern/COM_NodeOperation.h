@@ -29,6 +29,7 @@
 #include "COM_MemoryBuffer.h"
 #include "COM_MemoryProxy.h"
 #include "COM_Node.h"
+#include "COM_ResultCache.h"
 #include "COM_SocketReader.h"
 
 #include "clew.h"
@@ -102,6 +103,27 @@ class NodeOperation : public SocketReader {
    */
   bool m_openCL;
 
+  /**
+   * \brief can this operation process whole buffers at once.
+   * \see NodeOperation.update_memory_buffer
+   */
+  bool m_fullFrame;
+
+  /**
+   * \brief execution model used when executing regions of this operation
+   */
+  CompositorExecutionModel m_executionModel;
+
+  /**
+   * \brief hash of the settings this operation was created with, see #set_params_hash.
+   */
+  ResultHash m_paramsHash;
+
+  /**
+   * \brief the result of this operation can change without any change to its settings.
+   */
+  bool m_volatile;
+
   /**
    * \brief mutex reference for very special node initializations
    * \note only use when you really know what you are doing.
@@ -200,6 +222,30 @@ class NodeOperation : public SocketReader {
   {
   }
 
+  /**
+   * \brief compute an area of the output of this operation at once
+   * \ingroup execution
+   * \note only called for operations that set #setFullFrame
+   * \param output: the buffer to write to, covering at least \a area
+   * \param area: the area to compute
+   * \param inputs: the results of all input operations for \a area, one per input socket
+   */
+  virtual void update_memory_buffer(MemoryBuffer * /*output*/,
+                                    const rcti & /*area*/,
+                                    MemoryBuffer ** /*inputs*/)
+  {
+  }
+
+  /**
+   * \brief compute an area of the output of this operation using the full frame execution model
+   *
+   * Inputs are computed into temporary buffers first, then passed to #update_memory_buffer.
+   * Operations that don't support this are evaluated pixel per pixel for \a area
+   * (pulling their inputs through #readSampled), like in the tiled execution model.
+   * \param output: the buffer to write to, covering at least \a area
+   */
+  void render_memory_buffer(MemoryBuffer *output, const rcti &area);
+
   /**
    * \brief when a chunk is executed by an OpenCLDevice, this method is called
    * \ingroup execution
@@ -343,6 +389,52 @@ class NodeOperation : public SocketReader {
     return this->m_openCL;
   }
 
+  /**
+   * \brief can this NodeOperation process whole buffers at once
+   * \see NodeOperation.update_memory_buffer
+   */
+  bool isFullFrame() const
+  {
+    return this->m_fullFrame;
+  }
+
+  void setExecutionModel(CompositorExecutionModel model)
+  {
+    this->m_executionModel = model;
+  }
+  CompositorExecutionModel getExecutionModel() const
+  {
+    return this->m_executionModel;
+  }
+
+  /**
+   * \brief set the hash of the settings this operation was created with.
+   *
+   * Set by the NodeOperationBuilder for operations created by a node, from the settings of
+   * the node. Used to identify results in the #ResultCache.
+   * \param is_volatile: the result can change without any change of the settings (like the
+   * render result), it will never be cached.
+   */
+  void set_params_hash(const ResultHash &hash, bool is_volatile)
+  {
+    this->m_paramsHash = hash;
+    this->m_volatile = is_volatile;
+  }
+
+  /**
+   * \brief add everything the result depends on, besides the inputs, to \a hash.
+   * Operations that are not created by a node override this to add their own settings.
+   */
+  virtual void hash_params(ResultHash &hash) const
+  {
+    hash.add_hash(this->m_paramsHash);
+  }
+
+  bool is_volatile() const
+  {
+    return this->m_volatile;
+  }
+
   virtual bool isViewerOperation() const
   {
     return false;
@@ -420,6 +512,21 @@ class NodeOperation : public SocketReader {
     this->m_openCL = openCL;
   }
 
+  /**
+   * \brief set if this NodeOperation implements #update_memory_buffer
+   */
+  void setFullFrame(bool fullFrame)
+  {
+    this->m_fullFrame = fullFrame;
+  }
+
+ private:
+  bool use_memory_buffer_update();
+  void alloc_memory_buffer_inputs(const rcti &area, std::vector<MemoryBuffer *> &buffers);
+  void render_memory_buffer_band(MemoryBuffer *output,
+                                 const rcti &area,
+                                 MemoryBuffer **&buffers);
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
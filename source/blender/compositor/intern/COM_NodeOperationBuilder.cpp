@@ -16,8 +16,18 @@
  * Copyright 2013, Blender Foundation.
  */
 
+#include <typeinfo>
+
+#include "BLI_listbase.h"
 #include "BLI_utildefines.h"
 
+#include "DNA_camera_types.h"
+#include "DNA_image_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_node.h"
+
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionSystem.h"
@@ -28,6 +38,7 @@
 #include "COM_NodeOperation.h"
 #include "COM_PreviewOperation.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_SetColorOperation.h"
 #include "COM_SetValueOperation.h"
 #include "COM_SetVectorOperation.h"
@@ -38,7 +49,11 @@
 #include "COM_NodeOperationBuilder.h" /* own include */
 
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree)
-    : m_context(context), m_current_node(NULL), m_active_viewer(NULL)
+    : m_context(context),
+      m_current_node(NULL),
+      m_current_node_volatile(false),
+      m_current_node_num_operations(0),
+      m_active_viewer(NULL)
 {
   m_graph.from_bNodeTree(*context, b_nodetree);
 }
@@ -47,6 +62,96 @@ NodeOperationBuilder::~NodeOperationBuilder()
 {
 }
 
+static void hash_node_socket_value(ResultHash &hash, const bNodeSocket *sock)
+{
+  hash.add_int(sock->type);
+  if (sock->default_value == NULL) {
+    return;
+  }
+  switch (sock->type) {
+    case SOCK_FLOAT:
+      hash.add_float(((const bNodeSocketValueFloat *)sock->default_value)->value);
+      break;
+    case SOCK_INT:
+      hash.add_int(((const bNodeSocketValueInt *)sock->default_value)->value);
+      break;
+    case SOCK_BOOLEAN:
+      hash.add_int(((const bNodeSocketValueBoolean *)sock->default_value)->value);
+      break;
+    case SOCK_VECTOR:
+      hash.add_bytes(((const bNodeSocketValueVector *)sock->default_value)->value,
+                     sizeof(float[3]));
+      break;
+    case SOCK_RGBA:
+      hash.add_bytes(((const bNodeSocketValueRGBA *)sock->default_value)->value,
+                     sizeof(float[4]));
+      break;
+  }
+}
+
+/**
+ * Hash of all settings of a node that operations can be created from.
+ * \param r_volatile: set when the result of the node can change without any change to the
+ * settings or the data-blocks used by it.
+ */
+static ResultHash node_params_hash(const bNode *b_node,
+                                   const CompositorContext &context,
+                                   bool *r_volatile)
+{
+  ResultHash hash;
+  *r_volatile = false;
+  if (b_node == NULL) {
+    return hash;
+  }
+
+  hash.add_string(b_node->idname);
+  hash.add_int(b_node->custom1);
+  hash.add_int(b_node->custom2);
+  hash.add_float(b_node->custom3);
+  hash.add_float(b_node->custom4);
+
+  if (b_node->storage && b_node->typeinfo->storagename[0]) {
+    if (STREQ(b_node->typeinfo->storagename, "CurveMapping")) {
+      hash.add_curve_mapping((const CurveMapping *)b_node->storage);
+    }
+    else {
+      hash.add_dna_struct(b_node->typeinfo->storagename, b_node->storage);
+    }
+    if (b_node->type == CMP_NODE_CRYPTOMATTE) {
+      hash.add_string(((const NodeCryptomatte *)b_node->storage)->matte_id);
+    }
+  }
+
+  LISTBASE_FOREACH (const bNodeSocket *, sock, &b_node->inputs) {
+    hash_node_socket_value(hash, sock);
+  }
+
+  const ID *id = b_node->id;
+  hash.add_id(id);
+  if (b_node->type == CMP_NODE_R_LAYERS) {
+    /* The scene is tagged by #ntreeCompositTagRender when it has a new render result. */
+    const Scene *scene = id ? (const Scene *)id : context.getScene();
+    hash.add_id(&scene->id);
+  }
+  else if (id && GS(id->name) == ID_SCE) {
+    /* Nodes using the camera of a scene, like defocus. */
+    const Object *camera = ((const Scene *)id)->camera;
+    if (camera) {
+      hash.add_id(&camera->id);
+      hash.add_id((const ID *)camera->data);
+    }
+  }
+  else if (id && GS(id->name) == ID_IM) {
+    const Image *image = (const Image *)id;
+    if (image->source == IMA_SRC_VIEWER ||
+        ELEM(image->type, IMA_TYPE_R_RESULT, IMA_TYPE_COMPOSITE)) {
+      *r_volatile = true;
+    }
+  }
+
+  return hash;
+}
+
 void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 {
   /* interface handle for nodes */
@@ -56,6 +161,8 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
     Node *node = (Node *)m_graph.nodes()[index];
 
     m_current_node = node;
+    m_current_node_hash = node_params_hash(node->getbNode(), *m_context, &m_current_node_volatile);
+    m_current_node_num_operations = 0;
 
     DebugInfo::node_to_operations(node);
     node->convertToOperations(converter, *m_context);
@@ -119,12 +226,21 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
   /* create execution groups */
   group_operations();
 
+  compute_cache_keys();
+
   /* transfer resulting operations to the system */
   system->set_operations(m_operations, m_groups);
 }
 
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
+  if (m_current_node) {
+    /* Nodes can add multiple operations of the same type with different settings. */
+    ResultHash hash;
+    hash.add_hash(m_current_node_hash);
+    hash.add_int(m_current_node_num_operations++);
+    operation->set_params_hash(hash, m_current_node_volatile);
+  }
   m_operations.push_back(operation);
 }
 
@@ -735,3 +851,126 @@ void NodeOperationBuilder::group_operations()
     }
   }
 }
+
+/**
+ * Key of the result of an operation: every operation it depends on, in the order they are
+ * visited, each followed by the indices of the operations linked to it. The same graph of
+ * operations always gives the same key, operations used more than once are only added once.
+ */
+struct OperationCacheKey {
+  ResultHash hash;
+  std::map<NodeOperation *, int> indices;
+  bool is_volatile = false;
+};
+
+/* Add \a op and all operations it depends on to \a key, returns the index of \a op. */
+static int operation_cache_key(OperationCacheKey &key, NodeOperation *op)
+{
+  std::map<NodeOperation *, int>::const_iterator it = key.indices.find(op);
+  if (it != key.indices.end()) {
+    return it->second;
+  }
+
+  ResultHash hash;
+  key.is_volatile |= op->is_volatile();
+  hash.add_string(typeid(*op).name());
+  op->hash_params(hash);
+  hash.add_int(op->getWidth());
+  hash.add_int(op->getHeight());
+
+  for (int i = 0; i < op->getNumberOfInputSockets(); i++) {
+    NodeOperationInput *input = op->getInputSocket(i);
+    hash.add_int(input->getDataType());
+    hash.add_int(input->getResizeMode());
+    NodeOperationOutput *link = input->getLink();
+    if (link == NULL) {
+      hash.add_int(-1);
+      continue;
+    }
+    NodeOperation &link_op = link->getOperation();
+    for (int j = 0; j < link_op.getNumberOfOutputSockets(); j++) {
+      if (link_op.getOutputSocket(j) == link) {
+        hash.add_int(j);
+      }
+    }
+    hash.add_int(operation_cache_key(key, &link_op));
+  }
+
+  /* Buffers are written by operations of other groups. */
+  if (op->isReadBufferOperation()) {
+    ReadBufferOperation *read_op = (ReadBufferOperation *)op;
+    hash.add_int(operation_cache_key(key, read_op->getMemoryProxy()->getWriteBufferOperation()));
+  }
+
+  /* Operations are added after the ones they depend on. */
+  const int index = (int)key.indices.size();
+  key.indices[op] = index;
+  key.hash.add_hash(hash);
+  return index;
+}
+
+/* Hash of the settings of the execution that are not part of the operations. */
+static ResultHash context_cache_key(const CompositorContext &context)
+{
+  ResultHash hash;
+  const RenderData *rd = context.getRenderData();
+  hash.add_int(context.getFramenumber());
+  hash.add_int(rd->sfra);
+  hash.add_int(rd->efra);
+  hash.add_int(rd->frs_sec);
+  hash.add_float(rd->frs_sec_base);
+  hash.add_int(rd->xsch);
+  hash.add_int(rd->ysch);
+  hash.add_int(rd->size);
+  hash.add_int(rd->mode);
+
+  hash.add_id(&context.getScene()->id);
+  hash.add_string(context.getViewName());
+  hash.add_int(context.getQuality());
+  hash.add_int(context.isRendering());
+  hash.add_int(context.isFastCalculation());
+  hash.add_int(context.getChunksize());
+  hash.add_int(context.getExecutionModel());
+  hash.add_int(context.getHasActiveOpenCLDevices());
+  hash.add_int(context.isGroupnodeBufferEnabled());
+
+  const ColorManagedViewSettings *view_settings = context.getViewSettings();
+  hash.add_dna_struct("ColorManagedViewSettings", view_settings);
+  if (view_settings && (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES)) {
+    hash.add_curve_mapping(view_settings->curve_mapping);
+  }
+  hash.add_dna_struct("ColorManagedDisplaySettings", context.getDisplaySettings());
+
+  return hash;
+}
+
+void NodeOperationBuilder::compute_cache_keys()
+{
+  /* Only the buffers written by complex operations are cached, recalculating the results of
+   * other groups is usually faster than copying them. */
+  ResultHash context_key;
+  bool has_context_key = false;
+  for (Groups::const_iterator it = m_groups.begin(); it != m_groups.end(); ++it) {
+    ExecutionGroup *group = *it;
+    NodeOperation *output_op = group->getOutputOperation();
+    if (group->isOutputExecutionGroup() || !group->isComplex() ||
+        !output_op->isWriteBufferOperation()) {
+      continue;
+    }
+
+    OperationCacheKey op_key;
+    operation_cache_key(op_key, output_op);
+    if (op_key.is_volatile) {
+      continue;
+    }
+
+    if (!has_context_key) {
+      context_key = context_cache_key(*m_context);
+      has_context_key = true;
+    }
+    ResultHash hash;
+    hash.add_hash(context_key);
+    hash.add_hash(op_key.hash);
+    group->set_cache_key(hash);
+  }
+}
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "COM_NodeGraph.h"
+#include "COM_ResultCache.h"
 
 using std::vector;
 
@@ -88,6 +89,12 @@ class NodeOperationBuilder {
   OutputSocketMap m_output_map;
 
   Node *m_current_node;
+  /** Hash of the settings of the current node, see NodeOperation::set_params_hash */
+  ResultHash m_current_node_hash;
+  /** The results of the current node can change without changes to its settings */
+  bool m_current_node_volatile;
+  /** Number of operations added by the current node */
+  int m_current_node_num_operations;
 
   /** Operation that will be writing to the viewer image
    *  Only one operation can occupy this place at a time,
@@ -168,6 +175,9 @@ class NodeOperationBuilder {
   void group_operations();
   ExecutionGroup *make_group(NodeOperation *op);
 
+  /** Set the keys of the groups that store their result in the ResultCache */
+  void compute_cache_keys();
+
  private:
   PreviewOperation *make_preview_operation() const;
 
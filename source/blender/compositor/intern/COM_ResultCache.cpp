@@ -0,0 +1,293 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <cstring>
+#include <map>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_ID.h"
+#include "DNA_color_types.h"
+#include "DNA_genfile.h"
+#include "DNA_sdna_types.h"
+#include "DNA_userdef_types.h"
+
+#include "COM_MemoryBuffer.h"
+#include "COM_ResultCache.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Result Hash
+ * \{ */
+
+void ResultHash::add_string(const char *str)
+{
+  if (str) {
+    add_bytes(str, strlen(str) + 1);
+  }
+  else {
+    add_int(0);
+  }
+}
+
+static void add_dna_struct_recursive(ResultHash &hash,
+                                     const SDNA *sdna,
+                                     const int struct_nr,
+                                     const char *data)
+{
+  const SDNA_Struct *struct_info = sdna->structs[struct_nr];
+  for (int i = 0; i < struct_info->members_len; i++) {
+    const SDNA_StructMember *member = &struct_info->members[i];
+    const char *name = sdna->names[member->name];
+    const int size = DNA_elem_size_nr(sdna, member->type, member->name);
+
+    /* Pointers differ between copies of the same data, like the localized node tree. */
+    if (!ELEM(name[0], '*', '(')) {
+      const int member_struct_nr = DNA_struct_find_nr(sdna, sdna->types[member->type]);
+      if (member_struct_nr != -1) {
+        const int array_len = sdna->names_array_len[member->name];
+        const int elem_size = sdna->types_size[member->type];
+        for (int a = 0; a < array_len; a++) {
+          add_dna_struct_recursive(hash, sdna, member_struct_nr, data + a * elem_size);
+        }
+      }
+      else {
+        hash.add_bytes(data, size);
+      }
+    }
+
+    /* DNA structs have no implicit padding, members follow each other. */
+    data += size;
+  }
+}
+
+void ResultHash::add_dna_struct(const char *struct_name, const void *data)
+{
+  const SDNA *sdna = DNA_sdna_current_get();
+  const int struct_nr = DNA_struct_find_nr(sdna, struct_name);
+  BLI_assert(struct_nr != -1);
+  add_string(struct_name);
+  if (data && struct_nr != -1) {
+    add_dna_struct_recursive(*this, sdna, struct_nr, (const char *)data);
+  }
+}
+
+void ResultHash::add_curve_mapping(const CurveMapping *cumap)
+{
+  add_dna_struct("CurveMapping", cumap);
+  if (cumap == NULL) {
+    return;
+  }
+  for (int i = 0; i < CM_TOT; i++) {
+    const CurveMap *cuma = &cumap->cm[i];
+    add_int(cuma->totpoint);
+    if (cuma->curve) {
+      add_bytes(cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+    }
+  }
+}
+
+void ResultHash::add_id(const ID *id)
+{
+  if (id == NULL) {
+    add_int(0);
+    return;
+  }
+  /* Evaluated copies are used during rendering, they have the same data as their original. */
+  const ID *id_orig = id->orig_id ? id->orig_id : id;
+  add_int(GS(id_orig->name));
+  add_int(id_orig->session_uuid);
+  add_uint64(ResultCache::get_id_version(id_orig));
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Result Cache
+ * \{ */
+
+typedef struct ResultCacheEntry {
+  struct ResultCacheEntry *next, *prev;
+  uint64_t key;
+  /** All values of the key, compared on lookup since different keys can have the same hash. */
+  char *key_data;
+  size_t key_size;
+  float *buffer;
+  int width, height;
+  int num_channels;
+  size_t size;
+} ResultCacheEntry;
+
+static ThreadMutex g_cache_mutex = BLI_MUTEX_INITIALIZER;
+static std::map<uint64_t, ResultCacheEntry *> g_cache_entries;
+/** Entries from least to most recently used. */
+static ListBase g_cache_lru = {NULL, NULL};
+static size_t g_cache_memory_in_use = 0;
+/** Version per ID session UUID, the value of #g_id_version_last when it was last changed. */
+static std::map<unsigned int, uint64_t> g_id_versions;
+/** Last version given to an ID, versions are never reused. */
+static uint64_t g_id_version_last = 0;
+/** Version of IDs not changed since the versions were last cleared. */
+static uint64_t g_id_version_base = 0;
+
+static size_t cache_memory_limit()
+{
+  return (size_t)MAX2(U.compositor_cachelimit, 0) * 1024 * 1024;
+}
+
+static void cache_entry_free(ResultCacheEntry *entry)
+{
+  g_cache_entries.erase(entry->key);
+  BLI_remlink(&g_cache_lru, entry);
+  g_cache_memory_in_use -= entry->size;
+  MEM_SAFE_FREE(entry->key_data);
+  MEM_freeN(entry->buffer);
+  MEM_freeN(entry);
+}
+
+static void cache_free_to_limit(const size_t limit)
+{
+  while (g_cache_memory_in_use > limit && g_cache_lru.first) {
+    cache_entry_free((ResultCacheEntry *)g_cache_lru.first);
+  }
+}
+
+static bool cache_entry_key_equals(const ResultCacheEntry *entry, const ResultHash &key)
+{
+  const std::string &key_data = key.get_data();
+  return entry->key_size == key_data.size() &&
+         memcmp(entry->key_data, key_data.data(), entry->key_size) == 0;
+}
+
+bool ResultCache::lookup(const ResultHash &key, MemoryBuffer *buffer)
+{
+  bool found = false;
+  BLI_mutex_lock(&g_cache_mutex);
+  std::map<uint64_t, ResultCacheEntry *>::iterator it = g_cache_entries.find(key.get());
+  if (it != g_cache_entries.end()) {
+    ResultCacheEntry *entry = it->second;
+    if (cache_entry_key_equals(entry, key) && entry->width == buffer->getWidth() &&
+        entry->height == buffer->getHeight() &&
+        entry->num_channels == (int)buffer->get_num_channels()) {
+      memcpy(buffer->getBuffer(), entry->buffer, entry->size);
+      BLI_remlink(&g_cache_lru, entry);
+      BLI_addtail(&g_cache_lru, entry);
+      found = true;
+    }
+  }
+  BLI_mutex_unlock(&g_cache_mutex);
+  return found;
+}
+
+void ResultCache::store(const ResultHash &key, MemoryBuffer *buffer)
+{
+  const std::string &key_data = key.get_data();
+  const int width = buffer->getWidth();
+  const int height = buffer->getHeight();
+  const int num_channels = buffer->get_num_channels();
+  const size_t size = sizeof(float) * num_channels * width * height;
+
+  BLI_mutex_lock(&g_cache_mutex);
+  const size_t limit = cache_memory_limit();
+  /* A change of the limit is applied on the next store. */
+  cache_free_to_limit(limit);
+  if (size == 0 || size > limit) {
+    BLI_mutex_unlock(&g_cache_mutex);
+    return;
+  }
+
+  /* Also replaces the result of another key with the same hash. */
+  std::map<uint64_t, ResultCacheEntry *>::iterator it = g_cache_entries.find(key.get());
+  if (it != g_cache_entries.end()) {
+    cache_entry_free(it->second);
+  }
+  cache_free_to_limit(limit - size);
+
+  ResultCacheEntry *entry = (ResultCacheEntry *)MEM_callocN(sizeof(ResultCacheEntry), __func__);
+  entry->key = key.get();
+  entry->key_size = key_data.size();
+  if (entry->key_size) {
+    entry->key_data = (char *)MEM_mallocN(entry->key_size, __func__);
+    memcpy(entry->key_data, key_data.data(), entry->key_size);
+  }
+  entry->buffer = (float *)MEM_mallocN(size, __func__);
+  entry->width = width;
+  entry->height = height;
+  entry->num_channels = num_channels;
+  entry->size = size;
+  memcpy(entry->buffer, buffer->getBuffer(), size);
+
+  g_cache_entries[entry->key] = entry;
+  BLI_addtail(&g_cache_lru, entry);
+  g_cache_memory_in_use += size;
+  BLI_mutex_unlock(&g_cache_mutex);
+}
+
+void ResultCache::tag_id_changed(const ID *id)
+{
+  const ID *id_orig = id->orig_id ? id->orig_id : id;
+  BLI_mutex_lock(&g_cache_mutex);
+  g_id_versions[id_orig->session_uuid] = ++g_id_version_last;
+  BLI_mutex_unlock(&g_cache_mutex);
+}
+
+uint64_t ResultCache::get_id_version(const ID *id)
+{
+  const ID *id_orig = id->orig_id ? id->orig_id : id;
+  BLI_mutex_lock(&g_cache_mutex);
+  uint64_t version = g_id_version_base;
+  std::map<unsigned int, uint64_t>::const_iterator it = g_id_versions.find(
+      id_orig->session_uuid);
+  if (it != g_id_versions.end()) {
+    version = it->second;
+  }
+  BLI_mutex_unlock(&g_cache_mutex);
+  return version;
+}
+
+void ResultCache::clear()
+{
+  BLI_mutex_lock(&g_cache_mutex);
+  cache_free_to_limit(0);
+  /* IDs not changed since get the last version given out. Keys made before, like for an
+   * execution running at the same time, can't match the keys of changed data that way. */
+  g_id_versions.clear();
+  g_id_version_base = g_id_version_last;
+  BLI_mutex_unlock(&g_cache_mutex);
+}
+
+size_t ResultCache::get_memory_in_use()
+{
+  BLI_mutex_lock(&g_cache_mutex);
+  const size_t memory_in_use = g_cache_memory_in_use;
+  BLI_mutex_unlock(&g_cache_mutex);
+  return memory_in_use;
+}
+
+int ResultCache::get_num_entries()
+{
+  BLI_mutex_lock(&g_cache_mutex);
+  const int num_entries = (int)g_cache_entries.size();
+  BLI_mutex_unlock(&g_cache_mutex);
+  return num_entries;
+}
+
+/** \} */
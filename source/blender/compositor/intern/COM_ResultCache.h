@@ -0,0 +1,160 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MemoryBuffer;
+struct CurveMapping;
+struct ID;
+
+/**
+ * \brief key used to identify results in the #ResultCache.
+ *
+ * Values are added in order, the same sequence of values always gives the same hash. The values
+ * are kept as well, so results are only used when all of them match, not only the hash.
+ * \ingroup Memory
+ */
+class ResultHash {
+ private:
+  uint64_t m_hash;
+  std::string m_data;
+
+ public:
+  ResultHash() : m_hash(0xcbf29ce484222325ull)
+  {
+  }
+
+  void add_bytes(const void *data, size_t size)
+  {
+    /* FNV-1a. */
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+      m_hash = (m_hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    m_data.append((const char *)data, size);
+  }
+
+  /** \brief add all values of \a other, in the order they were added to it. */
+  void add_hash(const ResultHash &other)
+  {
+    add_bytes(other.m_data.data(), other.m_data.size());
+  }
+
+  void add_int(const int value)
+  {
+    add_bytes(&value, sizeof(value));
+  }
+
+  void add_uint64(const uint64_t value)
+  {
+    add_bytes(&value, sizeof(value));
+  }
+
+  void add_float(const float value)
+  {
+    add_bytes(&value, sizeof(value));
+  }
+
+  void add_string(const char *str);
+
+  /**
+   * \brief add the data of a DNA struct, using the SDNA to skip all pointers.
+   * Nested structs are added recursively, data referenced by pointers is not added.
+   */
+  void add_dna_struct(const char *struct_name, const void *data);
+
+  /** \brief add the points of all curves of a curve mapping. */
+  void add_curve_mapping(const CurveMapping *cumap);
+
+  /**
+   * \brief add an ID by identity and by the number of times it was changed.
+   * \see ResultCache::tag_id_changed
+   */
+  void add_id(const ID *id);
+
+  uint64_t get() const
+  {
+    /* Final mix, so keys that differ in a single value spread over all bits. */
+    uint64_t h = m_hash;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb53ca94d2b8bull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  /** \brief all values added so far. */
+  const std::string &get_data() const
+  {
+    return m_data;
+  }
+};
+
+/**
+ * \brief Results of execution groups kept between executions of the compositor.
+ *
+ * When a node tree is executed again after a change, only the parts of the tree that depend on
+ * the change need to be calculated. Groups writing a buffer store a copy of it, keyed on a hash
+ * of all operations and settings leading to it (see NodeOperationBuilder::compute_cache_keys).
+ * Changes to ID data-blocks (images, masks, movie clips...) invalidate results by changing the
+ * keys of the operations using them.
+ *
+ * The memory used is limited by the user preferences, least recently used results are freed
+ * first.
+ * \ingroup Memory
+ */
+class ResultCache {
+ public:
+  /**
+   * \brief copy a cached result into \a buffer.
+   * \return false when there is no result for \a key with the size of \a buffer.
+   */
+  static bool lookup(const ResultHash &key, MemoryBuffer *buffer);
+
+  /**
+   * \brief store a copy of \a buffer as the result for \a key.
+   * Least recently used results are freed to stay in the memory limit.
+   */
+  static void store(const ResultHash &key, MemoryBuffer *buffer);
+
+  /**
+   * \brief data of an ID changed, results using it can't be used anymore.
+   * \note can be called from any thread, also during execution.
+   */
+  static void tag_id_changed(const ID *id);
+
+  /**
+   * \brief version of the data of the original of \a id, changed by every #tag_id_changed.
+   * Versions are never reused, also not after #clear.
+   */
+  static uint64_t get_id_version(const ID *id);
+
+  /** \brief free all cached results and the versions of IDs. */
+  static void clear();
+
+  /** \brief memory used by the cached results in bytes. */
+  static size_t get_memory_in_use();
+
+  /** \brief number of cached results. */
+  static int get_num_entries();
+};
@@ -0,0 +1,182 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <cmath>
+#include <cstring>
+
+#include "COM_RowKernels.h"
+
+#include "BLI_math_color.h"
+#include "BLI_system.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Scalar Kernels
+ *
+ * Reference implementation, also used on CPUs without any of the supported instruction sets.
+ * \{ */
+
+namespace com_row_kernels_scalar {
+
+#define VSIZE 1
+
+typedef float vfloat;
+typedef bool vmask;
+
+static inline vfloat vmin(const vfloat a, const vfloat b)
+{
+  return (a < b) ? a : b;
+}
+
+static inline vfloat vmax(const vfloat a, const vfloat b)
+{
+  return (a > b) ? a : b;
+}
+
+static inline vfloat vabs(const vfloat a)
+{
+  return fabsf(a);
+}
+
+static inline vfloat vsqrt(const vfloat a)
+{
+  return sqrtf(a);
+}
+
+static inline vfloat select(const vmask mask, const vfloat a, const vfloat b)
+{
+  return mask ? a : b;
+}
+
+static inline vfloat vpow(const vfloat x, const vfloat y)
+{
+  return powf(x, y);
+}
+
+static inline vfloat v_linearrgb_to_srgb(const vfloat c)
+{
+  return linearrgb_to_srgb(c);
+}
+
+static inline vfloat v_srgb_to_linearrgb(const vfloat c)
+{
+  return srgb_to_linearrgb(c);
+}
+
+static inline void load_rgba(const float *p, vfloat &r, vfloat &g, vfloat &b, vfloat &a)
+{
+  r = p[0];
+  g = p[1];
+  b = p[2];
+  a = p[3];
+}
+
+static inline void store_rgba(
+    float *p, const vfloat r, const vfloat g, const vfloat b, const vfloat a)
+{
+  p[0] = r;
+  p[1] = g;
+  p[2] = b;
+  p[3] = a;
+}
+
+static inline vfloat load_value(const float *p)
+{
+  return p[0];
+}
+
+static inline void store_value(float *p, const vfloat v)
+{
+  p[0] = v;
+}
+
+#include "COM_RowKernels_impl.h"
+
+#undef VSIZE
+
+}  // namespace com_row_kernels_scalar
+
+bool COM_row_kernels_init_scalar(RowKernels *kernels)
+{
+  com_row_kernels_scalar::init_kernels(kernels);
+  kernels->isa = COM_ROW_KERNEL_SCALAR;
+  kernels->name = "Scalar";
+  return true;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Dispatch
+ * \{ */
+
+static bool cpu_supports(RowKernelISA isa)
+{
+  switch (isa) {
+    case COM_ROW_KERNEL_SCALAR:
+      return true;
+    case COM_ROW_KERNEL_SSE2:
+      return BLI_cpu_support_sse2();
+    case COM_ROW_KERNEL_AVX2:
+      return BLI_cpu_support_avx2();
+  }
+  return false;
+}
+
+struct RowKernelsTable {
+  RowKernels kernels[COM_ROW_KERNEL_ISA_NUM];
+  bool available[COM_ROW_KERNEL_ISA_NUM];
+  RowKernelISA best;
+
+  RowKernelsTable()
+  {
+    memset(kernels, 0, sizeof(kernels));
+    available[COM_ROW_KERNEL_SCALAR] = COM_row_kernels_init_scalar(
+        &kernels[COM_ROW_KERNEL_SCALAR]);
+    available[COM_ROW_KERNEL_SSE2] = COM_row_kernels_init_sse2(&kernels[COM_ROW_KERNEL_SSE2]);
+    available[COM_ROW_KERNEL_AVX2] = COM_row_kernels_init_avx2(&kernels[COM_ROW_KERNEL_AVX2]);
+
+    best = COM_ROW_KERNEL_SCALAR;
+    for (int isa = 0; isa < COM_ROW_KERNEL_ISA_NUM; isa++) {
+      available[isa] = available[isa] && cpu_supports((RowKernelISA)isa);
+      if (available[isa]) {
+        best = (RowKernelISA)isa;
+      }
+    }
+  }
+};
+
+static const RowKernelsTable &row_kernels_table()
+{
+  /* Thread-safe initialization on first use, the CPU doesn't change while running. */
+  static const RowKernelsTable table;
+  return table;
+}
+
+const RowKernels &RowKernels::get()
+{
+  const RowKernelsTable &table = row_kernels_table();
+  return table.kernels[table.best];
+}
+
+const RowKernels *RowKernels::get(RowKernelISA isa)
+{
+  const RowKernelsTable &table = row_kernels_table();
+  return table.available[isa] ? &table.kernels[isa] : NULL;
+}
+
+/** \} */
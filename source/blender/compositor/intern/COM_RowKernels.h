@@ -0,0 +1,149 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#pragma once
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+/**
+ * \brief Instruction sets the row kernels are compiled for.
+ * \ingroup execution
+ */
+typedef enum RowKernelISA {
+  COM_ROW_KERNEL_SCALAR = 0,
+  COM_ROW_KERNEL_SSE2 = 1,
+  COM_ROW_KERNEL_AVX2 = 2,
+} RowKernelISA;
+
+#define COM_ROW_KERNEL_ISA_NUM 3
+
+/**
+ * \brief Blend modes of the mix operations that have a row kernel.
+ */
+typedef enum RowKernelMixType {
+  COM_ROW_MIX_BLEND = 0,
+  COM_ROW_MIX_ADD,
+  COM_ROW_MIX_SUBTRACT,
+  COM_ROW_MIX_MULTIPLY,
+  COM_ROW_MIX_SCREEN,
+  COM_ROW_MIX_DIFFERENCE,
+  COM_ROW_MIX_DARKEN,
+  COM_ROW_MIX_LIGHTEN,
+} RowKernelMixType;
+
+#define COM_ROW_MIX_NUM 8
+
+typedef struct MixRowParams {
+  bool use_value_alpha_multiply;
+  bool use_clamp;
+} MixRowParams;
+
+typedef struct ColorBalanceLGGRowParams {
+  float lift[3];
+  float gamma_inv[3];
+  float gain[3];
+} ColorBalanceLGGRowParams;
+
+typedef struct ColorCorrectionRowSettings {
+  float contrast;
+  float saturation;
+  float gamma;
+  float gain;
+  float lift;
+} ColorCorrectionRowSettings;
+
+typedef struct ColorCorrectionRowParams {
+  ColorCorrectionRowSettings master;
+  ColorCorrectionRowSettings shadows;
+  ColorCorrectionRowSettings midtones;
+  ColorCorrectionRowSettings highlights;
+  float start_midtones;
+  float end_midtones;
+  float luma_coefficients[3];
+  bool use_red;
+  bool use_green;
+  bool use_blue;
+} ColorCorrectionRowParams;
+
+typedef struct ChromaMatteRowParams {
+  /** Tangent of half the acceptance angle. */
+  float tan_half_acceptance;
+  /** Tangent of half the cutoff angle, which must be smaller than 180 degrees. */
+  float tan_half_cutoff;
+  float gain;
+} ChromaMatteRowParams;
+
+/**
+ * \brief Kernels processing a row of \a width pixels for the full frame execution model.
+ *
+ * Color buffers have 4 interleaved channels, value buffers a single one. The kernels are
+ * compiled for several instruction sets, #RowKernels::get returns the fastest one the CPU
+ * supports. Results of the SIMD versions match the scalar ones, except for kernels with
+ * transcendental functions that use polynomial approximations accurate to a few ULP.
+ */
+struct RowKernels {
+  RowKernelISA isa;
+  const char *name;
+
+  void (*mix[COM_ROW_MIX_NUM])(float *out,
+                               const float *value,
+                               const float *color1,
+                               const float *color2,
+                               int width,
+                               const MixRowParams &params);
+  void (*color_balance_lgg)(float *out,
+                            const float *value,
+                            const float *color,
+                            int width,
+                            const ColorBalanceLGGRowParams &params);
+  void (*color_correction)(float *out,
+                           const float *color,
+                           const float *mask,
+                           int width,
+                           const ColorCorrectionRowParams &params);
+  void (*chroma_matte)(float *out,
+                       const float *image,
+                       const float *key,
+                       int width,
+                       const ChromaMatteRowParams &params);
+  void (*color_to_bw)(float *out, const float *color, int width, const float luma[3]);
+  void (*color_to_value)(float *out, const float *color, int width);
+  void (*value_to_color)(float *out, const float *value, int width);
+
+  /**
+   * \brief get the kernels of the fastest instruction set supported by the CPU.
+   */
+  static const RowKernels &get();
+
+  /**
+   * \brief get the kernels of a specific instruction set.
+   * \return NULL when they are not compiled in or not supported by the CPU.
+   */
+  static const RowKernels *get(RowKernelISA isa);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:RowKernels")
+#endif
+};
+
+/* Per instruction set initialization, return false when not compiled in. */
+bool COM_row_kernels_init_scalar(RowKernels *kernels);
+bool COM_row_kernels_init_sse2(RowKernels *kernels);
+bool COM_row_kernels_init_avx2(RowKernels *kernels);
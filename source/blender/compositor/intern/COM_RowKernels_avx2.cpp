@@ -0,0 +1,288 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <cstring>
+
+#include "COM_RowKernels.h"
+
+#ifdef __AVX2__
+
+#  include <immintrin.h>
+
+namespace com_row_kernels_avx2 {
+
+#  define VSIZE 8
+
+struct vfloat {
+  __m256 m;
+
+  vfloat() = default;
+  vfloat(const __m256 m) : m(m)
+  {
+  }
+  explicit vfloat(const float f) : m(_mm256_set1_ps(f))
+  {
+  }
+};
+
+struct vmask {
+  __m256 m;
+};
+
+static inline vfloat operator+(const vfloat a, const vfloat b)
+{
+  return _mm256_add_ps(a.m, b.m);
+}
+
+static inline vfloat operator-(const vfloat a, const vfloat b)
+{
+  return _mm256_sub_ps(a.m, b.m);
+}
+
+static inline vfloat operator*(const vfloat a, const vfloat b)
+{
+  return _mm256_mul_ps(a.m, b.m);
+}
+
+static inline vfloat operator/(const vfloat a, const vfloat b)
+{
+  return _mm256_div_ps(a.m, b.m);
+}
+
+static inline vmask operator<(const vfloat a, const vfloat b)
+{
+  return {_mm256_cmp_ps(a.m, b.m, _CMP_LT_OQ)};
+}
+
+static inline vmask operator>(const vfloat a, const vfloat b)
+{
+  return {_mm256_cmp_ps(a.m, b.m, _CMP_GT_OQ)};
+}
+
+static inline vmask operator&(const vmask a, const vmask b)
+{
+  return {_mm256_and_ps(a.m, b.m)};
+}
+
+static inline vmask operator|(const vmask a, const vmask b)
+{
+  return {_mm256_or_ps(a.m, b.m)};
+}
+
+/* Same operand order as #min_ff and #max_ff: the second argument is returned for NaN. */
+static inline vfloat vmin(const vfloat a, const vfloat b)
+{
+  return _mm256_min_ps(a.m, b.m);
+}
+
+static inline vfloat vmax(const vfloat a, const vfloat b)
+{
+  return _mm256_max_ps(a.m, b.m);
+}
+
+static inline vfloat vabs(const vfloat a)
+{
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.m);
+}
+
+static inline vfloat vsqrt(const vfloat a)
+{
+  return _mm256_sqrt_ps(a.m);
+}
+
+static inline vfloat select(const vmask mask, const vfloat a, const vfloat b)
+{
+  return _mm256_or_ps(_mm256_and_ps(mask.m, a.m), _mm256_andnot_ps(mask.m, b.m));
+}
+
+/* Natural logarithm and exponent for positive finite values, polynomial approximations from the
+ * Cephes library. */
+static inline vfloat vlog(const vfloat a)
+{
+  const __m256 one = _mm256_set1_ps(1.0f);
+  /* Cut off denormalized values. */
+  __m256 x = _mm256_max_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(0x00800000)));
+
+  __m256i emm0 = _mm256_srli_epi32(_mm256_castps_si256(x), 23);
+  /* Keep the mantissa, in the 0.5..1.0 range. */
+  x = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(~0x7f800000)));
+  x = _mm256_or_ps(x, _mm256_set1_ps(0.5f));
+
+  emm0 = _mm256_sub_epi32(emm0, _mm256_set1_epi32(0x7f));
+  __m256 e = _mm256_add_ps(_mm256_cvtepi32_ps(emm0), one);
+
+  const __m256 mask = _mm256_cmp_ps(x, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+  const __m256 tmp = _mm256_and_ps(x, mask);
+  x = _mm256_sub_ps(x, one);
+  e = _mm256_sub_ps(e, _mm256_and_ps(one, mask));
+  x = _mm256_add_ps(x, tmp);
+
+  const __m256 z = _mm256_mul_ps(x, x);
+  __m256 y = _mm256_set1_ps(7.0376836292e-2f);
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(-1.1514610310e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.1676998740e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(-1.2420140846e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.4249322787e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(-1.6668057665e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(2.0000714765e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(-2.4999993993e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(3.3333331174e-1f));
+  y = _mm256_mul_ps(_mm256_mul_ps(y, x), z);
+
+  y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(-2.12194440e-4f)));
+  y = _mm256_sub_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+  x = _mm256_add_ps(x, y);
+  x = _mm256_add_ps(x, _mm256_mul_ps(e, _mm256_set1_ps(0.693359375f)));
+  return x;
+}
+
+static inline vfloat vexp(const vfloat a)
+{
+  const __m256 one = _mm256_set1_ps(1.0f);
+  __m256 x = _mm256_min_ps(a.m, _mm256_set1_ps(88.3762626647949f));
+  x = _mm256_max_ps(x, _mm256_set1_ps(-88.3762626647949f));
+
+  /* Express exp(x) as exp(g + n * log(2)). */
+  __m256 fx = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                            _mm256_set1_ps(0.5f));
+  const __m256 tmp = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(fx));
+  fx = _mm256_sub_ps(tmp, _mm256_and_ps(_mm256_cmp_ps(tmp, fx, _CMP_GT_OQ), one));
+
+  x = _mm256_sub_ps(x, _mm256_mul_ps(fx, _mm256_set1_ps(0.693359375f)));
+  x = _mm256_sub_ps(x, _mm256_mul_ps(fx, _mm256_set1_ps(-2.12194440e-4f)));
+
+  const __m256 z = _mm256_mul_ps(x, x);
+  __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.3981999507e-3f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(8.3334519073e-3f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(4.1665795894e-2f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.6666665459e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(5.0000001201e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, z), x);
+  y = _mm256_add_ps(y, one);
+
+  /* Build 2^n. */
+  __m256i emm0 = _mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(0x7f));
+  emm0 = _mm256_slli_epi32(emm0, 23);
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(emm0));
+}
+
+/* Power for non-negative x and positive y. */
+static inline vfloat vpow(const vfloat x, const vfloat y)
+{
+  const vfloat zero(0.0f);
+  return select(x > zero, vexp(y * vlog(x)), zero);
+}
+
+static inline vfloat v_linearrgb_to_srgb(const vfloat c)
+{
+  const vfloat zero(0.0f);
+  const vfloat low = select(c < zero, zero, c * vfloat(12.92f));
+  const vfloat high = vfloat(1.055f) * vpow(c, vfloat(1.0f / 2.4f)) - vfloat(0.055f);
+  return select(c < vfloat(0.0031308f), low, high);
+}
+
+static inline vfloat v_srgb_to_linearrgb(const vfloat c)
+{
+  const vfloat zero(0.0f);
+  const vfloat low = select(c < zero, zero, c * vfloat(1.0f / 12.92f));
+  const vfloat high = vpow((c + vfloat(0.055f)) * vfloat(1.0f / 1.055f), vfloat(2.4f));
+  return select(c < vfloat(0.04045f), low, high);
+}
+
+/* Transpose the 4x4 matrix in each 128 bit lane, like #_MM_TRANSPOSE4_PS. */
+static inline void transpose_lanes(__m256 &p0, __m256 &p1, __m256 &p2, __m256 &p3)
+{
+  const __m256 t0 = _mm256_unpacklo_ps(p0, p1);
+  const __m256 t1 = _mm256_unpacklo_ps(p2, p3);
+  const __m256 t2 = _mm256_unpackhi_ps(p0, p1);
+  const __m256 t3 = _mm256_unpackhi_ps(p2, p3);
+  p0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+  p1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+  p2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  p3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+static inline __m256 load_pixel_pair(const float *p0, const float *p1)
+{
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p0)), _mm_loadu_ps(p1), 1);
+}
+
+static inline void store_pixel_pair(float *p0, float *p1, const __m256 v)
+{
+  _mm_storeu_ps(p0, _mm256_castps256_ps128(v));
+  _mm_storeu_ps(p1, _mm256_extractf128_ps(v, 1));
+}
+
+/* Pixels 0..3 go in the low lane and 4..7 in the high lane, so channels keep the pixel order. */
+static inline void load_rgba(const float *p, vfloat &r, vfloat &g, vfloat &b, vfloat &a)
+{
+  __m256 p0 = load_pixel_pair(p, p + 16);
+  __m256 p1 = load_pixel_pair(p + 4, p + 20);
+  __m256 p2 = load_pixel_pair(p + 8, p + 24);
+  __m256 p3 = load_pixel_pair(p + 12, p + 28);
+  transpose_lanes(p0, p1, p2, p3);
+  r = p0;
+  g = p1;
+  b = p2;
+  a = p3;
+}
+
+static inline void store_rgba(
+    float *p, const vfloat r, const vfloat g, const vfloat b, const vfloat a)
+{
+  __m256 p0 = r.m, p1 = g.m, p2 = b.m, p3 = a.m;
+  transpose_lanes(p0, p1, p2, p3);
+  store_pixel_pair(p, p + 16, p0);
+  store_pixel_pair(p + 4, p + 20, p1);
+  store_pixel_pair(p + 8, p + 24, p2);
+  store_pixel_pair(p + 12, p + 28, p3);
+}
+
+static inline vfloat load_value(const float *p)
+{
+  return _mm256_loadu_ps(p);
+}
+
+static inline void store_value(float *p, const vfloat v)
+{
+  _mm256_storeu_ps(p, v.m);
+}
+
+#  include "COM_RowKernels_impl.h"
+
+#  undef VSIZE
+
+}  // namespace com_row_kernels_avx2
+
+bool COM_row_kernels_init_avx2(RowKernels *kernels)
+{
+  com_row_kernels_avx2::init_kernels(kernels);
+  kernels->isa = COM_ROW_KERNEL_AVX2;
+  kernels->name = "AVX2";
+  return true;
+}
+
+#else
+
+bool COM_row_kernels_init_avx2(RowKernels * /*kernels*/)
+{
+  return false;
+}
+
+#endif
@@ -0,0 +1,447 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+/** \file
+ * \ingroup execution
+ *
+ * Row kernels shared by all instruction sets. This file is included inside a namespace of every
+ * COM_RowKernels_*.cpp file, which defines:
+ *
+ * - `VSIZE`: the number of pixels processed at once.
+ * - `vfloat` and `vmask`: a channel of `VSIZE` pixels and the result of comparing them, with the
+ *   arithmetic and comparison operators.
+ * - `vmin`, `vmax`, `vabs`, `vsqrt` and `select(mask, a, b)`.
+ * - `vpow(x, y)` for non-negative `x`, `v_linearrgb_to_srgb` and `v_srgb_to_linearrgb`.
+ * - `load_rgba`, `store_rgba`, `load_value` and `store_value` to convert `VSIZE` interleaved
+ *   pixels from and to one vector per channel.
+ */
+
+/**
+ * Call \a block for every \a VSIZE pixels of a row. The last pixels are padded, so they go
+ * through the same code path. Buffers with 0 channels are not used by the kernel.
+ */
+template<int OutChannels, int InChannels0, int InChannels1, int InChannels2, typename Block>
+static inline void process_row(float *out,
+                               const float *in0,
+                               const float *in1,
+                               const float *in2,
+                               const int width,
+                               const Block &block)
+{
+  int x = 0;
+  for (; x + VSIZE <= width; x += VSIZE) {
+    block(out + x * OutChannels,
+          in0 + x * InChannels0,
+          in1 + x * InChannels1,
+          in2 + x * InChannels2);
+  }
+
+  const int remainder = width - x;
+  if (remainder > 0) {
+    float tail_out[VSIZE * 4];
+    float tail_in0[VSIZE * 4] = {0.0f};
+    float tail_in1[VSIZE * 4] = {0.0f};
+    float tail_in2[VSIZE * 4] = {0.0f};
+    memcpy(tail_in0, in0 + x * InChannels0, sizeof(float) * remainder * InChannels0);
+    memcpy(tail_in1, in1 + x * InChannels1, sizeof(float) * remainder * InChannels1);
+    memcpy(tail_in2, in2 + x * InChannels2, sizeof(float) * remainder * InChannels2);
+    block(tail_out, tail_in0, tail_in1, tail_in2);
+    memcpy(out + x * OutChannels, tail_out, sizeof(float) * remainder * OutChannels);
+  }
+}
+
+static inline vfloat vclamp01(const vfloat a)
+{
+  /* Argument order keeps NaN as is, like #clamp_v4. */
+  return vmin(vfloat(1.0f), vmax(vfloat(0.0f), a));
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Mix
+ * \{ */
+
+template<RowKernelMixType Type>
+static inline vfloat mix_channel(const vfloat v, const vfloat vm, const vfloat c1, const vfloat c2)
+{
+  switch (Type) {
+    case COM_ROW_MIX_BLEND:
+      return vm * c1 + v * c2;
+    case COM_ROW_MIX_ADD:
+      return c1 + v * c2;
+    case COM_ROW_MIX_SUBTRACT:
+      return c1 - v * c2;
+    case COM_ROW_MIX_MULTIPLY:
+      return c1 * (vm + v * c2);
+    case COM_ROW_MIX_SCREEN:
+      return vfloat(1.0f) - (vm + v * (vfloat(1.0f) - c2)) * (vfloat(1.0f) - c1);
+    case COM_ROW_MIX_DIFFERENCE:
+      return vm * c1 + v * vabs(c1 - c2);
+    case COM_ROW_MIX_DARKEN:
+      return vmin(c1, c2) * v + c1 * vm;
+    case COM_ROW_MIX_LIGHTEN:
+      return vmax(v * c2, c1);
+  }
+  return c1;
+}
+
+template<RowKernelMixType Type>
+static void mix_row(float *out,
+                    const float *value,
+                    const float *color1,
+                    const float *color2,
+                    int width,
+                    const MixRowParams &params)
+{
+  process_row<4, 1, 4, 4>(
+      out,
+      value,
+      color1,
+      color2,
+      width,
+      [&](float *o, const float *pv, const float *pc1, const float *pc2) {
+        vfloat r1, g1, b1, a1, r2, g2, b2, a2;
+        load_rgba(pc1, r1, g1, b1, a1);
+        load_rgba(pc2, r2, g2, b2, a2);
+        vfloat v = load_value(pv);
+        if (params.use_value_alpha_multiply) {
+          v = v * a2;
+        }
+        const vfloat vm = vfloat(1.0f) - v;
+
+        vfloat r = mix_channel<Type>(v, vm, r1, r2);
+        vfloat g = mix_channel<Type>(v, vm, g1, g2);
+        vfloat b = mix_channel<Type>(v, vm, b1, b2);
+        vfloat a = a1;
+        if (params.use_clamp) {
+          r = vclamp01(r);
+          g = vclamp01(g);
+          b = vclamp01(b);
+          a = vclamp01(a);
+        }
+        store_rgba(o, r, g, b, a);
+      });
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Color Balance
+ * \{ */
+
+static inline vfloat colorbalance_lgg(const vfloat in,
+                                      const float lift_lgg,
+                                      const float gamma_inv,
+                                      const float gain)
+{
+  vfloat x = (((v_linearrgb_to_srgb(in) - vfloat(1.0f)) * vfloat(lift_lgg)) + vfloat(1.0f)) *
+             vfloat(gain);
+
+  /* prevent NaN */
+  x = select(x < vfloat(0.0f), vfloat(0.0f), x);
+
+  return vpow(v_srgb_to_linearrgb(x), vfloat(gamma_inv));
+}
+
+static void color_balance_lgg_row(float *out,
+                                  const float *value,
+                                  const float *color,
+                                  int width,
+                                  const ColorBalanceLGGRowParams &params)
+{
+  process_row<4, 1, 4, 0>(
+      out,
+      value,
+      color,
+      nullptr,
+      width,
+      [&](float *o, const float *pv, const float *pc, const float * /*unused*/) {
+        vfloat r, g, b, a;
+        load_rgba(pc, r, g, b, a);
+        const vfloat fac = vmin(load_value(pv), vfloat(1.0f));
+        const vfloat mfac = vfloat(1.0f) - fac;
+
+        const vfloat r_out = mfac * r + fac * colorbalance_lgg(r,
+                                                               params.lift[0],
+                                                               params.gamma_inv[0],
+                                                               params.gain[0]);
+        const vfloat g_out = mfac * g + fac * colorbalance_lgg(g,
+                                                               params.lift[1],
+                                                               params.gamma_inv[1],
+                                                               params.gain[1]);
+        const vfloat b_out = mfac * b + fac * colorbalance_lgg(b,
+                                                               params.lift[2],
+                                                               params.gamma_inv[2],
+                                                               params.gain[2]);
+        store_rgba(o, r_out, g_out, b_out, a);
+      });
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Color Correction
+ * \{ */
+
+static inline vfloat color_correction_weighted(const vfloat shadows,
+                                               const vfloat midtones,
+                                               const vfloat highlights,
+                                               const float shadows_setting,
+                                               const float midtones_setting,
+                                               const float highlights_setting)
+{
+  return (shadows * vfloat(shadows_setting)) + (midtones * vfloat(midtones_setting)) +
+         (highlights * vfloat(highlights_setting));
+}
+
+static void color_correction_row(float *out,
+                                 const float *color,
+                                 const float *mask,
+                                 int width,
+                                 const ColorCorrectionRowParams &params)
+{
+  const float margin = 0.10f;
+  const float margin_div = 0.5f / margin;
+
+  process_row<4, 4, 1, 0>(
+      out,
+      color,
+      mask,
+      nullptr,
+      width,
+      [&](float *o, const float *pc, const float *pm, const float * /*unused*/) {
+        vfloat in_r, in_g, in_b, in_a;
+        load_rgba(pc, in_r, in_g, in_b, in_a);
+        const vfloat level = (in_r + in_g + in_b) / vfloat(3.0f);
+
+        const vfloat value = vmin(load_value(pm), vfloat(1.0f));
+        const vfloat mvalue = vfloat(1.0f) - value;
+
+        /* Same ladder as the per pixel version, as selects. */
+        const vmask below_start = level < vfloat(params.start_midtones - margin);
+        const vmask in_start = level < vfloat(params.start_midtones + margin);
+        const vmask below_end = level < vfloat(params.end_midtones - margin);
+        const vmask in_end = level < vfloat(params.end_midtones + margin);
+        const vfloat start_midtones = ((level - vfloat(params.start_midtones)) *
+                                       vfloat(margin_div)) +
+                                      vfloat(0.5f);
+        const vfloat end_highlights = ((level - vfloat(params.end_midtones)) *
+                                       vfloat(margin_div)) +
+                                      vfloat(0.5f);
+        const vfloat zero(0.0f), one(1.0f);
+        const vfloat level_shadows = select(
+            below_start, one, select(in_start, one - start_midtones, zero));
+        const vfloat level_midtones = select(
+            below_start,
+            zero,
+            select(in_start,
+                   start_midtones,
+                   select(below_end, one, select(in_end, one - end_highlights, zero))));
+        const vfloat level_highlights = select(
+            below_start | in_start | below_end, zero, select(in_end, end_highlights, one));
+
+        const vfloat contrast = vfloat(params.master.contrast) *
+                                color_correction_weighted(level_shadows,
+                                                          level_midtones,
+                                                          level_highlights,
+                                                          params.shadows.contrast,
+                                                          params.midtones.contrast,
+                                                          params.highlights.contrast);
+        const vfloat saturation = vfloat(params.master.saturation) *
+                                  color_correction_weighted(level_shadows,
+                                                            level_midtones,
+                                                            level_highlights,
+                                                            params.shadows.saturation,
+                                                            params.midtones.saturation,
+                                                            params.highlights.saturation);
+        const vfloat gamma = vfloat(params.master.gamma) *
+                             color_correction_weighted(level_shadows,
+                                                       level_midtones,
+                                                       level_highlights,
+                                                       params.shadows.gamma,
+                                                       params.midtones.gamma,
+                                                       params.highlights.gamma);
+        const vfloat gain = vfloat(params.master.gain) *
+                            color_correction_weighted(level_shadows,
+                                                      level_midtones,
+                                                      level_highlights,
+                                                      params.shadows.gain,
+                                                      params.midtones.gain,
+                                                      params.highlights.gain);
+        const vfloat lift = vfloat(params.master.lift) +
+                            color_correction_weighted(level_shadows,
+                                                      level_midtones,
+                                                      level_highlights,
+                                                      params.shadows.lift,
+                                                      params.midtones.lift,
+                                                      params.highlights.lift);
+
+        const vfloat invgamma = vfloat(1.0f) / gamma;
+        const vfloat luma = vfloat(params.luma_coefficients[0]) * in_r +
+                            vfloat(params.luma_coefficients[1]) * in_g +
+                            vfloat(params.luma_coefficients[2]) * in_b;
+
+        const vfloat in[3] = {in_r, in_g, in_b};
+        const bool enabled[3] = {params.use_red, params.use_green, params.use_blue};
+        vfloat result[3];
+        for (int i = 0; i < 3; i++) {
+          if (!enabled[i]) {
+            result[i] = in[i];
+            continue;
+          }
+          vfloat c = (luma + saturation * (in[i] - luma));
+          c = vfloat(0.5f) + ((c - vfloat(0.5f)) * contrast);
+
+          /* Check for negative values to avoid nan. */
+          const vfloat base = c * gain + lift;
+          c = select(base < vfloat(0.0f), c, vpow(base, invgamma));
+
+          /* Mix with mask. */
+          result[i] = mvalue * in[i] + value * c;
+        }
+        store_rgba(o, result[0], result[1], result[2], in_a);
+      });
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Chroma Matte
+ * \{ */
+
+static void chroma_matte_row(float *out,
+                             const float *image,
+                             const float *key,
+                             int width,
+                             const ChromaMatteRowParams &params)
+{
+  process_row<1, 4, 4, 0>(
+      out,
+      image,
+      key,
+      nullptr,
+      width,
+      [&](float *o, const float *pi, const float *pk, const float * /*unused*/) {
+        vfloat image_r, image_g, image_b, image_a;
+        vfloat key_r, key_g, key_b, key_a;
+        load_rgba(pi, image_r, image_g, image_b, image_a);
+        load_rgba(pk, key_r, key_g, key_b, key_a);
+
+        /* Rescale to -1.0..1.0. */
+        const vfloat cb = (image_g * vfloat(2.0f)) - vfloat(1.0f);
+        const vfloat cr = (image_b * vfloat(2.0f)) - vfloat(1.0f);
+        const vfloat key_cb = (key_g * vfloat(2.0f)) - vfloat(1.0f);
+        const vfloat key_cr = (key_b * vfloat(2.0f)) - vfloat(1.0f);
+
+        /* Cosine and sine of the angle the color space is rotated by, based on the key. Same as
+         * `atan2(key_cr, key_cb)` followed by `cosf` and `sinf`, without the trigonometry. */
+        const vfloat key_len = vsqrt(key_cb * key_cb + key_cr * key_cr);
+        const vmask has_key = key_len > vfloat(0.0f);
+        const vfloat cos_theta = select(has_key, key_cb / key_len, vfloat(1.0f));
+        const vfloat sin_theta = select(has_key, key_cr / key_len, vfloat(0.0f));
+
+        /* Rotate the cb and cr into x/z space. */
+        const vfloat x_angle = cb * cos_theta + cr * sin_theta;
+        const vfloat z_angle = cr * cos_theta - cb * sin_theta;
+
+        /* If kfg is <0 then the pixel is outside of the key color. */
+        const vfloat kfg = x_angle - (vabs(z_angle) / vfloat(params.tan_half_acceptance));
+        const vmask inside = kfg > vfloat(0.0f);
+
+        vfloat alpha = vfloat(1.0f) - (kfg / vfloat(params.gain));
+
+        /* If the angle of the pixel is within the cutoff angle, compared through the tangent
+         * since x is positive inside the acceptance angle. */
+        const vmask in_cutoff = (x_angle > vfloat(0.0f)) &
+                                (vabs(z_angle) < x_angle * vfloat(params.tan_half_cutoff));
+        alpha = select(in_cutoff, vfloat(0.0f), alpha);
+
+        /* Don't make something that was more transparent less transparent. */
+        alpha = select(alpha < image_a, alpha, image_a);
+        store_value(o, select(inside, alpha, image_a));
+      });
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Conversion
+ * \{ */
+
+static void color_to_bw_row(float *out, const float *color, int width, const float luma[3])
+{
+  process_row<1, 4, 0, 0>(
+      out,
+      color,
+      nullptr,
+      nullptr,
+      width,
+      [&](float *o, const float *pc, const float * /*unused*/, const float * /*unused*/) {
+        vfloat r, g, b, a;
+        load_rgba(pc, r, g, b, a);
+        store_value(o, vfloat(luma[0]) * r + vfloat(luma[1]) * g + vfloat(luma[2]) * b);
+      });
+}
+
+static void color_to_value_row(float *out, const float *color, int width)
+{
+  process_row<1, 4, 0, 0>(
+      out,
+      color,
+      nullptr,
+      nullptr,
+      width,
+      [&](float *o, const float *pc, const float * /*unused*/, const float * /*unused*/) {
+        vfloat r, g, b, a;
+        load_rgba(pc, r, g, b, a);
+        store_value(o, (r + g + b) / vfloat(3.0f));
+      });
+}
+
+static void value_to_color_row(float *out, const float *value, int width)
+{
+  process_row<4, 1, 0, 0>(
+      out,
+      value,
+      nullptr,
+      nullptr,
+      width,
+      [&](float *o, const float *pv, const float * /*unused*/, const float * /*unused*/) {
+        const vfloat v = load_value(pv);
+        store_rgba(o, v, v, v, vfloat(1.0f));
+      });
+}
+
+/** \} */
+
+static void init_kernels(RowKernels *kernels)
+{
+  kernels->mix[COM_ROW_MIX_BLEND] = mix_row<COM_ROW_MIX_BLEND>;
+  kernels->mix[COM_ROW_MIX_ADD] = mix_row<COM_ROW_MIX_ADD>;
+  kernels->mix[COM_ROW_MIX_SUBTRACT] = mix_row<COM_ROW_MIX_SUBTRACT>;
+  kernels->mix[COM_ROW_MIX_MULTIPLY] = mix_row<COM_ROW_MIX_MULTIPLY>;
+  kernels->mix[COM_ROW_MIX_SCREEN] = mix_row<COM_ROW_MIX_SCREEN>;
+  kernels->mix[COM_ROW_MIX_DIFFERENCE] = mix_row<COM_ROW_MIX_DIFFERENCE>;
+  kernels->mix[COM_ROW_MIX_DARKEN] = mix_row<COM_ROW_MIX_DARKEN>;
+  kernels->mix[COM_ROW_MIX_LIGHTEN] = mix_row<COM_ROW_MIX_LIGHTEN>;
+  kernels->color_balance_lgg = color_balance_lgg_row;
+  kernels->color_correction = color_correction_row;
+  kernels->chroma_matte = chroma_matte_row;
+  kernels->color_to_bw = color_to_bw_row;
+  kernels->color_to_value = color_to_value_row;
+  kernels->value_to_color = value_to_color_row;
+}
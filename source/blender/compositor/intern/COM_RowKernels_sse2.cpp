@@ -0,0 +1,262 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <cstring>
+
+#include "COM_RowKernels.h"
+
+#ifdef __SSE2__
+
+#  include <emmintrin.h>
+
+namespace com_row_kernels_sse2 {
+
+#  define VSIZE 4
+
+struct vfloat {
+  __m128 m;
+
+  vfloat() = default;
+  vfloat(const __m128 m) : m(m)
+  {
+  }
+  explicit vfloat(const float f) : m(_mm_set1_ps(f))
+  {
+  }
+};
+
+struct vmask {
+  __m128 m;
+};
+
+static inline vfloat operator+(const vfloat a, const vfloat b)
+{
+  return _mm_add_ps(a.m, b.m);
+}
+
+static inline vfloat operator-(const vfloat a, const vfloat b)
+{
+  return _mm_sub_ps(a.m, b.m);
+}
+
+static inline vfloat operator*(const vfloat a, const vfloat b)
+{
+  return _mm_mul_ps(a.m, b.m);
+}
+
+static inline vfloat operator/(const vfloat a, const vfloat b)
+{
+  return _mm_div_ps(a.m, b.m);
+}
+
+static inline vmask operator<(const vfloat a, const vfloat b)
+{
+  return {_mm_cmplt_ps(a.m, b.m)};
+}
+
+static inline vmask operator>(const vfloat a, const vfloat b)
+{
+  return {_mm_cmpgt_ps(a.m, b.m)};
+}
+
+static inline vmask operator&(const vmask a, const vmask b)
+{
+  return {_mm_and_ps(a.m, b.m)};
+}
+
+static inline vmask operator|(const vmask a, const vmask b)
+{
+  return {_mm_or_ps(a.m, b.m)};
+}
+
+/* Same operand order as #min_ff and #max_ff: the second argument is returned for NaN. */
+static inline vfloat vmin(const vfloat a, const vfloat b)
+{
+  return _mm_min_ps(a.m, b.m);
+}
+
+static inline vfloat vmax(const vfloat a, const vfloat b)
+{
+  return _mm_max_ps(a.m, b.m);
+}
+
+static inline vfloat vabs(const vfloat a)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.m);
+}
+
+static inline vfloat vsqrt(const vfloat a)
+{
+  return _mm_sqrt_ps(a.m);
+}
+
+static inline vfloat select(const vmask mask, const vfloat a, const vfloat b)
+{
+  return _mm_or_ps(_mm_and_ps(mask.m, a.m), _mm_andnot_ps(mask.m, b.m));
+}
+
+/* Natural logarithm and exponent for positive finite values, polynomial approximations from the
+ * Cephes library. */
+static inline vfloat vlog(const vfloat a)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  /* Cut off denormalized values. */
+  __m128 x = _mm_max_ps(a.m, _mm_castsi128_ps(_mm_set1_epi32(0x00800000)));
+
+  __m128i emm0 = _mm_srli_epi32(_mm_castps_si128(x), 23);
+  /* Keep the mantissa, in the 0.5..1.0 range. */
+  x = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(~0x7f800000)));
+  x = _mm_or_ps(x, _mm_set1_ps(0.5f));
+
+  emm0 = _mm_sub_epi32(emm0, _mm_set1_epi32(0x7f));
+  __m128 e = _mm_add_ps(_mm_cvtepi32_ps(emm0), one);
+
+  const __m128 mask = _mm_cmplt_ps(x, _mm_set1_ps(0.707106781186547524f));
+  const __m128 tmp = _mm_and_ps(x, mask);
+  x = _mm_sub_ps(x, one);
+  e = _mm_sub_ps(e, _mm_and_ps(one, mask));
+  x = _mm_add_ps(x, tmp);
+
+  const __m128 z = _mm_mul_ps(x, x);
+  __m128 y = _mm_set1_ps(7.0376836292e-2f);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.1514610310e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.1676998740e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.2420140846e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.4249322787e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.6668057665e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(2.0000714765e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-2.4999993993e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(3.3333331174e-1f));
+  y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+
+  y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+  y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+  x = _mm_add_ps(x, y);
+  x = _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+  return x;
+}
+
+static inline vfloat vexp(const vfloat a)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  __m128 x = _mm_min_ps(a.m, _mm_set1_ps(88.3762626647949f));
+  x = _mm_max_ps(x, _mm_set1_ps(-88.3762626647949f));
+
+  /* Express exp(x) as exp(g + n * log(2)). */
+  __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+  const __m128 tmp = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+  fx = _mm_sub_ps(tmp, _mm_and_ps(_mm_cmpgt_ps(tmp, fx), one));
+
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+  const __m128 z = _mm_mul_ps(x, x);
+  __m128 y = _mm_set1_ps(1.9875691500e-4f);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, z), x);
+  y = _mm_add_ps(y, one);
+
+  /* Build 2^n. */
+  __m128i emm0 = _mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(0x7f));
+  emm0 = _mm_slli_epi32(emm0, 23);
+  return _mm_mul_ps(y, _mm_castsi128_ps(emm0));
+}
+
+/* Power for non-negative x and positive y. */
+static inline vfloat vpow(const vfloat x, const vfloat y)
+{
+  const vfloat zero(0.0f);
+  return select(x > zero, vexp(y * vlog(x)), zero);
+}
+
+static inline vfloat v_linearrgb_to_srgb(const vfloat c)
+{
+  const vfloat zero(0.0f);
+  const vfloat low = select(c < zero, zero, c * vfloat(12.92f));
+  const vfloat high = vfloat(1.055f) * vpow(c, vfloat(1.0f / 2.4f)) - vfloat(0.055f);
+  return select(c < vfloat(0.0031308f), low, high);
+}
+
+static inline vfloat v_srgb_to_linearrgb(const vfloat c)
+{
+  const vfloat zero(0.0f);
+  const vfloat low = select(c < zero, zero, c * vfloat(1.0f / 12.92f));
+  const vfloat high = vpow((c + vfloat(0.055f)) * vfloat(1.0f / 1.055f), vfloat(2.4f));
+  return select(c < vfloat(0.04045f), low, high);
+}
+
+static inline void load_rgba(const float *p, vfloat &r, vfloat &g, vfloat &b, vfloat &a)
+{
+  __m128 p0 = _mm_loadu_ps(p);
+  __m128 p1 = _mm_loadu_ps(p + 4);
+  __m128 p2 = _mm_loadu_ps(p + 8);
+  __m128 p3 = _mm_loadu_ps(p + 12);
+  _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+  r = p0;
+  g = p1;
+  b = p2;
+  a = p3;
+}
+
+static inline void store_rgba(
+    float *p, const vfloat r, const vfloat g, const vfloat b, const vfloat a)
+{
+  __m128 p0 = r.m, p1 = g.m, p2 = b.m, p3 = a.m;
+  _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+  _mm_storeu_ps(p, p0);
+  _mm_storeu_ps(p + 4, p1);
+  _mm_storeu_ps(p + 8, p2);
+  _mm_storeu_ps(p + 12, p3);
+}
+
+static inline vfloat load_value(const float *p)
+{
+  return _mm_loadu_ps(p);
+}
+
+static inline void store_value(float *p, const vfloat v)
+{
+  _mm_storeu_ps(p, v.m);
+}
+
+#  include "COM_RowKernels_impl.h"
+
+#  undef VSIZE
+
+}  // namespace com_row_kernels_sse2
+
+bool COM_row_kernels_init_sse2(RowKernels *kernels)
+{
+  com_row_kernels_sse2::init_kernels(kernels);
+  kernels->isa = COM_ROW_KERNEL_SSE2;
+  kernels->name = "SSE2";
+  return true;
+}
+
+#else
+
+bool COM_row_kernels_init_sse2(RowKernels * /*kernels*/)
+{
+  return false;
+}
+
+#endif
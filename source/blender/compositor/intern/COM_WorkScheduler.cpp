@@ -17,6 +17,7 @@
  */
 
 #include <list>
+#include <deque>
 #include <stdio.h>
 
 #include "COM_CPUDevice.h"
@@ -29,6 +30,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "PIL_time.h"
 
@@ -39,6 +41,8 @@
 #    warning COM_CURRENT_THREADING_MODEL COM_TM_NOTHREAD is activated. Use only for debugging.
 #  endif
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+/* do nothing - previous default */
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
 /* do nothing - default */
 #else
 #  error COM_CURRENT_THREADING_MODEL No threading model selected
@@ -48,12 +52,22 @@
 static vector<CPUDevice *> g_cpudevices;
 static ThreadLocal(CPUDevice *) g_thread_device;
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
+static bool g_cpuInitialized = false;
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 /** \brief list of all thread for every CPUDevice in cpudevices a thread exists. */
 static ListBase g_cputhreads;
-static bool g_cpuInitialized = false;
 /** \brief all scheduled work for the cpu */
 static ThreadQueue *g_cpuqueue;
+#  else
+/** \brief task pool running a worker for every busy CPUDevice. */
+static TaskPool *g_cpupool;
+/** \brief all scheduled work for the cpu that no worker picked up yet. */
+static std::deque<WorkPackage *> g_cpuwork;
+/** \brief CPUDevices that have no worker running, limiting the workers to the device count. */
+static vector<CPUDevice *> g_cpudevices_idle;
+static ThreadMutex g_cpuMutex = BLI_MUTEX_INITIALIZER;
+#  endif
 static ThreadQueue *g_gpuqueue;
 #  ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -67,6 +81,28 @@ static ListBase g_gputhreads;
 static bool g_openclActive = false;
 static bool g_openclInitialized = false;
 #  endif
+
+/** \brief number of scheduled work packages that did not finish yet. */
+static int g_workPending = 0;
+static ThreadMutex g_workMutex = BLI_MUTEX_INITIALIZER;
+static ThreadCondition g_workCondition;
+
+static void work_package_scheduled()
+{
+  BLI_mutex_lock(&g_workMutex);
+  g_workPending++;
+  BLI_mutex_unlock(&g_workMutex);
+}
+
+static void work_package_finished(WorkPackage *work)
+{
+  delete work;
+
+  BLI_mutex_lock(&g_workMutex);
+  g_workPending--;
+  BLI_condition_notify_all(&g_workCondition);
+  BLI_mutex_unlock(&g_workMutex);
+}
 #endif
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
@@ -77,12 +113,41 @@ void *WorkScheduler::thread_execute_cpu(void *data)
   BLI_thread_local_set(g_thread_device, device);
   while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
     device->execute(work);
-    delete work;
+    work_package_finished(work);
   }
 
   return NULL;
 }
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+/**
+ * \brief worker loop of a CPUDevice, run by the task scheduler.
+ * Executes work until none is left, then makes the device available for a new worker.
+ */
+static void thread_execute_task(TaskPool *__restrict /*pool*/, void *data)
+{
+  CPUDevice *device = (CPUDevice *)data;
+  BLI_thread_local_set(g_thread_device, device);
+
+  while (true) {
+    BLI_mutex_lock(&g_cpuMutex);
+    if (g_cpuwork.empty()) {
+      g_cpudevices_idle.push_back(device);
+      BLI_mutex_unlock(&g_cpuMutex);
+      break;
+    }
+    WorkPackage *work = g_cpuwork.front();
+    g_cpuwork.pop_front();
+    BLI_mutex_unlock(&g_cpuMutex);
+
+    device->execute(work);
+    work_package_finished(work);
+  }
 
+  BLI_thread_local_set(g_thread_device, NULL);
+}
+#endif
+
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 void *WorkScheduler::thread_execute_gpu(void *data)
 {
   Device *device = (Device *)data;
@@ -90,11 +155,33 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 
   while ((work = (WorkPackage *)BLI_thread_queue_pop(g_gpuqueue))) {
     device->execute(work);
-    delete work;
+    work_package_finished(work);
   }
 
   return NULL;
 }
+
+/** \brief schedule a work package for the CPU devices. */
+static void schedule_cpu(WorkPackage *package)
+{
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+  BLI_thread_queue_push(g_cpuqueue, package);
+#  else
+  /* Start a worker when a device is idle, otherwise a running worker picks the work up. */
+  CPUDevice *device = NULL;
+  BLI_mutex_lock(&g_cpuMutex);
+  g_cpuwork.push_back(package);
+  if (!g_cpudevices_idle.empty()) {
+    device = g_cpudevices_idle.back();
+    g_cpudevices_idle.pop_back();
+  }
+  BLI_mutex_unlock(&g_cpuMutex);
+
+  if (device) {
+    BLI_task_pool_push(g_cpupool, thread_execute_task, device, false, NULL);
+  }
+#  endif
+}
 #endif
 
 void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
@@ -104,30 +191,37 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
   CPUDevice device(0);
   device.execute(package);
   delete package;
-#elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#else
+  work_package_scheduled();
 #  ifdef COM_OPENCL_ENABLED
   if (group->isOpenCL() && g_openclActive) {
     BLI_thread_queue_push(g_gpuqueue, package);
   }
   else {
-    BLI_thread_queue_push(g_cpuqueue, package);
+    schedule_cpu(package);
   }
 #  else
-  BLI_thread_queue_push(g_cpuqueue, package);
+  schedule_cpu(package);
 #  endif
 #endif
 }
 
 void WorkScheduler::start(CompositorContext &context)
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
   unsigned int index;
+  BLI_condition_init(&g_workCondition);
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   g_cpuqueue = BLI_thread_queue_init();
   BLI_threadpool_init(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
   for (index = 0; index < g_cpudevices.size(); index++) {
     Device *device = g_cpudevices[index];
     BLI_threadpool_insert(&g_cputhreads, device);
   }
+#  else
+  g_cpupool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  g_cpudevices_idle.assign(g_cpudevices.begin(), g_cpudevices.end());
+#  endif
 #  ifdef COM_OPENCL_ENABLED
   if (context.getHasActiveOpenCLDevices()) {
     g_gpuqueue = BLI_thread_queue_init();
@@ -144,29 +238,47 @@ void WorkScheduler::start(CompositorContext &context)
 #  endif
 #endif
 }
+
+void WorkScheduler::wait_for_any()
+{
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
+  BLI_mutex_lock(&g_workMutex);
+  if (g_workPending > 0) {
+    BLI_condition_wait(&g_workCondition, &g_workMutex);
+  }
+  BLI_mutex_unlock(&g_workMutex);
+#endif
+}
+
 void WorkScheduler::finish()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_wait_finish(g_gpuqueue);
-    BLI_thread_queue_wait_finish(g_cpuqueue);
-  }
-  else {
-    BLI_thread_queue_wait_finish(g_cpuqueue);
   }
+#  endif
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+  BLI_thread_queue_wait_finish(g_cpuqueue);
 #  else
-  BLI_thread_queue_wait_finish(cpuqueue);
+  BLI_task_pool_work_and_wait(g_cpupool);
 #  endif
 #endif
 }
 void WorkScheduler::stop()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   BLI_thread_queue_nowait(g_cpuqueue);
   BLI_threadpool_end(&g_cputhreads);
   BLI_thread_queue_free(g_cpuqueue);
   g_cpuqueue = NULL;
+#  else
+  BLI_task_pool_work_and_wait(g_cpupool);
+  BLI_task_pool_free(g_cpupool);
+  g_cpupool = NULL;
+  g_cpudevices_idle.clear();
+#  endif
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_nowait(g_gpuqueue);
@@ -175,12 +287,13 @@ void WorkScheduler::stop()
     g_gpuqueue = NULL;
   }
 #  endif
+  BLI_condition_end(&g_workCondition);
 #endif
 }
 
 bool WorkScheduler::hasGPUDevices()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #  ifdef COM_OPENCL_ENABLED
   return !g_gpudevices.empty();
 #  else
@@ -191,7 +304,7 @@ bool WorkScheduler::hasGPUDevices()
 #endif
 }
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 static void CL_CALLBACK clContextError(const char *errinfo,
                                        const void * /*private_info*/,
                                        size_t /*cb*/,
@@ -203,7 +316,7 @@ static void CL_CALLBACK clContextError(const char *errinfo,
 
 void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
   /* deinitialize if number of threads doesn't match */
   if (g_cpudevices.size() != num_cpu_threads) {
     Device *device;
@@ -325,7 +438,7 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 
 void WorkScheduler::deinitialize()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
   /* deinitialize CPU threads */
   if (g_cpuInitialized) {
     Device *device;
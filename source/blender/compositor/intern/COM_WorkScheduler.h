@@ -42,7 +42,8 @@ class WorkScheduler {
    * inside this loop new work is queried and being executed
    */
   static void *thread_execute_cpu(void *data);
-
+#endif
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
   /**
    * \brief main thread loop for gpudevices
    * inside this loop new work is queried and being executed
@@ -101,6 +102,15 @@ class WorkScheduler {
    */
   static void finish();
 
+  /**
+   * \brief wait until at least one scheduled work package has been completed.
+   * Returns immediately when there is no pending work.
+   *
+   * Used to schedule new chunks as soon as a device becomes available, without waiting for all
+   * scheduled work to drain.
+   */
+  static void wait_for_any();
+
   /**
    * \brief Are there OpenCL capable GPU devices initialized?
    * the result of this method is stored in the CompositorContext
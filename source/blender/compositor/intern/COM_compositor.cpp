@@ -25,6 +25,7 @@
 
 #include "COM_ExecutionSystem.h"
 #include "COM_MovieDistortionOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
 #include "COM_compositor.h"
 #include "clew.h"
@@ -113,8 +114,19 @@ void COM_deinitialize()
   if (is_compositorMutex_init) {
     BLI_mutex_lock(&s_compositorMutex);
     WorkScheduler::deinitialize();
+    ResultCache::clear();
     is_compositorMutex_init = false;
     BLI_mutex_unlock(&s_compositorMutex);
     BLI_mutex_end(&s_compositorMutex);
   }
 }
+
+void COM_clearCaches()
+{
+  ResultCache::clear();
+}
+
+void COM_tagIDChanged(const ID *id)
+{
+  ResultCache::tag_id_changed(id);
+}
@@ -17,6 +17,8 @@
  */
 
 #include "COM_ChromaMatteOperation.h"
+#include "COM_RowKernels.h"
+
 #include "BLI_math.h"
 
 ChromaMatteOperation::ChromaMatteOperation() : NodeOperation()
@@ -27,6 +29,7 @@ ChromaMatteOperation::ChromaMatteOperation() : NodeOperation()
 
   this->m_inputImageProgram = NULL;
   this->m_inputKeyProgram = NULL;
+  this->setFullFrame(true);
 }
 
 void ChromaMatteOperation::initExecution()
@@ -108,3 +111,23 @@ void ChromaMatteOperation::executePixelSampled(float output[4],
     output[0] = inImage[3]; /* make pixel just as transparent as it was before */
   }
 }
+
+void ChromaMatteOperation::update_memory_buffer(MemoryBuffer *output,
+                                                const rcti &area,
+                                                MemoryBuffer **inputs)
+{
+  ChromaMatteRowParams params;
+  params.tan_half_acceptance = tanf(this->m_settings->t1 / 2.0f);
+  params.tan_half_cutoff = tanf(this->m_settings->t2 / 2.0f);
+  params.gain = this->m_settings->fstrength;
+
+  const RowKernels &kernels = RowKernels::get();
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    kernels.chroma_matte(output->get_elem(area.xmin, y),
+                         inputs[0]->get_elem(area.xmin, y),
+                         inputs[1]->get_elem(area.xmin, y),
+                         width,
+                         params);
+  }
+}
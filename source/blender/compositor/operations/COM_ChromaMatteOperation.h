@@ -44,6 +44,8 @@ class ChromaMatteOperation : public NodeOperation {
   void initExecution();
   void deinitExecution();
 
+  void update_memory_buffer(MemoryBuffer *output, const rcti &area, MemoryBuffer **inputs);
+
   void setSettings(NodeChroma *nodeChroma)
   {
     this->m_settings = nodeChroma;
@@ -17,6 +17,8 @@
  */
 
 #include "COM_ColorBalanceLGGOperation.h"
+#include "COM_RowKernels.h"
+
 #include "BLI_math.h"
 
 inline float colorbalance_lgg(float in, float lift_lgg, float gamma_inv, float gain)
@@ -44,6 +46,7 @@ ColorBalanceLGGOperation::ColorBalanceLGGOperation() : NodeOperation()
   this->m_inputValueOperation = NULL;
   this->m_inputColorOperation = NULL;
   this->setResolutionInputSocketIndex(1);
+  this->setFullFrame(true);
 }
 
 void ColorBalanceLGGOperation::initExecution()
@@ -79,6 +82,26 @@ void ColorBalanceLGGOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ColorBalanceLGGOperation::update_memory_buffer(MemoryBuffer *output,
+                                                    const rcti &area,
+                                                    MemoryBuffer **inputs)
+{
+  ColorBalanceLGGRowParams params;
+  copy_v3_v3(params.lift, this->m_lift);
+  copy_v3_v3(params.gamma_inv, this->m_gamma_inv);
+  copy_v3_v3(params.gain, this->m_gain);
+
+  const RowKernels &kernels = RowKernels::get();
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    kernels.color_balance_lgg(output->get_elem(area.xmin, y),
+                              inputs[0]->get_elem(area.xmin, y),
+                              inputs[1]->get_elem(area.xmin, y),
+                              width,
+                              params);
+  }
+}
+
 void ColorBalanceLGGOperation::deinitExecution()
 {
   this->m_inputValueOperation = NULL;
@@ -57,6 +57,8 @@ class ColorBalanceLGGOperation : public NodeOperation {
    */
   void deinitExecution();
 
+  void update_memory_buffer(MemoryBuffer *output, const rcti &area, MemoryBuffer **inputs);
+
   void setGain(const float gain[3])
   {
     copy_v3_v3(this->m_gain, gain);
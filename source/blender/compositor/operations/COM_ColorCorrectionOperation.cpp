@@ -17,6 +17,8 @@
  */
 
 #include "COM_ColorCorrectionOperation.h"
+#include "COM_RowKernels.h"
+
 #include "BLI_math.h"
 
 #include "IMB_colormanagement.h"
@@ -31,6 +33,7 @@ ColorCorrectionOperation::ColorCorrectionOperation() : NodeOperation()
   this->m_redChannelEnabled = true;
   this->m_greenChannelEnabled = true;
   this->m_blueChannelEnabled = true;
+  this->setFullFrame(true);
 }
 void ColorCorrectionOperation::initExecution()
 {
@@ -155,6 +158,43 @@ void ColorCorrectionOperation::executePixelSampled(float output[4],
   output[3] = inputImageColor[3];
 }
 
+static void color_correction_row_settings(ColorCorrectionRowSettings *r_settings,
+                                          const ColorCorrectionData *data)
+{
+  r_settings->contrast = data->contrast;
+  r_settings->saturation = data->saturation;
+  r_settings->gamma = data->gamma;
+  r_settings->gain = data->gain;
+  r_settings->lift = data->lift;
+}
+
+void ColorCorrectionOperation::update_memory_buffer(MemoryBuffer *output,
+                                                    const rcti &area,
+                                                    MemoryBuffer **inputs)
+{
+  ColorCorrectionRowParams params;
+  color_correction_row_settings(&params.master, &this->m_data->master);
+  color_correction_row_settings(&params.shadows, &this->m_data->shadows);
+  color_correction_row_settings(&params.midtones, &this->m_data->midtones);
+  color_correction_row_settings(&params.highlights, &this->m_data->highlights);
+  params.start_midtones = this->m_data->startmidtones;
+  params.end_midtones = this->m_data->endmidtones;
+  IMB_colormanagement_get_luminance_coefficients(params.luma_coefficients);
+  params.use_red = this->m_redChannelEnabled;
+  params.use_green = this->m_greenChannelEnabled;
+  params.use_blue = this->m_blueChannelEnabled;
+
+  const RowKernels &kernels = RowKernels::get();
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    kernels.color_correction(output->get_elem(area.xmin, y),
+                             inputs[0]->get_elem(area.xmin, y),
+                             inputs[1]->get_elem(area.xmin, y),
+                             width,
+                             params);
+  }
+}
+
 void ColorCorrectionOperation::deinitExecution()
 {
   this->m_inputImage = NULL;
@@ -51,6 +51,8 @@ class ColorCorrectionOperation : public NodeOperation {
    */
   void deinitExecution();
 
+  void update_memory_buffer(MemoryBuffer *output, const rcti &area, MemoryBuffer **inputs);
+
   void setData(NodeColorCorrection *data)
   {
     this->m_data = data;
@@ -142,6 +142,10 @@ void CompositorOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
   if (!buffer) {
     return;
   }
+  if (this->getExecutionModel() == COM_EM_FULL_FRAME) {
+    executeRegionFullFrame(rect);
+    return;
+  }
   int x1 = rect->xmin;
   int y1 = rect->ymin;
   int x2 = rect->xmax;
@@ -217,6 +221,33 @@ void CompositorOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
   }
 }
 
+void CompositorOperation::executeRegionFullFrame(rcti *rect)
+{
+  const int width = BLI_rcti_size_x(rect);
+  MemoryBuffer image(COM_DT_COLOR, rect);
+  MemoryBuffer alpha(COM_DT_VALUE, rect);
+  MemoryBuffer depth(COM_DT_VALUE, rect);
+
+  this->getInputOperation(0)->render_memory_buffer(&image, *rect);
+  if (this->m_useAlphaInput) {
+    this->getInputOperation(1)->render_memory_buffer(&alpha, *rect);
+  }
+  this->getInputOperation(2)->render_memory_buffer(&depth, *rect);
+
+  for (int y = rect->ymin; y < rect->ymax; y++) {
+    const int offset = y * this->getWidth() + rect->xmin;
+    float *out = &this->m_outputBuffer[offset * COM_NUM_CHANNELS_COLOR];
+    memcpy(out, image.get_elem(rect->xmin, y), sizeof(float) * COM_NUM_CHANNELS_COLOR * width);
+    if (this->m_useAlphaInput) {
+      const float *alpha_row = alpha.get_elem(rect->xmin, y);
+      for (int x = 0; x < width; x++) {
+        out[x * COM_NUM_CHANNELS_COLOR + 3] = alpha_row[x];
+      }
+    }
+    memcpy(&this->m_depthBuffer[offset], depth.get_elem(rect->xmin, y), sizeof(float) * width);
+  }
+}
+
 void CompositorOperation::determineResolution(unsigned int resolution[2],
                                               unsigned int preferredResolution[2])
 {
@@ -122,4 +122,7 @@ class CompositorOperation : public NodeOperation {
   {
     this->m_active = active;
   }
+
+ private:
+  void executeRegionFullFrame(rcti *rect);
 };
@@ -17,6 +17,7 @@
  */
 
 #include "COM_ConvertOperation.h"
+#include "COM_RowKernels.h"
 
 #include "IMB_colormanagement.h"
 
@@ -41,6 +42,7 @@ ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperat
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
 }
 
 void ConvertValueToColorOperation::executePixelSampled(float output[4],
@@ -54,12 +56,25 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                        const rcti &area,
+                                                        MemoryBuffer **inputs)
+{
+  const RowKernels &kernels = RowKernels::get();
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    kernels.value_to_color(
+        output->get_elem(area.xmin, y), inputs[0]->get_elem(area.xmin, y), width);
+  }
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void ConvertColorToValueOperation::executePixelSampled(float output[4],
@@ -72,12 +87,25 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4],
   output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::update_memory_buffer(MemoryBuffer *output,
+                                                        const rcti &area,
+                                                        MemoryBuffer **inputs)
+{
+  const RowKernels &kernels = RowKernels::get();
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    kernels.color_to_value(
+        output->get_elem(area.xmin, y), inputs[0]->get_elem(area.xmin, y), width);
+  }
+}
+
 /* ******** Color to BW ******** */
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void ConvertColorToBWOperation::executePixelSampled(float output[4],
@@ -90,12 +118,30 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4],
   output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::update_memory_buffer(MemoryBuffer *output,
+                                                     const rcti &area,
+                                                     MemoryBuffer **inputs)
+{
+  float luma_coefficients[3];
+  IMB_colormanagement_get_luminance_coefficients(luma_coefficients);
+
+  const RowKernels &kernels = RowKernels::get();
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    kernels.color_to_bw(output->get_elem(area.xmin, y),
+                        inputs[0]->get_elem(area.xmin, y),
+                        width,
+                        luma_coefficients);
+  }
+}
+
 /* ******** Color to Vector ******** */
 
 ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setFullFrame(true);
 }
 
 void ConvertColorToVectorOperation::executePixelSampled(float output[4],
@@ -108,12 +154,28 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4],
   copy_v3_v3(output, color);
 }
 
+void ConvertColorToVectorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti &area,
+                                                         MemoryBuffer **inputs)
+{
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->get_elem(area.xmin, y);
+    float *out = output->get_elem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++) {
+      copy_v3_v3(out, in);
+      in += COM_NUM_CHANNELS_COLOR;
+      out += COM_NUM_CHANNELS_VECTOR;
+    }
+  }
+}
+
 /* ******** Value to Vector ******** */
 
 ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setFullFrame(true);
 }
 
 void ConvertValueToVectorOperation::executePixelSampled(float output[4],
@@ -126,12 +188,28 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4],
   output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti &area,
+                                                         MemoryBuffer **inputs)
+{
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->get_elem(area.xmin, y);
+    float *out = output->get_elem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++) {
+      out[0] = out[1] = out[2] = in[0];
+      in += COM_NUM_CHANNELS_VALUE;
+      out += COM_NUM_CHANNELS_VECTOR;
+    }
+  }
+}
+
 /* ******** Vector to Color ******** */
 
 ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
 }
 
 void ConvertVectorToColorOperation::executePixelSampled(float output[4],
@@ -143,12 +221,29 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti &area,
+                                                         MemoryBuffer **inputs)
+{
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->get_elem(area.xmin, y);
+    float *out = output->get_elem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++) {
+      copy_v3_v3(out, in);
+      out[3] = 1.0f;
+      in += COM_NUM_CHANNELS_VECTOR;
+      out += COM_NUM_CHANNELS_COLOR;
+    }
+  }
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void ConvertVectorToValueOperation::executePixelSampled(float output[4],
@@ -161,6 +256,21 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4],
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti &area,
+                                                         MemoryBuffer **inputs)
+{
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->get_elem(area.xmin, y);
+    float *out = output->get_elem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++) {
+      out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+      in += COM_NUM_CHANNELS_VECTOR;
+      out += COM_NUM_CHANNELS_VALUE;
+    }
+  }
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
@@ -18,6 +18,7 @@
 
 #include <limits.h>
 
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "COM_FastGaussianBlurOperation.h"
 #include "MEM_guardedalloc.h"
@@ -110,19 +111,127 @@ void *FastGaussianBlurOperation::initializeTileData(rcti *rect)
   return this->m_iirgaus;
 }
 
+struct IIRGaussData {
+  float *buffer;
+  unsigned int src_width;
+  unsigned int src_height;
+  unsigned int num_channels;
+  unsigned int chan;
+  /** Length of the intermediate buffers, enough for a row and a column. */
+  unsigned int sz;
+  double cf[4];
+  double tsM[9];
+};
+
+/** Per thread intermediate buffers, allocated on first use. */
+struct IIRGaussTLS {
+  double *X, *Y, *W;
+};
+
+/**
+ * Recursive filter of a single line of \a L values, from \a X to \a Y.
+ * Explicitly expects lines of at least 3 values.
+ */
+static void iir_gauss_line(const IIRGaussData *data, IIRGaussTLS *tls, const unsigned int L)
+{
+  const double *cf = data->cf;
+  const double *tsM = data->tsM;
+  const double *X = tls->X;
+  double *Y = tls->Y;
+  double *W = tls->W;
+  double tsu[3], tsv[3];
+  unsigned int i;
+
+  W[0] = cf[0] * X[0] + cf[1] * X[0] + cf[2] * X[0] + cf[3] * X[0];
+  W[1] = cf[0] * X[1] + cf[1] * W[0] + cf[2] * X[0] + cf[3] * X[0];
+  W[2] = cf[0] * X[2] + cf[1] * W[1] + cf[2] * W[0] + cf[3] * X[0];
+  for (i = 3; i < L; i++) {
+    W[i] = cf[0] * X[i] + cf[1] * W[i - 1] + cf[2] * W[i - 2] + cf[3] * W[i - 3];
+  }
+  tsu[0] = W[L - 1] - X[L - 1];
+  tsu[1] = W[L - 2] - X[L - 1];
+  tsu[2] = W[L - 3] - X[L - 1];
+  tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + X[L - 1];
+  tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + X[L - 1];
+  tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + X[L - 1];
+  Y[L - 1] = cf[0] * W[L - 1] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2];
+  Y[L - 2] = cf[0] * W[L - 2] + cf[1] * Y[L - 1] + cf[2] * tsv[0] + cf[3] * tsv[1];
+  Y[L - 3] = cf[0] * W[L - 3] + cf[1] * Y[L - 2] + cf[2] * Y[L - 1] + cf[3] * tsv[0];
+  /* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */
+  for (i = L - 4; i != UINT_MAX; i--) {
+    Y[i] = cf[0] * W[i] + cf[1] * Y[i + 1] + cf[2] * Y[i + 2] + cf[3] * Y[i + 3];
+  }
+}
+
+static IIRGaussTLS *iir_gauss_tls_ensure(const IIRGaussData *data,
+                                         const TaskParallelTLS *__restrict tls)
+{
+  IIRGaussTLS *buffers = (IIRGaussTLS *)tls->userdata_chunk;
+  if (buffers->X == NULL) {
+    buffers->X = (double *)MEM_callocN(data->sz * sizeof(double), "IIR_gauss X buf");
+    buffers->Y = (double *)MEM_callocN(data->sz * sizeof(double), "IIR_gauss Y buf");
+    buffers->W = (double *)MEM_callocN(data->sz * sizeof(double), "IIR_gauss W buf");
+  }
+  return buffers;
+}
+
+static void iir_gauss_tls_free(const void *__restrict /*userdata*/, void *__restrict chunk)
+{
+  IIRGaussTLS *buffers = (IIRGaussTLS *)chunk;
+  MEM_SAFE_FREE(buffers->X);
+  MEM_SAFE_FREE(buffers->Y);
+  MEM_SAFE_FREE(buffers->W);
+}
+
+static void iir_gauss_row(void *__restrict userdata,
+                          const int y,
+                          const TaskParallelTLS *__restrict tls)
+{
+  const IIRGaussData *data = (const IIRGaussData *)userdata;
+  IIRGaussTLS *buffers = iir_gauss_tls_ensure(data, tls);
+  const unsigned int num_channels = data->num_channels;
+  float *row = data->buffer + (size_t)y * data->src_width * num_channels + data->chan;
+  unsigned int x;
+
+  for (x = 0; x < data->src_width; x++) {
+    buffers->X[x] = row[x * num_channels];
+  }
+  iir_gauss_line(data, buffers, data->src_width);
+  for (x = 0; x < data->src_width; x++) {
+    row[x * num_channels] = buffers->Y[x];
+  }
+}
+
+static void iir_gauss_column(void *__restrict userdata,
+                             const int x,
+                             const TaskParallelTLS *__restrict tls)
+{
+  const IIRGaussData *data = (const IIRGaussData *)userdata;
+  IIRGaussTLS *buffers = iir_gauss_tls_ensure(data, tls);
+  const size_t add = (size_t)data->src_width * data->num_channels;
+  float *column = data->buffer + (size_t)x * data->num_channels + data->chan;
+  unsigned int y;
+
+  for (y = 0; y < data->src_height; y++) {
+    buffers->X[y] = column[y * add];
+  }
+  iir_gauss_line(data, buffers, data->src_height);
+  for (y = 0; y < data->src_height; y++) {
+    column[y * add] = buffers->Y[y];
+  }
+}
+
 void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
                                           float sigma,
                                           unsigned int chan,
                                           unsigned int xy)
 {
-  double q, q2, sc, cf[4], tsM[9], tsu[3], tsv[3];
-  double *X, *Y, *W;
+  double q, q2, sc;
   const unsigned int src_width = src->getWidth();
   const unsigned int src_height = src->getHeight();
-  unsigned int x, y, sz;
-  unsigned int i;
-  float *buffer = src->getBuffer();
-  const unsigned int num_channels = src->get_num_channels();
+  IIRGaussData data;
+  double *cf = data.cf;
+  double *tsM = data.tsM;
 
   // <0.5 not valid, though can have a possibly useful sort of sharpening effect
   if (sigma < 0.5f) {
@@ -133,7 +242,7 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
     xy = 3;
   }
 
-  // XXX The YVV macro defined below explicitly expects sources of at least 3x3 pixels,
+  // XXX iir_gauss_line explicitly expects sources of at least 3x3 pixels,
   //     so just skipping blur along faulty direction if src's def is below that limit!
   if (src_width < 3) {
     xy &= ~1;
@@ -184,75 +293,28 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
                  cf[3] * cf[3] * cf[3] - cf[3] * cf[2] + cf[3]);
   tsM[8] = sc * (cf[3] * (cf[1] + cf[3] * cf[2]));
 
-#define YVV(L) \
-  { \
-    W[0] = cf[0] * X[0] + cf[1] * X[0] + cf[2] * X[0] + cf[3] * X[0]; \
-    W[1] = cf[0] * X[1] + cf[1] * W[0] + cf[2] * X[0] + cf[3] * X[0]; \
-    W[2] = cf[0] * X[2] + cf[1] * W[1] + cf[2] * W[0] + cf[3] * X[0]; \
-    for (i = 3; i < L; i++) { \
-      W[i] = cf[0] * X[i] + cf[1] * W[i - 1] + cf[2] * W[i - 2] + cf[3] * W[i - 3]; \
-    } \
-    tsu[0] = W[L - 1] - X[L - 1]; \
-    tsu[1] = W[L - 2] - X[L - 1]; \
-    tsu[2] = W[L - 3] - X[L - 1]; \
-    tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + X[L - 1]; \
-    tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + X[L - 1]; \
-    tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + X[L - 1]; \
-    Y[L - 1] = cf[0] * W[L - 1] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2]; \
-    Y[L - 2] = cf[0] * W[L - 2] + cf[1] * Y[L - 1] + cf[2] * tsv[0] + cf[3] * tsv[1]; \
-    Y[L - 3] = cf[0] * W[L - 3] + cf[1] * Y[L - 2] + cf[2] * Y[L - 1] + cf[3] * tsv[0]; \
-    /* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */ \
-    for (i = L - 4; i != UINT_MAX; i--) { \
-      Y[i] = cf[0] * W[i] + cf[1] * Y[i + 1] + cf[2] * Y[i + 2] + cf[3] * Y[i + 3]; \
-    } \
-  } \
-  (void)0
-
+  data.buffer = src->getBuffer();
+  data.src_width = src_width;
+  data.src_height = src_height;
+  data.num_channels = src->get_num_channels();
+  data.chan = chan;
   // intermediate buffers
-  sz = max(src_width, src_height);
-  X = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss X buf");
-  Y = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss Y buf");
-  W = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss W buf");
+  data.sz = max(src_width, src_height);
+
+  /* Rows and columns are filtered independently, each thread uses its own buffers. */
+  IIRGaussTLS tls = {NULL, NULL, NULL};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &tls;
+  settings.userdata_chunk_size = sizeof(tls);
+  settings.func_free = iir_gauss_tls_free;
+
   if (xy & 1) {  // H
-    int offset;
-    for (y = 0; y < src_height; y++) {
-      const int yx = y * src_width;
-      offset = yx * num_channels + chan;
-      for (x = 0; x < src_width; x++) {
-        X[x] = buffer[offset];
-        offset += num_channels;
-      }
-      YVV(src_width);
-      offset = yx * num_channels + chan;
-      for (x = 0; x < src_width; x++) {
-        buffer[offset] = Y[x];
-        offset += num_channels;
-      }
-    }
+    BLI_task_parallel_range(0, src_height, &data, iir_gauss_row, &settings);
   }
   if (xy & 2) {  // V
-    int offset;
-    const int add = src_width * num_channels;
-
-    for (x = 0; x < src_width; x++) {
-      offset = x * num_channels + chan;
-      for (y = 0; y < src_height; y++) {
-        X[y] = buffer[offset];
-        offset += add;
-      }
-      YVV(src_height);
-      offset = x * num_channels + chan;
-      for (y = 0; y < src_height; y++) {
-        buffer[offset] = Y[y];
-        offset += add;
-      }
-    }
+    BLI_task_parallel_range(0, src_width, &data, iir_gauss_column, &settings);
   }
-
-  MEM_freeN(X);
-  MEM_freeN(W);
-  MEM_freeN(Y);
-#undef YVV
 }
 
 ///
@@ -63,6 +63,27 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
   output[3] = inputColor1[3];
 }
 
+void MixBaseOperation::update_memory_buffer(MemoryBuffer *output,
+                                            const rcti &area,
+                                            MemoryBuffer **inputs)
+{
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    update_memory_buffer_row(output->get_elem(area.xmin, y),
+                             inputs[0]->get_elem(area.xmin, y),
+                             inputs[1]->get_elem(area.xmin, y),
+                             inputs[2]->get_elem(area.xmin, y),
+                             width);
+  }
+}
+
+void MixBaseOperation::update_memory_buffer_row(
+    float *out, const float *value, const float *color1, const float *color2, int width)
+{
+  RowKernels::get().mix[COM_ROW_MIX_BLEND](
+      out, value, color1, color2, width, this->get_row_params(false));
+}
+
 void MixBaseOperation::determineResolution(unsigned int resolution[2],
                                            unsigned int preferredResolution[2])
 {
@@ -99,7 +120,7 @@ void MixBaseOperation::deinitExecution()
 
 MixAddOperation::MixAddOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -124,11 +145,18 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+void MixAddOperation::update_memory_buffer_row(
+    float *out, const float *value, const float *color1, const float *color2, int width)
+{
+  RowKernels::get().mix[COM_ROW_MIX_ADD](
+      out, value, color1, color2, width, this->get_row_params(true));
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixBlendOperation::executePixelSampled(float output[4],
@@ -158,6 +186,13 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixBlendOperation::update_memory_buffer_row(
+    float *out, const float *value, const float *color1, const float *color2, int width)
+{
+  RowKernels::get().mix[COM_ROW_MIX_BLEND](
+      out, value, color1, color2, width, this->get_row_params(true));
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
@@ -290,7 +325,7 @@ void MixColorOperation::executePixelSampled(float output[4],
 
 MixDarkenOperation::MixDarkenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDarkenOperation::executePixelSampled(float output[4],
@@ -319,11 +354,18 @@ void MixDarkenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDarkenOperation::update_memory_buffer_row(
+    float *out, const float *value, const float *color1, const float *color2, int width)
+{
+  RowKernels::get().mix[COM_ROW_MIX_DARKEN](
+      out, value, color1, color2, width, this->get_row_params(true));
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDifferenceOperation::executePixelSampled(float output[4],
@@ -352,6 +394,13 @@ void MixDifferenceOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDifferenceOperation::update_memory_buffer_row(
+    float *out, const float *value, const float *color1, const float *color2, int width)
+{
+  RowKernels::get().mix[COM_ROW_MIX_DIFFERENCE](
+      out, value, color1, color2, width, this->get_row_params(true));
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDivideOperation::MixDivideOperation() : MixBaseOperation()
@@ -577,7 +626,7 @@ void MixHueOperation::executePixelSampled(float output[4], float x, float y, Pix
 
 MixLightenOperation::MixLightenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixLightenOperation::executePixelSampled(float output[4],
@@ -624,6 +673,13 @@ void MixLightenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixLightenOperation::update_memory_buffer_row(
+    float *out, const float *value, const float *color1, const float *color2, int width)
+{
+  RowKernels::get().mix[COM_ROW_MIX_LIGHTEN](
+      out, value, color1, color2, width, this->get_row_params(true));
+}
+
 /* ******** Mix Linear Light Operation ******** */
 
 MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
@@ -676,7 +732,7 @@ void MixLinearLightOperation::executePixelSampled(float output[4],
 
 MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixMultiplyOperation::executePixelSampled(float output[4],
@@ -705,6 +761,13 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::update_memory_buffer_row(
+    float *out, const float *value, const float *color1, const float *color2, int width)
+{
+  RowKernels::get().mix[COM_ROW_MIX_MULTIPLY](
+      out, value, color1, color2, width, this->get_row_params(true));
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -801,7 +864,7 @@ void MixSaturationOperation::executePixelSampled(float output[4],
 
 MixScreenOperation::MixScreenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixScreenOperation::executePixelSampled(float output[4],
@@ -831,6 +894,13 @@ void MixScreenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixScreenOperation::update_memory_buffer_row(
+    float *out, const float *value, const float *color1, const float *color2, int width)
+{
+  RowKernels::get().mix[COM_ROW_MIX_SCREEN](
+      out, value, color1, color2, width, this->get_row_params(true));
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
@@ -881,7 +951,7 @@ void MixSoftLightOperation::executePixelSampled(float output[4],
 
 MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixSubtractOperation::executePixelSampled(float output[4],
@@ -909,6 +979,13 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixSubtractOperation::update_memory_buffer_row(
+    float *out, const float *value, const float *color1, const float *color2, int width)
+{
+  RowKernels::get().mix[COM_ROW_MIX_SUBTRACT](
+      out, value, color1, color2, width, this->get_row_params(true));
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "COM_NodeOperation.h"
+#include "COM_RowKernels.h"
 
 /**
  * All this programs converts an input color to an output value.
@@ -43,6 +44,24 @@ class MixBaseOperation : public NodeOperation {
     }
   }
 
+  /**
+   * Parameters of the row kernels, \a use_clamp is false for the base blend mode.
+   */
+  inline MixRowParams get_row_params(bool use_clamp)
+  {
+    MixRowParams params;
+    params.use_value_alpha_multiply = m_valueAlphaMultiply;
+    params.use_clamp = use_clamp && m_useClamp;
+    return params;
+  }
+
+  /**
+   * Mix a row of \a width pixels, called by #update_memory_buffer.
+   * Only used by operations that set #setFullFrame.
+   */
+  virtual void update_memory_buffer_row(
+      float *out, const float *value, const float *color1, const float *color2, int width);
+
  public:
   /**
    * Default constructor
@@ -54,6 +73,8 @@ class MixBaseOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void update_memory_buffer(MemoryBuffer *output, const rcti &area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
@@ -84,12 +105,20 @@ class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out, const float *value, const float *color1, const float *color2, int width);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out, const float *value, const float *color1, const float *color2, int width);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
@@ -108,12 +137,20 @@ class MixDarkenOperation : public MixBaseOperation {
  public:
   MixDarkenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out, const float *value, const float *color1, const float *color2, int width);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
   MixDifferenceOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out, const float *value, const float *color1, const float *color2, int width);
 };
 
 class MixDivideOperation : public MixBaseOperation {
@@ -144,6 +181,10 @@ class MixLightenOperation : public MixBaseOperation {
  public:
   MixLightenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out, const float *value, const float *color1, const float *color2, int width);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
@@ -156,6 +197,10 @@ class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out, const float *value, const float *color1, const float *color2, int width);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -174,6 +219,10 @@ class MixScreenOperation : public MixBaseOperation {
  public:
   MixScreenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out, const float *value, const float *color1, const float *color2, int width);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
@@ -186,6 +235,10 @@ class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out, const float *value, const float *color1, const float *color2, int width);
 };
 
 class MixValueOperation : public MixBaseOperation {
@@ -26,6 +26,7 @@ ReadBufferOperation::ReadBufferOperation(DataType datatype) : NodeOperation()
   this->m_single_value = false;
   this->m_offset = 0;
   this->m_buffer = NULL;
+  this->setFullFrame(true);
 }
 
 void *ReadBufferOperation::initializeTileData(rcti * /*rect*/)
@@ -74,6 +75,41 @@ void ReadBufferOperation::executePixelSampled(float output[4],
   }
 }
 
+void ReadBufferOperation::update_memory_buffer(MemoryBuffer *output,
+                                               const rcti &area,
+                                               MemoryBuffer ** /*inputs*/)
+{
+  const int num_channels = output->get_num_channels();
+  BLI_assert(num_channels == m_buffer->get_num_channels());
+
+  if (m_single_value) {
+    /* write buffer has a single value stored at (0,0) */
+    float value[4];
+    m_buffer->read(value, 0, 0);
+    output->fill(area, value);
+    return;
+  }
+
+  /* Same as nearest sampling: pixels outside of the buffer are zero. */
+  const rcti *buffer_rect = m_buffer->getRect();
+  const int xmin = max(area.xmin, buffer_rect->xmin);
+  const int xmax = min(area.xmax, buffer_rect->xmax);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->get_elem(area.xmin, y);
+    if (y < buffer_rect->ymin || y >= buffer_rect->ymax || xmin >= xmax) {
+      memset(out, 0, sizeof(float) * num_channels * BLI_rcti_size_x(&area));
+      continue;
+    }
+    memset(out, 0, sizeof(float) * num_channels * (xmin - area.xmin));
+    memcpy(out + num_channels * (xmin - area.xmin),
+           m_buffer->get_elem(xmin, y),
+           sizeof(float) * num_channels * (xmax - xmin));
+    memset(out + num_channels * (xmax - area.xmin),
+           0,
+           sizeof(float) * num_channels * (area.xmax - xmax));
+  }
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4],
                                              float x,
                                              float y,
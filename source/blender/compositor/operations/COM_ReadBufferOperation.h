@@ -43,6 +43,7 @@ class ReadBufferOperation : public NodeOperation {
 
   void *initializeTileData(rcti *rect);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output, const rcti &area, MemoryBuffer **inputs);
   void executePixelExtend(float output[4],
                           float x,
                           float y,
@@ -47,10 +47,17 @@ class SetValueOperation : public NodeOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output, const rcti &area, MemoryBuffer **inputs);
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 
   bool isSetOperation() const
   {
     return true;
   }
+
+  void hash_params(ResultHash &hash) const
+  {
+    NodeOperation::hash_params(hash);
+    hash.add_float(this->m_value);
+  }
 };
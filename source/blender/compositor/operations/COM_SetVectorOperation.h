@@ -74,6 +74,7 @@ class SetVectorOperation : public NodeOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output, const rcti &area, MemoryBuffer **inputs);
 
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
   bool isSetOperation() const
@@ -81,6 +82,15 @@ class SetVectorOperation : public NodeOperation {
     return true;
   }
 
+  void hash_params(ResultHash &hash) const
+  {
+    NodeOperation::hash_params(hash);
+    hash.add_float(this->m_x);
+    hash.add_float(this->m_y);
+    hash.add_float(this->m_z);
+    hash.add_float(this->m_w);
+  }
+
   void setVector(const float vector[3])
   {
     setX(vector[0]);
@@ -83,6 +83,11 @@ void ViewerOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
   if (!buffer) {
     return;
   }
+  if (this->getExecutionModel() == COM_EM_FULL_FRAME) {
+    executeRegionFullFrame(rect);
+    updateImage(rect);
+    return;
+  }
   const int x1 = rect->xmin;
   const int y1 = rect->ymin;
   const int x2 = rect->xmax;
@@ -118,6 +123,33 @@ void ViewerOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
   updateImage(rect);
 }
 
+void ViewerOperation::executeRegionFullFrame(rcti *rect)
+{
+  const int width = BLI_rcti_size_x(rect);
+  MemoryBuffer image(COM_DT_COLOR, rect);
+  MemoryBuffer alpha(COM_DT_VALUE, rect);
+  MemoryBuffer depth(COM_DT_VALUE, rect);
+
+  this->getInputOperation(0)->render_memory_buffer(&image, *rect);
+  if (this->m_useAlphaInput) {
+    this->getInputOperation(1)->render_memory_buffer(&alpha, *rect);
+  }
+  this->getInputOperation(2)->render_memory_buffer(&depth, *rect);
+
+  for (int y = rect->ymin; y < rect->ymax; y++) {
+    const int offset = y * this->getWidth() + rect->xmin;
+    float *out = &this->m_outputBuffer[offset * 4];
+    memcpy(out, image.get_elem(rect->xmin, y), sizeof(float) * 4 * width);
+    if (this->m_useAlphaInput) {
+      const float *alpha_row = alpha.get_elem(rect->xmin, y);
+      for (int x = 0; x < width; x++) {
+        out[x * 4 + 3] = alpha_row[x];
+      }
+    }
+    memcpy(&this->m_depthBuffer[offset], depth.get_elem(rect->xmin, y), sizeof(float) * width);
+  }
+}
+
 void ViewerOperation::initImage()
 {
   Image *ima = this->m_image;
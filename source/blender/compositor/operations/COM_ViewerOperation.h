@@ -126,6 +126,7 @@ class ViewerOperation : public NodeOperation {
   }
 
  private:
+  void executeRegionFullFrame(rcti *rect);
   void updateImage(rcti *rect);
   void initImage();
 };
@@ -85,6 +85,10 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
       data = NULL;
     }
   }
+  else if (this->getExecutionModel() == COM_EM_FULL_FRAME) {
+    /* The memory buffer covers the whole frame, the chunk is written in place. */
+    this->m_input->render_memory_buffer(memoryBuffer, *rect);
+  }
   else {
     int x1 = rect->xmin;
     int y1 = rect->ymin;
@@ -0,0 +1,409 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <array>
+#include <cmath>
+#include <memory>
+
+#include "BLI_math.h"
+#include "BLI_rect.h"
+#include "BLI_span.hh"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "DNA_node_types.h"
+
+#include "COM_ChromaMatteOperation.h"
+#include "COM_ColorBalanceLGGOperation.h"
+#include "COM_ColorCorrectionOperation.h"
+#include "COM_ConvertOperation.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_MixOperation.h"
+#include "COM_NodeOperation.h"
+#include "COM_SetColorOperation.h"
+#include "COM_SetValueOperation.h"
+
+namespace blender::compositor::tests {
+
+/**
+ * Input which only supports the tiled execution model, so the full frame model has to pull it
+ * per pixel. Values go out of the [0, 1] range on purpose.
+ */
+class GradientOperation : public NodeOperation {
+ public:
+  GradientOperation()
+  {
+    this->addOutputSocket(COM_DT_COLOR);
+  }
+
+  void executePixelSampled(float output[4], float x, float y, PixelSampler /*sampler*/)
+  {
+    output[0] = x / 100.0f - 0.5f;
+    output[1] = y / 40.0f;
+    output[2] = sinf(x * 0.3f + y * 0.7f) * 1.5f;
+    output[3] = 0.25f + fmodf(x + y, 4.0f) * 0.25f;
+  }
+};
+
+using Pixel = std::array<float, 4>;
+
+/**
+ * Input with one pixel per column, only supporting the tiled execution model. Operations under
+ * test get the same values through #executePixelSampled and #update_memory_buffer.
+ */
+class PixelsOperation : public NodeOperation {
+ private:
+  Vector<Pixel> m_pixels;
+
+ public:
+  PixelsOperation(DataType data_type, Span<Pixel> pixels) : m_pixels(pixels)
+  {
+    this->addOutputSocket(data_type);
+  }
+
+  void executePixelSampled(float output[4], float x, float /*y*/, PixelSampler /*sampler*/)
+  {
+    const Pixel &pixel = m_pixels[(int)x];
+    copy_v4_v4(output, pixel.data());
+  }
+};
+
+/* Colors at the edges of the ranges the row kernels handle differently. */
+static Vector<Pixel> edge_colors()
+{
+  return {
+      {0.0f, 0.0f, 0.0f, 0.0f},
+      {1.0f, 1.0f, 1.0f, 1.0f},
+      {0.5f, 0.5f, 0.5f, 1.0f},
+      {0.2f, 0.9f, 0.1f, 1.0f},
+      {0.1f, 0.1f, 0.95f, 0.5f},
+      {-0.5f, -0.01f, -2.0f, 1.0f},
+      {1.5f, 0.3f, -0.2f, 0.0f},
+      {50.0f, 12.5f, 3.0f, 1.0f},
+      {1e-6f, 2e-6f, 1e-7f, 1.0f},
+      {0.0031308f, 0.04045f, 0.0031f, 2.0f},
+      {0.7f, 0.2f, 0.4f, -1.0f},
+  };
+}
+
+/* Factors below zero, above one and at the edges. */
+static Vector<Pixel> edge_values()
+{
+  Vector<Pixel> values;
+  for (const float value : {0.0f, 1.0f, 0.5f, -0.25f, 1.75f, 1e-6f}) {
+    values.append({value, 0.0f, 0.0f, 0.0f});
+  }
+  return values;
+}
+
+/* Random values in [min, max]. */
+static Vector<Pixel> random_pixels(const int num, uint seed, const float min, const float max)
+{
+  Vector<Pixel> pixels(num);
+  for (Pixel &pixel : pixels) {
+    for (float &value : pixel) {
+      seed = seed * 1664525u + 1013904223u;
+      value = min + (max - min) * (float)(seed >> 8) / (float)(1 << 24);
+    }
+  }
+  return pixels;
+}
+
+static int test_break(void * /*handle*/)
+{
+  return 0;
+}
+
+class ExecutionModelTest : public testing::Test {
+ protected:
+  Vector<std::unique_ptr<NodeOperation>> operations_;
+  bNodeTree ntree_ = {{nullptr}};
+
+  template<typename T> T *add_operation()
+  {
+    operations_.append(std::make_unique<T>());
+    return static_cast<T *>(operations_.last().get());
+  }
+
+  static void add_link(NodeOperation *from, NodeOperation *to, const int input_index)
+  {
+    to->getInputSocket(input_index)->setLink(from->getOutputSocket());
+  }
+
+  /**
+   * Mix of tiled only and full frame operations, with implicit conversions, clamping and an
+   * operation read by more than one other.
+   */
+  NodeOperation *build_tree()
+  {
+    GradientOperation *gradient = add_operation<GradientOperation>();
+    SetColorOperation *color = add_operation<SetColorOperation>();
+    const float color_value[4] = {0.8f, -0.2f, 1.7f, 0.5f};
+    color->setChannels(color_value);
+    SetValueOperation *half = add_operation<SetValueOperation>();
+    half->setValue(0.5f);
+
+    ConvertColorToValueOperation *gradient_value = add_operation<ConvertColorToValueOperation>();
+    add_link(gradient, gradient_value, 0);
+
+    MixMultiplyOperation *multiply = add_operation<MixMultiplyOperation>();
+    add_link(gradient_value, multiply, 0);
+    add_link(gradient, multiply, 1);
+    add_link(color, multiply, 2);
+
+    /* Not implemented for full frame, its inputs are pulled per pixel. */
+    MixColorBurnOperation *burn = add_operation<MixColorBurnOperation>();
+    add_link(half, burn, 0);
+    add_link(gradient, burn, 1);
+    add_link(color, burn, 2);
+
+    MixSubtractOperation *subtract = add_operation<MixSubtractOperation>();
+    subtract->setUseClamp(true);
+    subtract->setUseValueAlphaMultiply(true);
+    add_link(half, subtract, 0);
+    add_link(multiply, subtract, 1);
+    add_link(burn, subtract, 2);
+
+    MixAddOperation *add = add_operation<MixAddOperation>();
+    add_link(gradient_value, add, 0);
+    add_link(subtract, add, 1);
+    add_link(multiply, add, 2);
+
+    init_execution();
+    return add;
+  }
+
+  /**
+   * Link inputs to \a operation which make it process every combination of \a pixels_a and
+   * \a pixels_b, one per column. Returns the number of columns.
+   */
+  int add_inputs_combined(NodeOperation *operation, Span<Pixel> pixels_a, Span<Pixel> pixels_b)
+  {
+    Vector<Pixel> inputs_a, inputs_b;
+    for (const Pixel &a : pixels_a) {
+      for (const Pixel &b : pixels_b) {
+        inputs_a.append(a);
+        inputs_b.append(b);
+      }
+    }
+    NodeOperationInput *socket_a = operation->getInputSocket(0);
+    NodeOperationInput *socket_b = operation->getInputSocket(1);
+    operations_.append(std::make_unique<PixelsOperation>(socket_a->getDataType(), inputs_a));
+    add_link(operations_.last().get(), operation, 0);
+    operations_.append(std::make_unique<PixelsOperation>(socket_b->getDataType(), inputs_b));
+    add_link(operations_.last().get(), operation, 1);
+    return (int)inputs_a.size();
+  }
+
+  void init_execution()
+  {
+    for (std::unique_ptr<NodeOperation> &operation : operations_) {
+      operation->setbNodeTree(&ntree_);
+      operation->initExecution();
+    }
+  }
+
+  void SetUp() override
+  {
+    ntree_.test_break = test_break;
+  }
+
+  void TearDown() override
+  {
+    for (std::unique_ptr<NodeOperation> &operation : operations_) {
+      operation->deinitExecution();
+    }
+    operations_.clear();
+  }
+};
+
+/**
+ * Render \a area of \a operation in both execution models and compare the results, relative to
+ * their magnitude when above one.
+ */
+static void expect_execution_models_equal(NodeOperation *operation,
+                                          const rcti &area,
+                                          const float epsilon = 1e-5f)
+{
+  const DataType data_type = operation->getOutputSocket()->getDataType();
+  rcti rect = area;
+  MemoryBuffer tiled(data_type, &rect);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      operation->readSampled(tiled.get_elem(x, y), x, y, COM_PS_NEAREST);
+    }
+  }
+
+  MemoryBuffer full_frame(data_type, &rect);
+  operation->render_memory_buffer(&full_frame, area);
+
+  const int num_channels = full_frame.get_num_channels();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      const float *expected = tiled.get_elem(x, y);
+      const float *result = full_frame.get_elem(x, y);
+      for (int i = 0; i < num_channels; i++) {
+        EXPECT_NEAR(expected[i], result[i], epsilon * fmaxf(1.0f, fabsf(expected[i])))
+            << "pixel " << x << ", " << y << " channel " << i;
+      }
+    }
+  }
+}
+
+TEST_F(ExecutionModelTest, single_band)
+{
+  NodeOperation *operation = build_tree();
+  rcti area;
+  BLI_rcti_init(&area, 0, 31, 0, 17);
+  expect_execution_models_equal(operation, area);
+}
+
+TEST_F(ExecutionModelTest, multiple_bands)
+{
+  NodeOperation *operation = build_tree();
+  /* Bands of COM_FULL_FRAME_BAND_PIXELS, the last one is smaller. */
+  rcti area;
+  BLI_rcti_init(&area, 0, 203, 0, 61);
+  ASSERT_GT(BLI_rcti_size_x(&area) * BLI_rcti_size_y(&area), 2 * COM_FULL_FRAME_BAND_PIXELS);
+  expect_execution_models_equal(operation, area);
+}
+
+TEST_F(ExecutionModelTest, offset_area)
+{
+  NodeOperation *operation = build_tree();
+  rcti area;
+  BLI_rcti_init(&area, 57, 140, 23, 101);
+  expect_execution_models_equal(operation, area);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Row Kernels
+ *
+ * Per pixel #executePixelSampled of operations against their row kernels, on the same inputs.
+ * \{ */
+
+/* Render the single row of \a width pixels of \a operation in both execution models. */
+static void expect_row_equal(NodeOperation *operation, const int width, const float epsilon)
+{
+  rcti area;
+  BLI_rcti_init(&area, 0, width, 0, 1);
+  expect_execution_models_equal(operation, area, epsilon);
+}
+
+TEST_F(ExecutionModelTest, mix_row_kernels)
+{
+  Vector<Pixel> colors = edge_colors();
+  colors.extend(random_pixels(16, 1, -0.5f, 1.5f));
+
+  for (int flags = 0; flags < 4; flags++) {
+    Vector<MixBaseOperation *> mix_operations = {add_operation<MixAddOperation>(),
+                                                 add_operation<MixBlendOperation>(),
+                                                 add_operation<MixDarkenOperation>(),
+                                                 add_operation<MixDifferenceOperation>(),
+                                                 add_operation<MixLightenOperation>(),
+                                                 add_operation<MixMultiplyOperation>(),
+                                                 add_operation<MixScreenOperation>(),
+                                                 add_operation<MixSubtractOperation>()};
+    int width = 0;
+    for (MixBaseOperation *mix : mix_operations) {
+      mix->setUseValueAlphaMultiply(flags & 1);
+      mix->setUseClamp(flags & 2);
+      ASSERT_TRUE(mix->isFullFrame());
+
+      /* Every factor with every first color, the second colors are shuffled. */
+      width = add_inputs_combined(mix, edge_values(), colors);
+      Vector<Pixel> colors2;
+      for (int i = 0; i < width; i++) {
+        colors2.append(colors[(i * 7 + 3) % colors.size()]);
+      }
+      operations_.append(std::make_unique<PixelsOperation>(COM_DT_COLOR, colors2));
+      add_link(operations_.last().get(), mix, 2);
+    }
+    init_execution();
+    for (MixBaseOperation *mix : mix_operations) {
+      SCOPED_TRACE(flags);
+      expect_row_equal(mix, width, 1e-5f);
+    }
+  }
+}
+
+TEST_F(ExecutionModelTest, color_balance_lgg_row_kernel)
+{
+  Vector<Pixel> colors = edge_colors();
+  colors.extend(random_pixels(16, 2, -0.5f, 2.0f));
+
+  ColorBalanceLGGOperation *operation = add_operation<ColorBalanceLGGOperation>();
+  const float lift[3] = {0.8f, 1.0f, 1.3f};
+  const float gamma_inv[3] = {1.0f / 1.2f, 2.0f, 0.5f};
+  const float gain[3] = {1.1f, 0.9f, 1.0f};
+  operation->setLift(lift);
+  operation->setGammaInv(gamma_inv);
+  operation->setGain(gain);
+  const int width = add_inputs_combined(operation, edge_values(), colors);
+  init_execution();
+  /* The row kernel approximates the power function. */
+  expect_row_equal(operation, width, 1e-4f);
+}
+
+TEST_F(ExecutionModelTest, color_correction_row_kernel)
+{
+  Vector<Pixel> colors = edge_colors();
+  colors.extend(random_pixels(16, 3, -0.5f, 2.0f));
+
+  NodeColorCorrection data = {{0.0f}};
+  data.master = {1.1f, 0.9f, 1.2f, 1.0f, 0.05f};
+  data.shadows = {1.0f, 1.2f, 0.8f, 1.1f, -0.02f};
+  data.midtones = {0.9f, 1.0f, 1.0f, 0.95f, 0.0f};
+  data.highlights = {1.2f, 0.8f, 1.3f, 1.0f, 0.01f};
+  data.startmidtones = 0.2f;
+  data.endmidtones = 0.7f;
+
+  for (int channels = 0; channels < 8; channels++) {
+    ColorCorrectionOperation *operation = add_operation<ColorCorrectionOperation>();
+    operation->setData(&data);
+    operation->setRedChannelEnabled(channels & 1);
+    operation->setGreenChannelEnabled(channels & 2);
+    operation->setBlueChannelEnabled(channels & 4);
+    const int width = add_inputs_combined(operation, colors, edge_values());
+    init_execution();
+    SCOPED_TRACE(channels);
+    expect_row_equal(operation, width, 1e-4f);
+  }
+}
+
+TEST_F(ExecutionModelTest, chroma_matte_row_kernel)
+{
+  /* Keys include gray, for which the angle of the color space is undefined. */
+  Vector<Pixel> images = edge_colors();
+  images.extend(random_pixels(32, 4, -0.25f, 1.25f));
+  Vector<Pixel> keys = edge_colors();
+  keys.extend(random_pixels(8, 5, 0.0f, 1.0f));
+
+  struct {
+    float acceptance, cutoff, gain;
+  } settings[] = {
+      {DEG2RADF(30.0f), DEG2RADF(10.0f), 1.0f},
+      {DEG2RADF(1.0f), DEG2RADF(0.0f), 0.01f},
+      {DEG2RADF(90.0f), DEG2RADF(30.0f), 0.5f},
+      {DEG2RADF(179.0f), DEG2RADF(179.0f), 1.0f},
+  };
+  NodeChroma chroma[ARRAY_SIZE(settings)] = {{0.0f}};
+  for (int i = 0; i < (int)ARRAY_SIZE(settings); i++) {
+    const auto &setting = settings[i];
+    chroma[i].t1 = setting.acceptance;
+    chroma[i].t2 = setting.cutoff;
+    chroma[i].fstrength = setting.gain;
+
+    ChromaMatteOperation *operation = add_operation<ChromaMatteOperation>();
+    operation->setSettings(&chroma[i]);
+    const int width = add_inputs_combined(operation, images, keys);
+    init_execution();
+    SCOPED_TRACE(setting.acceptance);
+    expect_row_equal(operation, width, 1e-4f);
+  }
+}
+
+/** \} */
+
+}  // namespace blender::compositor::tests
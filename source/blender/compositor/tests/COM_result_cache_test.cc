@@ -0,0 +1,184 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_rect.h"
+#include "BLI_string.h"
+
+#include "DNA_ID.h"
+#include "DNA_userdef_types.h"
+
+#include "COM_MemoryBuffer.h"
+#include "COM_ResultCache.h"
+
+namespace blender::compositor::tests {
+
+class ResultCacheTest : public testing::Test {
+ protected:
+  int cachelimit_orig_;
+
+  void SetUp() override
+  {
+    cachelimit_orig_ = U.compositor_cachelimit;
+    ResultCache::clear();
+  }
+
+  void TearDown() override
+  {
+    ResultCache::clear();
+    U.compositor_cachelimit = cachelimit_orig_;
+  }
+};
+
+static ResultHash make_key(const int value)
+{
+  ResultHash key;
+  key.add_int(value);
+  return key;
+}
+
+/* Color buffer of 1 MB, filled with \a value. */
+static MemoryBuffer *create_buffer(const float value)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, 256, 0, 256);
+  MemoryBuffer *buffer = new MemoryBuffer(COM_DT_COLOR, &rect);
+  float *data = buffer->getBuffer();
+  for (int i = 0; i < 256 * 256 * 4; i++) {
+    data[i] = value;
+  }
+  return buffer;
+}
+
+TEST_F(ResultCacheTest, store_lookup)
+{
+  U.compositor_cachelimit = 4;
+  MemoryBuffer *buffer = create_buffer(0.5f);
+  ResultCache::store(make_key(1), buffer);
+  EXPECT_EQ(ResultCache::get_num_entries(), 1);
+  EXPECT_EQ(ResultCache::get_memory_in_use(), 256 * 256 * 4 * sizeof(float));
+
+  MemoryBuffer *result = create_buffer(0.0f);
+  EXPECT_FALSE(ResultCache::lookup(make_key(2), result));
+  EXPECT_TRUE(ResultCache::lookup(make_key(1), result));
+  EXPECT_EQ(result->get_elem(17, 42)[2], 0.5f);
+
+  /* Results of another size are not used. */
+  rcti rect;
+  BLI_rcti_init(&rect, 0, 128, 0, 256);
+  MemoryBuffer *small = new MemoryBuffer(COM_DT_COLOR, &rect);
+  EXPECT_FALSE(ResultCache::lookup(make_key(1), small));
+
+  delete small;
+  delete result;
+  delete buffer;
+}
+
+TEST_F(ResultCacheTest, least_recently_used)
+{
+  U.compositor_cachelimit = 2;
+  MemoryBuffer *buffer = create_buffer(1.0f);
+  ResultCache::store(make_key(1), buffer);
+  ResultCache::store(make_key(2), buffer);
+  EXPECT_TRUE(ResultCache::lookup(make_key(1), buffer));
+  ResultCache::store(make_key(3), buffer);
+
+  EXPECT_EQ(ResultCache::get_num_entries(), 2);
+  EXPECT_TRUE(ResultCache::lookup(make_key(1), buffer));
+  EXPECT_FALSE(ResultCache::lookup(make_key(2), buffer));
+  EXPECT_TRUE(ResultCache::lookup(make_key(3), buffer));
+
+  /* Lowering the limit frees results on the next store. */
+  U.compositor_cachelimit = 1;
+  ResultCache::store(make_key(4), buffer);
+  EXPECT_EQ(ResultCache::get_num_entries(), 1);
+  EXPECT_TRUE(ResultCache::lookup(make_key(4), buffer));
+
+  U.compositor_cachelimit = 0;
+  ResultCache::store(make_key(5), buffer);
+  EXPECT_EQ(ResultCache::get_num_entries(), 0);
+  EXPECT_EQ(ResultCache::get_memory_in_use(), 0);
+
+  delete buffer;
+}
+
+TEST_F(ResultCacheTest, id_changed)
+{
+  ID id = {nullptr};
+  STRNCPY(id.name, "IMimage");
+  id.session_uuid = 1234;
+
+  ResultHash hash_before;
+  hash_before.add_id(&id);
+  ResultHash hash_unchanged;
+  hash_unchanged.add_id(&id);
+  EXPECT_EQ(hash_before.get(), hash_unchanged.get());
+
+  ResultCache::tag_id_changed(&id);
+  ResultHash hash_after;
+  hash_after.add_id(&id);
+  EXPECT_NE(hash_before.get(), hash_after.get());
+
+  /* Copies refer to their original. */
+  ID id_copy = id;
+  id_copy.session_uuid = 0;
+  id_copy.orig_id = &id;
+  ResultHash hash_copy;
+  hash_copy.add_id(&id_copy);
+  EXPECT_EQ(hash_after.get(), hash_copy.get());
+}
+
+TEST_F(ResultCacheTest, id_changed_clear)
+{
+  ID id = {nullptr};
+  STRNCPY(id.name, "IMimage");
+  id.session_uuid = 1234;
+  ID id_other = id;
+  id_other.session_uuid = 1235;
+
+  ResultHash hash_before;
+  hash_before.add_id(&id);
+  ResultCache::tag_id_changed(&id);
+  ResultCache::tag_id_changed(&id_other);
+  ResultHash hash_changed;
+  hash_changed.add_id(&id);
+
+  /* Versions are freed with the results, but not reused: keys made before the change don't
+   * match keys made after it. */
+  ResultCache::clear();
+  ResultHash hash_cleared;
+  hash_cleared.add_id(&id);
+  EXPECT_NE(hash_before.get_data(), hash_cleared.get_data());
+
+  ResultCache::tag_id_changed(&id);
+  ResultHash hash_after;
+  hash_after.add_id(&id);
+  EXPECT_NE(hash_before.get_data(), hash_after.get_data());
+  EXPECT_NE(hash_changed.get_data(), hash_after.get_data());
+}
+
+TEST_F(ResultCacheTest, full_key)
+{
+  U.compositor_cachelimit = 4;
+  ResultHash key;
+  key.add_string("key");
+  key.add_float(1.0f);
+  ResultHash key_copy;
+  key_copy.add_hash(key);
+  EXPECT_EQ(key.get(), key_copy.get());
+  EXPECT_EQ(key.get_data(), key_copy.get_data());
+
+  MemoryBuffer *buffer = create_buffer(0.5f);
+  ResultCache::store(key, buffer);
+  EXPECT_TRUE(ResultCache::lookup(key_copy, buffer));
+
+  /* All values are part of the key. */
+  ResultHash key_longer;
+  key_longer.add_hash(key);
+  key_longer.add_int(0);
+  EXPECT_FALSE(ResultCache::lookup(key_longer, buffer));
+
+  delete buffer;
+}
+
+}  // namespace blender::compositor::tests
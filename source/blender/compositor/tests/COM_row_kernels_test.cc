@@ -0,0 +1,159 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "BLI_array.hh"
+
+#include "COM_RowKernels.h"
+
+namespace blender::compositor::tests {
+
+/* Odd width, so the padded tail of every instruction set is tested too. */
+static const int width = 67;
+
+static void fill_random(Array<float> &buffer, uint seed, float min, float max)
+{
+  for (float &value : buffer) {
+    seed = seed * 1664525u + 1013904223u;
+    value = min + (max - min) * (float)(seed >> 8) / (float)(1 << 24);
+  }
+}
+
+struct RowKernelsInputs {
+  Array<float> value = Array<float>(width);
+  Array<float> color1 = Array<float>(width * 4);
+  Array<float> color2 = Array<float>(width * 4);
+
+  RowKernelsInputs()
+  {
+    fill_random(value, 1, -0.25f, 1.25f);
+    fill_random(color1, 2, -0.5f, 1.5f);
+    fill_random(color2, 3, -0.5f, 1.5f);
+  }
+};
+
+static void expect_near_relative(const Array<float> &expected,
+                                 const Array<float> &result,
+                                 const float epsilon)
+{
+  for (int i = 0; i < expected.size(); i++) {
+    EXPECT_NEAR(expected[i], result[i], epsilon * fmaxf(1.0f, fabsf(expected[i])))
+        << "index " << i;
+  }
+}
+
+/* Call \a test for every instruction set other than scalar, with the reference kernels. */
+template<typename Func> static void for_each_simd_isa(const Func &test)
+{
+  const RowKernels *scalar = RowKernels::get(COM_ROW_KERNEL_SCALAR);
+  ASSERT_NE(scalar, nullptr);
+  for (int isa = COM_ROW_KERNEL_SCALAR + 1; isa < COM_ROW_KERNEL_ISA_NUM; isa++) {
+    const RowKernels *kernels = RowKernels::get((RowKernelISA)isa);
+    if (kernels == nullptr) {
+      continue;
+    }
+    SCOPED_TRACE(kernels->name);
+    test(*scalar, *kernels);
+  }
+}
+
+TEST(row_kernels, BestIsAvailable)
+{
+  const RowKernels &best = RowKernels::get();
+  EXPECT_EQ(RowKernels::get(best.isa), &best);
+  for (int isa = best.isa + 1; isa < COM_ROW_KERNEL_ISA_NUM; isa++) {
+    EXPECT_EQ(RowKernels::get((RowKernelISA)isa), nullptr);
+  }
+}
+
+TEST(row_kernels, Mix)
+{
+  RowKernelsInputs in;
+  for_each_simd_isa([&](const RowKernels &scalar, const RowKernels &kernels) {
+    for (int type = 0; type < COM_ROW_MIX_NUM; type++) {
+      for (int flags = 0; flags < 4; flags++) {
+        MixRowParams params;
+        params.use_value_alpha_multiply = flags & 1;
+        params.use_clamp = flags & 2;
+        Array<float> expected(width * 4), result(width * 4);
+        scalar.mix[type](
+            expected.data(), in.value.data(), in.color1.data(), in.color2.data(), width, params);
+        kernels.mix[type](
+            result.data(), in.value.data(), in.color1.data(), in.color2.data(), width, params);
+        EXPECT_EQ_ARRAY(expected.data(), result.data(), width * 4);
+      }
+    }
+  });
+}
+
+TEST(row_kernels, ColorBalanceLGG)
+{
+  RowKernelsInputs in;
+  ColorBalanceLGGRowParams params = {{0.8f, 1.0f, 1.3f}, {1.2f, 0.5f, 2.0f}, {1.1f, 0.9f, 1.0f}};
+  for_each_simd_isa([&](const RowKernels &scalar, const RowKernels &kernels) {
+    Array<float> expected(width * 4), result(width * 4);
+    scalar.color_balance_lgg(expected.data(), in.value.data(), in.color1.data(), width, params);
+    kernels.color_balance_lgg(result.data(), in.value.data(), in.color1.data(), width, params);
+    expect_near_relative(expected, result, 1e-5f);
+  });
+}
+
+TEST(row_kernels, ColorCorrection)
+{
+  RowKernelsInputs in;
+  ColorCorrectionRowParams params;
+  params.master = {1.1f, 0.9f, 1.2f, 1.0f, 0.05f};
+  params.shadows = {1.0f, 1.2f, 0.8f, 1.1f, -0.02f};
+  params.midtones = {0.9f, 1.0f, 1.0f, 0.95f, 0.0f};
+  params.highlights = {1.2f, 0.8f, 1.3f, 1.0f, 0.01f};
+  params.start_midtones = 0.2f;
+  params.end_midtones = 0.7f;
+  params.luma_coefficients[0] = 0.2126f;
+  params.luma_coefficients[1] = 0.7152f;
+  params.luma_coefficients[2] = 0.0722f;
+  params.use_red = true;
+  params.use_green = false;
+  params.use_blue = true;
+  for_each_simd_isa([&](const RowKernels &scalar, const RowKernels &kernels) {
+    Array<float> expected(width * 4), result(width * 4);
+    scalar.color_correction(expected.data(), in.color1.data(), in.value.data(), width, params);
+    kernels.color_correction(result.data(), in.color1.data(), in.value.data(), width, params);
+    expect_near_relative(expected, result, 1e-5f);
+  });
+}
+
+TEST(row_kernels, ChromaMatte)
+{
+  RowKernelsInputs in;
+  ChromaMatteRowParams params = {tanf(0.4f), tanf(0.1f), 0.5f};
+  for_each_simd_isa([&](const RowKernels &scalar, const RowKernels &kernels) {
+    Array<float> expected(width), result(width);
+    scalar.chroma_matte(expected.data(), in.color1.data(), in.color2.data(), width, params);
+    kernels.chroma_matte(result.data(), in.color1.data(), in.color2.data(), width, params);
+    EXPECT_EQ_ARRAY(expected.data(), result.data(), width);
+  });
+}
+
+TEST(row_kernels, Convert)
+{
+  RowKernelsInputs in;
+  const float luma[3] = {0.2126f, 0.7152f, 0.0722f};
+  for_each_simd_isa([&](const RowKernels &scalar, const RowKernels &kernels) {
+    Array<float> expected(width * 4), result(width * 4);
+    scalar.color_to_bw(expected.data(), in.color1.data(), width, luma);
+    kernels.color_to_bw(result.data(), in.color1.data(), width, luma);
+    EXPECT_EQ_ARRAY(expected.data(), result.data(), width);
+
+    scalar.color_to_value(expected.data(), in.color1.data(), width);
+    kernels.color_to_value(result.data(), in.color1.data(), width);
+    EXPECT_EQ_ARRAY(expected.data(), result.data(), width);
+
+    scalar.value_to_color(expected.data(), in.value.data(), width);
+    kernels.value_to_color(result.data(), in.value.data(), width);
+    EXPECT_EQ_ARRAY(expected.data(), result.data(), width * 4);
+  });
+}
+
+}  // namespace blender::compositor::tests
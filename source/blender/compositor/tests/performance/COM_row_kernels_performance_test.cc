@@ -0,0 +1,156 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <cstdio>
+
+#include "MEM_guardedalloc.h"
+
+#include "PIL_time.h"
+
+#include "COM_RowKernels.h"
+
+/* A full HD frame, processed row by row like the full frame execution model does. */
+#define FRAME_WIDTH 1920
+#define FRAME_HEIGHT 1080
+#define NUM_RUN_AVERAGED 10
+
+struct FrameBuffers {
+  float *value;
+  float *color1;
+  float *color2;
+  float *out;
+
+  FrameBuffers()
+  {
+    const size_t num_pixels = (size_t)FRAME_WIDTH * FRAME_HEIGHT;
+    value = (float *)MEM_mallocN(sizeof(float) * num_pixels, __func__);
+    color1 = (float *)MEM_mallocN(sizeof(float) * num_pixels * 4, __func__);
+    color2 = (float *)MEM_mallocN(sizeof(float) * num_pixels * 4, __func__);
+    out = (float *)MEM_mallocN(sizeof(float) * num_pixels * 4, __func__);
+
+    uint seed = 1;
+    for (size_t i = 0; i < num_pixels * 4; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      color1[i] = (float)(seed >> 8) / (float)(1 << 24);
+      color2[i] = 1.0f - color1[i] * 0.5f;
+      if (i < num_pixels) {
+        value[i] = color1[i];
+      }
+    }
+  }
+
+  ~FrameBuffers()
+  {
+    MEM_freeN(value);
+    MEM_freeN(color1);
+    MEM_freeN(color2);
+    MEM_freeN(out);
+  }
+};
+
+template<typename Func> static void bench_kernel(const char *id, const Func &row_func)
+{
+  const RowKernels *scalar = RowKernels::get(COM_ROW_KERNEL_SCALAR);
+  double scalar_time = 0.0;
+
+  printf("\t%s:\n", id);
+  for (int isa = 0; isa < COM_ROW_KERNEL_ISA_NUM; isa++) {
+    const RowKernels *kernels = RowKernels::get((RowKernelISA)isa);
+    if (kernels == NULL) {
+      continue;
+    }
+
+    double averaged_timing = 0.0;
+    for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+      const double init_time = PIL_check_seconds_timer();
+      for (int y = 0; y < FRAME_HEIGHT; y++) {
+        row_func(*kernels, y);
+      }
+      averaged_timing += PIL_check_seconds_timer() - init_time;
+    }
+    averaged_timing /= NUM_RUN_AVERAGED;
+    if (kernels == scalar) {
+      scalar_time = averaged_timing;
+    }
+
+    printf("\t\t%s: %.3fms on average over %d runs (%.2fx)\n",
+           kernels->name,
+           averaged_timing * 1000.0,
+           NUM_RUN_AVERAGED,
+           scalar_time / averaged_timing);
+  }
+}
+
+TEST(row_kernels, PerformanceFullHD)
+{
+  const char *id = "Row kernels on a full HD frame";
+  FrameBuffers buffers;
+  const size_t row = FRAME_WIDTH;
+
+  printf("\n========== STARTING %s ==========\n", id);
+
+  const MixRowParams mix_params = {false, true};
+  bench_kernel("Mix Blend", [&](const RowKernels &kernels, int y) {
+    kernels.mix[COM_ROW_MIX_BLEND](buffers.out + y * row * 4,
+                                   buffers.value + y * row,
+                                   buffers.color1 + y * row * 4,
+                                   buffers.color2 + y * row * 4,
+                                   FRAME_WIDTH,
+                                   mix_params);
+  });
+  bench_kernel("Mix Screen", [&](const RowKernels &kernels, int y) {
+    kernels.mix[COM_ROW_MIX_SCREEN](buffers.out + y * row * 4,
+                                    buffers.value + y * row,
+                                    buffers.color1 + y * row * 4,
+                                    buffers.color2 + y * row * 4,
+                                    FRAME_WIDTH,
+                                    mix_params);
+  });
+
+  const ColorBalanceLGGRowParams lgg_params = {
+      {0.8f, 1.0f, 1.3f}, {1.2f, 0.5f, 2.0f}, {1.1f, 0.9f, 1.0f}};
+  bench_kernel("Color Balance LGG", [&](const RowKernels &kernels, int y) {
+    kernels.color_balance_lgg(buffers.out + y * row * 4,
+                              buffers.value + y * row,
+                              buffers.color1 + y * row * 4,
+                              FRAME_WIDTH,
+                              lgg_params);
+  });
+
+  ColorCorrectionRowParams cc_params;
+  cc_params.master = {1.1f, 0.9f, 1.2f, 1.0f, 0.05f};
+  cc_params.shadows = {1.0f, 1.2f, 0.8f, 1.1f, -0.02f};
+  cc_params.midtones = {0.9f, 1.0f, 1.0f, 0.95f, 0.0f};
+  cc_params.highlights = {1.2f, 0.8f, 1.3f, 1.0f, 0.01f};
+  cc_params.start_midtones = 0.2f;
+  cc_params.end_midtones = 0.7f;
+  cc_params.luma_coefficients[0] = 0.2126f;
+  cc_params.luma_coefficients[1] = 0.7152f;
+  cc_params.luma_coefficients[2] = 0.0722f;
+  cc_params.use_red = cc_params.use_green = cc_params.use_blue = true;
+  bench_kernel("Color Correction", [&](const RowKernels &kernels, int y) {
+    kernels.color_correction(buffers.out + y * row * 4,
+                             buffers.color1 + y * row * 4,
+                             buffers.value + y * row,
+                             FRAME_WIDTH,
+                             cc_params);
+  });
+
+  const ChromaMatteRowParams chroma_params = {tanf(0.4f), tanf(0.1f), 0.5f};
+  bench_kernel("Chroma Matte", [&](const RowKernels &kernels, int y) {
+    kernels.chroma_matte(buffers.out + y * row,
+                         buffers.color1 + y * row * 4,
+                         buffers.color2 + y * row * 4,
+                         FRAME_WIDTH,
+                         chroma_params);
+  });
+
+  const float luma[3] = {0.2126f, 0.7152f, 0.0722f};
+  bench_kernel("Color to BW", [&](const RowKernels &kernels, int y) {
+    kernels.color_to_bw(buffers.out + y * row, buffers.color1 + y * row * 4, FRAME_WIDTH, luma);
+  });
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
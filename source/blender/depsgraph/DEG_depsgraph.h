@@ -161,6 +161,26 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float ctime);
 /* Data changed recalculation entry point. */
 void DEG_evaluate_on_refresh(Depsgraph *graph);
 
+/* Called for every frame evaluated by DEG_evaluate_frames(), in the order of the frames. The graph
+ * is evaluated at the frame and is not modified until the callback returns.
+ * Return false to stop evaluating further frames. */
+typedef bool (*DEG_EvaluateFramesCb)(Depsgraph *graph, int frame_index, void *user_data);
+
+/* Evaluate the given frames, using every graph to evaluate one frame at a time so that up to
+ * num_graphs frames are evaluated concurrently, while the callback is called for the frames
+ * which are ready.
+ *
+ * The graphs are to be built for the same scene and evaluated once, so that copy-on-write of the
+ * scene doesn't overwrite the frames. They are not to be active, so that original data-blocks
+ * are never written to. Unlike BKE_scene_graph_update_for_newframe() the frame of
+ * the original scene is not changed, and no frame change handlers are run. */
+void DEG_evaluate_frames(Depsgraph **graphs,
+                         int num_graphs,
+                         const float *frames,
+                         int num_frames,
+                         DEG_EvaluateFramesCb callback,
+                         void *user_data);
+
 /* Editors Integration  -------------------------- */
 
 /* Mechanism to allow editors to be informed of depsgraph updates,
@@ -78,6 +78,12 @@ void DEG_graph_relations_update(struct Depsgraph *graph);
 /* Tag all relations in the database for update.*/
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of the given ID for update. Dependency graphs which can not update relations of
+ * this ID alone will do a full rebuild. Use when only the ID's own dependencies changed, like
+ * adding a constraint, modifier or driver to an object. */
+void DEG_graph_id_relations_tag_update(struct Depsgraph *graph, struct ID *id);
+void DEG_id_relations_tag_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /* Handle for components to define their dependencies from callbacks.
@@ -32,11 +32,13 @@
 #include "DNA_object_types.h"
 
 #include "BLI_stack.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_action.h"
 
 #include "intern/builder/deg_builder_cache.h"
+#include "intern/builder/deg_builder_fuse.h"
 #include "intern/builder/deg_builder_remove_noop.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
@@ -202,6 +204,14 @@ void deg_graph_build_flush_visibility(Depsgraph *graph)
   BLI_stack_free(stack);
 }
 
+void id_node_finalize_build_func(void *__restrict data_v,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict /*tls*/)
+{
+  Depsgraph *graph = static_cast<Depsgraph *>(data_v);
+  graph->id_nodes[i]->finalize_build(graph);
+}
+
 }  // namespace
 
 void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
@@ -209,12 +219,18 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
   /* Make sure dependencies of visible ID datablocks are visible. */
   deg_graph_build_flush_visibility(graph);
   deg_graph_remove_unused_noops(graph);
+  deg_graph_fuse_operations(graph);
+
+  /* Components of different IDs are independent, finalize them in parallel. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, graph->id_nodes.size(), graph, id_node_finalize_build_func, &settings);
 
   /* Re-tag IDs for update if it was tagged before the relations
    * update tag. */
   for (IDNode *id_node : graph->id_nodes) {
     ID *id_orig = id_node->id_orig;
-    id_node->finalize_build(graph);
     int flag = 0;
     /* Tag rebuild if special evaluation flags changed. */
     if (id_node->eval_flags != id_node->previous_eval_flags) {
@@ -23,13 +23,18 @@
 
 #include "intern/builder/deg_builder_cache.h"
 
+#include <utility>
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_anim_types.h"
 
+#include "BLI_array.hh"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_animsys.h"
+#include "BKE_main.h"
 
 namespace blender {
 namespace deg {
@@ -81,10 +86,15 @@ uint64_t AnimatedPropertyID::hash() const
 
 namespace {
 
+/* Animated property together with the ID it belongs to. */
+struct AnimatedPropertyOfID {
+  ID *owner_id;
+  AnimatedPropertyID property_id;
+};
+
 struct AnimatedPropertyCallbackData {
   PointerRNA pointer_rna;
-  AnimatedPropertyStorage *animated_property_storage;
-  DepsgraphBuilderCache *builder_cache;
+  Vector<AnimatedPropertyOfID> *animated_properties;
 };
 
 void animated_property_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
@@ -100,15 +110,48 @@ void animated_property_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
           &data->pointer_rna, fcurve->rna_path, &pointer_rna, &property_rna)) {
     return;
   }
-  /* Get storage for the ID.
-   * This is needed to deal with cases when nested datablock is animated by its parent. */
-  AnimatedPropertyStorage *animated_property_storage = data->animated_property_storage;
-  if (pointer_rna.owner_id != data->pointer_rna.owner_id) {
-    animated_property_storage = data->builder_cache->ensureAnimatedPropertyStorage(
-        pointer_rna.owner_id);
+  data->animated_properties->append(
+      {pointer_rna.owner_id, AnimatedPropertyID(&pointer_rna, property_rna)});
+}
+
+/* Resolve properties animated by F-Curves of the given ID.
+ * Only reads the ID, so can be used from multiple threads when no IDs are to be lazy loaded. */
+void collect_animated_properties(ID *id, Vector<AnimatedPropertyOfID> &r_animated_properties)
+{
+  AnimatedPropertyCallbackData data;
+  RNA_id_pointer_create(id, &data.pointer_rna);
+  data.animated_properties = &r_animated_properties;
+  BKE_fcurves_id_cb(id, animated_property_cb, &data);
+}
+
+void tag_animated_properties(DepsgraphBuilderCache *builder_cache,
+                             ID *id,
+                             AnimatedPropertyStorage *animated_property_storage,
+                             Span<AnimatedPropertyOfID> animated_properties)
+{
+  for (const AnimatedPropertyOfID &animated_property : animated_properties) {
+    /* Get storage for the ID.
+     * This is needed to deal with cases when nested datablock is animated by its parent. */
+    AnimatedPropertyStorage *owner_storage = animated_property_storage;
+    if (animated_property.owner_id != id) {
+      owner_storage = builder_cache->ensureAnimatedPropertyStorage(animated_property.owner_id);
+    }
+    /* Set the property as animated. */
+    owner_storage->tagPropertyAsAnimated(animated_property.property_id);
   }
-  /* Set the property as animated. */
-  animated_property_storage->tagPropertyAsAnimated(&pointer_rna, property_rna);
+}
+
+struct AnimatedPropertiesCollectData {
+  Span<ID *> ids;
+  MutableSpan<Vector<AnimatedPropertyOfID>> animated_properties;
+};
+
+void animated_properties_collect_func(void *__restrict data_v,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict /*tls*/)
+{
+  AnimatedPropertiesCollectData *data = static_cast<AnimatedPropertiesCollectData *>(data_v);
+  collect_animated_properties(data->ids[i], data->animated_properties[i]);
 }
 
 }  // namespace
@@ -119,11 +162,9 @@ AnimatedPropertyStorage::AnimatedPropertyStorage() : is_fully_initialized(false)
 
 void AnimatedPropertyStorage::initializeFromID(DepsgraphBuilderCache *builder_cache, ID *id)
 {
-  AnimatedPropertyCallbackData data;
-  RNA_id_pointer_create(id, &data.pointer_rna);
-  data.animated_property_storage = this;
-  data.builder_cache = builder_cache;
-  BKE_fcurves_id_cb(id, animated_property_cb, &data);
+  Vector<AnimatedPropertyOfID> animated_properties;
+  collect_animated_properties(id, animated_properties);
+  tag_animated_properties(builder_cache, id, this, animated_properties);
 }
 
 void AnimatedPropertyStorage::tagPropertyAsAnimated(const AnimatedPropertyID &property_id)
@@ -178,5 +219,53 @@ AnimatedPropertyStorage *DepsgraphBuilderCache::ensureInitializedAnimatedPropert
   return animated_property_storage;
 }
 
+void DepsgraphBuilderCache::ensureInitializedAnimatedPropertyStorages(Main *bmain,
+                                                                      Span<ID *> ids)
+{
+  Vector<ID *> ids_to_initialize;
+  for (ID *id : ids) {
+    const AnimatedPropertyStorage *animated_property_storage =
+        animated_property_storage_map_.lookup_default(id, nullptr);
+    if (animated_property_storage == nullptr ||
+        !animated_property_storage->is_fully_initialized) {
+      ids_to_initialize.append(id);
+    }
+  }
+
+  /* Resolving RNA paths is the expensive part, do it in parallel and only store results in the
+   * cache afterwards, in the same order as initializing storages one by one would do. */
+  Array<Vector<AnimatedPropertyOfID>> animated_properties(ids_to_initialize.size());
+  AnimatedPropertiesCollectData data;
+  data.ids = ids_to_initialize;
+  data.animated_properties = animated_properties;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 16;
+  /* Resolving a path reads lazy loaded IDs it passes through, which replaces their contents while
+   * other threads might be reading them. Resolve serially until everything is loaded. */
+  settings.use_threading = (bmain->lazy_load == nullptr);
+  BLI_task_parallel_range(
+      0, ids_to_initialize.size(), &data, animated_properties_collect_func, &settings);
+
+  for (const int64_t i : ids_to_initialize.index_range()) {
+    ID *id = ids_to_initialize[i];
+    AnimatedPropertyStorage *animated_property_storage = ensureAnimatedPropertyStorage(id);
+    tag_animated_properties(this, id, animated_property_storage, animated_properties[i]);
+    animated_property_storage->is_fully_initialized = true;
+  }
+}
+
+void DepsgraphBuilderCache::invalidateAnimatedPropertyStorage(ID *id)
+{
+  AnimatedPropertyStorage *animated_property_storage = animated_property_storage_map_.pop_default(
+      id, nullptr);
+  delete animated_property_storage;
+}
+
+void DepsgraphBuilderCache::swap(DepsgraphBuilderCache &other)
+{
+  std::swap(animated_property_storage_map_, other.animated_property_storage_map_);
+}
+
 }  // namespace deg
 }  // namespace blender
@@ -25,11 +25,14 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_span.hh"
+
 #include "intern/depsgraph_type.h"
 
 #include "RNA_access.h"
 
 struct ID;
+struct Main;
 struct PointerRNA;
 struct PropertyRNA;
 
@@ -87,6 +90,16 @@ class DepsgraphBuilderCache {
   /* Makes sure storage for animated properties exists and initialized for the given ID. */
   AnimatedPropertyStorage *ensureAnimatedPropertyStorage(ID *id);
   AnimatedPropertyStorage *ensureInitializedAnimatedPropertyStorage(ID *id);
+  /* Same as above, for all the given IDs. F-Curves of different IDs are resolved in parallel,
+   * unless some IDs of the main database are still to be lazy loaded. */
+  void ensureInitializedAnimatedPropertyStorages(Main *bmain, Span<ID *> ids);
+
+  /* Forget animated properties of the given ID, so they are collected again on the next query.
+   * Used when the cache outlives a build of the graph. */
+  void invalidateAnimatedPropertyStorage(ID *id);
+
+  /* Exchange cached data with the other cache. */
+  void swap(DepsgraphBuilderCache &other);
 
   /* Shortcuts to go through ensureInitializedAnimatedPropertyStorage and its
    * isPropertyAnimated.
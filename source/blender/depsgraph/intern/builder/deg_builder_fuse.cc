@@ -0,0 +1,154 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Rigs create a lot of operations which only take microseconds to evaluate. Scheduling each of
+ * them as a separate task costs more than evaluating them, so operations which only depend on a
+ * single other operation are evaluated in the task of that operation:
+ *
+ * - One such child is always fused. It can only start once its parent is done anyway, so this
+ *   only saves the scheduling, no parallelism is lost.
+ * - More such children are fused as long as their estimated cost is small, the gain of
+ *   evaluating those in parallel is smaller than the scheduling overhead.
+ *
+ * Fused children are evaluated in the task of their parent only when they are tagged for update,
+ * otherwise they are skipped as usual.
+ */
+
+#include "intern/builder/deg_builder_fuse.h"
+
+#include <algorithm>
+
+#include "BLI_map.hh"
+#include "BLI_vector.hh"
+
+#include "intern/node/deg_node.h"
+#include "intern/node/deg_node_operation.h"
+
+#include "intern/debug/deg_debug.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/depsgraph_type.h"
+
+namespace blender {
+namespace deg {
+
+/* Total cost of the children fused in addition to the first one, in seconds. */
+static const double FUSED_SIBLINGS_MAX_COST = 2e-5;
+
+static bool is_fusable_relation(const Relation *rel)
+{
+  if (rel->flag & RELATION_FLAG_CYCLIC) {
+    return false;
+  }
+  /* The child can be evaluated as soon as its parent is done. */
+  return rel->to->type == NodeType::OPERATION && rel->to->inlinks.size() == 1;
+}
+
+static bool is_topology_relation(const Relation *rel)
+{
+  return rel->from->type == NodeType::OPERATION && (rel->flag & RELATION_FLAG_CYCLIC) == 0;
+}
+
+void deg_graph_fuse_operations(Depsgraph *graph)
+{
+  /* Operations in topological order, ignoring cyclic relations. */
+  Vector<OperationNode *> order;
+  order.reserve(graph->operations.size());
+  for (OperationNode *node : graph->operations) {
+    node->fused_child = nullptr;
+    node->fused_sibling = nullptr;
+    node->custom_flags = 0;
+    for (Relation *rel : node->inlinks) {
+      if (is_topology_relation(rel)) {
+        node->custom_flags++;
+      }
+    }
+    if (node->custom_flags == 0) {
+      order.append(node);
+    }
+  }
+  for (int64_t i = 0; i < order.size(); i++) {
+    for (Relation *rel : order[i]->outlinks) {
+      OperationNode *child = (OperationNode *)rel->to;
+      if (is_topology_relation(rel) && --child->custom_flags == 0) {
+        order.append(child);
+      }
+    }
+  }
+
+  /* Estimated cost of operations together with everything fused to them. */
+  Map<const OperationNode *, double> fused_costs;
+  Vector<pair<double, OperationNode *>> candidates;
+  int num_fused = 0;
+
+  /* Children first, so their fused costs are known when visiting their parents. */
+  for (int64_t i = order.size() - 1; i >= 0; i--) {
+    OperationNode *node = order[i];
+    double cost = node->cost_estimate();
+
+    candidates.clear();
+    for (Relation *rel : node->outlinks) {
+      if (is_fusable_relation(rel)) {
+        OperationNode *child = (OperationNode *)rel->to;
+        candidates.append(make_pair(fused_costs.lookup_default(child, 0.0), child));
+      }
+    }
+    /* The most expensive child continues the chain, the cheapest ones are grouped with it. */
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [](const pair<double, OperationNode *> &a, const pair<double, OperationNode *> &b) {
+                return a.first > b.first;
+              });
+
+    double siblings_cost = 0.0;
+    OperationNode *last_fused = nullptr;
+    for (int64_t j = 0; j < candidates.size(); j++) {
+      const double child_cost = candidates[j].first;
+      OperationNode *child = candidates[j].second;
+      if (j > 0) {
+        if (siblings_cost + child_cost > FUSED_SIBLINGS_MAX_COST) {
+          continue;
+        }
+        siblings_cost += child_cost;
+      }
+      if (last_fused == nullptr) {
+        node->fused_child = child;
+      }
+      else {
+        last_fused->fused_sibling = child;
+      }
+      last_fused = child;
+      cost += child_cost;
+      num_fused++;
+    }
+
+    fused_costs.add_new(node, cost);
+  }
+
+  DEG_DEBUG_PRINTF((::Depsgraph *)graph,
+                   BUILD,
+                   "Fused %d operations into the tasks of their parents\n",
+                   num_fused);
+}
+
+}  // namespace deg
+}  // namespace blender
@@ -46,6 +46,11 @@ void BuilderMap::tagBuild(ID *id, int tag)
   id_tags_.lookup_or_add(id, 0) |= tag;
 }
 
+void BuilderMap::untagBuild(ID *id)
+{
+  id_tags_.remove(id);
+}
+
 bool BuilderMap::checkIsBuiltAndTag(ID *id, int tag)
 {
   int &id_tag = id_tags_.lookup_or_add(id, 0);
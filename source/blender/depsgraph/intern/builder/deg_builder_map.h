@@ -56,6 +56,9 @@ class BuilderMap {
   /* Tag given ID as handled/built. */
   void tagBuild(ID *id, int tag = TAG_COMPLETE);
 
+  /* Forget that given ID was handled, so that it is built again. */
+  void untagBuild(ID *id);
+
   /* Combination of previous two functions, returns truth if ID was already handled, or tags is
    * handled otherwise and return false. */
   bool checkIsBuiltAndTag(ID *id, int tag = TAG_COMPLETE);
@@ -84,6 +84,7 @@
 #include "BKE_lattice.h"
 #include "BKE_layer.h"
 #include "BKE_light.h"
+#include "BKE_main.h"
 #include "BKE_mask.h"
 #include "BKE_material.h"
 #include "BKE_mball.h"
@@ -112,6 +113,7 @@
 
 #include "intern/builder/deg_builder.h"
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_type.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/node/deg_node.h"
@@ -152,6 +154,10 @@ DepsgraphNodeBuilder::~DepsgraphNodeBuilder()
 
 IDNode *DepsgraphNodeBuilder::add_id_node(ID *id)
 {
+  /* All build paths add the ID node before accessing the ID data, read the contents of lazily
+   * loaded data-blocks now. Data-blocks which are not pulled into the graph stay unread. */
+  BKE_main_lazy_load_ensure_id(bmain_, id);
+
   IDNode *id_node = nullptr;
   ID *id_cow = nullptr;
   IDComponentsMask previously_visible_components_mask = 0;
@@ -339,16 +345,7 @@ void DepsgraphNodeBuilder::begin_build()
   }
 
   for (OperationNode *op_node : graph_->entry_tags) {
-    ComponentNode *comp_node = op_node->owner;
-    IDNode *id_node = comp_node->owner;
-
-    SavedEntryTag entry_tag;
-    entry_tag.id_orig = id_node->id_orig;
-    entry_tag.component_type = comp_node->type;
-    entry_tag.opcode = op_node->opcode;
-    entry_tag.name = op_node->name;
-    entry_tag.name_tag = op_node->name_tag;
-    saved_entry_tags_.append(entry_tag);
+    save_entry_tag(op_node);
   }
 
   /* Make sure graph has no nodes left from previous state. */
@@ -357,6 +354,93 @@ void DepsgraphNodeBuilder::begin_build()
   graph_->entry_tags.clear();
 }
 
+void DepsgraphNodeBuilder::begin_build_incremental(const Set<ID *> &ids)
+{
+  Set<OperationNode *> removed_operations;
+  for (IDNode *id_node : graph_->id_nodes) {
+    /* Flags are compared against the previous state when build is finalized. Nodes which are
+     * kept do not get their flags calculated from scratch, so only changes done by this build
+     * will cause re-evaluation. */
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    if (!ids.contains(id_node->id_orig)) {
+      /* Make it possible for the IDs which are built again to add operations to components of
+       * the kept IDs, same as they would do in a full build. */
+      built_map_.tagBuild(id_node->id_orig);
+      for (ComponentNode *comp_node : id_node->components.values()) {
+        comp_node->reopen_build();
+      }
+      continue;
+    }
+    /* Keep the ID node itself, so that its copy-on-write datablock and position in the graph
+     * stays the same. Previous state is restored by add_id_node(), same as for a full build. */
+    IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
+    id_info->id_cow = nullptr;
+    id_info->previously_visible_components_mask = id_node->visible_components_mask;
+    id_info->previous_eval_flags = id_node->eval_flags;
+    id_info->previous_customdata_masks = id_node->customdata_masks;
+    id_info_hash_.add_new(id_node->id_orig, id_info);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        if (graph_->entry_tags.remove(op_node)) {
+          save_entry_tag(op_node);
+        }
+        /* Relations are referenced from both their ends, unlink them from the kept nodes. */
+        while (!op_node->inlinks.is_empty()) {
+          Relation *rel = op_node->inlinks.last();
+          rel->unlink();
+          delete rel;
+        }
+        while (!op_node->outlinks.is_empty()) {
+          Relation *rel = op_node->outlinks.last();
+          rel->unlink();
+          delete rel;
+        }
+        removed_operations.add_new(op_node);
+      }
+    }
+    id_node->eval_flags = 0;
+    id_node->customdata_masks = DEGCustomDataMeshMasks();
+    id_node->linked_state = DEG_ID_LINKED_INDIRECTLY;
+    id_node->is_directly_visible = true;
+    id_node->is_collection_fully_expanded = false;
+    id_node->has_base = false;
+    id_node->visible_components_mask = 0;
+  }
+
+  Depsgraph::OperationNodes operations;
+  operations.reserve(graph_->operations.size() - removed_operations.size());
+  for (OperationNode *op_node : graph_->operations) {
+    if (!removed_operations.contains(op_node)) {
+      operations.append(op_node);
+    }
+  }
+  graph_->operations = std::move(operations);
+
+  for (const ID *id : id_info_hash_.keys()) {
+    IDNode *id_node = graph_->find_id_node(id);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      delete comp_node;
+    }
+    id_node->components.clear();
+  }
+}
+
+void DepsgraphNodeBuilder::save_entry_tag(OperationNode *op_node)
+{
+  ComponentNode *comp_node = op_node->owner;
+  IDNode *id_node = comp_node->owner;
+
+  SavedEntryTag entry_tag;
+  entry_tag.id_orig = id_node->id_orig;
+  entry_tag.component_type = comp_node->type;
+  entry_tag.opcode = op_node->opcode;
+  entry_tag.name = op_node->name;
+  entry_tag.name_tag = op_node->name_tag;
+  saved_entry_tags_.append(entry_tag);
+}
+
 void DepsgraphNodeBuilder::end_build()
 {
   for (const SavedEntryTag &entry_tag : saved_entry_tags_) {
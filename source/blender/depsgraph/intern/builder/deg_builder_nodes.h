@@ -101,6 +101,10 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void begin_build();
   virtual void end_build();
 
+  /* Begin build which only updates nodes of the given IDs. Nodes of other IDs are kept as-is and
+   * are not built again, nodes of the given IDs are removed together with all their relations. */
+  virtual void begin_build_incremental(const Set<ID *> &ids);
+
   IDNode *add_id_node(ID *id);
   IDNode *find_id_node(ID *id);
   TimeSourceNode *add_time_source();
@@ -162,6 +166,11 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  /* Build objects of the view layer which are in the given set, with the same base index and
+   * visibility as build_view_layer() gives them. */
+  virtual void build_view_layer_objects(Scene *scene,
+                                        ViewLayer *view_layer,
+                                        const Set<ID *> &ids);
   virtual void build_collection(LayerCollection *from_layer_collection, Collection *collection);
   virtual void build_object(int base_index,
                             Object *object,
@@ -259,6 +268,8 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   };
   Vector<SavedEntryTag> saved_entry_tags_;
 
+  void save_entry_tag(OperationNode *op_node);
+
   struct BuilderWalkUserData {
     DepsgraphNodeBuilder *builder;
     /* Denotes whether object the walk is invoked from is visible. */
@@ -31,7 +31,9 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_action_types.h"
@@ -244,7 +246,11 @@ bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(nullptr), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(nullptr),
+      rna_node_query_(graph, this),
+      check_relations_before_add_(false),
+      deferred_relations_(nullptr)
 {
 }
 
@@ -349,7 +355,14 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       const char *description,
                                                       int flags)
 {
+  if (check_relations_before_add_) {
+    flags |= RELATION_CHECK_BEFORE_ADD;
+  }
   if (timesrc && node_to) {
+    if (deferred_relations_ != nullptr) {
+      deferred_relations_->append({timesrc, node_to, description, flags});
+      return nullptr;
+    }
     return graph_->add_new_relation(timesrc, node_to, description, flags);
   }
 
@@ -370,7 +383,14 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            const char *description,
                                                            int flags)
 {
+  if (check_relations_before_add_) {
+    flags |= RELATION_CHECK_BEFORE_ADD;
+  }
   if (node_from && node_to) {
+    if (deferred_relations_ != nullptr) {
+      deferred_relations_->append({node_from, node_to, description, flags});
+      return nullptr;
+    }
     return graph_->add_new_relation(node_from, node_to, description, flags);
   }
 
@@ -478,6 +498,22 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_build_incremental(const Set<ID *> &ids)
+{
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (!ids.contains(id_node->id_orig)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+  check_relations_before_add_ = true;
+}
+
+void DepsgraphRelationBuilder::rebuild_id(ID *id)
+{
+  built_map_.untagBuild(id);
+  build_id(id);
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
@@ -2730,13 +2766,81 @@ void DepsgraphRelationBuilder::build_scene_speakers(Scene * /*scene*/, ViewLayer
   }
 }
 
+namespace {
+
+struct CopyOnWriteRelationsData {
+  Main *bmain;
+  Depsgraph *graph;
+  DepsgraphBuilderCache *cache;
+  MutableSpan<Vector<DeferredRelation>> relations;
+};
+
+struct CopyOnWriteRelationsChunk {
+  /* Builder of the thread, created on first use. */
+  DepsgraphRelationBuilder *builder;
+};
+
+void build_copy_on_write_relations_func(void *__restrict data_v,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict tls)
+{
+  CopyOnWriteRelationsData *data = static_cast<CopyOnWriteRelationsData *>(data_v);
+  CopyOnWriteRelationsChunk *chunk = static_cast<CopyOnWriteRelationsChunk *>(
+      tls->userdata_chunk);
+  if (chunk->builder == nullptr) {
+    chunk->builder = new DepsgraphRelationBuilder(data->bmain, data->graph, data->cache);
+  }
+  chunk->builder->build_copy_on_write_relations_deferred(data->graph->id_nodes[i],
+                                                         data->relations[i]);
+}
+
+void build_copy_on_write_relations_free(const void *__restrict /*userdata*/,
+                                        void *__restrict chunk_v)
+{
+  CopyOnWriteRelationsChunk *chunk = static_cast<CopyOnWriteRelationsChunk *>(chunk_v);
+  delete chunk->builder;
+}
+
+}  // namespace
+
 void DepsgraphRelationBuilder::build_copy_on_write_relations()
 {
-  for (IDNode *id_node : graph_->id_nodes) {
-    build_copy_on_write_relations(id_node);
+  /* Relations of every ID only depend on the operations of the ID itself, so they are gathered
+   * for all IDs in parallel and added to the graph afterwards, in the order of the IDs. */
+  Array<Vector<DeferredRelation>> relations(graph_->id_nodes.size());
+  CopyOnWriteRelationsData data;
+  data.bmain = bmain_;
+  data.graph = graph_;
+  data.cache = cache_;
+  data.relations = relations;
+  CopyOnWriteRelationsChunk chunk;
+  chunk.builder = nullptr;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &chunk;
+  settings.userdata_chunk_size = sizeof(chunk);
+  settings.func_free = build_copy_on_write_relations_free;
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(
+      0, graph_->id_nodes.size(), &data, build_copy_on_write_relations_func, &settings);
+
+  const int flags = check_relations_before_add_ ? RELATION_CHECK_BEFORE_ADD : 0;
+  for (Span<DeferredRelation> id_relations : relations) {
+    for (const DeferredRelation &relation : id_relations) {
+      graph_->add_new_relation(
+          relation.from, relation.to, relation.description, relation.flags | flags);
+    }
   }
 }
 
+void DepsgraphRelationBuilder::build_copy_on_write_relations_deferred(
+    IDNode *id_node, Vector<DeferredRelation> &r_relations)
+{
+  deferred_relations_ = &r_relations;
+  build_copy_on_write_relations(id_node);
+  deferred_relations_ = nullptr;
+}
+
 /* Nested datablocks (node trees, shape keys) requires special relation to
  * ensure owner's datablock remapping happens after node tree itself is ready.
  *
@@ -2818,8 +2922,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
      * copy of ID. */
     OperationNode *op_entry = comp_node->get_entry_operation();
     if (op_entry != nullptr) {
-      Relation *rel = graph_->add_new_relation(op_cow, op_entry, "CoW Dependency");
-      rel->flag |= rel_flag;
+      add_operation_relation(op_cow, op_entry, "CoW Dependency", rel_flag);
     }
     /* All dangling operations should also be executed after copy-on-write. */
     for (OperationNode *op_node : comp_node->operations_map->values()) {
@@ -2827,8 +2930,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
         continue;
       }
       if (op_node->inlinks.is_empty()) {
-        Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
-        rel->flag |= rel_flag;
+        add_operation_relation(op_cow, op_node, "CoW Dependency", rel_flag);
       }
       else {
         bool has_same_comp_dependency = false;
@@ -2843,8 +2945,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
           }
         }
         if (!has_same_comp_dependency) {
-          Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
-          rel->flag |= rel_flag;
+          add_operation_relation(op_cow, op_node, "CoW Dependency", rel_flag);
         }
       }
     }
@@ -92,6 +92,7 @@ struct ComponentNode;
 struct DepsNodeHandle;
 struct Depsgraph;
 class DepsgraphBuilderCache;
+struct DriverGroups;
 struct IDNode;
 struct Node;
 struct OperationNode;
@@ -159,12 +160,27 @@ struct RNAPathKey {
   RNAPointerSource source;
 };
 
+/* Relation which is added to the graph later, see
+ * DepsgraphRelationBuilder::build_copy_on_write_relations_deferred(). */
+struct DeferredRelation {
+  Node *from;
+  Node *to;
+  const char *description;
+  int flags;
+};
+
 class DepsgraphRelationBuilder : public DepsgraphBuilder {
  public:
   DepsgraphRelationBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache);
 
   void begin_build();
 
+  /* Begin build which only adds relations of the given IDs. Relations of other IDs are expected
+   * to be in the graph already, and relations which already exist are not added again. */
+  void begin_build_incremental(const Set<ID *> &ids);
+  /* Build relations of the given ID again, even if they were built already. */
+  void rebuild_id(ID *id);
+
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
                          const KeyTo &key_to,
@@ -313,6 +329,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   virtual void build_copy_on_write_relations();
   virtual void build_copy_on_write_relations(IDNode *id_node);
+  /* Build copy-on-write relations of the ID, storing them in the given vector instead of adding
+   * them to the graph. The graph is not modified, so relations of different IDs can be built from
+   * multiple threads, each thread using its own builder. */
+  void build_copy_on_write_relations_deferred(IDNode *id_node,
+                                              Vector<DeferredRelation> &r_relations);
   virtual void build_driver_relations();
   virtual void build_driver_relations(IDNode *id_node);
 
@@ -338,6 +359,8 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
                                    const char *description,
                                    int flags = 0);
 
+  void build_driver_relations(const DriverGroups &driver_groups);
+
   template<typename KeyType>
   DepsNodeHandle create_node_handle(const KeyType &key, const char *default_name = "");
 
@@ -373,6 +396,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
+
+  /* Relations are added to a graph which already has relations, see begin_build_incremental(). */
+  bool check_relations_before_add_;
+  /* When set, relations are stored here instead of being added to the graph. */
+  Vector<DeferredRelation> *deferred_relations_;
 };
 
 struct DepsNodeHandle {
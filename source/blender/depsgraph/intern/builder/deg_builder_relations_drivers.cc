@@ -29,7 +29,11 @@
 
 #include "DNA_anim_types.h"
 
+#include "BLI_array.hh"
+#include "BLI_task.h"
+
 #include "BKE_anim_data.h"
+#include "BKE_main.h"
 
 #include "intern/builder/deg_builder_relations.h"
 #include "intern/depsgraph_relation.h"
@@ -153,16 +157,78 @@ static bool is_reachable(const Node *const from, const Node *const to)
   return false;
 }
 
+void DriverGroups::collect(ID *id)
+{
+  AnimData *adt = BKE_animdata_from_id(id);
+  if (adt == nullptr) {
+    return;
+  }
+
+  RNA_id_pointer_create(id, &id_ptr);
+
+  LISTBASE_FOREACH (FCurve *, fcu, &adt->drivers) {
+    if (fcu->rna_path == nullptr) {
+      continue;
+    }
+
+    DriverDescriptor driver_desc(&id_ptr, fcu);
+    if (!driver_desc.driver_relations_needed()) {
+      continue;
+    }
+
+    groups.lookup_or_add_default_as(driver_desc.rna_prefix).append(driver_desc);
+  }
+}
+
+namespace {
+
+struct DriverGroupsCollectData {
+  Depsgraph *graph;
+  MutableSpan<DriverGroups> driver_groups;
+};
+
+void driver_groups_collect_func(void *__restrict data_v,
+                                const int i,
+                                const TaskParallelTLS *__restrict /*tls*/)
+{
+  DriverGroupsCollectData *data = static_cast<DriverGroupsCollectData *>(data_v);
+  data->driver_groups[i].collect(data->graph->id_nodes[i]->id_orig);
+}
+
+}  // namespace
+
 /* **** DepsgraphRelationBuilder functions **** */
 
 void DepsgraphRelationBuilder::build_driver_relations()
 {
-  for (IDNode *id_node : graph_->id_nodes) {
-    build_driver_relations(id_node);
+  /* Resolving RNA paths of the drivers is done for all IDs in parallel. Relations are added
+   * afterwards, one ID at a time, since checks for cycles depend on relations added so far. */
+  Array<DriverGroups> driver_groups(graph_->id_nodes.size());
+  DriverGroupsCollectData data;
+  data.graph = graph_;
+  data.driver_groups = driver_groups;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  /* Lazy loaded IDs are read when a path passes through them, see
+   * #DepsgraphBuilderCache::ensureInitializedAnimatedPropertyStorages. */
+  settings.use_threading = (bmain_->lazy_load == nullptr);
+  BLI_task_parallel_range(
+      0, graph_->id_nodes.size(), &data, driver_groups_collect_func, &settings);
+
+  for (const int64_t i : graph_->id_nodes.index_range()) {
+    build_driver_relations(driver_groups[i]);
   }
 }
 
 void DepsgraphRelationBuilder::build_driver_relations(IDNode *id_node)
+{
+  DriverGroups driver_groups;
+  driver_groups.collect(id_node->id_orig);
+  build_driver_relations(driver_groups);
+}
+
+void DepsgraphRelationBuilder::build_driver_relations(const DriverGroups &driver_groups)
 {
   /* Add relations between drivers that write to the same datablock.
    *
@@ -174,32 +240,7 @@ void DepsgraphRelationBuilder::build_driver_relations(IDNode *id_node)
    *   value will write the entire int containing the bit, in a non-thread-safe
    *   way.
    */
-  ID *id_orig = id_node->id_orig;
-  AnimData *adt = BKE_animdata_from_id(id_orig);
-  if (adt == nullptr) {
-    return;
-  }
-
-  // Mapping from RNA prefix -> set of driver descriptors:
-  Map<string, Vector<DriverDescriptor>> driver_groups;
-
-  PointerRNA id_ptr;
-  RNA_id_pointer_create(id_orig, &id_ptr);
-
-  LISTBASE_FOREACH (FCurve *, fcu, &adt->drivers) {
-    if (fcu->rna_path == nullptr) {
-      continue;
-    }
-
-    DriverDescriptor driver_desc(&id_ptr, fcu);
-    if (!driver_desc.driver_relations_needed()) {
-      continue;
-    }
-
-    driver_groups.lookup_or_add_default_as(driver_desc.rna_prefix).append(driver_desc);
-  }
-
-  for (Span<DriverDescriptor> prefix_group : driver_groups.values()) {
+  for (Span<DriverDescriptor> prefix_group : driver_groups.groups.values()) {
     // For each node in the driver group, try to connect it to another node
     // in the same group without creating any cycles.
     int num_drivers = prefix_group.size();
@@ -30,6 +30,7 @@
 #include "intern/builder/deg_builder_relations.h"
 
 struct FCurve;
+struct ID;
 
 namespace blender {
 namespace deg {
@@ -72,5 +73,17 @@ class DriverDescriptor {
   bool resolve_rna();
 };
 
+/* Drivers of an ID which need relations between each other, grouped by their RNA prefix. */
+struct DriverGroups {
+  /* Mapping from RNA prefix -> set of driver descriptors. */
+  Map<string, Vector<DriverDescriptor>> groups;
+  /* Pointer to the ID, referenced by the descriptors. */
+  PointerRNA id_ptr;
+
+  /* Gather drivers of the given ID. Only reads the ID, so drivers of different IDs can be
+   * gathered from multiple threads. */
+  void collect(ID *id);
+};
+
 }  // namespace deg
 }  // namespace blender
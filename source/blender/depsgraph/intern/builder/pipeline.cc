@@ -21,8 +21,15 @@
 
 #include "PIL_time.h"
 
+#include "BLI_listbase.h"
+
+#include "BKE_anim_data.h"
 #include "BKE_global.h"
+#include "BKE_main.h"
 
+#include "DNA_armature_types.h"
+#include "DNA_layer_types.h"
+#include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
 #include "deg_builder_cycle.h"
@@ -53,7 +60,13 @@ void AbstractBuilderPipeline::build()
     start_time = PIL_check_seconds_timer();
   }
 
+  /* Cache of the previous build does not match the graph anymore. Pipelines which support
+   * incremental updates store their own cache once they are done. */
+  delete deg_graph_->builder_cache;
+  deg_graph_->builder_cache = nullptr;
+
   build_step_sanity_check();
+  build_step_animated_properties();
   build_step_nodes();
   build_step_relations();
   build_step_finalize();
@@ -70,6 +83,38 @@ void AbstractBuilderPipeline::build_step_sanity_check()
   BLI_assert(deg_graph_->view_layer == view_layer_);
 }
 
+static void add_animated_property_ids_of_object(Object *object, VectorSet<ID *> &ids)
+{
+  if (BKE_animdata_from_id(&object->id) != nullptr) {
+    ids.add(&object->id);
+  }
+  if (object->type == OB_ARMATURE) {
+    bArmature *armature = static_cast<bArmature *>(object->data);
+    if (BKE_animdata_from_id(&armature->id) != nullptr) {
+      ids.add(&armature->id);
+    }
+  }
+}
+
+void AbstractBuilderPipeline::build_step_animated_properties()
+{
+  /* Builders query animated visibility of the objects of the view layer, and animated B-Bone
+   * segments of armatures. Resolve them at once rather than one by one while the graph is being
+   * built. IDs which are only pulled into the graph by dependencies are resolved on demand. */
+  VectorSet<ID *> ids;
+  LISTBASE_FOREACH (Base *, base, &view_layer_->object_bases) {
+    if (need_animated_properties_of_base(base)) {
+      add_animated_property_ids_of_object(base->object, ids);
+    }
+  }
+  builder_cache_.ensureInitializedAnimatedPropertyStorages(bmain_, ids);
+}
+
+bool AbstractBuilderPipeline::need_animated_properties_of_base(Base * /*base*/)
+{
+  return true;
+}
+
 void AbstractBuilderPipeline::build_step_nodes()
 {
   /* Generate all the nodes in the graph first */
@@ -113,6 +158,7 @@ void AbstractBuilderPipeline::build_step_finalize()
 #endif
   /* Relations are up to date. */
   deg_graph_->need_update = false;
+  deg_graph_->relations_update_ids.clear();
 }
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
@@ -27,6 +27,7 @@
 
 #include "intern/depsgraph_type.h"
 
+struct Base;
 struct Depsgraph;
 struct Main;
 struct Scene;
@@ -65,10 +66,14 @@ class AbstractBuilderPipeline {
   virtual unique_ptr<DepsgraphRelationBuilder> construct_relation_builder();
 
   virtual void build_step_sanity_check();
-  void build_step_nodes();
-  void build_step_relations();
+  void build_step_animated_properties();
+  virtual void build_step_nodes();
+  virtual void build_step_relations();
   void build_step_finalize();
 
+  /* Whether animated properties of the object of the base are resolved before building. */
+  virtual bool need_animated_properties_of_base(Base *base);
+
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) = 0;
   virtual void build_relations(DepsgraphRelationBuilder &relation_builder) = 0;
 };
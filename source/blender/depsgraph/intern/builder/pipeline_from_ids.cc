@@ -130,6 +130,12 @@ unique_ptr<DepsgraphRelationBuilder> FromIDsBuilderPipeline::construct_relation_
       bmain_, deg_graph_, &builder_cache_, ids_);
 }
 
+bool FromIDsBuilderPipeline::need_animated_properties_of_base(Base *base)
+{
+  /* Bases of other objects are not pulled into the graph. */
+  return ids_.contains(&base->object->id);
+}
+
 void FromIDsBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
 {
   node_builder.build_view_layer(scene_, view_layer_, DEG_ID_LINKED_DIRECTLY);
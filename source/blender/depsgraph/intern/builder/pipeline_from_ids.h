@@ -49,6 +49,8 @@ class FromIDsBuilderPipeline : public AbstractBuilderPipeline {
   virtual unique_ptr<DepsgraphNodeBuilder> construct_node_builder() override;
   virtual unique_ptr<DepsgraphRelationBuilder> construct_relation_builder() override;
 
+  virtual bool need_animated_properties_of_base(Base *base) override;
+
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
   virtual void build_relations(DepsgraphRelationBuilder &relation_builder) override;
 
@@ -0,0 +1,319 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "pipeline_incremental.h"
+
+#include <cstdio>
+
+#include "BLI_listbase.h"
+
+#include "BKE_collision.h"
+#include "BKE_effect.h"
+#include "BKE_layer.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+#include "DNA_particle_types.h"
+#include "DNA_scene_types.h"
+
+#include "intern/builder/deg_builder_cache.h"
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender {
+namespace deg {
+
+namespace {
+
+bool partdeflect_is_field(const PartDeflect *pd)
+{
+  return pd != nullptr && pd->forcefield != PFIELD_NULL;
+}
+
+/* Objects which are effectors or colliders are listed in the physics relations of the graph,
+ * which are only collected by a full build. */
+bool object_has_physics(Object *object)
+{
+  if (partdeflect_is_field(object->pd)) {
+    return true;
+  }
+  if (object->rigidbody_object != nullptr || object->rigidbody_constraint != nullptr) {
+    return true;
+  }
+  LISTBASE_FOREACH (ModifierData *, md, &object->modifiers) {
+    if (ELEM(md->type, eModifierType_Collision, eModifierType_Fluid, eModifierType_DynamicPaint)) {
+      return true;
+    }
+  }
+  LISTBASE_FOREACH (ParticleSystem *, psys, &object->particlesystem) {
+    if (psys->part != nullptr &&
+        (partdeflect_is_field(psys->part->pd) || partdeflect_is_field(psys->part->pd2))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool physics_relations_use_object(const Depsgraph *graph, const Object *object)
+{
+  for (int i = 0; i < DEG_PHYSICS_RELATIONS_NUM; i++) {
+    Map<const ID *, ListBase *> *hash = graph->physics_relations[i];
+    if (hash == nullptr) {
+      continue;
+    }
+    for (ListBase *relations : hash->values()) {
+      if (relations == nullptr) {
+        continue;
+      }
+      if (i == DEG_PHYSICS_EFFECTOR) {
+        LISTBASE_FOREACH (EffectorRelation *, relation, relations) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+      else {
+        LISTBASE_FOREACH (CollisionRelation *, relation, relations) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+ID *operation_id(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return nullptr;
+  }
+  const OperationNode *op_node = static_cast<const OperationNode *>(node);
+  return op_node->owner->owner->id_orig;
+}
+
+string node_full_identifier(const Node *node)
+{
+  if (node->type == NodeType::OPERATION) {
+    return static_cast<const OperationNode *>(node)->full_identifier();
+  }
+  return node->identifier();
+}
+
+int print_missing(const char *message, const Set<string> &expected, const Set<string> &actual)
+{
+  int num_missing = 0;
+  for (const string &identifier : expected) {
+    if (!actual.contains(identifier)) {
+      printf("  %s: %s\n", message, identifier.c_str());
+      num_missing++;
+    }
+  }
+  return num_missing;
+}
+
+}  // namespace
+
+GraphSignature::GraphSignature(const Depsgraph *graph)
+{
+  for (OperationNode *op_node : graph->operations) {
+    operations.add(op_node->full_identifier());
+    for (Relation *rel : op_node->inlinks) {
+      relations.add(node_full_identifier(rel->from) + " -> " + op_node->full_identifier() + " (" +
+                    rel->name + ")");
+    }
+  }
+}
+
+IncrementalBuilderPipeline::IncrementalBuilderPipeline(::Depsgraph *graph)
+    : ViewLayerBuilderPipeline(graph)
+{
+  BLI_assert(can_build(deg_graph_));
+  for (ID *id : deg_graph_->relations_update_ids) {
+    rebuild_ids_.add(id);
+  }
+  /* Re-use animated properties of the kept IDs, the cache is given back to the graph once the
+   * build is done. */
+  builder_cache_.swap(*deg_graph_->builder_cache);
+  for (ID *id : rebuild_ids_) {
+    builder_cache_.invalidateAnimatedPropertyStorage(id);
+  }
+}
+
+bool IncrementalBuilderPipeline::can_build(const Depsgraph *graph)
+{
+  if (graph->builder_cache == nullptr || graph->relations_update_ids.is_empty()) {
+    return false;
+  }
+  const int base_flag = (graph->mode == DAG_EVAL_VIEWPORT) ? BASE_ENABLED_VIEWPORT :
+                                                             BASE_ENABLED_RENDER;
+  for (ID *id : graph->relations_update_ids) {
+    if (GS(id->name) != ID_OB) {
+      return false;
+    }
+    const IDNode *id_node = graph->find_id_node(id);
+    if (id_node == nullptr || !id_node->has_base ||
+        id_node->linked_state != DEG_ID_LINKED_DIRECTLY) {
+      return false;
+    }
+    Object *object = (Object *)id;
+    if (object->proxy != nullptr || object->proxy_from != nullptr) {
+      return false;
+    }
+    if (object_has_physics(object) || physics_relations_use_object(graph, object)) {
+      return false;
+    }
+    /* Objects pulled into the graph because of animated visibility are not handled. */
+    Base *base = BKE_view_layer_base_find(graph->view_layer, object);
+    if (base == nullptr || (base->flag & base_flag) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void IncrementalBuilderPipeline::build_step_nodes()
+{
+  /* Relations of the rebuilt IDs are removed together with their nodes, so relations of the IDs
+   * on the other side are to be built again. */
+  for (ID *id : rebuild_ids_) {
+    relation_ids_.add(id);
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        for (Relation *rel : op_node->inlinks) {
+          if (ID *id_from = operation_id(rel->from)) {
+            relation_ids_.add(id_from);
+          }
+        }
+        for (Relation *rel : op_node->outlinks) {
+          if (ID *id_to = operation_id(rel->to)) {
+            relation_ids_.add(id_to);
+          }
+        }
+      }
+    }
+  }
+
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  node_builder->begin_build_incremental(rebuild_ids_);
+  const int64_t num_kept_operations = deg_graph_->operations.size();
+  build_nodes(*node_builder);
+  node_builder->end_build();
+
+  /* Operations might be added to the kept IDs, and new IDs might be pulled into the graph. */
+  for (int64_t i = num_kept_operations; i < deg_graph_->operations.size(); i++) {
+    relation_ids_.add(operation_id(deg_graph_->operations[i]));
+  }
+}
+
+void IncrementalBuilderPipeline::build_step_relations()
+{
+  unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+  relation_builder->begin_build_incremental(relation_ids_);
+  build_relations(*relation_builder);
+
+  /* Relations to unused no-op operations are removed when the graph is finalized, see
+   * deg_graph_remove_unused_noops(). When the rebuilt IDs start depending on such an operation,
+   * relations of its ID need to be built again, recursively. */
+  Vector<ID *> ids_to_check(relation_ids_.begin(), relation_ids_.end());
+  while (!ids_to_check.is_empty()) {
+    Set<ID *> ids_to_rebuild;
+    for (ID *id : ids_to_check) {
+      IDNode *id_node = deg_graph_->find_id_node(id);
+      for (ComponentNode *comp_node : id_node->components.values()) {
+        for (OperationNode *op_node : comp_node->operations_map->values()) {
+          for (Relation *rel : op_node->inlinks) {
+            ID *id_from = operation_id(rel->from);
+            if (id_from == nullptr || relation_ids_.contains(id_from)) {
+              continue;
+            }
+            OperationNode *op_from = static_cast<OperationNode *>(rel->from);
+            if (op_from->is_noop() && op_from->inlinks.is_empty()) {
+              ids_to_rebuild.add(id_from);
+            }
+          }
+        }
+      }
+    }
+    ids_to_check.clear();
+    for (ID *id : ids_to_rebuild) {
+      relation_ids_.add_new(id);
+      relation_builder->rebuild_id(id);
+      ids_to_check.append(id);
+    }
+  }
+
+  for (ID *id : relation_ids_) {
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    relation_builder->build_copy_on_write_relations(id_node);
+    relation_builder->build_driver_relations(id_node);
+  }
+}
+
+void IncrementalBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
+{
+  node_builder.build_view_layer_objects(scene_, view_layer_, rebuild_ids_);
+}
+
+void IncrementalBuilderPipeline::build_relations(DepsgraphRelationBuilder &relation_builder)
+{
+  /* Go through the view layer to build relations in the same context as a full build does, then
+   * handle IDs which are only reachable via the kept IDs. */
+  relation_builder.build_view_layer(scene_, view_layer_, DEG_ID_LINKED_DIRECTLY);
+  for (ID *id : relation_ids_) {
+    relation_builder.build_id(id);
+  }
+}
+
+void deg_graph_validate_incremental_build(Depsgraph *graph)
+{
+  const GraphSignature incremental_signature(graph);
+
+  ViewLayerBuilderPipeline builder(reinterpret_cast<::Depsgraph *>(graph));
+  builder.build();
+
+  const GraphSignature full_signature(graph);
+  int num_differences = 0;
+  num_differences += print_missing(
+      "Missing operation", full_signature.operations, incremental_signature.operations);
+  num_differences += print_missing(
+      "Extra operation", incremental_signature.operations, full_signature.operations);
+  num_differences += print_missing(
+      "Missing relation", full_signature.relations, incremental_signature.relations);
+  num_differences += print_missing(
+      "Extra relation", incremental_signature.relations, full_signature.relations);
+  printf("Depsgraph incremental relations update: %d differences from full build.\n",
+         num_differences);
+}
+
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,73 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "pipeline_view_layer.h"
+
+struct ID;
+
+namespace blender {
+namespace deg {
+
+/* Update of a view layer graph which only builds nodes and relations of the IDs tagged with
+ * DEG_id_relations_tag_update() again, together with relations of the IDs they are connected to.
+ * Nodes and relations of all other IDs are kept from the previous build.
+ *
+ * Only objects which are directly in the view layer and do not take part in physics are handled,
+ * use can_build() to check whether this pipeline can be used for the graph. */
+class IncrementalBuilderPipeline : public ViewLayerBuilderPipeline {
+ public:
+  IncrementalBuilderPipeline(::Depsgraph *graph);
+
+  static bool can_build(const Depsgraph *graph);
+
+ protected:
+  virtual void build_step_nodes() override;
+  virtual void build_step_relations() override;
+
+  virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
+  virtual void build_relations(DepsgraphRelationBuilder &relation_builder) override;
+
+  /* IDs which nodes are built again. */
+  Set<ID *> rebuild_ids_;
+  /* IDs which relations are built again. Besides the rebuilt IDs these are the IDs which were
+   * connected to them, and the IDs which got new operations during this build. */
+  Set<ID *> relation_ids_;
+};
+
+/* Identifiers of all operations and relations of the graph, used to compare graphs built in
+ * different ways. */
+struct GraphSignature {
+  Set<string> operations;
+  Set<string> relations;
+
+  GraphSignature(const Depsgraph *graph);
+};
+
+/* Build the graph from scratch and print differences from its current state. Used to validate
+ * incremental relations updates. */
+void deg_graph_validate_incremental_build(Depsgraph *graph);
+
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,221 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+
+#include "BKE_anim_data.h"
+#include "BKE_constraint.h"
+#include "BKE_fcurve.h"
+#include "BKE_fcurve_driver.h"
+#include "BKE_main.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_constraint_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/builder/pipeline_incremental.h"
+#include "intern/depsgraph.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+class DepsgraphIncrementalBuildTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+  Object *object = nullptr;
+  Object *target = nullptr;
+  ::Depsgraph *graph = nullptr;
+
+ public:
+  static void SetUpTestCase()
+  {
+    BlendfileLoadingBaseTest::SetUpTestCase();
+    BLI_task_scheduler_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_task_scheduler_exit();
+    BlendfileLoadingBaseTest::TearDownTestCase();
+  }
+
+ protected:
+  virtual void SetUp()
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+    target = BKE_object_add(bmain, view_layer, OB_EMPTY, "Target");
+    object = BKE_object_add(bmain, view_layer, OB_MESH, "Object");
+    /* Objects which are not touched by the updates keep their nodes and relations. */
+    BKE_object_add(bmain, view_layer, OB_MESH, "Other")->parent = target;
+
+    graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(graph);
+  }
+
+  virtual void TearDown()
+  {
+    DEG_graph_free(graph);
+    BKE_main_free(bmain);
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /* Update relations of the changed object incrementally, and compare the graph with one which
+   * is built from scratch. */
+  void expect_incremental_update_equal_full_build(Object *changed_object)
+  {
+    Depsgraph *deg_graph = reinterpret_cast<Depsgraph *>(graph);
+    DEG_graph_id_relations_tag_update(graph, &changed_object->id);
+    ASSERT_TRUE(IncrementalBuilderPipeline::can_build(deg_graph));
+    DEG_graph_relations_update(graph);
+    EXPECT_FALSE(deg_graph->need_update);
+    const GraphSignature incremental_signature(deg_graph);
+
+    ::Depsgraph *full_graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(full_graph);
+    const GraphSignature full_signature(reinterpret_cast<Depsgraph *>(full_graph));
+    DEG_graph_free(full_graph);
+
+    EXPECT_EQ(incremental_signature.operations.size(), full_signature.operations.size());
+    for (const string &identifier : full_signature.operations) {
+      EXPECT_TRUE(incremental_signature.operations.contains(identifier))
+          << "Missing operation " << identifier;
+    }
+    for (const string &identifier : incremental_signature.operations) {
+      EXPECT_TRUE(full_signature.operations.contains(identifier))
+          << "Extra operation " << identifier;
+    }
+    EXPECT_EQ(incremental_signature.relations.size(), full_signature.relations.size());
+    for (const string &identifier : full_signature.relations) {
+      EXPECT_TRUE(incremental_signature.relations.contains(identifier))
+          << "Missing relation " << identifier;
+    }
+    for (const string &identifier : incremental_signature.relations) {
+      EXPECT_TRUE(full_signature.relations.contains(identifier))
+          << "Extra relation " << identifier;
+    }
+  }
+
+  bConstraint *add_constraint()
+  {
+    bConstraint *con = BKE_constraint_add_for_object(
+        object, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+    static_cast<bLocateLikeConstraint *>(con->data)->tar = target;
+    return con;
+  }
+
+  ModifierData *add_modifier()
+  {
+    ModifierData *md = BKE_modifier_new(eModifierType_Cast);
+    reinterpret_cast<CastModifierData *>(md)->object = target;
+    BLI_addtail(&object->modifiers, md);
+    return md;
+  }
+
+  /* Drive the X location of the object by the X location of the target. */
+  void add_driver()
+  {
+    AnimData *adt = BKE_animdata_add_id(&object->id);
+    FCurve *fcu = BKE_fcurve_create();
+    fcu->rna_path = BLI_strdup("location");
+    fcu->array_index = 0;
+    fcu->driver = static_cast<ChannelDriver *>(
+        MEM_callocN(sizeof(ChannelDriver), "ChannelDriver"));
+    fcu->driver->type = DRIVER_TYPE_AVERAGE;
+    DriverVar *dvar = driver_add_new_variable(fcu->driver);
+    driver_change_variable_type(dvar, DVAR_TYPE_SINGLE_PROP);
+    dvar->targets[0].id = &target->id;
+    dvar->targets[0].idtype = ID_OB;
+    dvar->targets[0].rna_path = BLI_strdup("location[0]");
+    BLI_addtail(&adt->drivers, fcu);
+  }
+};
+
+TEST_F(DepsgraphIncrementalBuildTest, constraint_add)
+{
+  add_constraint();
+  expect_incremental_update_equal_full_build(object);
+}
+
+TEST_F(DepsgraphIncrementalBuildTest, constraint_remove)
+{
+  bConstraint *con = add_constraint();
+  DEG_graph_build_from_view_layer(graph);
+
+  BKE_constraint_remove_ex(&object->constraints, object, con, true);
+  expect_incremental_update_equal_full_build(object);
+}
+
+TEST_F(DepsgraphIncrementalBuildTest, modifier_add)
+{
+  add_modifier();
+  expect_incremental_update_equal_full_build(object);
+}
+
+TEST_F(DepsgraphIncrementalBuildTest, modifier_remove)
+{
+  ModifierData *md = add_modifier();
+  DEG_graph_build_from_view_layer(graph);
+
+  BLI_remlink(&object->modifiers, md);
+  BKE_modifier_free(md);
+  expect_incremental_update_equal_full_build(object);
+}
+
+TEST_F(DepsgraphIncrementalBuildTest, driver_add)
+{
+  add_driver();
+  expect_incremental_update_equal_full_build(object);
+}
+
+/* Several objects changed in one update. */
+TEST_F(DepsgraphIncrementalBuildTest, constraint_add_to_target)
+{
+  add_constraint();
+  BKE_constraint_add_for_object(target, "Limit Location", CONSTRAINT_TYPE_LOCLIMIT);
+  DEG_graph_id_relations_tag_update(graph, &target->id);
+  expect_incremental_update_equal_full_build(object);
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
@@ -31,6 +31,15 @@ ViewLayerBuilderPipeline::ViewLayerBuilderPipeline(::Depsgraph *graph)
 {
 }
 
+ViewLayerBuilderPipeline::~ViewLayerBuilderPipeline()
+{
+  /* Keep the cache for incremental relations updates of the graph. */
+  if (deg_graph_->builder_cache == nullptr) {
+    deg_graph_->builder_cache = new DepsgraphBuilderCache();
+  }
+  deg_graph_->builder_cache->swap(builder_cache_);
+}
+
 void ViewLayerBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
 {
   node_builder.build_view_layer(scene_, view_layer_, DEG_ID_LINKED_DIRECTLY);
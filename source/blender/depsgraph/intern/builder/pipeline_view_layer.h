@@ -31,6 +31,7 @@ namespace deg {
 class ViewLayerBuilderPipeline : public AbstractBuilderPipeline {
  public:
   ViewLayerBuilderPipeline(::Depsgraph *graph);
+  virtual ~ViewLayerBuilderPipeline();
 
  protected:
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
@@ -41,6 +41,7 @@
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_debug.h"
 
+#include "intern/builder/deg_builder_cache.h"
 #include "intern/depsgraph_physics.h"
 #include "intern/depsgraph_registry.h"
 #include "intern/depsgraph_relation.h"
@@ -71,7 +72,8 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
       scene_cow(nullptr),
       is_active(false),
       is_evaluating(false),
-      is_render_pipeline_depsgraph(false)
+      is_render_pipeline_depsgraph(false),
+      builder_cache(nullptr)
 {
   BLI_spin_init(&lock);
   memset(id_type_updated, 0, sizeof(id_type_updated));
@@ -85,6 +87,7 @@ Depsgraph::~Depsgraph()
 {
   clear_id_nodes();
   delete time_source;
+  delete builder_cache;
   BLI_spin_end(&lock);
 }
 
@@ -52,6 +52,7 @@ struct ViewLayer;
 namespace blender {
 namespace deg {
 
+class DepsgraphBuilderCache;
 struct IDNode;
 struct Node;
 struct OperationNode;
@@ -111,6 +112,10 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* IDs which relations are to be updated. When relations need to be updated and this set is
+   * empty, the whole graph is to be rebuilt. */
+  Set<ID *> relations_update_ids;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
 
@@ -168,6 +173,10 @@ struct Depsgraph {
    * created along with relations, for fast lookup during evaluation. */
   Map<const ID *, ListBase *> *physics_relations[DEG_PHYSICS_RELATIONS_NUM];
 
+  /* Cache of the last view layer build, re-used by incremental relations updates.
+   * Is nullptr when the graph was built by any other pipeline. */
+  DepsgraphBuilderCache *builder_cache;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("Depsgraph");
 };
 
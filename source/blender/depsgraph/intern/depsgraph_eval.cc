@@ -25,7 +25,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_listbase.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_scene.h"
@@ -34,6 +37,7 @@
 #include "DNA_scene_types.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_query.h"
 
 #include "intern/eval/deg_eval.h"
@@ -81,3 +85,94 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float ctime)
   deg_graph->ctime = ctime;
   deg_flush_updates_and_refresh(deg_graph);
 }
+
+namespace {
+
+/* Graph which is used to evaluate one of the frames of DEG_evaluate_frames(). */
+struct FrameGraph {
+  Depsgraph *graph;
+  float ctime;
+  bool is_evaluated;
+};
+
+struct EvaluateFramesState {
+  ThreadMutex mutex;
+  /* Notified whenever a graph is done evaluating its frame. */
+  ThreadCondition condition;
+};
+
+void evaluate_frame_task(TaskPool *__restrict pool, void *taskdata)
+{
+  EvaluateFramesState *state = static_cast<EvaluateFramesState *>(BLI_task_pool_user_data(pool));
+  FrameGraph *frame_graph = static_cast<FrameGraph *>(taskdata);
+  DEG_evaluate_on_framechange(frame_graph->graph, frame_graph->ctime);
+
+  BLI_mutex_lock(&state->mutex);
+  frame_graph->is_evaluated = true;
+  BLI_condition_notify_all(&state->condition);
+  BLI_mutex_unlock(&state->mutex);
+}
+
+void evaluate_frame_push(TaskPool *pool, FrameGraph *frame_graph, const float ctime)
+{
+  frame_graph->ctime = ctime;
+  frame_graph->is_evaluated = false;
+  BLI_task_pool_push(pool, evaluate_frame_task, frame_graph, false, nullptr);
+}
+
+}  // namespace
+
+void DEG_evaluate_frames(Depsgraph **graphs,
+                         const int num_graphs,
+                         const float *frames,
+                         const int num_frames,
+                         DEG_EvaluateFramesCb callback,
+                         void *user_data)
+{
+  BLI_assert(num_graphs > 0);
+
+  blender::Array<FrameGraph> frame_graphs(num_graphs);
+  for (int i = 0; i < num_graphs; i++) {
+    BLI_assert(!DEG_is_active(graphs[i]));
+    DEG_graph_relations_update(graphs[i]);
+    frame_graphs[i].graph = graphs[i];
+  }
+
+  EvaluateFramesState state;
+  BLI_mutex_init(&state.mutex);
+  BLI_condition_init(&state.condition);
+
+  /* Frame with index i is evaluated by graph i % num_graphs. Every graph starts evaluating its
+   * next frame as soon as the callback is done with the current one. */
+  TaskPool *task_pool = BLI_task_pool_create(&state, TASK_PRIORITY_HIGH);
+  for (int i = 0; i < num_graphs && i < num_frames; i++) {
+    evaluate_frame_push(task_pool, &frame_graphs[i], frames[i]);
+  }
+
+  for (int frame_index = 0; frame_index < num_frames; frame_index++) {
+    FrameGraph &frame_graph = frame_graphs[frame_index % num_graphs];
+
+    BLI_mutex_lock(&state.mutex);
+    while (!frame_graph.is_evaluated) {
+      BLI_condition_wait(&state.condition, &state.mutex);
+    }
+    BLI_mutex_unlock(&state.mutex);
+
+    if (!callback(frame_graph.graph, frame_index, user_data)) {
+      break;
+    }
+    DEG_ids_clear_recalc(DEG_get_bmain(frame_graph.graph), frame_graph.graph);
+
+    const int next_frame_index = frame_index + num_graphs;
+    if (next_frame_index < num_frames) {
+      evaluate_frame_push(task_pool, &frame_graph, frames[next_frame_index]);
+    }
+  }
+
+  /* Frames evaluated ahead are not used when the callback stopped early. */
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+
+  BLI_condition_end(&state.condition);
+  BLI_mutex_end(&state.mutex);
+}
@@ -0,0 +1,182 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include "BLI_task.h"
+#include "BLI_vector.hh"
+
+#include "BKE_main.h"
+#include "BKE_scene.h"
+
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+/* State of the graph passed to the callback of DEG_evaluate_frames(). */
+struct EvaluatedFrame {
+  int frame_index;
+  float ctime;
+  float scene_frame;
+};
+
+struct EvaluateFramesData {
+  Vector<EvaluatedFrame> evaluated_frames;
+  /* Index of the frame at which the callback stops the evaluation, -1 to evaluate all. */
+  int stop_frame_index = -1;
+};
+
+static bool evaluate_frames_cb(::Depsgraph *graph, int frame_index, void *user_data)
+{
+  EvaluateFramesData *data = static_cast<EvaluateFramesData *>(user_data);
+  EvaluatedFrame evaluated_frame;
+  evaluated_frame.frame_index = frame_index;
+  evaluated_frame.ctime = DEG_get_ctime(graph);
+  evaluated_frame.scene_frame = BKE_scene_frame_get(DEG_get_evaluated_scene(graph));
+  data->evaluated_frames.append(evaluated_frame);
+  return frame_index != data->stop_frame_index;
+}
+
+class DepsgraphEvaluateFramesTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  Vector<::Depsgraph *> graphs;
+
+ public:
+  static void SetUpTestCase()
+  {
+    BlendfileLoadingBaseTest::SetUpTestCase();
+    BLI_task_scheduler_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_task_scheduler_exit();
+    BlendfileLoadingBaseTest::TearDownTestCase();
+  }
+
+ protected:
+  virtual void SetUp()
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    scene->r.cfra = 1;
+  }
+
+  virtual void TearDown()
+  {
+    for (::Depsgraph *graph : graphs) {
+      DEG_graph_free(graph);
+    }
+    graphs.clear();
+    BKE_main_free(bmain);
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  void graphs_create(int num_graphs)
+  {
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+    for (int i = 0; i < num_graphs; i++) {
+      ::Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+      DEG_graph_build_from_view_layer(graph);
+      BKE_scene_graph_update_tagged(graph, bmain);
+      graphs.append(graph);
+    }
+  }
+};
+
+TEST_F(DepsgraphEvaluateFramesTest, frame_order)
+{
+  graphs_create(3);
+  const Vector<float> frames = {10.0f, 11.0f, 11.5f, 12.0f, 13.0f, 14.0f, 15.0f};
+
+  EvaluateFramesData data;
+  DEG_evaluate_frames(graphs.data(),
+                      static_cast<int>(graphs.size()),
+                      frames.data(),
+                      static_cast<int>(frames.size()),
+                      evaluate_frames_cb,
+                      &data);
+
+  ASSERT_EQ(data.evaluated_frames.size(), frames.size());
+  for (const int i : frames.index_range()) {
+    EXPECT_EQ(data.evaluated_frames[i].frame_index, i);
+    EXPECT_FLOAT_EQ(data.evaluated_frames[i].ctime, frames[i]);
+    EXPECT_FLOAT_EQ(data.evaluated_frames[i].scene_frame, frames[i]);
+  }
+
+  /* The frame of the original scene is not changed. */
+  EXPECT_EQ(scene->r.cfra, 1);
+}
+
+TEST_F(DepsgraphEvaluateFramesTest, more_graphs_than_frames)
+{
+  graphs_create(4);
+  const Vector<float> frames = {1.0f, 2.0f};
+
+  EvaluateFramesData data;
+  DEG_evaluate_frames(graphs.data(),
+                      static_cast<int>(graphs.size()),
+                      frames.data(),
+                      static_cast<int>(frames.size()),
+                      evaluate_frames_cb,
+                      &data);
+
+  ASSERT_EQ(data.evaluated_frames.size(), frames.size());
+  EXPECT_FLOAT_EQ(data.evaluated_frames[0].ctime, 1.0f);
+  EXPECT_FLOAT_EQ(data.evaluated_frames[1].ctime, 2.0f);
+}
+
+TEST_F(DepsgraphEvaluateFramesTest, stop_early)
+{
+  graphs_create(2);
+  const Vector<float> frames = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+
+  EvaluateFramesData data;
+  data.stop_frame_index = 2;
+  DEG_evaluate_frames(graphs.data(),
+                      static_cast<int>(graphs.size()),
+                      frames.data(),
+                      static_cast<int>(frames.size()),
+                      evaluate_frames_cb,
+                      &data);
+
+  /* No callbacks after the one which stopped, frames evaluated ahead are dropped. */
+  ASSERT_EQ(data.evaluated_frames.size(), 3);
+  for (const int i : data.evaluated_frames.index_range()) {
+    EXPECT_EQ(data.evaluated_frames[i].frame_index, i);
+    EXPECT_FLOAT_EQ(data.evaluated_frames[i].ctime, frames[i]);
+  }
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
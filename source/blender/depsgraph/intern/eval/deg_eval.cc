@@ -25,12 +25,16 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+
 #include "PIL_time.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -62,6 +66,10 @@ namespace {
 struct DepsgraphEvalState;
 
 void deg_task_run_func(TaskPool *pool, void *taskdata);
+void deg_task_run_priority_func(TaskPool *pool, void *taskdata);
+bool check_operation_node_visible(OperationNode *op_node);
+bool need_evaluate_operation_at_stage(DepsgraphEvalState *state,
+                                      const OperationNode *operation_node);
 
 template<typename ScheduleFunction, typename... ScheduleFunctionArgs>
 void schedule_children(DepsgraphEvalState *state,
@@ -96,6 +104,12 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Evaluate ready operations with the longest remaining chain first, instead of in the order
+   * they became ready. */
+  bool use_priority;
+  /* Operations which are ready for evaluation, as a heap ordered by priority. */
+  Vector<OperationNode *> ready_operations;
+  SpinLock ready_operations_lock;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
@@ -105,27 +119,110 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
-  if (state->do_stats) {
+  if (state->do_stats || state->use_priority) {
     const double start_time = PIL_check_seconds_timer();
     operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    const double time = PIL_check_seconds_timer() - start_time;
+    if (state->do_stats) {
+      operation_node->stats.current_time += time;
+    }
+    /* Follow changes of the scene within a few evaluations. */
+    Node::Stats &stats = operation_node->stats;
+    stats.average_time = (stats.average_time == 0.0) ? time : (stats.average_time + time) * 0.5;
   }
   else {
     operation_node->evaluate(depsgraph);
   }
 }
 
+/* Claim an operation fused to the one which was just evaluated, following the same rules as
+ * #schedule_node. Its parent is its only dependency, so there is nothing else to wait for. */
+bool fused_operation_take(DepsgraphEvalState *state, OperationNode *node)
+{
+  if (!check_operation_node_visible(node)) {
+    return false;
+  }
+  if ((node->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+    return false;
+  }
+  if (!need_evaluate_operation_at_stage(state, node)) {
+    return false;
+  }
+  BLI_assert(node->num_links_pending == 1);
+  atomic_sub_and_fetch_uint32(&node->num_links_pending, 1);
+  return !atomic_fetch_and_or_uint8((uint8_t *)&node->scheduled, (uint8_t) true);
+}
+
+/* Evaluate the operation and the operations fused to it, then schedule their children. */
+template<typename ScheduleFunction>
+void evaluate_node_and_fused(DepsgraphEvalState *state,
+                             OperationNode *operation_node,
+                             ScheduleFunction *schedule_function,
+                             TaskPool *pool)
+{
+  Vector<OperationNode *, 16> operations;
+  operations.append(operation_node);
+
+  while (!operations.is_empty()) {
+    OperationNode *node = operations.pop_last();
+    if (!node->is_noop()) {
+      evaluate_node(state, node);
+    }
+    /* Claimed before scheduling children, so they are skipped there. */
+    for (OperationNode *fused = node->fused_child; fused != nullptr;
+         fused = fused->fused_sibling) {
+      if (fused_operation_take(state, fused)) {
+        operations.append(fused);
+      }
+    }
+    schedule_children(state, node, schedule_function, pool);
+  }
+}
+
 void deg_task_run_func(TaskPool *pool, void *taskdata)
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
+  /* Evaluate node and schedule children. */
   OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
+  evaluate_node_and_fused(state, operation_node, schedule_node_to_pool, pool);
+}
 
-  /* Schedule children. */
-  schedule_children(state, operation_node, schedule_node_to_pool, pool);
+bool operation_priority_less(const OperationNode *a, const OperationNode *b)
+{
+  return a->priority < b->priority;
+}
+
+void schedule_node_to_pool_by_priority(OperationNode *node,
+                                       const int UNUSED(thread_id),
+                                       TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+
+  BLI_spin_lock(&state->ready_operations_lock);
+  state->ready_operations.append(node);
+  std::push_heap(
+      state->ready_operations.begin(), state->ready_operations.end(), operation_priority_less);
+  BLI_spin_unlock(&state->ready_operations_lock);
+
+  BLI_task_pool_push(pool, deg_task_run_priority_func, NULL, false, NULL);
+}
+
+void deg_task_run_priority_func(TaskPool *pool, void *UNUSED(taskdata))
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+
+  /* There is one task per ready operation, but a task evaluates whichever operation has the
+   * highest priority when it starts, not necessarily the one it was pushed for. */
+  BLI_spin_lock(&state->ready_operations_lock);
+  BLI_assert(!state->ready_operations.is_empty());
+  std::pop_heap(
+      state->ready_operations.begin(), state->ready_operations.end(), operation_priority_less);
+  OperationNode *operation_node = state->ready_operations.pop_last();
+  BLI_spin_unlock(&state->ready_operations_lock);
+
+  evaluate_node_and_fused(state, operation_node, schedule_node_to_pool_by_priority, pool);
 }
 
 bool check_operation_node_visible(OperationNode *op_node)
@@ -178,10 +275,63 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+/* Operations which are to be evaluated, same rules as #calculate_pending_parents_for_node. */
+bool is_operation_pending(OperationNode *node)
+{
+  return (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) && check_operation_node_visible(node);
+}
+
+/* Set priority of every pending operation to the cost of the longest chain of pending operations
+ * starting at it, the critical path. Relies on pending parents being calculated. */
+void calculate_priorities(Depsgraph *graph)
+{
+  /* Pending operations in topological order. */
+  Vector<OperationNode *> order;
+  for (OperationNode *node : graph->operations) {
+    if (!is_operation_pending(node)) {
+      continue;
+    }
+    /* Operations in dependency cycles are never added to the order, use their own cost. */
+    node->priority = node->cost_estimate();
+    node->custom_flags = node->num_links_pending;
+    if (node->custom_flags == 0) {
+      order.append(node);
+    }
+  }
+  for (int64_t i = 0; i < order.size(); i++) {
+    for (Relation *rel : order[i]->outlinks) {
+      OperationNode *child = (OperationNode *)rel->to;
+      if ((rel->flag & RELATION_FLAG_CYCLIC) || !is_operation_pending(child)) {
+        continue;
+      }
+      if (--child->custom_flags == 0) {
+        order.append(child);
+      }
+    }
+  }
+
+  /* Children first, so their critical path is known when visiting their parents. */
+  for (int64_t i = order.size() - 1; i >= 0; i--) {
+    OperationNode *node = order[i];
+    double longest_child_path = 0.0;
+    for (Relation *rel : node->outlinks) {
+      OperationNode *child = (OperationNode *)rel->to;
+      if ((rel->flag & RELATION_FLAG_CYCLIC) || !is_operation_pending(child)) {
+        continue;
+      }
+      longest_child_path = max(longest_child_path, child->priority);
+    }
+    node->priority = node->cost_estimate() + longest_child_path;
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  if (state->use_priority) {
+    calculate_priorities(graph);
+  }
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -357,6 +507,21 @@ static TaskPool *deg_evaluate_task_pool_create(DepsgraphEvalState *state)
   return BLI_task_pool_create_suspended(state, TASK_PRIORITY_HIGH);
 }
 
+static void deg_evaluate_task_pool_run(DepsgraphEvalState *state)
+{
+  TaskPool *task_pool = deg_evaluate_task_pool_create(state);
+  if (state->use_priority) {
+    schedule_graph(state, schedule_node_to_pool_by_priority, task_pool);
+  }
+  else {
+    schedule_graph(state, schedule_node_to_pool, task_pool);
+  }
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+  /* Every task takes one operation from the heap. */
+  BLI_assert(state->ready_operations.is_empty());
+}
+
 /**
  * Evaluate all nodes tagged for updating,
  * \warning This is usually done as part of main loop, but may also be
@@ -380,23 +545,22 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
   state.need_single_thread_pass = false;
+  /* Ordering only matters when operations compete for threads. */
+  state.use_priority = (G.debug & (G_DEBUG_DEPSGRAPH_NO_THREADS |
+                                   G_DEBUG_DEPSGRAPH_NO_PRIORITY)) == 0 &&
+                       BLI_task_scheduler_num_threads() > 1;
+  BLI_spin_init(&state.ready_operations_lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
   /* Do actual evaluation now. */
   /* First, process all Copy-On-Write nodes. */
   state.stage = EvaluationStage::COPY_ON_WRITE;
-  TaskPool *task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
-  BLI_task_pool_work_and_wait(task_pool);
-  BLI_task_pool_free(task_pool);
+  deg_evaluate_task_pool_run(&state);
 
   /* After that, process all other nodes. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
-  task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
-  BLI_task_pool_work_and_wait(task_pool);
-  BLI_task_pool_free(task_pool);
+  deg_evaluate_task_pool_run(&state);
 
   if (state.need_single_thread_pass) {
     state.stage = EvaluationStage::SINGLE_THREADED_WORKAROUND;
@@ -413,6 +577,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   deg_graph_clear_tags(graph);
   graph->is_evaluating = false;
 
+  BLI_spin_end(&state.ready_operations_lock);
+
   graph->debug.end_graph_evaluation();
 }
 
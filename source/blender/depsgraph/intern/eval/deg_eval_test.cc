@@ -0,0 +1,428 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "BLI_listbase.h"
+#include "BLI_map.hh"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_vector.hh"
+
+#include "BKE_global.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_ID.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+/* Unique in a graph, and the same for the same operation in other graphs of the scene. */
+static std::string operation_key(const OperationNode *node)
+{
+  return node->owner->identifier() + "/" + node->full_identifier();
+}
+
+/* Operations evaluated when the graph is evaluated, same rules as the evaluation. */
+static bool is_operation_pending(const OperationNode *node)
+{
+  if ((node->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+    return false;
+  }
+  return node->owner->type == NodeType::COPY_ON_WRITE || node->owner->affects_directly_visible;
+}
+
+static bool is_metaball_operation(const OperationNode *node)
+{
+  const ID *id = node->owner->owner->id_orig;
+  return GS(id->name) == ID_OB && reinterpret_cast<const Object *>(id)->type == OB_MBALL;
+}
+
+/* Record evaluations of a graph, by wrapping the callbacks of its operations. */
+class EvaluationLog {
+ public:
+  struct PendingOperation {
+    double priority;
+    double cost;
+  };
+
+  struct Evaluation {
+    int num_evaluations = 0;
+    int begin = 0;
+    int end = 0;
+  };
+
+  /* State of the pending operations, taken before the first operation is evaluated. */
+  Map<const OperationNode *, PendingOperation> pending;
+  Map<const OperationNode *, Evaluation> evaluations;
+
+ private:
+  Depsgraph *graph_;
+  ThreadMutex mutex_;
+  int clock_ = 0;
+
+ public:
+  EvaluationLog(Depsgraph *graph) : graph_(graph)
+  {
+    BLI_mutex_init(&mutex_);
+    for (OperationNode *node : graph->operations) {
+      if (node->is_noop()) {
+        continue;
+      }
+      DepsEvalOperationCb evaluate = node->evaluate;
+      node->evaluate = [this, node, evaluate](::Depsgraph *depsgraph) {
+        begin(node);
+        evaluate(depsgraph);
+        end(node);
+      };
+    }
+  }
+
+  ~EvaluationLog()
+  {
+    BLI_mutex_end(&mutex_);
+  }
+
+  /* Keys of the evaluated operations. */
+  std::vector<std::string> evaluated_keys() const
+  {
+    std::vector<std::string> keys;
+    for (const OperationNode *node : evaluations.keys()) {
+      keys.push_back(operation_key(node));
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+  }
+
+ private:
+  void begin(const OperationNode *node)
+  {
+    BLI_mutex_lock(&mutex_);
+    /* Statistics of an operation change once it's evaluated, so the priorities and costs from
+     * the start of the evaluation are only known before the first operation finishes. */
+    if (clock_ == 0) {
+      for (const OperationNode *operation : graph_->operations) {
+        if (is_operation_pending(operation)) {
+          pending.add_new(operation, {operation->priority, operation->cost_estimate()});
+        }
+      }
+    }
+    Evaluation &evaluation = evaluations.lookup_or_add_default(node);
+    evaluation.num_evaluations++;
+    evaluation.begin = ++clock_;
+    BLI_mutex_unlock(&mutex_);
+  }
+
+  void end(const OperationNode *node)
+  {
+    BLI_mutex_lock(&mutex_);
+    evaluations.lookup(node).end = ++clock_;
+    BLI_mutex_unlock(&mutex_);
+  }
+};
+
+class DepsgraphEvaluationTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+  Vector<::Depsgraph *> graphs;
+  int debug_flags;
+
+ public:
+  static void SetUpTestCase()
+  {
+    BlendfileLoadingBaseTest::SetUpTestCase();
+    /* Operations are only ordered by priority when there are multiple threads. */
+    BLI_system_num_threads_override_set(4);
+    BLI_task_scheduler_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_task_scheduler_exit();
+    BLI_system_num_threads_override_set(0);
+    BlendfileLoadingBaseTest::TearDownTestCase();
+  }
+
+ protected:
+  virtual void SetUp()
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    debug_flags = G.debug;
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+  }
+
+  virtual void TearDown()
+  {
+    for (::Depsgraph *graph : graphs) {
+      DEG_graph_free(graph);
+    }
+    graphs.clear();
+    BKE_main_free(bmain);
+    G.debug = debug_flags;
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  Object *add_object(int type, const char *name, Object *parent = nullptr)
+  {
+    Object *object = BKE_object_add(bmain, view_layer, type, name);
+    object->parent = parent;
+    return object;
+  }
+
+  /* A tree of parented objects, so chains of different lengths are ready at the same time. */
+  void add_object_tree()
+  {
+    Vector<Object *> objects;
+    for (int i = 0; i < 12; i++) {
+      char name[MAX_ID_NAME - 2];
+      BLI_snprintf(name, sizeof(name), "Object%d", i);
+      Object *parent = (i == 0) ? nullptr : objects[(i - 1) / 2];
+      objects.append(add_object((i % 3 == 2) ? OB_EMPTY : OB_MESH, name, parent));
+    }
+  }
+
+  Object *find_object(const char *name)
+  {
+    return static_cast<Object *>(BLI_findstring(&bmain->objects, name, offsetof(ID, name)));
+  }
+
+  /* Highest priority of the operations of an object. */
+  double object_max_priority(const EvaluationLog &log, const char *name)
+  {
+    const Object *object = find_object(name);
+    double max_priority = 0.0;
+    for (const auto item : log.pending.items()) {
+      if (item.key->owner->owner->id_orig == &object->id) {
+        max_priority = std::max(max_priority, item.value.priority);
+      }
+    }
+    return max_priority;
+  }
+
+  Depsgraph *graph_build()
+  {
+    ::Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(graph);
+    graphs.append(graph);
+    return reinterpret_cast<Depsgraph *>(graph);
+  }
+
+  void graph_evaluate(Depsgraph *graph)
+  {
+    BKE_scene_graph_update_tagged(reinterpret_cast<::Depsgraph *>(graph), bmain);
+  }
+
+  /* Every operation which was waiting for others has seen all of them finish. */
+  void expect_no_links_pending(Depsgraph *graph)
+  {
+    for (const OperationNode *node : graph->operations) {
+      EXPECT_EQ(node->num_links_pending, 0u) << operation_key(node);
+    }
+  }
+
+  /* Every pending operation is evaluated once, after the operations it depends on. */
+  void expect_evaluated_once(Depsgraph *graph, const EvaluationLog &log)
+  {
+    ASSERT_FALSE(log.pending.is_empty());
+    for (const OperationNode *node : graph->operations) {
+      const bool is_pending = log.pending.contains(node) && !node->is_noop();
+      const EvaluationLog::Evaluation *evaluation = log.evaluations.lookup_ptr(node);
+      if (!is_pending) {
+        EXPECT_EQ(evaluation, nullptr) << operation_key(node);
+        continue;
+      }
+      ASSERT_NE(evaluation, nullptr) << operation_key(node);
+      EXPECT_EQ(evaluation->num_evaluations, 1) << operation_key(node);
+
+      for (const Relation *rel : node->inlinks) {
+        if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC)) {
+          continue;
+        }
+        const EvaluationLog::Evaluation *parent = log.evaluations.lookup_ptr(
+            (const OperationNode *)rel->from);
+        if (parent != nullptr) {
+          EXPECT_LT(parent->end, evaluation->begin)
+              << operation_key((const OperationNode *)rel->from) << " -> "
+              << operation_key(node);
+        }
+      }
+    }
+  }
+};
+
+/* The priority of a pending operation is the cost of the longest chain of pending operations
+ * starting at it. */
+TEST_F(DepsgraphEvaluationTest, critical_path_priorities)
+{
+  add_object_tree();
+  Depsgraph *graph = graph_build();
+  EvaluationLog log(graph);
+  graph_evaluate(graph);
+
+  ASSERT_FALSE(log.pending.is_empty());
+  for (const auto item : log.pending.items()) {
+    const OperationNode *node = item.key;
+    double longest_child_path = 0.0;
+    for (const Relation *rel : node->outlinks) {
+      const EvaluationLog::PendingOperation *child = log.pending.lookup_ptr(
+          (const OperationNode *)rel->to);
+      if (child != nullptr && (rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        longest_child_path = std::max(longest_child_path, child->priority);
+      }
+    }
+    EXPECT_DOUBLE_EQ(item.value.priority, item.value.cost + longest_child_path)
+        << operation_key(node);
+  }
+
+  /* All other objects depend on the root of the tree, the leaves only on their parents. */
+  const double root_priority = object_max_priority(log, "OBObject0");
+  const double leaf_priority = object_max_priority(log, "OBObject11");
+  EXPECT_GT(leaf_priority, 0.0);
+  EXPECT_GT(root_priority, leaf_priority);
+}
+
+/* Evaluation by priority evaluates the same operations as evaluation in the order they become
+ * ready, each of them once. */
+TEST_F(DepsgraphEvaluationTest, evaluated_once)
+{
+  add_object_tree();
+  add_object(OB_MBALL, "Metaball");
+
+  Depsgraph *graph = graph_build();
+  EvaluationLog log(graph);
+  graph_evaluate(graph);
+  expect_evaluated_once(graph, log);
+
+  G.debug |= G_DEBUG_DEPSGRAPH_NO_PRIORITY;
+  Depsgraph *graph_no_priority = graph_build();
+  EvaluationLog log_no_priority(graph_no_priority);
+  graph_evaluate(graph_no_priority);
+  expect_evaluated_once(graph_no_priority, log_no_priority);
+
+  EXPECT_EQ(log.evaluated_keys(), log_no_priority.evaluated_keys());
+}
+
+/* Tagging some objects again evaluates only their operations and the ones depending on them. */
+TEST_F(DepsgraphEvaluationTest, evaluated_once_after_tag)
+{
+  add_object_tree();
+  Depsgraph *graph = graph_build();
+  graph_evaluate(graph);
+
+  EvaluationLog log(graph);
+  Object *object = find_object("OBObject1");
+  ASSERT_NE(object, nullptr);
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM);
+  graph_evaluate(graph);
+  expect_evaluated_once(graph, log);
+  EXPECT_LT(log.evaluations.size(), graph->operations.size());
+}
+
+/* Operations are only fused to their single dependency, and fused operations which are not to be
+ * evaluated with their parent are still scheduled as usual: untagged ones, ones of invisible
+ * objects and ones of another evaluation stage (copy-on-write or metaballs). */
+TEST_F(DepsgraphEvaluationTest, fused_operations)
+{
+  add_object_tree();
+  add_object(OB_MBALL, "Metaball");
+  Object *hidden = add_object(OB_MESH, "Hidden", find_object("OBObject0"));
+  hidden->restrictflag |= OB_RESTRICT_VIEWPORT;
+  BKE_layer_collection_sync(scene, view_layer);
+
+  Depsgraph *graph = graph_build();
+  Map<const OperationNode *, const OperationNode *> fused_parents;
+  int num_fused_invisible = 0;
+  int num_fused_other_stage = 0;
+  for (const OperationNode *node : graph->operations) {
+    for (const OperationNode *fused = node->fused_child; fused != nullptr;
+         fused = fused->fused_sibling) {
+      EXPECT_TRUE(fused_parents.add(fused, node)) << operation_key(fused);
+      ASSERT_EQ(fused->inlinks.size(), 1) << operation_key(fused);
+      const Relation *rel = fused->inlinks[0];
+      EXPECT_EQ(rel->from, node) << operation_key(fused);
+      EXPECT_EQ(rel->flag & RELATION_FLAG_CYCLIC, 0) << operation_key(fused);
+
+      if (fused->owner->type != NodeType::COPY_ON_WRITE &&
+          !fused->owner->affects_directly_visible) {
+        num_fused_invisible++;
+      }
+      if ((node->owner->type == NodeType::COPY_ON_WRITE &&
+           fused->owner->type != NodeType::COPY_ON_WRITE) ||
+          is_metaball_operation(fused)) {
+        num_fused_other_stage++;
+      }
+    }
+  }
+  EXPECT_GT(num_fused_invisible, 0);
+  EXPECT_GT(num_fused_other_stage, 0);
+
+  EvaluationLog log(graph);
+  graph_evaluate(graph);
+  expect_evaluated_once(graph, log);
+  expect_no_links_pending(graph);
+
+  /* Fused operations of the root which are not tagged again are skipped. */
+  EvaluationLog log_tag(graph);
+  DEG_id_tag_update_ex(bmain, &find_object("OBObject0")->id, ID_RECALC_TRANSFORM);
+  graph_evaluate(graph);
+  expect_evaluated_once(graph, log_tag);
+  expect_no_links_pending(graph);
+
+  int num_fused_untagged = 0;
+  for (const auto item : fused_parents.items()) {
+    if (log_tag.evaluations.contains(item.value) && !item.key->is_noop() &&
+        !log_tag.evaluations.contains(item.key)) {
+      num_fused_untagged++;
+    }
+  }
+  EXPECT_GT(num_fused_untagged, 0);
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
@@ -279,6 +279,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  average_time = 0.0;
 }
 
 void Node::Stats::reset_current()
@@ -163,6 +163,9 @@ struct Node {
     void reset_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Time spend on this node, averaged over the recent graph evaluations.
+     * Only gathered for operations, and only when evaluating them by priority. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
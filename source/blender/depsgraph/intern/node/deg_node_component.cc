@@ -298,6 +298,19 @@ void ComponentNode::finalize_build(Depsgraph * /*graph*/)
   operations_map = nullptr;
 }
 
+void ComponentNode::reopen_build()
+{
+  if (operations_map != nullptr) {
+    return;
+  }
+  operations_map = new Map<ComponentNode::OperationIDKey, OperationNode *>();
+  for (OperationNode *op_node : operations) {
+    OperationIDKey key(op_node->opcode, op_node->name.c_str(), op_node->name_tag);
+    operations_map->add_new(key, op_node);
+  }
+  operations.clear();
+}
+
 /* Bone Component ========================================= */
 
 /* Initialize 'bone component' node - from pointer data given */
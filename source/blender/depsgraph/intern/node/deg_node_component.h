@@ -106,6 +106,8 @@ struct ComponentNode : public Node {
   virtual OperationNode *get_exit_operation() override;
 
   void finalize_build(Depsgraph *graph);
+  /* Revert finalize_build(), so that operations can be added to the component again. */
+  void reopen_build();
 
   IDNode *owner;
 
@@ -210,7 +210,8 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0)
+OperationNode::OperationNode()
+    : priority(0.0), fused_child(nullptr), fused_sibling(nullptr), name_tag(-1), flag(0)
 {
 }
 
@@ -265,6 +266,39 @@ void OperationNode::set_as_exit()
   owner->set_exit_operation(this);
 }
 
+double OperationNode::cost_estimate() const
+{
+  if (is_noop()) {
+    return 0.0;
+  }
+  if (stats.average_time > 0.0) {
+    return stats.average_time;
+  }
+  switch (opcode) {
+    case OperationCode::GEOMETRY_EVAL:
+    case OperationCode::PARTICLE_SYSTEM_EVAL:
+    case OperationCode::RIGIDBODY_SIM:
+    case OperationCode::FILE_CACHE_UPDATE:
+    case OperationCode::SIMULATION_EVAL:
+      return 1e-3;
+    case OperationCode::COPY_ON_WRITE:
+    case OperationCode::RIGIDBODY_REBUILD:
+    case OperationCode::POSE_IK_SOLVER:
+    case OperationCode::POSE_SPLINE_IK_SOLVER:
+    case OperationCode::SEQUENCES_EVAL:
+      return 1e-4;
+    case OperationCode::ANIMATION_EVAL:
+    case OperationCode::DRIVER:
+    case OperationCode::TRANSFORM_CONSTRAINTS:
+    case OperationCode::BONE_CONSTRAINTS:
+    case OperationCode::BONE_SEGMENTS:
+    case OperationCode::GEOMETRY_SHAPEKEY:
+      return 1e-5;
+    default:
+      return 1e-6;
+  }
+}
+
 DEG_DEPSNODE_DEFINE(OperationNode, NodeType::OPERATION, "Operation");
 static DepsNodeFactoryImpl<OperationNode> DNTI_OPERATION;
 
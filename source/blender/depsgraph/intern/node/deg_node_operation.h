@@ -256,6 +256,9 @@ struct OperationNode : public Node {
   void set_as_entry();
   void set_as_exit();
 
+  /* Evaluation time in seconds, measured when available and guessed from the opcode otherwise. */
+  double cost_estimate() const;
+
   /* Component that contains the operation. */
   ComponentNode *owner;
 
@@ -266,6 +269,15 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time of the longest chain of pending operations starting at this one.
+   * Ready operations with higher priority are evaluated first. */
+  double priority;
+
+  /* Operations which only depend on this one, evaluated in the same task right after it.
+   * Linked through fused_sibling, see #deg_graph_fuse_operations. */
+  OperationNode *fused_child;
+  OperationNode *fused_sibling;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
@@ -141,6 +141,8 @@ static int wm_alembic_export_exec(bContext *C, wmOperator *op)
       .ngon_method = RNA_enum_get(op->ptr, "ngon_method"),
 
       .global_scale = RNA_float_get(op->ptr, "global_scale"),
+
+      .concurrent_frames = RNA_int_get(op->ptr, "concurrent_frames"),
   };
 
   /* Take some defaults from the scene, if not specified explicitly. */
@@ -183,6 +185,7 @@ static void ui_alembic_export_settings(uiLayout *layout, PointerRNA *imfptr)
 
   uiItemR(col, imfptr, "xsamples", 0, IFACE_("Samples Transform"), ICON_NONE);
   uiItemR(col, imfptr, "gsamples", 0, IFACE_("Geometry"), ICON_NONE);
+  uiItemR(col, imfptr, "concurrent_frames", 0, NULL, ICON_NONE);
 
   sub = uiLayoutColumn(col, true);
   uiItemR(sub, imfptr, "sh_open", UI_ITEM_R_SLIDER, NULL, ICON_NONE);
@@ -336,6 +339,18 @@ void WM_OT_alembic_export(wmOperatorType *ot)
               1,
               128);
 
+  RNA_def_int(ot->srna,
+              "concurrent_frames",
+              1,
+              1,
+              64,
+              "Concurrent Frames",
+              "Number of frames evaluated at the same time, each using its own copy of the "
+              "evaluated scene. Speeds up the export at the cost of memory usage. Frame change "
+              "handlers are not run when more than one frame is evaluated at a time",
+              1,
+              16);
+
   RNA_def_float(ot->srna,
                 "sh_open",
                 0.0f,
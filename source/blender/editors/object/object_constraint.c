@@ -1390,7 +1390,7 @@ void ED_object_constraint_dependency_update(Main *bmain, Object *ob)
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_id_relations_tag_update(bmain, &ob->id);
 }
 
 void ED_object_constraint_tag_update(Main *bmain, Object *ob, bConstraint *con)
@@ -1423,7 +1423,7 @@ void ED_object_constraint_dependency_tag_update(Main *bmain, Object *ob, bConstr
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_id_relations_tag_update(bmain, &ob->id);
 }
 
 bool ED_object_constraint_move_to_index(Object *ob, bConstraint *con, const int index)
@@ -686,6 +686,9 @@ bool ED_object_editmode_enter_ex(Main *bmain, Scene *scene, Object *ob, int flag
     return false;
   }
 
+  /* Edit-mode data is created from the contents, which may not be read yet. */
+  BKE_main_lazy_load_ensure_id(bmain, ob->data);
+
   ob->restore_mode = ob->mode;
 
   ob->mode = OB_MODE_EDIT;
@@ -234,7 +234,7 @@ ModifierData *ED_object_modifier_add(
   }
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  DEG_id_relations_tag_update(bmain, &ob->id);
 
   return new_md;
 }
@@ -398,7 +398,7 @@ bool ED_object_modifier_remove(
   }
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  DEG_id_relations_tag_update(bmain, &ob->id);
 
   return true;
 }
@@ -831,6 +831,8 @@ bool ED_object_modifier_apply(Main *bmain,
     BKE_report(reports, RPT_ERROR, "Modifiers cannot be applied in edit mode");
     return false;
   }
+  /* The result replaces the contents, read them first so reading them later doesn't undo it. */
+  BKE_main_lazy_load_ensure_id(bmain, ob->data);
   if (mode != MODIFIER_APPLY_SHAPE && ID_REAL_USERS(ob->data) > 1) {
     BKE_report(reports, RPT_ERROR, "Modifiers cannot be applied to multi-user data");
     return false;
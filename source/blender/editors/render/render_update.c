@@ -238,6 +238,9 @@ static void texture_changed(Main *bmain, Tex *tex)
   /* icons */
   BKE_icon_changed(BKE_icon_id_ensure(&tex->id));
 
+  /* Also called for changes of the image used by the texture. */
+  ntreeCompositTagIDChanged(&tex->id);
+
   for (scene = bmain->scenes.first; scene; scene = scene->id.next) {
     /* paint overlays */
     for (view_layer = scene->view_layers.first; view_layer; view_layer = view_layer->next) {
@@ -297,6 +300,11 @@ void ED_render_id_flush_update(const DEGEditorUpdateContext *update_ctx, ID *id)
     return;
   }
   Main *bmain = update_ctx->bmain;
+  /* Cached compositor results using the ID. Scenes are only tagged for new render results,
+   * the scene settings used by the compositor are part of its cache keys. */
+  if (GS(id->name) != ID_SCE) {
+    ntreeCompositTagIDChanged(id);
+  }
   /* Internal ID update handlers. */
   switch (GS(id->name)) {
     case ID_MA:
@@ -30,11 +30,14 @@
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
 #include "BLI_math.h"
+#include "BLI_threads.h"
 #include "BLI_timecode.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
 
+#include "PIL_time.h"
+
 #include "DNA_scene_types.h"
 #include "DNA_sound_types.h"
 
@@ -144,12 +147,115 @@ static void proxy_freejob(void *pjv)
   MEM_freeN(pj);
 }
 
+/* Proxies of multiple strips are built at the same time, each thread takes the next strip
+ * from the queue. */
+typedef struct ProxyThreads {
+  SpinLock spin;
+  LinkData *link_next;
+  int index_next;
+  int num_running;
+
+  short *stop;
+  /* Progress of every strip in the queue. */
+  float *progress;
+} ProxyThreads;
+
+static void *proxy_thread_func(void *data)
+{
+  ProxyThreads *threads = data;
+
+  while (true) {
+    struct SeqIndexBuildContext *context = NULL;
+    int index = 0;
+
+    BLI_spin_lock(&threads->spin);
+    if (threads->link_next && !*threads->stop) {
+      context = threads->link_next->data;
+      index = threads->index_next;
+      threads->link_next = threads->link_next->next;
+      threads->index_next++;
+    }
+    BLI_spin_unlock(&threads->spin);
+
+    if (context == NULL) {
+      break;
+    }
+
+    short do_update;
+    BKE_sequencer_proxy_rebuild(context, threads->stop, &do_update, &threads->progress[index]);
+    threads->progress[index] = 1.0f;
+  }
+
+  BLI_spin_lock(&threads->spin);
+  threads->num_running--;
+  BLI_spin_unlock(&threads->spin);
+
+  return NULL;
+}
+
+static void proxy_build_threaded(
+    ProxyJob *pj, const int num_threads, short *stop, short *do_update, float *progress)
+{
+  const int num_contexts = BLI_listbase_count(&pj->queue);
+  ProxyThreads threads;
+  ListBase threadbase;
+
+  BLI_spin_init(&threads.spin);
+  threads.link_next = pj->queue.first;
+  threads.index_next = 0;
+  threads.num_running = num_threads;
+  threads.stop = stop;
+  threads.progress = MEM_callocN(sizeof(float) * num_contexts, "proxy threads progress");
+
+  BLI_threadpool_init(&threadbase, proxy_thread_func, num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    BLI_threadpool_insert(&threadbase, &threads);
+  }
+
+  /* Report the average progress of all strips, until all threads are done. */
+  while (true) {
+    BLI_spin_lock(&threads.spin);
+    const bool running = threads.num_running > 0;
+    BLI_spin_unlock(&threads.spin);
+
+    float progress_sum = 0.0f;
+    for (int i = 0; i < num_contexts; i++) {
+      progress_sum += threads.progress[i];
+    }
+    *progress = progress_sum / num_contexts;
+    *do_update = true;
+
+    if (!running) {
+      break;
+    }
+    PIL_sleep_ms(100);
+  }
+
+  BLI_threadpool_end(&threadbase);
+  BLI_spin_end(&threads.spin);
+  MEM_freeN(threads.progress);
+}
+
 /* Only this runs inside thread. */
 static void proxy_startjob(void *pjv, short *stop, short *do_update, float *progress)
 {
   ProxyJob *pj = pjv;
   LinkData *link;
 
+  /* Decoding and encoding of a single strip uses multiple threads already. */
+  const int num_threads = min_ii(BLI_listbase_count(&pj->queue),
+                                 max_ii(BLI_system_thread_count() / 2, 1));
+
+  if (num_threads > 1) {
+    proxy_build_threaded(pj, num_threads, stop, do_update, progress);
+
+    if (*stop) {
+      pj->stop = 1;
+      fprintf(stderr, "Canceling proxy rebuild on users request...\n");
+    }
+    return;
+  }
+
   for (link = pj->queue.first; link; link = link->next) {
     struct SeqIndexBuildContext *context = link->data;
 
@@ -72,6 +72,7 @@ BLI_INLINE unsigned char IMB_colormanagement_get_luminance_byte(const unsigned c
 BLI_INLINE void IMB_colormangement_xyz_to_rgb(float rgb[3], const float xyz[3]);
 BLI_INLINE void IMB_colormangement_rgb_to_xyz(float xyz[3], const float rgb[3]);
 const float *IMB_colormangement_get_xyz_to_rgb(void);
+void IMB_colormanagement_get_luminance_coefficients(float r_coefficients[3]);
 
 /* ** Color space transformation functions ** */
 void IMB_colormanagement_transform(float *buffer,
@@ -227,6 +228,9 @@ void IMB_display_buffer_transform_apply(unsigned char *display_buffer,
 
 void IMB_display_buffer_release(void *cache_handle);
 
+/* Use baked lookup tables instead of evaluating display transforms per pixel. */
+void IMB_colormanagement_display_lut_set_enabled(bool enabled);
+
 /* ** Display functions ** */
 int IMB_colormanagement_display_get_named_index(const char *name);
 const char *IMB_colormanagement_display_get_indexed_name(int index);
@@ -462,6 +462,27 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum eIMBScaleFilter {
+  /* Average of the covered pixels, nearest neighbor when scaling up. */
+  IMB_SCALE_FILTER_BOX = 0,
+  IMB_SCALE_FILTER_BILINEAR = 1,
+  /* Catmull-Rom spline. */
+  IMB_SCALE_FILTER_BICUBIC = 2,
+  /* Lanczos with 3 lobes. */
+  IMB_SCALE_FILTER_LANCZOS = 3,
+} eIMBScaleFilter;
+
+/**
+ * Separable, multi-threaded scaling of byte and float buffers with the given filter.
+ * When scaling down, the filter is widened so every source pixel contributes.
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_scale_filter_ImBuf(struct ImBuf *ibuf,
+                            unsigned int newx,
+                            unsigned int newy,
+                            eIMBScaleFilter filter);
+
 /**
  *
  * \attention Defined in writeimage.c
@@ -571,6 +592,8 @@ void IMB_buffer_byte_from_byte(unsigned char *rect_to,
                                int height,
                                int stride_to,
                                int stride_from);
+void IMB_buffer_half_from_float(unsigned short *rect_to, const float *rect_from, size_t len);
+void IMB_buffer_float_from_half(float *rect_to, const unsigned short *rect_from, size_t len);
 void IMB_buffer_float_unpremultiply(float *buf, int width, int height);
 void IMB_buffer_float_premultiply(float *buf, int width, int height);
 
@@ -43,13 +43,24 @@ typedef void *(*MovieCacheGetPriorityDataFP)(void *userkey);
 typedef int (*MovieCacheGetItemPriorityFP)(void *last_userkey, void *priority_data);
 typedef void (*MovieCachePriorityDeleterFP)(void *priority_data);
 
+/* Caches of each budget share a memory limit, separate from the other budgets. */
+typedef enum eMovieCacheBudget {
+  IMB_MOVIECACHE_BUDGET_DEFAULT = 0,
+  IMB_MOVIECACHE_BUDGET_IMAGE = 1,
+  /* Movie clips and motion tracking. */
+  IMB_MOVIECACHE_BUDGET_CLIP = 2,
+} eMovieCacheBudget;
+#define IMB_MOVIECACHE_BUDGET_NUM 3
+
 void IMB_moviecache_init(void);
 void IMB_moviecache_destruct(void);
+void IMB_moviecache_set_budget_limit(eMovieCacheBudget budget, size_t limit);
 
 struct MovieCache *IMB_moviecache_create(const char *name,
                                          int keysize,
                                          GHashHashFP hashfp,
                                          GHashCmpFP cmpfp);
+void IMB_moviecache_set_budget(struct MovieCache *cache, eMovieCacheBudget budget);
 void IMB_moviecache_set_getdata_callback(struct MovieCache *cache,
                                          MovieCacheGetKeyDataFP getdatafp);
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
@@ -62,6 +62,9 @@
 #  include <libavcodec/avcodec.h>
 #  include <libavformat/avformat.h>
 #  include <libswscale/swscale.h>
+
+#  include "BLI_threads.h"
+#  include "DNA_listBase.h"
 #endif
 
 /* more endianness... should move to a separate file... */
@@ -136,6 +139,32 @@ struct anim {
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+
+  /* Color conversion in horizontal bands, in parallel. */
+  struct SwsContext **img_convert_bands;
+  unsigned char **img_convert_band_buffers;
+  int img_convert_bands_num;
+  int img_convert_band_height;
+
+  /* Decoding of the following frames in a thread during sequential playback. */
+  ListBase decode_ahead_threads;
+  ThreadMutex decode_ahead_mutex;
+  ThreadCondition decode_ahead_cond;
+  /* Ring buffer of decoded frames, starting at decode_ahead_position. */
+  struct ImBuf **decode_ahead_frames;
+  /* Frame taken from the ring buffer last, at decode_ahead_position - 1. */
+  struct ImBuf *decode_ahead_last;
+  /* Memory reserved for the ring buffer from the budget shared by all anims. */
+  size_t decode_ahead_memory;
+  int decode_ahead_size;
+  int decode_ahead_first;
+  int decode_ahead_len;
+  int decode_ahead_position;
+  IMB_Timecode_Type decode_ahead_tc;
+  int decode_ahead_sequential;
+  bool decode_ahead_running;
+  bool decode_ahead_stop;
+  bool decode_ahead_done;
 #endif
 
   char index_dir[768];
@@ -151,3 +180,7 @@ struct anim {
 
   struct IDProperty *metadata;
 };
+
+#ifdef WITH_FFMPEG
+void IMB_anim_decode_ahead_stop(struct anim *anim);
+#endif
@@ -126,6 +126,31 @@ void colorspace_set_default_role(char *colorspace, int size, int role);
 void colormanage_imbuf_set_default_spaces(struct ImBuf *ibuf);
 void colormanage_imbuf_make_linear(struct ImBuf *ibuf, const char *from_colorspace);
 
+/* ** Baked display transforms, see colormanagement_lut.c ** */
+
+typedef struct ColormanageDisplayLUT ColormanageDisplayLUT;
+
+/* Transform len packed RGB pixels in place. */
+typedef void (*ColormanageLUTEvalFunc)(void *userdata, float *rgb, int len);
+
+bool colormanage_display_lut_is_enabled(void);
+int colormanage_display_lut_bake_threshold(void);
+ColormanageDisplayLUT *colormanage_display_lut_acquire(
+    const char *key, bool is_float, bool bake, ColormanageLUTEvalFunc eval, void *userdata);
+void colormanage_display_lut_release(ColormanageDisplayLUT *lut);
+void colormanage_display_lut_free_all(void);
+void colormanage_display_lut_apply_float(const ColormanageDisplayLUT *lut,
+                                         float *buffer,
+                                         size_t num_pixels,
+                                         int channels,
+                                         bool predivide,
+                                         ColormanageLUTEvalFunc eval,
+                                         void *userdata);
+void colormanage_display_lut_apply_byte(const ColormanageDisplayLUT *lut,
+                                        const unsigned char *buffer,
+                                        float *r_buffer,
+                                        size_t num_pixels);
+
 #ifdef __cplusplus
 }
 #endif
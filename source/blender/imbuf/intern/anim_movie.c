@@ -53,8 +53,12 @@
 #  include <io.h>
 #endif
 
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "MEM_guardedalloc.h"
@@ -78,6 +82,7 @@
 
 #  include <libavcodec/avcodec.h>
 #  include <libavformat/avformat.h>
+#  include <libavutil/pixdesc.h>
 #  include <libavutil/rational.h>
 #  include <libswscale/swscale.h>
 
@@ -505,6 +510,60 @@ BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
   return (anim->x & 31) != 0;
 }
 
+/* Conversion of \a height rows of the decoded frames to RGBA, in the color space of the video. */
+static struct SwsContext *ffmpeg_sws_context_create(struct anim *anim, int height, int flags)
+{
+  struct SwsContext *sws_ctx = sws_getContext(anim->x,
+                                              height,
+                                              anim->pCodecCtx->pix_fmt,
+                                              anim->x,
+                                              height,
+                                              AV_PIX_FMT_RGBA,
+                                              SWS_FAST_BILINEAR | SWS_FULL_CHR_H_INT | flags,
+                                              NULL,
+                                              NULL,
+                                              NULL);
+  if (!sws_ctx) {
+    return NULL;
+  }
+
+#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+  /* The following for color space determination */
+  int srcRange, dstRange, brightness, contrast, saturation;
+  int *table;
+  const int *inv_table;
+
+  /* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
+  if (!sws_getColorspaceDetails(sws_ctx,
+                                (int **)&inv_table,
+                                &srcRange,
+                                &table,
+                                &dstRange,
+                                &brightness,
+                                &contrast,
+                                &saturation)) {
+    srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
+    inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+
+    if (sws_setColorspaceDetails(sws_ctx,
+                                 (int *)inv_table,
+                                 srcRange,
+                                 table,
+                                 dstRange,
+                                 brightness,
+                                 contrast,
+                                 saturation)) {
+      fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+    }
+  }
+  else {
+    fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+  }
+#  endif
+
+  return sws_ctx;
+}
+
 static int startffmpeg(struct anim *anim)
 {
   int i, video_stream_index;
@@ -518,13 +577,6 @@ static int startffmpeg(struct anim *anim)
   double frs_den;
   int streamcount;
 
-#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-  /* The following for color space determination */
-  int srcRange, dstRange, brightness, contrast, saturation;
-  int *table;
-  const int *inv_table;
-#  endif
-
   if (anim == NULL) {
     return (-1);
   }
@@ -573,6 +625,23 @@ static int startffmpeg(struct anim *anim)
 
   pCodecCtx->workaround_bugs = 1;
 
+  /* Decode in multiple threads, frame threading gives the best scaling but is not supported by
+   * all codecs. It delays the output by one frame per thread, the delayed frames are drained
+   * at the end of the stream by #ffmpeg_decode_video_frame. */
+  if (pCodec->capabilities & AV_CODEC_CAP_AUTO_THREADS) {
+    pCodecCtx->thread_count = 0;
+  }
+  else {
+    pCodecCtx->thread_count = BLI_system_thread_count();
+  }
+
+  if (pCodec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_FRAME;
+  }
+  else if (pCodec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_SLICE;
+  }
+
   if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
     avformat_close_input(&pFormatCtx);
     return -1;
@@ -692,16 +761,7 @@ static int startffmpeg(struct anim *anim)
     anim->preseek = 0;
   }
 
-  anim->img_convert_ctx = sws_getContext(anim->x,
-                                         anim->y,
-                                         anim->pCodecCtx->pix_fmt,
-                                         anim->x,
-                                         anim->y,
-                                         AV_PIX_FMT_RGBA,
-                                         SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT,
-                                         NULL,
-                                         NULL,
-                                         NULL);
+  anim->img_convert_ctx = ffmpeg_sws_context_create(anim, anim->y, SWS_PRINT_INFO);
 
   if (!anim->img_convert_ctx) {
     fprintf(stderr, "Can't transform color space??? Bailing out...\n");
@@ -714,84 +774,24 @@ static int startffmpeg(struct anim *anim)
     return -1;
   }
 
-#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-  /* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
-  if (!sws_getColorspaceDetails(anim->img_convert_ctx,
-                                (int **)&inv_table,
-                                &srcRange,
-                                &table,
-                                &dstRange,
-                                &brightness,
-                                &contrast,
-                                &saturation)) {
-    srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
-    inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+  anim->img_convert_bands = NULL;
+  anim->img_convert_band_buffers = NULL;
+  anim->img_convert_bands_num = 0;
 
-    if (sws_setColorspaceDetails(anim->img_convert_ctx,
-                                 (int *)inv_table,
-                                 srcRange,
-                                 table,
-                                 dstRange,
-                                 brightness,
-                                 contrast,
-                                 saturation)) {
-      fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-    }
-  }
-  else {
-    fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-  }
-#  endif
+  BLI_listbase_clear(&anim->decode_ahead_threads);
+  BLI_mutex_init(&anim->decode_ahead_mutex);
+  BLI_condition_init(&anim->decode_ahead_cond);
+  anim->decode_ahead_frames = NULL;
+  anim->decode_ahead_last = NULL;
+  anim->decode_ahead_len = 0;
+  anim->decode_ahead_sequential = 0;
+  anim->decode_ahead_running = false;
 
   return 0;
 }
 
-/* postprocess the image in anim->pFrame and do color conversion
- * and deinterlacing stuff.
- *
- * Output is anim->last_frame
- */
-
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_convert_frame(struct anim *anim, AVFrame *input, ImBuf *ibuf)
 {
-  AVFrame *input = anim->pFrame;
-  ImBuf *ibuf = anim->last_frame;
-  int filter_y = 0;
-
-  if (!anim->pFrameComplete) {
-    return;
-  }
-
-  /* This means the data wasn't read properly,
-   * this check stops crashing */
-  if (input->data[0] == 0 && input->data[1] == 0 && input->data[2] == 0 && input->data[3] == 0) {
-    fprintf(stderr,
-            "ffmpeg_fetchibuf: "
-            "data not read properly...\n");
-    return;
-  }
-
-  av_log(anim->pFormatCtx,
-         AV_LOG_DEBUG,
-         "  POSTPROC: anim->pFrame planes: %p %p %p %p\n",
-         input->data[0],
-         input->data[1],
-         input->data[2],
-         input->data[3]);
-
-  if (anim->ib_flags & IB_animdeinterlace) {
-    if (avpicture_deinterlace((AVPicture *)anim->pFrameDeinterlaced,
-                              (const AVPicture *)anim->pFrame,
-                              anim->pCodecCtx->pix_fmt,
-                              anim->pCodecCtx->width,
-                              anim->pCodecCtx->height) < 0) {
-      filter_y = true;
-    }
-    else {
-      input = anim->pFrameDeinterlaced;
-    }
-  }
-
   if (!need_aligned_ffmpeg_buffer(anim)) {
     avpicture_fill((AVPicture *)anim->pFrameRGB,
                    (unsigned char *)ibuf->rect,
@@ -870,6 +870,212 @@ static void ffmpeg_postprocess(struct anim *anim)
       src += anim->pFrameRGB->linesize[0];
     }
   }
+}
+
+/* Rows converted by a thread, a multiple of 16 so chroma planes start at a whole row. */
+#  define FFMPEG_CONVERT_BAND_MIN_HEIGHT 64
+/* Source rows converted above and below a band, so the vertical chroma interpolation at the
+ * borders of the band gives the same result as the conversion of the whole frame. */
+#  define FFMPEG_CONVERT_BAND_MARGIN 16
+
+static int ffmpeg_convert_band_stride(struct anim *anim)
+{
+  /* Aligned like the frame buffer, see #need_aligned_ffmpeg_buffer. */
+  return (anim->x * 4 + 31) & ~31;
+}
+
+static void ffmpeg_convert_band_rows(
+    struct anim *anim, int band, int *r_y_start, int *r_y_end, int *r_src_start, int *r_src_end)
+{
+  *r_y_start = band * anim->img_convert_band_height;
+  *r_y_end = min_ii(*r_y_start + anim->img_convert_band_height, anim->y);
+  *r_src_start = max_ii(*r_y_start - FFMPEG_CONVERT_BAND_MARGIN, 0);
+  *r_src_end = min_ii(*r_y_end + FFMPEG_CONVERT_BAND_MARGIN, anim->y);
+}
+
+static void ffmpeg_convert_bands_free(struct anim *anim)
+{
+  for (int band = 0; band < anim->img_convert_bands_num; band++) {
+    if (anim->img_convert_bands) {
+      sws_freeContext(anim->img_convert_bands[band]);
+    }
+    if (anim->img_convert_band_buffers && anim->img_convert_band_buffers[band]) {
+      MEM_freeN(anim->img_convert_band_buffers[band]);
+    }
+  }
+  MEM_SAFE_FREE(anim->img_convert_bands);
+  MEM_SAFE_FREE(anim->img_convert_band_buffers);
+  anim->img_convert_bands_num = 0;
+}
+
+/* Create the conversion contexts for the bands on first use.
+ * Returns false when the frames are converted as a whole. */
+static bool ffmpeg_convert_bands_init(struct anim *anim)
+{
+  if (anim->img_convert_bands_num != 0) {
+    return anim->img_convert_bands != NULL;
+  }
+
+  /* Converted as a whole unless all bands can be set up. */
+  anim->img_convert_bands_num = 1;
+
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(anim->pCodecCtx->pix_fmt);
+  const int num_threads = BLI_system_thread_count();
+  if (desc == NULL || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM)) ||
+      num_threads < 2 || ENDIAN_ORDER == B_ENDIAN) {
+    return false;
+  }
+
+  int band_height = (anim->y + num_threads - 1) / num_threads;
+  band_height = max_ii((band_height + 15) & ~15, FFMPEG_CONVERT_BAND_MIN_HEIGHT);
+  const int num_bands = (anim->y + band_height - 1) / band_height;
+  if (num_bands < 2) {
+    return false;
+  }
+
+  anim->img_convert_band_height = band_height;
+  anim->img_convert_bands_num = num_bands;
+  anim->img_convert_bands = MEM_callocN(sizeof(*anim->img_convert_bands) * num_bands,
+                                        "ffmpeg convert bands");
+  anim->img_convert_band_buffers = MEM_callocN(
+      sizeof(*anim->img_convert_band_buffers) * num_bands, "ffmpeg convert band buffers");
+
+  for (int band = 0; band < num_bands; band++) {
+    int y_start, y_end, src_start, src_end;
+    ffmpeg_convert_band_rows(anim, band, &y_start, &y_end, &src_start, &src_end);
+
+    anim->img_convert_bands[band] = ffmpeg_sws_context_create(anim, src_end - src_start, 0);
+    if (anim->img_convert_bands[band] == NULL) {
+      ffmpeg_convert_bands_free(anim);
+      anim->img_convert_bands_num = 1;
+      return false;
+    }
+    anim->img_convert_band_buffers[band] = MEM_mallocN_aligned(
+        (size_t)ffmpeg_convert_band_stride(anim) * (src_end - src_start),
+        32,
+        "ffmpeg convert band buffer");
+  }
+
+  return true;
+}
+
+typedef struct FFmpegConvertBandData {
+  struct anim *anim;
+  AVFrame *input;
+  ImBuf *ibuf;
+} FFmpegConvertBandData;
+
+static void ffmpeg_convert_band(void *__restrict userdata,
+                                const int band,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  FFmpegConvertBandData *data = userdata;
+  struct anim *anim = data->anim;
+  AVFrame *input = data->input;
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(anim->pCodecCtx->pix_fmt);
+  const int num_planes = av_pix_fmt_count_planes(anim->pCodecCtx->pix_fmt);
+  const int stride = ffmpeg_convert_band_stride(anim);
+  int y_start, y_end, src_start, src_end;
+
+  ffmpeg_convert_band_rows(anim, band, &y_start, &y_end, &src_start, &src_end);
+
+  /* The rows of the band, any palette is passed as is. */
+  const uint8_t *src[4];
+  for (int plane = 0; plane < 4; plane++) {
+    src[plane] = input->data[plane];
+    if (plane < num_planes) {
+      const int shift = ELEM(plane, 1, 2) ? desc->log2_chroma_h : 0;
+      src[plane] += (src_start >> shift) * input->linesize[plane];
+    }
+  }
+
+  uint8_t *buffer = anim->img_convert_band_buffers[band];
+  uint8_t *dst[4] = {buffer, NULL, NULL, NULL};
+  const int dst_stride[4] = {stride, 0, 0, 0};
+
+  sws_scale(anim->img_convert_bands[band],
+            src,
+            input->linesize,
+            0,
+            src_end - src_start,
+            dst,
+            dst_stride);
+
+  /* Copy the rows of the band without the margins, flipped vertically. */
+  for (int y = y_start; y < y_end; y++) {
+    memcpy((uint8_t *)data->ibuf->rect + (size_t)(anim->y - 1 - y) * anim->x * 4,
+           buffer + (size_t)(y - src_start) * stride,
+           (size_t)anim->x * 4);
+  }
+}
+
+/* Convert the frame in horizontal bands, each thread using its own conversion context. */
+static void ffmpeg_convert_bands(struct anim *anim, AVFrame *input, ImBuf *ibuf)
+{
+  FFmpegConvertBandData data = {
+      .anim = anim,
+      .input = input,
+      .ibuf = ibuf,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, anim->img_convert_bands_num, &data, ffmpeg_convert_band, &settings);
+}
+
+/* postprocess the image in anim->pFrame and do color conversion
+ * and deinterlacing stuff.
+ *
+ * Output is anim->last_frame
+ */
+
+static void ffmpeg_postprocess(struct anim *anim)
+{
+  AVFrame *input = anim->pFrame;
+  ImBuf *ibuf = anim->last_frame;
+  int filter_y = 0;
+
+  if (!anim->pFrameComplete) {
+    return;
+  }
+
+  /* This means the data wasn't read properly,
+   * this check stops crashing */
+  if (input->data[0] == 0 && input->data[1] == 0 && input->data[2] == 0 && input->data[3] == 0) {
+    fprintf(stderr,
+            "ffmpeg_fetchibuf: "
+            "data not read properly...\n");
+    return;
+  }
+
+  av_log(anim->pFormatCtx,
+         AV_LOG_DEBUG,
+         "  POSTPROC: anim->pFrame planes: %p %p %p %p\n",
+         input->data[0],
+         input->data[1],
+         input->data[2],
+         input->data[3]);
+
+  if (anim->ib_flags & IB_animdeinterlace) {
+    if (avpicture_deinterlace((AVPicture *)anim->pFrameDeinterlaced,
+                              (const AVPicture *)anim->pFrame,
+                              anim->pCodecCtx->pix_fmt,
+                              anim->pCodecCtx->width,
+                              anim->pCodecCtx->height) < 0) {
+      filter_y = true;
+    }
+    else {
+      input = anim->pFrameDeinterlaced;
+    }
+  }
+
+  if (ffmpeg_convert_bands_init(anim)) {
+    ffmpeg_convert_bands(anim, input, ibuf);
+  }
+  else {
+    ffmpeg_convert_frame(anim, input, ibuf);
+  }
 
   if (filter_y) {
     IMB_filtery(ibuf);
@@ -1048,7 +1254,7 @@ static int ffmpeg_seek_by_byte(AVFormatContext *pFormatCtx)
   return false;
 }
 
-static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
+static ImBuf *ffmpeg_fetchibuf_decode(struct anim *anim, int position, IMB_Timecode_Type tc)
 {
   int64_t pts_to_search = 0;
   double frame_rate;
@@ -1243,6 +1449,226 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   return anim->last_frame;
 }
 
+/* Frames decoded ahead during sequential playback, see #ffmpeg_fetchibuf. The ring buffers of
+ * all anims together are limited to this size. */
+#  define FFMPEG_DECODE_AHEAD_MEMORY ((size_t)256 * 1024 * 1024)
+#  define FFMPEG_DECODE_AHEAD_MAX_FRAMES 8
+
+/* Memory reserved by the ring buffers of all anims that decode ahead. */
+static size_t ffmpeg_decode_ahead_memory = 0;
+static ThreadMutex ffmpeg_decode_ahead_memory_mutex = BLI_MUTEX_INITIALIZER;
+
+/* Reserve memory for the ring buffer of \a anim, as many frames as fit in what other anims left
+ * of the budget. Returns the number of frames, zero when there is no room for a single one. */
+static int ffmpeg_decode_ahead_memory_reserve(struct anim *anim)
+{
+  const size_t framesize = max_zz(anim->framesize, 1);
+
+  BLI_mutex_lock(&ffmpeg_decode_ahead_memory_mutex);
+  const size_t available = FFMPEG_DECODE_AHEAD_MEMORY - ffmpeg_decode_ahead_memory;
+  const int size = (int)min_zz(available / framesize, FFMPEG_DECODE_AHEAD_MAX_FRAMES);
+  anim->decode_ahead_memory = size * framesize;
+  ffmpeg_decode_ahead_memory += anim->decode_ahead_memory;
+  BLI_mutex_unlock(&ffmpeg_decode_ahead_memory_mutex);
+
+  return size;
+}
+
+static void ffmpeg_decode_ahead_memory_release(struct anim *anim)
+{
+  BLI_mutex_lock(&ffmpeg_decode_ahead_memory_mutex);
+  ffmpeg_decode_ahead_memory -= anim->decode_ahead_memory;
+  BLI_mutex_unlock(&ffmpeg_decode_ahead_memory_mutex);
+  anim->decode_ahead_memory = 0;
+}
+
+static void ffmpeg_decode_ahead_pop(struct anim *anim)
+{
+  anim->decode_ahead_first = (anim->decode_ahead_first + 1) % anim->decode_ahead_size;
+  anim->decode_ahead_len--;
+  anim->decode_ahead_position++;
+}
+
+static void *ffmpeg_decode_ahead_thread(void *anim_v)
+{
+  struct anim *anim = anim_v;
+
+  BLI_mutex_lock(&anim->decode_ahead_mutex);
+  while (!anim->decode_ahead_stop) {
+    if (anim->decode_ahead_len == anim->decode_ahead_size) {
+      BLI_condition_wait(&anim->decode_ahead_cond, &anim->decode_ahead_mutex);
+      continue;
+    }
+
+    const int position = anim->decode_ahead_position + anim->decode_ahead_len;
+    if (position >= anim->duration_in_frames) {
+      break;
+    }
+
+    /* The decoding state of the anim is only used by this thread while it runs. */
+    BLI_mutex_unlock(&anim->decode_ahead_mutex);
+    ImBuf *ibuf = ffmpeg_fetchibuf_decode(anim, position, anim->decode_ahead_tc);
+    BLI_mutex_lock(&anim->decode_ahead_mutex);
+
+    if (ibuf == NULL) {
+      break;
+    }
+
+    const int index = (anim->decode_ahead_first + anim->decode_ahead_len) %
+                      anim->decode_ahead_size;
+    anim->decode_ahead_frames[index] = ibuf;
+    anim->decode_ahead_len++;
+    BLI_condition_notify_all(&anim->decode_ahead_cond);
+  }
+
+  anim->decode_ahead_done = true;
+  BLI_condition_notify_all(&anim->decode_ahead_cond);
+  BLI_mutex_unlock(&anim->decode_ahead_mutex);
+
+  return NULL;
+}
+
+static void ffmpeg_decode_ahead_start(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+  /* Other movies playing at the same time may use all of the memory. */
+  anim->decode_ahead_size = ffmpeg_decode_ahead_memory_reserve(anim);
+  if (anim->decode_ahead_size == 0) {
+    return;
+  }
+
+  if (anim->decode_ahead_frames == NULL) {
+    anim->decode_ahead_frames = MEM_callocN(
+        sizeof(*anim->decode_ahead_frames) * FFMPEG_DECODE_AHEAD_MAX_FRAMES, "ffmpeg decode ahead");
+  }
+
+  anim->decode_ahead_first = 0;
+  anim->decode_ahead_len = 0;
+  anim->decode_ahead_position = position;
+  anim->decode_ahead_tc = tc;
+  anim->decode_ahead_stop = false;
+  anim->decode_ahead_done = false;
+
+  BLI_threadpool_init(&anim->decode_ahead_threads, ffmpeg_decode_ahead_thread, 1);
+  BLI_threadpool_insert(&anim->decode_ahead_threads, anim);
+  anim->decode_ahead_running = true;
+}
+
+void IMB_anim_decode_ahead_stop(struct anim *anim)
+{
+  if (!anim->decode_ahead_running) {
+    return;
+  }
+
+  BLI_mutex_lock(&anim->decode_ahead_mutex);
+  anim->decode_ahead_stop = true;
+  BLI_condition_notify_all(&anim->decode_ahead_cond);
+  BLI_mutex_unlock(&anim->decode_ahead_mutex);
+
+  BLI_threadpool_end(&anim->decode_ahead_threads);
+  anim->decode_ahead_running = false;
+
+  while (anim->decode_ahead_len > 0) {
+    IMB_freeImBuf(anim->decode_ahead_frames[anim->decode_ahead_first]);
+    ffmpeg_decode_ahead_pop(anim);
+  }
+  if (anim->decode_ahead_last) {
+    IMB_freeImBuf(anim->decode_ahead_last);
+    anim->decode_ahead_last = NULL;
+  }
+
+  ffmpeg_decode_ahead_memory_release(anim);
+}
+
+/* Take the frame at \a position from the frames decoded ahead, waiting for it when the thread is
+ * about to decode it. The frame taken last can be requested again, like when playback is slower
+ * than the frame rate of the movie. Returns NULL when the thread won't decode the frame. */
+static ImBuf *ffmpeg_decode_ahead_take(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+  ImBuf *ibuf = NULL;
+
+  if (!anim->decode_ahead_running || tc != anim->decode_ahead_tc) {
+    return NULL;
+  }
+
+  if (anim->decode_ahead_last && position == anim->decode_ahead_position - 1) {
+    IMB_refImBuf(anim->decode_ahead_last);
+    return anim->decode_ahead_last;
+  }
+
+  BLI_mutex_lock(&anim->decode_ahead_mutex);
+  if (position >= anim->decode_ahead_position) {
+    while (true) {
+      /* Skipped frames are not needed anymore. */
+      while (anim->decode_ahead_len > 0 && anim->decode_ahead_position < position) {
+        IMB_freeImBuf(anim->decode_ahead_frames[anim->decode_ahead_first]);
+        ffmpeg_decode_ahead_pop(anim);
+        BLI_condition_notify_all(&anim->decode_ahead_cond);
+      }
+
+      if (anim->decode_ahead_len > 0) {
+        ibuf = anim->decode_ahead_frames[anim->decode_ahead_first];
+        ffmpeg_decode_ahead_pop(anim);
+        BLI_condition_notify_all(&anim->decode_ahead_cond);
+        break;
+      }
+
+      if (anim->decode_ahead_done ||
+          position - anim->decode_ahead_position >= anim->decode_ahead_size) {
+        break;
+      }
+
+      BLI_condition_wait(&anim->decode_ahead_cond, &anim->decode_ahead_mutex);
+    }
+  }
+  BLI_mutex_unlock(&anim->decode_ahead_mutex);
+
+  if (ibuf) {
+    if (anim->decode_ahead_last) {
+      IMB_freeImBuf(anim->decode_ahead_last);
+    }
+    IMB_refImBuf(ibuf);
+    anim->decode_ahead_last = ibuf;
+  }
+
+  return ibuf;
+}
+
+static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+  ImBuf *ibuf = ffmpeg_decode_ahead_take(anim, position, tc);
+  if (ibuf) {
+    return ibuf;
+  }
+
+  /* Random access, the decoding state is used here again. */
+  IMB_anim_decode_ahead_stop(anim);
+
+  const bool sequential = (position == anim->curposition + 1);
+  const bool repeated = (position == anim->curposition);
+  ibuf = ffmpeg_fetchibuf_decode(anim, position, tc);
+  if (ibuf == NULL) {
+    return NULL;
+  }
+
+  /* Start decoding the following frames in the background once frames are requested in order,
+   * and keep it running until a frame is requested out of order. Single steps, like while
+   * scrubbing, don't waste time decoding frames that are not used. Repeated frames don't
+   * interrupt playback. */
+  if (!repeated) {
+    anim->decode_ahead_sequential = sequential ? anim->decode_ahead_sequential + 1 : 0;
+  }
+  if (anim->decode_ahead_sequential >= 2 && position + 1 < anim->duration_in_frames &&
+      BLI_system_thread_count() > 1) {
+    ffmpeg_decode_ahead_start(anim, position + 1, tc);
+    if (anim->decode_ahead_running) {
+      IMB_refImBuf(ibuf);
+      anim->decode_ahead_last = ibuf;
+    }
+  }
+
+  return ibuf;
+}
+
 static void free_anim_ffmpeg(struct anim *anim)
 {
   if (anim == NULL) {
@@ -1250,6 +1676,11 @@ static void free_anim_ffmpeg(struct anim *anim)
   }
 
   if (anim->pCodecCtx) {
+    IMB_anim_decode_ahead_stop(anim);
+    MEM_SAFE_FREE(anim->decode_ahead_frames);
+    BLI_condition_end(&anim->decode_ahead_cond);
+    BLI_mutex_end(&anim->decode_ahead_mutex);
+
     avcodec_close(anim->pCodecCtx);
     avformat_close_input(&anim->pFormatCtx);
 
@@ -1272,6 +1703,7 @@ static void free_anim_ffmpeg(struct anim *anim)
     av_frame_free(&anim->pFrameDeinterlaced);
 
     sws_freeContext(anim->img_convert_ctx);
+    ffmpeg_convert_bands_free(anim);
     IMB_freeImBuf(anim->last_frame);
     if (anim->next_packet.stream_index != -1) {
       av_free_packet(&anim->next_packet);
@@ -1429,10 +1861,9 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
 #endif
 #ifdef WITH_FFMPEG
     case ANIM_FFMPEG:
+      /* Sets the current position internally, while frames are decoded ahead it is the position
+       * of the last decoded frame. */
       ibuf = ffmpeg_fetchibuf(anim, position, tc);
-      if (ibuf) {
-        anim->curposition = position;
-      }
       filter_y = 0; /* done internally */
       break;
 #endif
@@ -1442,7 +1873,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
     if (filter_y) {
       IMB_filtery(ibuf);
     }
-    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->curposition + 1);
+    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
   }
   return ibuf;
 }
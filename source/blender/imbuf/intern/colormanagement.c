@@ -757,6 +757,7 @@ void colormanagement_exit(void)
   memset(&global_glsl_state, 0, sizeof(global_glsl_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  colormanage_display_lut_free_all();
   colormanage_free_config();
 }
 
@@ -1478,6 +1479,13 @@ const float *IMB_colormangement_get_xyz_to_rgb()
   return &imbuf_xyz_to_rgb[0][0];
 }
 
+/* Coefficients used by IMB_colormanagement_get_luminance(), for code that computes it for many
+ * pixels at once. */
+void IMB_colormanagement_get_luminance_coefficients(float r_coefficients[3])
+{
+  copy_v3_v3(r_coefficients, imbuf_luma_coefficients);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1486,6 +1494,7 @@ const float *IMB_colormangement_get_xyz_to_rgb()
 
 typedef struct DisplayBufferThread {
   ColormanageProcessor *cm_processor;
+  ColormanageDisplayLUT *display_lut;
 
   const float *buffer;
   unsigned char *byte_buffer;
@@ -1509,6 +1518,7 @@ typedef struct DisplayBufferThread {
 typedef struct DisplayBufferInitData {
   ImBuf *ibuf;
   ColormanageProcessor *cm_processor;
+  ColormanageDisplayLUT *display_lut;
   const float *buffer;
   unsigned char *byte_buffer;
 
@@ -1540,6 +1550,7 @@ static void display_buffer_init_handle(void *handle_v,
   memset(handle, 0, sizeof(DisplayBufferThread));
 
   handle->cm_processor = init_data->cm_processor;
+  handle->display_lut = init_data->display_lut;
 
   if (init_data->buffer) {
     handle->buffer = init_data->buffer + offset;
@@ -1650,6 +1661,78 @@ static void display_buffer_apply_get_linear_buffer(DisplayBufferThread *handle,
   }
 }
 
+/* Evaluates the display transform for baking float LUTs, and for pixels outside of their range. */
+static void display_lut_eval_float(void *userdata, float *rgb, int len)
+{
+  ColormanageProcessor *cm_processor = userdata;
+  IMB_colormanagement_processor_apply(cm_processor, rgb, len, 1, 3, false);
+}
+
+typedef struct DisplayLUTByteEvalData {
+  ColormanageProcessor *cm_processor;
+  const char *byte_colorspace;
+} DisplayLUTByteEvalData;
+
+/* Same transform as the byte path of #do_display_buffer_apply_thread. */
+static void display_lut_eval_byte(void *userdata, float *rgb, int len)
+{
+  DisplayLUTByteEvalData *data = userdata;
+
+  if (!data->cm_processor->is_data_result) {
+    IMB_colormanagement_transform(
+        rgb, len, 1, 3, data->byte_colorspace, global_role_scene_linear, false);
+  }
+  IMB_colormanagement_processor_apply(data->cm_processor, rgb, len, 1, 3, false);
+}
+
+/* Get a baked LUT for the display transform of ibuf, when the transform can be baked. */
+static ColormanageDisplayLUT *display_lut_acquire(
+    ImBuf *ibuf,
+    ColormanageProcessor *cm_processor,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  const bool is_float = ibuf->rect_float != NULL;
+
+  if (!colormanage_display_lut_is_enabled() || cm_processor->curve_mapping ||
+      (ibuf->colormanage_flag & IMB_COLORMANAGE_IS_DATA)) {
+    return NULL;
+  }
+  if (is_float ? !ELEM(ibuf->channels, 3, 4) : (ibuf->rect == NULL || ibuf->channels != 4)) {
+    return NULL;
+  }
+
+  ColorManagedViewSettings default_view_settings;
+  if (view_settings == NULL) {
+    IMB_colormanagement_init_default_view_settings(&default_view_settings, display_settings);
+    view_settings = &default_view_settings;
+  }
+
+  DisplayLUTByteEvalData byte_data;
+  byte_data.cm_processor = cm_processor;
+  byte_data.byte_colorspace = (ibuf->rect_colorspace) ? ibuf->rect_colorspace->name :
+                                                        global_role_default_byte;
+
+  char key[512];
+  BLI_snprintf(key,
+               sizeof(key),
+               "%s|%s|%s|%s|%f|%f",
+               is_float ? "" : byte_data.byte_colorspace,
+               view_settings->look,
+               view_settings->view_transform,
+               display_settings->display_device,
+               view_settings->exposure,
+               view_settings->gamma);
+
+  /* Use a cached LUT for any image, but only bake for images with more pixels than the LUT. */
+  const bool bake = ((size_t)ibuf->x) * ibuf->y >= colormanage_display_lut_bake_threshold();
+
+  if (is_float) {
+    return colormanage_display_lut_acquire(key, true, bake, display_lut_eval_float, cm_processor);
+  }
+  return colormanage_display_lut_acquire(key, false, bake, display_lut_eval_byte, &byte_data);
+}
+
 static void *do_display_buffer_apply_thread(void *handle_v)
 {
   DisplayBufferThread *handle = (DisplayBufferThread *)handle_v;
@@ -1692,7 +1775,17 @@ static void *do_display_buffer_apply_thread(void *handle_v)
     float *linear_buffer = MEM_mallocN(((size_t)channels) * width * height * sizeof(float),
                                        "color conversion linear buffer");
 
-    display_buffer_apply_get_linear_buffer(handle, height, linear_buffer, &is_straight_alpha);
+    const bool use_byte_lut = handle->display_lut && !handle->buffer;
+
+    if (use_byte_lut) {
+      /* Byte to linear and display transform in one step. */
+      colormanage_display_lut_apply_byte(
+          handle->display_lut, handle->byte_buffer, linear_buffer, ((size_t)width) * height);
+      is_straight_alpha = true;
+    }
+    else {
+      display_buffer_apply_get_linear_buffer(handle, height, linear_buffer, &is_straight_alpha);
+    }
 
     bool predivide = handle->predivide && (is_straight_alpha == false);
 
@@ -1701,6 +1794,18 @@ static void *do_display_buffer_apply_thread(void *handle_v)
        * only generate byte buffers
        */
     }
+    else if (use_byte_lut) {
+      /* Already applied. */
+    }
+    else if (handle->display_lut) {
+      colormanage_display_lut_apply_float(handle->display_lut,
+                                          linear_buffer,
+                                          ((size_t)width) * height,
+                                          channels,
+                                          predivide,
+                                          display_lut_eval_float,
+                                          cm_processor);
+    }
     else {
       /* apply processor */
       IMB_colormanagement_processor_apply(
@@ -1748,12 +1853,14 @@ static void display_buffer_apply_threaded(ImBuf *ibuf,
                                           unsigned char *byte_buffer,
                                           float *display_buffer,
                                           unsigned char *display_buffer_byte,
-                                          ColormanageProcessor *cm_processor)
+                                          ColormanageProcessor *cm_processor,
+                                          ColormanageDisplayLUT *display_lut)
 {
   DisplayBufferInitData init_data;
 
   init_data.ibuf = ibuf;
   init_data.cm_processor = cm_processor;
+  init_data.display_lut = display_lut;
   init_data.buffer = buffer;
   init_data.byte_buffer = byte_buffer;
   init_data.display_buffer = display_buffer;
@@ -1806,27 +1913,39 @@ static bool is_ibuf_rect_in_display_space(ImBuf *ibuf,
   return false;
 }
 
-static void colormanage_display_buffer_process_ex(
+/* Processor computing the display buffer of ibuf, NULL when no transform is needed. */
+static ColormanageProcessor *display_buffer_processor_new(
     ImBuf *ibuf,
-    float *display_buffer,
-    unsigned char *display_buffer_byte,
     const ColorManagedViewSettings *view_settings,
     const ColorManagedDisplaySettings *display_settings)
 {
-  ColormanageProcessor *cm_processor = NULL;
-  bool skip_transform = false;
-
   /* if we're going to transform byte buffer, check whether transformation would
    * happen to the same color space as byte buffer itself is
    * this would save byte -> float -> byte conversions making display buffer
    * computation noticeable faster
    */
-  if (ibuf->rect_float == NULL && ibuf->rect_colorspace) {
-    skip_transform = is_ibuf_rect_in_display_space(ibuf, view_settings, display_settings);
+  if (ibuf->rect_float == NULL && ibuf->rect_colorspace &&
+      is_ibuf_rect_in_display_space(ibuf, view_settings, display_settings)) {
+    return NULL;
   }
 
-  if (skip_transform == false) {
-    cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+  return IMB_colormanagement_display_processor_new(view_settings, display_settings);
+}
+
+static void colormanage_display_buffer_process_ex(
+    ImBuf *ibuf,
+    float *display_buffer,
+    unsigned char *display_buffer_byte,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  ColormanageProcessor *cm_processor = display_buffer_processor_new(
+      ibuf, view_settings, display_settings);
+  ColormanageDisplayLUT *display_lut = NULL;
+
+  /* Only byte display buffers, float ones keep the full precision. */
+  if (cm_processor && display_buffer == NULL) {
+    display_lut = display_lut_acquire(ibuf, cm_processor, view_settings, display_settings);
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -1834,7 +1953,12 @@ static void colormanage_display_buffer_process_ex(
                                 (unsigned char *)ibuf->rect,
                                 display_buffer,
                                 display_buffer_byte,
-                                cm_processor);
+                                cm_processor,
+                                display_lut);
+
+  if (display_lut) {
+    colormanage_display_lut_release(display_lut);
+  }
 
   if (cm_processor) {
     IMB_colormanagement_processor_free(cm_processor);
@@ -1843,11 +1967,16 @@ static void colormanage_display_buffer_process_ex(
 
 static void colormanage_display_buffer_process(ImBuf *ibuf,
                                                unsigned char *display_buffer,
-                                               const ColorManagedViewSettings *view_settings,
-                                               const ColorManagedDisplaySettings *display_settings)
+                                               ColormanageProcessor *cm_processor,
+                                               ColormanageDisplayLUT *display_lut)
 {
-  colormanage_display_buffer_process_ex(
-      ibuf, NULL, display_buffer, view_settings, display_settings);
+  display_buffer_apply_threaded(ibuf,
+                                ibuf->rect_float,
+                                (unsigned char *)ibuf->rect,
+                                NULL,
+                                display_buffer,
+                                cm_processor,
+                                display_lut);
 }
 
 /** \} */
@@ -2788,17 +2917,40 @@ unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf,
     return display_buffer;
   }
 
-  buffer_size = DISPLAY_BUFFER_CHANNELS * ((size_t)ibuf->x) * ibuf->y * sizeof(char);
-  display_buffer = MEM_callocN(buffer_size, "imbuf display buffer");
+  /* Baking a display LUT evaluates the transform for many colors, don't block other threads
+   * acquiring display buffers meanwhile. */
+  BLI_thread_unlock(LOCK_COLORMANAGE);
+  ColormanageProcessor *cm_processor = display_buffer_processor_new(
+      ibuf, applied_view_settings, display_settings);
+  ColormanageDisplayLUT *display_lut = NULL;
+  if (cm_processor) {
+    display_lut = display_lut_acquire(ibuf, cm_processor, applied_view_settings, display_settings);
+  }
+  BLI_thread_lock(LOCK_COLORMANAGE);
 
-  colormanage_display_buffer_process(
-      ibuf, display_buffer, applied_view_settings, display_settings);
+  /* Another thread may have computed the display buffer in the meantime. */
+  display_buffer = colormanage_cache_get(
+      ibuf, &cache_view_settings, &cache_display_settings, cache_handle);
+
+  if (display_buffer == NULL) {
+    buffer_size = DISPLAY_BUFFER_CHANNELS * ((size_t)ibuf->x) * ibuf->y * sizeof(char);
+    display_buffer = MEM_callocN(buffer_size, "imbuf display buffer");
 
-  colormanage_cache_put(
-      ibuf, &cache_view_settings, &cache_display_settings, display_buffer, cache_handle);
+    colormanage_display_buffer_process(ibuf, display_buffer, cm_processor, display_lut);
+
+    colormanage_cache_put(
+        ibuf, &cache_view_settings, &cache_display_settings, display_buffer, cache_handle);
+  }
 
   BLI_thread_unlock(LOCK_COLORMANAGE);
 
+  if (display_lut) {
+    colormanage_display_lut_release(display_lut);
+  }
+  if (cm_processor) {
+    IMB_colormanagement_processor_free(cm_processor);
+  }
+
   return display_buffer;
 }
 
@@ -0,0 +1,500 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup imbuf
+ *
+ * Display transforms baked into 3D lookup tables.
+ *
+ * Evaluating OCIO processors per pixel is the main cost of computing display buffers. A LUT
+ * evaluates the transform once per lattice point, pixels are then interpolated tetrahedrally
+ * between the 4 lattice points around them.
+ *
+ * - Byte LUTs take byte colors, a uniform lattice covers the whole input range.
+ * - Float LUTs take scene linear colors. A 1D shaper maps them to the lattice, linear below
+ *   #LUT_FLOAT_TOE and logarithmic up to #LUT_FLOAT_MAX, so every stop gets a similar number of
+ *   lattice points. Pixels outside of that range are evaluated exactly.
+ *
+ * Interpolation blurs transforms that aren't smooth, like the hard edges of False Color, so LUTs
+ * are only used when enabled in the preferences.
+ *
+ * LUTs are cached by the key of their transform and shared between threads.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_colormanagement_intern.h"
+
+/* Lattice points per axis. */
+#define LUT_SIZE 65
+
+/* Scene linear range of float LUTs, values in between are spaced by log2. The 63 cells above
+ * the toe cover 21 stops, so 1.0 is a lattice point and the clipping of views like Standard
+ * isn't interpolated. */
+#define LUT_FLOAT_TOE_LOG2 -12.0f
+#define LUT_FLOAT_TOE 0.000244140625f /* 2^-12 */
+#define LUT_FLOAT_MAX_LOG2 9.0f
+#define LUT_FLOAT_MAX 512.0f /* 2^9 */
+
+/* Number of LUTs kept, a few views and displays are commonly used at the same time. */
+#define LUT_CACHE_SIZE 4
+
+/* Pixels outside of the range of float LUTs are gathered and evaluated in chunks this size. */
+#define LUT_EXACT_CHUNK_SIZE 256
+
+typedef struct ColormanageDisplayLUT {
+  char key[512];
+  bool is_float;
+  int size;
+  /* Lattice of RGB results, padded to 4 floats, red index changes fastest. */
+  float *lattice;
+  /* Users of the LUT, it's freed when removed from the cache and unused. */
+  int users;
+  /* Least recently used LUT is removed from the cache first. */
+  uint64_t last_used;
+} ColormanageDisplayLUT;
+
+static ColormanageDisplayLUT *lut_cache[LUT_CACHE_SIZE] = {NULL};
+static uint64_t lut_cache_clock = 0;
+static ThreadMutex lut_cache_lock = BLI_MUTEX_INITIALIZER;
+static bool lut_enabled = false;
+
+/* -------------------------------------------------------------------- */
+/** \name Shaper
+ * \{ */
+
+/* Maps scene linear values to lattice coordinates in [0, size - 1]. The first cell is linear
+ * from 0 to the toe, the others are spaced by log2. */
+BLI_INLINE float lut_float_shaper(float value, int size)
+{
+  if (value < LUT_FLOAT_TOE) {
+    return value * (1.0f / LUT_FLOAT_TOE);
+  }
+  return 1.0f + (log2f(value) - LUT_FLOAT_TOE_LOG2) * ((float)(size - 2) /
+                                                       (LUT_FLOAT_MAX_LOG2 - LUT_FLOAT_TOE_LOG2));
+}
+
+static float lut_float_shaper_inverse(int index, int size)
+{
+  if (index == 0) {
+    return 0.0f;
+  }
+  /* Divide last, so lattice points at whole stops are exact. */
+  return powf(2.0f,
+              LUT_FLOAT_TOE_LOG2 + (float)(index - 1) *
+                                       (LUT_FLOAT_MAX_LOG2 - LUT_FLOAT_TOE_LOG2) /
+                                       (float)(size - 2));
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Baking
+ * \{ */
+
+typedef struct LUTBakeData {
+  ColormanageDisplayLUT *lut;
+  ColormanageLUTEvalFunc eval;
+  void *userdata;
+} LUTBakeData;
+
+/* Evaluates one slice of the lattice with constant blue. */
+static void lut_bake_slice(void *__restrict userdata,
+                           const int b,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LUTBakeData *data = userdata;
+  ColormanageDisplayLUT *lut = data->lut;
+  const int size = lut->size;
+  const int slice_len = size * size;
+  float *rgb = MEM_mallocN(sizeof(float[3]) * slice_len, "display LUT slice");
+  float *coords = MEM_mallocN(sizeof(float) * size, "display LUT coords");
+
+  for (int i = 0; i < size; i++) {
+    coords[i] = lut->is_float ? lut_float_shaper_inverse(i, size) : (float)i / (size - 1);
+  }
+
+  for (int g = 0; g < size; g++) {
+    for (int r = 0; r < size; r++) {
+      float *pixel = rgb + 3 * (g * size + r);
+      pixel[0] = coords[r];
+      pixel[1] = coords[g];
+      pixel[2] = coords[b];
+    }
+  }
+
+  data->eval(data->userdata, rgb, slice_len);
+
+  float *lattice = lut->lattice + (size_t)4 * b * slice_len;
+  for (int i = 0; i < slice_len; i++) {
+    lattice[i * 4 + 0] = rgb[i * 3 + 0];
+    lattice[i * 4 + 1] = rgb[i * 3 + 1];
+    lattice[i * 4 + 2] = rgb[i * 3 + 2];
+    lattice[i * 4 + 3] = 0.0f;
+  }
+
+  MEM_freeN(coords);
+  MEM_freeN(rgb);
+}
+
+static ColormanageDisplayLUT *lut_bake(const char *key,
+                                       bool is_float,
+                                       ColormanageLUTEvalFunc eval,
+                                       void *userdata)
+{
+  ColormanageDisplayLUT *lut = MEM_callocN(sizeof(ColormanageDisplayLUT), "display LUT");
+  BLI_strncpy(lut->key, key, sizeof(lut->key));
+  lut->is_float = is_float;
+  lut->size = LUT_SIZE;
+  lut->lattice = MEM_mallocN(sizeof(float[4]) * lut->size * lut->size * lut->size,
+                             "display LUT lattice");
+
+  LUTBakeData data = {lut, eval, userdata};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, lut->size, &data, lut_bake_slice, &settings);
+
+  return lut;
+}
+
+static void lut_free(ColormanageDisplayLUT *lut)
+{
+  MEM_freeN(lut->lattice);
+  MEM_freeN(lut);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Cache
+ * \{ */
+
+void IMB_colormanagement_display_lut_set_enabled(bool enabled)
+{
+  lut_enabled = enabled;
+}
+
+bool colormanage_display_lut_is_enabled(void)
+{
+  return lut_enabled;
+}
+
+/* Baking evaluates as many pixels as there are lattice points, it's only worth it for images
+ * with more pixels than that. */
+int colormanage_display_lut_bake_threshold(void)
+{
+  return LUT_SIZE * LUT_SIZE * LUT_SIZE;
+}
+
+/* Find a cached LUT, otherwise return the slot to store it in. The cache must be locked. */
+static ColormanageDisplayLUT *lut_cache_find(const char *key, bool is_float, int *r_free_slot)
+{
+  int free_slot = 0;
+
+  for (int i = 0; i < LUT_CACHE_SIZE; i++) {
+    ColormanageDisplayLUT *cached = lut_cache[i];
+    if (cached == NULL) {
+      free_slot = i;
+      continue;
+    }
+    if (cached->is_float == is_float && STREQ(cached->key, key)) {
+      return cached;
+    }
+    if (lut_cache[free_slot] && cached->last_used < lut_cache[free_slot]->last_used) {
+      free_slot = i;
+    }
+  }
+
+  *r_free_slot = free_slot;
+  return NULL;
+}
+
+/**
+ * Get the LUT for the transform identified by key. When it's not cached, it's baked with eval
+ * if bake is true, otherwise NULL is returned. Must be released with
+ * #colormanage_display_lut_release.
+ */
+ColormanageDisplayLUT *colormanage_display_lut_acquire(
+    const char *key, bool is_float, bool bake, ColormanageLUTEvalFunc eval, void *userdata)
+{
+  int free_slot;
+
+  BLI_mutex_lock(&lut_cache_lock);
+  ColormanageDisplayLUT *lut = lut_cache_find(key, is_float, &free_slot);
+
+  if (lut == NULL && bake) {
+    /* Bake without the lock, so drawing with other LUTs isn't blocked. Threads baking the same
+     * LUT at the same time both bake it, the first one to finish publishes it. */
+    BLI_mutex_unlock(&lut_cache_lock);
+    ColormanageDisplayLUT *baked = lut_bake(key, is_float, eval, userdata);
+    BLI_mutex_lock(&lut_cache_lock);
+
+    lut = lut_cache_find(key, is_float, &free_slot);
+    if (lut) {
+      lut_free(baked);
+    }
+    else {
+      lut = baked;
+      ColormanageDisplayLUT *removed = lut_cache[free_slot];
+      if (removed && removed->users == 0) {
+        lut_free(removed);
+      }
+      else if (removed) {
+        /* Freed by the last user. */
+        removed->key[0] = '\0';
+      }
+      lut_cache[free_slot] = lut;
+    }
+  }
+
+  if (lut) {
+    lut->users++;
+    lut->last_used = ++lut_cache_clock;
+  }
+
+  BLI_mutex_unlock(&lut_cache_lock);
+
+  return lut;
+}
+
+static bool lut_is_cached(const ColormanageDisplayLUT *lut)
+{
+  for (int i = 0; i < LUT_CACHE_SIZE; i++) {
+    if (lut_cache[i] == lut) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void colormanage_display_lut_release(ColormanageDisplayLUT *lut)
+{
+  BLI_mutex_lock(&lut_cache_lock);
+  lut->users--;
+  if (lut->users == 0 && !lut_is_cached(lut)) {
+    lut_free(lut);
+  }
+  BLI_mutex_unlock(&lut_cache_lock);
+}
+
+/* Free all cached LUTs, when the configuration changes or on exit. */
+void colormanage_display_lut_free_all(void)
+{
+  BLI_mutex_lock(&lut_cache_lock);
+  for (int i = 0; i < LUT_CACHE_SIZE; i++) {
+    ColormanageDisplayLUT *lut = lut_cache[i];
+    lut_cache[i] = NULL;
+    if (lut && lut->users == 0) {
+      lut_free(lut);
+    }
+  }
+  BLI_mutex_unlock(&lut_cache_lock);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Tetrahedral Interpolation
+ * \{ */
+
+/* Interpolate at lattice coordinates in [0, size - 1], writes RGB. */
+BLI_INLINE void lut_interpolate(const ColormanageDisplayLUT *lut, const float coord[3], float *out)
+{
+  const int size = lut->size;
+  const int max_cell = size - 2;
+  const int ri = min_ii((int)coord[0], max_cell);
+  const int gi = min_ii((int)coord[1], max_cell);
+  const int bi = min_ii((int)coord[2], max_cell);
+  const float fr = coord[0] - (float)ri;
+  const float fg = coord[1] - (float)gi;
+  const float fb = coord[2] - (float)bi;
+
+  const size_t stride_r = 4;
+  const size_t stride_g = (size_t)4 * size;
+  const size_t stride_b = (size_t)4 * size * size;
+  const float *c000 = lut->lattice + ri * stride_r + gi * stride_g + bi * stride_b;
+  const float *c111 = c000 + stride_r + stride_g + stride_b;
+
+  /* Walk from the lattice point at the origin of the cell to the opposite one, along the axes
+   * sorted by their fraction. */
+  const float *c1, *c2;
+  float w0, w1, w2, w3;
+  if (fr >= fg) {
+    if (fg >= fb) {
+      c1 = c000 + stride_r;
+      c2 = c1 + stride_g;
+      w0 = 1.0f - fr, w1 = fr - fg, w2 = fg - fb, w3 = fb;
+    }
+    else if (fr >= fb) {
+      c1 = c000 + stride_r;
+      c2 = c1 + stride_b;
+      w0 = 1.0f - fr, w1 = fr - fb, w2 = fb - fg, w3 = fg;
+    }
+    else {
+      c1 = c000 + stride_b;
+      c2 = c1 + stride_r;
+      w0 = 1.0f - fb, w1 = fb - fr, w2 = fr - fg, w3 = fg;
+    }
+  }
+  else {
+    if (fb >= fg) {
+      c1 = c000 + stride_b;
+      c2 = c1 + stride_g;
+      w0 = 1.0f - fb, w1 = fb - fg, w2 = fg - fr, w3 = fr;
+    }
+    else if (fb >= fr) {
+      c1 = c000 + stride_g;
+      c2 = c1 + stride_b;
+      w0 = 1.0f - fg, w1 = fg - fb, w2 = fb - fr, w3 = fr;
+    }
+    else {
+      c1 = c000 + stride_g;
+      c2 = c1 + stride_r;
+      w0 = 1.0f - fg, w1 = fg - fr, w2 = fr - fb, w3 = fb;
+    }
+  }
+
+#ifdef __SSE2__
+  __m128 result = _mm_mul_ps(_mm_loadu_ps(c000), _mm_set1_ps(w0));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(c1), _mm_set1_ps(w1)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(c2), _mm_set1_ps(w2)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(c111), _mm_set1_ps(w3)));
+  float result_v[4];
+  _mm_storeu_ps(result_v, result);
+  out[0] = result_v[0];
+  out[1] = result_v[1];
+  out[2] = result_v[2];
+#else
+  for (int c = 0; c < 3; c++) {
+    out[c] = w0 * c000[c] + w1 * c1[c] + w2 * c2[c] + w3 * c111[c];
+  }
+#endif
+}
+
+/* Evaluate gathered pixels in one call and write them back premultiplied. */
+static void lut_apply_exact(float (*rgb)[3],
+                            const float *alpha,
+                            float **pixel,
+                            int len,
+                            ColormanageLUTEvalFunc eval,
+                            void *userdata)
+{
+  eval(userdata, rgb[0], len);
+  for (int i = 0; i < len; i++) {
+    mul_v3_v3fl(pixel[i], rgb[i], alpha[i]);
+  }
+}
+
+/**
+ * Apply a float LUT to scene linear pixels with 3 or 4 channels, in place. Pixels outside of the
+ * range of the LUT are gathered and transformed with eval.
+ */
+void colormanage_display_lut_apply_float(const ColormanageDisplayLUT *lut,
+                                         float *buffer,
+                                         size_t num_pixels,
+                                         int channels,
+                                         bool predivide,
+                                         ColormanageLUTEvalFunc eval,
+                                         void *userdata)
+{
+  BLI_assert(lut->is_float && ELEM(channels, 3, 4));
+  const int size = lut->size;
+
+  /* Pixels outside of the range of the LUT, with their alpha and their position in buffer. */
+  float exact_rgb[LUT_EXACT_CHUNK_SIZE][3];
+  float exact_alpha[LUT_EXACT_CHUNK_SIZE];
+  float *exact_pixel[LUT_EXACT_CHUNK_SIZE];
+  int exact_len = 0;
+
+  for (size_t i = 0; i < num_pixels; i++) {
+    float *pixel = buffer + i * channels;
+    float alpha = 1.0f;
+    float rgb[3] = {pixel[0], pixel[1], pixel[2]};
+
+    /* Same as OCIO_processorApplyRGBA_predivide. */
+    if (predivide && channels == 4 && pixel[3] != 1.0f && pixel[3] != 0.0f) {
+      alpha = pixel[3];
+      const float inv_alpha = 1.0f / alpha;
+      rgb[0] *= inv_alpha;
+      rgb[1] *= inv_alpha;
+      rgb[2] *= inv_alpha;
+    }
+
+    if (rgb[0] >= 0.0f && rgb[1] >= 0.0f && rgb[2] >= 0.0f && rgb[0] <= LUT_FLOAT_MAX &&
+        rgb[1] <= LUT_FLOAT_MAX && rgb[2] <= LUT_FLOAT_MAX) {
+      const float coord[3] = {lut_float_shaper(rgb[0], size),
+                              lut_float_shaper(rgb[1], size),
+                              lut_float_shaper(rgb[2], size)};
+      lut_interpolate(lut, coord, rgb);
+
+      pixel[0] = rgb[0] * alpha;
+      pixel[1] = rgb[1] * alpha;
+      pixel[2] = rgb[2] * alpha;
+      continue;
+    }
+
+    copy_v3_v3(exact_rgb[exact_len], rgb);
+    exact_alpha[exact_len] = alpha;
+    exact_pixel[exact_len] = pixel;
+    exact_len++;
+
+    if (exact_len == LUT_EXACT_CHUNK_SIZE) {
+      lut_apply_exact(exact_rgb, exact_alpha, exact_pixel, exact_len, eval, userdata);
+      exact_len = 0;
+    }
+  }
+
+  if (exact_len != 0) {
+    lut_apply_exact(exact_rgb, exact_alpha, exact_pixel, exact_len, eval, userdata);
+  }
+}
+
+/**
+ * Apply a byte LUT to RGBA byte pixels, writing float pixels with straight alpha.
+ */
+void colormanage_display_lut_apply_byte(const ColormanageDisplayLUT *lut,
+                                        const unsigned char *buffer,
+                                        float *r_buffer,
+                                        size_t num_pixels)
+{
+  BLI_assert(!lut->is_float);
+  const float scale = (float)(lut->size - 1) / 255.0f;
+
+  for (size_t i = 0; i < num_pixels; i++) {
+    const unsigned char *pixel = buffer + i * 4;
+    float *r_pixel = r_buffer + i * 4;
+    const float coord[3] = {pixel[0] * scale, pixel[1] * scale, pixel[2] * scale};
+    lut_interpolate(lut, coord, r_pixel);
+    r_pixel[3] = pixel[3] * (1.0f / 255.0f);
+  }
+}
+
+/** \} */
@@ -35,6 +35,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#ifdef __F16C__
+#  include <immintrin.h>
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name Floyd-Steinberg dithering
  * \{ */
@@ -711,6 +715,101 @@ void IMB_buffer_byte_from_byte(uchar *rect_to,
   }
 }
 
+/* Conversion of single values between float and half float (IEEE 754 binary16), rounding to
+ * nearest even. Values too large for half float become infinite, NaN stays NaN. */
+static unsigned short half_from_float(const float value)
+{
+  union {
+    float f;
+    uint u;
+  } in, denorm;
+  const uint f32_infinity = 255u << 23;
+  const uint f16_overflow = (127u + 16u) << 23;
+  const uint f16_denorm_min = 113u << 23;
+  const uint denorm_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  in.f = value;
+  const uint sign = in.u & 0x80000000u;
+  in.u ^= sign;
+
+  unsigned short result;
+  if (in.u >= f16_overflow) {
+    result = (in.u > f32_infinity) ? 0x7e00 : 0x7c00;
+  }
+  else if (in.u < f16_denorm_min) {
+    /* Denormal or zero, let float addition align and round the mantissa. */
+    denorm.u = denorm_magic;
+    in.f += denorm.f;
+    result = (unsigned short)(in.u - denorm_magic);
+  }
+  else {
+    const uint mantissa_odd = (in.u >> 13) & 1u;
+    /* Re-bias the exponent and round. */
+    in.u += ((uint)(15 - 127) << 23) + 0xfffu;
+    in.u += mantissa_odd;
+    result = (unsigned short)(in.u >> 13);
+  }
+
+  return result | (unsigned short)(sign >> 16);
+}
+
+static float float_from_half(const unsigned short value)
+{
+  union {
+    float f;
+    uint u;
+  } out, denorm;
+  const uint shifted_exponent = 0x7c00u << 13;
+
+  out.u = ((uint)value & 0x7fffu) << 13;
+  const uint exponent = out.u & shifted_exponent;
+  out.u += (127u - 15u) << 23;
+
+  if (exponent == shifted_exponent) {
+    /* Infinity or NaN. */
+    out.u += (128u - 16u) << 23;
+  }
+  else if (exponent == 0) {
+    /* Zero or denormal, renormalize. */
+    denorm.u = 113u << 23;
+    out.u += 1u << 23;
+    out.f -= denorm.f;
+  }
+
+  out.u |= ((uint)value & 0x8000u) << 16;
+  return out.f;
+}
+
+/* float to half float values, for storing float images with half the memory. */
+void IMB_buffer_half_from_float(unsigned short *rect_to, const float *rect_from, size_t len)
+{
+  size_t i = 0;
+#ifdef __F16C__
+  for (; i + 4 <= len; i += 4) {
+    const __m128i half = _mm_cvtps_ph(_mm_loadu_ps(rect_from + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storel_epi64((__m128i *)(rect_to + i), half);
+  }
+#endif
+  for (; i < len; i++) {
+    rect_to[i] = half_from_float(rect_from[i]);
+  }
+}
+
+/* half float to float values, see #IMB_buffer_half_from_float. */
+void IMB_buffer_float_from_half(float *rect_to, const unsigned short *rect_from, size_t len)
+{
+  size_t i = 0;
+#ifdef __F16C__
+  for (; i + 4 <= len; i += 4) {
+    const __m128i half = _mm_loadl_epi64((const __m128i *)(rect_from + i));
+    _mm_storeu_ps(rect_to + i, _mm_cvtph_ps(half));
+  }
+#endif
+  for (; i < len; i++) {
+    rect_to[i] = float_from_half(rect_from[i]);
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -29,6 +29,7 @@
 #include "BLI_ghash.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #ifdef _WIN32
 #  include "BLI_winstuff.h"
@@ -444,6 +445,10 @@ typedef struct IndexBuildContext {
 
 #ifdef WITH_FFMPEG
 
+/* Number of decoded frames waiting to be encoded into a proxy, limits memory usage when
+ * encoding is slower than decoding. */
+#  define PROXY_QUEUE_SIZE 8
+
 struct proxy_output_ctx {
   AVFormatContext *of;
   AVStream *st;
@@ -455,6 +460,13 @@ struct proxy_output_ctx {
   int proxy_size;
   int orig_height;
   struct anim *anim;
+
+  /* Every proxy size is scaled and encoded by its own thread, while decoding continues. */
+  ThreadMutex queue_mutex;
+  ThreadCondition queue_cond;
+  AVFrame *queue[PROXY_QUEUE_SIZE];
+  int queue_first, queue_len;
+  bool queue_finished;
 };
 
 // work around stupid swscaler 16 bytes alignment bug...
@@ -475,6 +487,9 @@ static struct proxy_output_ctx *alloc_proxy_output_ffmpeg(
   rv->proxy_size = proxy_size;
   rv->anim = anim;
 
+  BLI_mutex_init(&rv->queue_mutex);
+  BLI_condition_init(&rv->queue_cond);
+
   get_proxy_filename(rv->anim, rv->proxy_size, fname, true);
   BLI_make_existing_file(fname);
 
@@ -632,6 +647,61 @@ static int add_to_proxy_output_ffmpeg(struct proxy_output_ctx *ctx, AVFrame *fra
   return 0;
 }
 
+/* Hand a reference to a decoded frame over to the thread encoding the proxy,
+ * waits when too many frames are queued already. */
+static void proxy_output_queue_push(struct proxy_output_ctx *ctx, AVFrame *frame)
+{
+  BLI_mutex_lock(&ctx->queue_mutex);
+  while (ctx->queue_len == PROXY_QUEUE_SIZE) {
+    BLI_condition_wait(&ctx->queue_cond, &ctx->queue_mutex);
+  }
+  ctx->queue[(ctx->queue_first + ctx->queue_len) % PROXY_QUEUE_SIZE] = frame;
+  ctx->queue_len++;
+  BLI_condition_notify_all(&ctx->queue_cond);
+  BLI_mutex_unlock(&ctx->queue_mutex);
+}
+
+/* Returns NULL when all frames have been taken and no more frames will be added. */
+static AVFrame *proxy_output_queue_pop(struct proxy_output_ctx *ctx)
+{
+  AVFrame *frame = NULL;
+
+  BLI_mutex_lock(&ctx->queue_mutex);
+  while (ctx->queue_len == 0 && !ctx->queue_finished) {
+    BLI_condition_wait(&ctx->queue_cond, &ctx->queue_mutex);
+  }
+  if (ctx->queue_len > 0) {
+    frame = ctx->queue[ctx->queue_first];
+    ctx->queue_first = (ctx->queue_first + 1) % PROXY_QUEUE_SIZE;
+    ctx->queue_len--;
+    BLI_condition_notify_all(&ctx->queue_cond);
+  }
+  BLI_mutex_unlock(&ctx->queue_mutex);
+
+  return frame;
+}
+
+static void proxy_output_queue_finish(struct proxy_output_ctx *ctx)
+{
+  BLI_mutex_lock(&ctx->queue_mutex);
+  ctx->queue_finished = true;
+  BLI_condition_notify_all(&ctx->queue_cond);
+  BLI_mutex_unlock(&ctx->queue_mutex);
+}
+
+static void *proxy_output_thread(void *data)
+{
+  struct proxy_output_ctx *ctx = data;
+  AVFrame *frame;
+
+  while ((frame = proxy_output_queue_pop(ctx))) {
+    add_to_proxy_output_ffmpeg(ctx, frame);
+    av_frame_free(&frame);
+  }
+
+  return NULL;
+}
+
 static void free_proxy_output_ffmpeg(struct proxy_output_ctx *ctx, int rollback)
 {
   char fname[FILE_MAX];
@@ -666,6 +736,9 @@ static void free_proxy_output_ffmpeg(struct proxy_output_ctx *ctx, int rollback)
     av_free(ctx->frame);
   }
 
+  BLI_mutex_end(&ctx->queue_mutex);
+  BLI_condition_end(&ctx->queue_cond);
+
   get_proxy_filename(ctx->anim, ctx->proxy_size, fname_tmp, true);
 
   if (rollback) {
@@ -774,6 +847,13 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
 
   context->iCodecCtx->workaround_bugs = 1;
 
+  /* Frame threading delays decoded frames, which would give them the seek position of a later
+   * packet in the timecode index. Slicing threads don't have that problem. */
+  if (context->iCodec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    context->iCodecCtx->thread_count = BLI_system_thread_count();
+    context->iCodecCtx->thread_type = FF_THREAD_SLICE;
+  }
+
   if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
     avformat_close_input(&context->iFormatCtx);
     MEM_freeN(context);
@@ -843,7 +923,12 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
   unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
   for (i = 0; i < context->num_proxy_sizes; i++) {
-    add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+    /* New reference to the frame data, the decoder doesn't reuse the buffers until the
+     * frame is encoded and freed. */
+    AVFrame *frame = context->proxy_ctx[i] ? av_frame_clone(in_frame) : NULL;
+    if (frame) {
+      proxy_output_queue_push(context->proxy_ctx[i], frame);
+    }
   }
 
   if (!context->start_pts_set) {
@@ -895,11 +980,20 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
   AVFrame *in_frame = 0;
   AVPacket next_packet;
   uint64_t stream_size;
+  ListBase threads;
+  int i;
 
   memset(&next_packet, 0, sizeof(AVPacket));
 
   in_frame = av_frame_alloc();
 
+  BLI_threadpool_init(&threads, proxy_output_thread, context->num_proxy_sizes);
+  for (i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      BLI_threadpool_insert(&threads, context->proxy_ctx[i]);
+    }
+  }
+
   stream_size = avio_size(context->iFormatCtx->pb);
 
   context->frame_rate = av_q2d(av_guess_frame_rate(context->iFormatCtx, context->iStream, NULL));
@@ -960,6 +1054,14 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
     } while (frame_finished);
   }
 
+  /* Wait for all queued frames to be encoded. */
+  for (i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      proxy_output_queue_finish(context->proxy_ctx[i]);
+    }
+  }
+  BLI_threadpool_end(&threads);
+
   av_free(in_frame);
 
   return 1;
@@ -1261,6 +1363,11 @@ void IMB_free_indices(struct anim *anim)
 {
   int i;
 
+#ifdef WITH_FFMPEG
+  /* The decoding thread uses the time-code index. */
+  IMB_anim_decode_ahead_stop(anim);
+#endif
+
   for (i = 0; i < IMB_PROXY_MAX_SLOT; i++) {
     if (anim->proxy_anim[i]) {
       IMB_close_anim(anim->proxy_anim[i]);
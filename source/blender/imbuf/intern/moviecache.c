@@ -35,6 +35,8 @@
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "atomic_ops.h"
+
 #include "IMB_moviecache.h"
 
 #include "IMB_imbuf.h"
@@ -50,8 +52,24 @@
 #  define PRINT(format, ...)
 #endif
 
-static MEM_CacheLimiterC *limitor = NULL;
-static pthread_mutex_t limitor_lock = BLI_MUTEX_INITIALIZER;
+/* Every budget has its own limiter and lock, so caches of different budgets don't wait for
+ * each other when putting or getting images. The global memory cache limit applies to the sum
+ * of all budgets, see #moviecache_enforce_global_limit. */
+typedef struct MovieCacheLimiter {
+  MEM_CacheLimiterC *limitor;
+  pthread_mutex_t lock;
+  /* Maximum memory in bytes, 0 to only use the global limit. */
+  size_t budget;
+  /* Copy of the memory in use of limitor, so it can be read without lock. */
+  size_t memory_in_use;
+} MovieCacheLimiter;
+
+static MovieCacheLimiter limiters[IMB_MOVIECACHE_BUDGET_NUM] = {
+    {NULL, BLI_MUTEX_INITIALIZER, 0, 0},
+    {NULL, BLI_MUTEX_INITIALIZER, 0, 0},
+    {NULL, BLI_MUTEX_INITIALIZER, 0, 0},
+};
+static size_t limiters_memory_in_use = 0;
 
 typedef struct MovieCache {
   char name[64];
@@ -74,7 +92,8 @@ typedef struct MovieCache {
   void *last_userkey;
 
   int totseg, *points, proxy, render_flags; /* for visual statistics optimization */
-  int pad;
+  /* eMovieCacheBudget. */
+  int budget;
 } MovieCache;
 
 typedef struct MovieCacheKey {
@@ -104,6 +123,15 @@ static bool moviecache_hashcmp(const void *av, const void *bv)
   return a->cache_owner->cmpfp(a->userkey, b->userkey);
 }
 
+/* Limiter must be locked. */
+static void moviecache_limiter_update_memory(MovieCacheLimiter *limiter)
+{
+  const size_t memory_in_use = MEM_CacheLimiter_get_memory_in_use(limiter->limitor);
+  /* Unsigned overflow gives the right result when memory decreased. */
+  atomic_add_and_fetch_z(&limiters_memory_in_use, memory_in_use - limiter->memory_in_use);
+  limiter->memory_in_use = memory_in_use;
+}
+
 static void moviecache_keyfree(void *val)
 {
   MovieCacheKey *key = val;
@@ -121,7 +149,11 @@ static void moviecache_valfree(void *val)
   PRINT("%s: cache '%s' free item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
   if (item->ibuf) {
+    MovieCacheLimiter *limiter = &limiters[cache->budget];
+    BLI_mutex_lock(&limiter->lock);
     MEM_CacheLimiter_unmanage(item->c_handle);
+    moviecache_limiter_update_memory(limiter);
+    BLI_mutex_unlock(&limiter->lock);
     IMB_freeImBuf(item->ibuf);
   }
 
@@ -244,18 +276,93 @@ static bool get_item_destroyable(void *item_v)
   return true;
 }
 
-void IMB_moviecache_init(void)
+/* Limiter must be locked. */
+static void moviecache_limiter_ensure(eMovieCacheBudget budget)
 {
-  limitor = new_MEM_CacheLimiter(IMB_moviecache_destructor, get_item_size);
+  MovieCacheLimiter *limiter = &limiters[budget];
+
+  if (limiter->limitor) {
+    return;
+  }
+
+  limiter->limitor = new_MEM_CacheLimiter(IMB_moviecache_destructor, get_item_size);
+  MEM_CacheLimiter_set_budget(limiter->limitor, limiter->budget);
+  /* Only movie clips use priorities, other budgets free least recently used images first. */
+  if (budget == IMB_MOVIECACHE_BUDGET_CLIP) {
+    MEM_CacheLimiter_ItemPriority_Func_set(limiter->limitor, get_item_priority);
+  }
+  MEM_CacheLimiter_ItemDestroyable_Func_set(limiter->limitor, get_item_destroyable);
+}
 
-  MEM_CacheLimiter_ItemPriority_Func_set(limitor, get_item_priority);
-  MEM_CacheLimiter_ItemDestroyable_Func_set(limitor, get_item_destroyable);
+void IMB_moviecache_init(void)
+{
+  for (int budget = 0; budget < IMB_MOVIECACHE_BUDGET_NUM; budget++) {
+    BLI_mutex_lock(&limiters[budget].lock);
+    moviecache_limiter_ensure(budget);
+    BLI_mutex_unlock(&limiters[budget].lock);
+  }
 }
 
 void IMB_moviecache_destruct(void)
 {
-  if (limitor) {
-    delete_MEM_CacheLimiter(limitor);
+  for (int budget = 0; budget < IMB_MOVIECACHE_BUDGET_NUM; budget++) {
+    MovieCacheLimiter *limiter = &limiters[budget];
+    if (limiter->limitor) {
+      delete_MEM_CacheLimiter(limiter->limitor);
+      limiter->limitor = NULL;
+    }
+    limiter->memory_in_use = 0;
+  }
+  limiters_memory_in_use = 0;
+}
+
+/**
+ * Limit memory used by caches of a budget, in bytes. 0 to only use the global memory cache limit.
+ */
+void IMB_moviecache_set_budget_limit(eMovieCacheBudget budget, size_t limit)
+{
+  MovieCacheLimiter *limiter = &limiters[budget];
+
+  BLI_mutex_lock(&limiter->lock);
+  limiter->budget = limit;
+  if (limiter->limitor) {
+    MEM_CacheLimiter_set_budget(limiter->limitor, limit);
+  }
+  BLI_mutex_unlock(&limiter->lock);
+}
+
+/* Free images of the budgets using the most memory, until the sum of all budgets is within the
+ * global limit. Locks a single limiter at a time. */
+static void moviecache_enforce_global_limit(void)
+{
+  const size_t mem_limit = MEM_CacheLimiter_get_maximum();
+
+  if (mem_limit == 0) {
+    return;
+  }
+
+  for (int i = 0; i < IMB_MOVIECACHE_BUDGET_NUM; i++) {
+    const size_t mem_in_use = atomic_add_and_fetch_z(&limiters_memory_in_use, 0);
+    if (mem_in_use <= mem_limit) {
+      break;
+    }
+
+    MovieCacheLimiter *largest = NULL;
+    for (int budget = 0; budget < IMB_MOVIECACHE_BUDGET_NUM; budget++) {
+      if (largest == NULL || limiters[budget].memory_in_use > largest->memory_in_use) {
+        largest = &limiters[budget];
+      }
+    }
+
+    BLI_mutex_lock(&largest->lock);
+    if (largest->limitor) {
+      const size_t excess = mem_in_use - mem_limit;
+      const size_t largest_in_use = largest->memory_in_use;
+      MEM_CacheLimiter_reduce_memory(largest->limitor,
+                                     (largest_in_use > excess) ? largest_in_use - excess : 0);
+      moviecache_limiter_update_memory(largest);
+    }
+    BLI_mutex_unlock(&largest->lock);
   }
 }
 
@@ -286,6 +393,13 @@ MovieCache *IMB_moviecache_create(const char *name,
   return cache;
 }
 
+/* Must be called before images are put into the cache. */
+void IMB_moviecache_set_budget(MovieCache *cache, eMovieCacheBudget budget)
+{
+  BLI_assert(BLI_ghash_len(cache->hash) == 0);
+  cache->budget = budget;
+}
+
 void IMB_moviecache_set_getdata_callback(MovieCache *cache, MovieCacheGetKeyDataFP getdatafp)
 {
   cache->getdatafp = getdatafp;
@@ -303,15 +417,12 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
   cache->prioritydeleterfp = prioritydeleterfp;
 }
 
-static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, bool need_lock)
+static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
+  MovieCacheLimiter *limiter = &limiters[cache->budget];
   MovieCacheKey *key;
   MovieCacheItem *item;
 
-  if (!limitor) {
-    IMB_moviecache_init();
-  }
-
   IMB_refImBuf(ibuf);
 
   key = BLI_mempool_alloc(cache->keys_pool);
@@ -338,19 +449,19 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
     memcpy(cache->last_userkey, userkey, cache->keysize);
   }
 
-  if (need_lock) {
-    BLI_mutex_lock(&limitor_lock);
-  }
+  BLI_mutex_lock(&limiter->lock);
 
-  item->c_handle = MEM_CacheLimiter_insert(limitor, item);
+  moviecache_limiter_ensure(cache->budget);
+  item->c_handle = MEM_CacheLimiter_insert(limiter->limitor, item);
 
   MEM_CacheLimiter_ref(item->c_handle);
-  MEM_CacheLimiter_enforce_limits(limitor);
+  MEM_CacheLimiter_enforce_limits(limiter->limitor);
   MEM_CacheLimiter_unref(item->c_handle);
+  moviecache_limiter_update_memory(limiter);
 
-  if (need_lock) {
-    BLI_mutex_unlock(&limitor_lock);
-  }
+  BLI_mutex_unlock(&limiter->lock);
+
+  moviecache_enforce_global_limit();
 
   /* cache limiter can't remove unused keys which points to destroyed values */
   check_unused_keys(cache);
@@ -363,28 +474,33 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 
 void IMB_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
-  do_moviecache_put(cache, userkey, ibuf, true);
+  do_moviecache_put(cache, userkey, ibuf);
 }
 
 bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
+  MovieCacheLimiter *limiter = &limiters[cache->budget];
   size_t mem_in_use, mem_limit, elem_size;
-  bool result = false;
 
   elem_size = get_size_in_memory(ibuf);
   mem_limit = MEM_CacheLimiter_get_maximum();
 
-  BLI_mutex_lock(&limitor_lock);
-  mem_in_use = MEM_CacheLimiter_get_memory_in_use(limitor);
-
-  if (mem_in_use + elem_size <= mem_limit) {
-    do_moviecache_put(cache, userkey, ibuf, false);
-    result = true;
+  /* Only checked without holding the lock while putting, so threads putting at the same time
+   * can go over the limit by a few images, which are freed by the next put. */
+  mem_in_use = atomic_add_and_fetch_z(&limiters_memory_in_use, 0);
+  if (mem_in_use + elem_size > mem_limit) {
+    return false;
   }
 
-  BLI_mutex_unlock(&limitor_lock);
+  BLI_mutex_lock(&limiter->lock);
+  mem_in_use = limiter->memory_in_use;
+  BLI_mutex_unlock(&limiter->lock);
+  if (limiter->budget != 0 && mem_in_use + elem_size > limiter->budget) {
+    return false;
+  }
 
-  return result;
+  do_moviecache_put(cache, userkey, ibuf);
+  return true;
 }
 
 void IMB_moviecache_remove(MovieCache *cache, void *userkey)
@@ -406,9 +522,11 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
 
   if (item) {
     if (item->ibuf) {
-      BLI_mutex_lock(&limitor_lock);
+      MovieCacheLimiter *limiter = &limiters[cache->budget];
+      BLI_mutex_lock(&limiter->lock);
       MEM_CacheLimiter_touch(item->c_handle);
-      BLI_mutex_unlock(&limitor_lock);
+      moviecache_limiter_update_memory(limiter);
+      BLI_mutex_unlock(&limiter->lock);
 
       IMB_refImBuf(item->ibuf);
 
@@ -23,9 +23,17 @@
  */
 
 #include <math.h>
+#include <string.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -1876,3 +1884,308 @@ void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
     ibuf->rect_float = init_data.float_buffer;
   }
 }
+
+/* ******** filtered scaling ******** */
+
+/* Scaling is done in two separable passes per output row: a vertical pass that blends source
+ * rows into a float row with the width of the source, then a horizontal pass that blends the
+ * pixels of that row. The weights of both passes are computed once, every output pixel reads a
+ * contiguous window of `taps` source pixels starting at its first index. Pixels outside of the
+ * image are clamped to the border, by adding their weight to the border pixel. */
+
+typedef struct ScaleFilterWeights {
+  /* First source index of every output index. */
+  int *first;
+  /* Normalized weights, `taps` for every output index. */
+  float *weights;
+  int taps;
+} ScaleFilterWeights;
+
+static float scale_filter_radius(eIMBScaleFilter filter)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return 0.5f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return 1.0f;
+    case IMB_SCALE_FILTER_BICUBIC:
+      return 2.0f;
+    case IMB_SCALE_FILTER_LANCZOS:
+      return 3.0f;
+  }
+  return 1.0f;
+}
+
+static float scale_filter_sinc(float x)
+{
+  if (x == 0.0f) {
+    return 1.0f;
+  }
+  x *= (float)M_PI;
+  return sinf(x) / x;
+}
+
+static float scale_filter_eval(eIMBScaleFilter filter, float x)
+{
+  x = fabsf(x);
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return (x <= 0.5f) ? 1.0f : 0.0f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return (x < 1.0f) ? 1.0f - x : 0.0f;
+    case IMB_SCALE_FILTER_BICUBIC:
+      /* Catmull-Rom, a = -0.5. */
+      if (x < 1.0f) {
+        return (1.5f * x - 2.5f) * x * x + 1.0f;
+      }
+      if (x < 2.0f) {
+        return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+      }
+      return 0.0f;
+    case IMB_SCALE_FILTER_LANCZOS:
+      return (x < 3.0f) ? scale_filter_sinc(x) * scale_filter_sinc(x / 3.0f) : 0.0f;
+  }
+  return 0.0f;
+}
+
+static void scale_filter_weights_init(ScaleFilterWeights *r_weights,
+                                      eIMBScaleFilter filter,
+                                      int src_size,
+                                      int dst_size)
+{
+  const float scale = (float)src_size / (float)dst_size;
+  /* Widen the filter when scaling down, so it averages all covered pixels. */
+  const float filter_scale = max_ff(scale, 1.0f);
+  const float support = scale_filter_radius(filter) * filter_scale;
+  const int taps = min_ii((int)ceilf(support) * 2 + 1, src_size);
+
+  r_weights->taps = taps;
+  r_weights->first = MEM_mallocN(sizeof(int) * dst_size, "scale filter first");
+  r_weights->weights = MEM_callocN(sizeof(float) * dst_size * taps, "scale filter weights");
+
+  for (int i = 0; i < dst_size; i++) {
+    const float center = ((float)i + 0.5f) * scale - 0.5f;
+    const int begin = (int)floorf(center - support) + 1;
+    const int end = (int)ceilf(center + support) - 1;
+    const int first = clamp_i(begin, 0, src_size - taps);
+    float *weights = r_weights->weights + (size_t)i * taps;
+    float total = 0.0f;
+
+    for (int j = begin; j <= end; j++) {
+      const float weight = scale_filter_eval(filter, ((float)j - center) / filter_scale);
+      weights[clamp_i(j, 0, src_size - 1) - first] += weight;
+      total += weight;
+    }
+
+    if (total != 0.0f) {
+      mul_vn_fl(weights, taps, 1.0f / total);
+    }
+    else {
+      /* Only possible for the box filter exactly between pixels, use the nearest one. */
+      weights[clamp_i((int)(center + 0.5f), 0, src_size - 1) - first] = 1.0f;
+    }
+    r_weights->first[i] = first;
+  }
+}
+
+static void scale_filter_weights_free(ScaleFilterWeights *weights)
+{
+  MEM_freeN(weights->first);
+  MEM_freeN(weights->weights);
+}
+
+typedef struct ScaleFilterData {
+  const ImBuf *ibuf;
+  int newx;
+  int channels;
+  ScaleFilterWeights weights_x;
+  ScaleFilterWeights weights_y;
+
+  unsigned char *byte_buffer;
+  float *float_buffer;
+} ScaleFilterData;
+
+typedef struct ScaleFilterTLS {
+  /* One row with the width of the source image, allocated on first use. */
+  float *row;
+} ScaleFilterTLS;
+
+static void scale_filter_vertical_byte(const ScaleFilterData *data, int y, float *row)
+{
+  const ImBuf *ibuf = data->ibuf;
+  const size_t row_len = (size_t)ibuf->x * 4;
+  const int first = data->weights_y.first[y];
+  const float *weights = data->weights_y.weights + (size_t)y * data->weights_y.taps;
+
+  memset(row, 0, sizeof(float) * row_len);
+  for (int k = 0; k < data->weights_y.taps; k++) {
+    const unsigned char *src = (const unsigned char *)ibuf->rect + (first + k) * row_len;
+    const float weight = weights[k];
+    for (size_t i = 0; i < row_len; i++) {
+      row[i] += weight * (float)src[i];
+    }
+  }
+}
+
+static void scale_filter_vertical_float(const ScaleFilterData *data, int y, float *row)
+{
+  const ImBuf *ibuf = data->ibuf;
+  const size_t row_len = (size_t)ibuf->x * data->channels;
+  const int first = data->weights_y.first[y];
+  const float *weights = data->weights_y.weights + (size_t)y * data->weights_y.taps;
+
+  memset(row, 0, sizeof(float) * row_len);
+  for (int k = 0; k < data->weights_y.taps; k++) {
+    const float *src = ibuf->rect_float + (first + k) * row_len;
+    const float weight = weights[k];
+    for (size_t i = 0; i < row_len; i++) {
+      row[i] += weight * src[i];
+    }
+  }
+}
+
+/* Horizontal pass for 4 channels, writes one output pixel. */
+BLI_INLINE void scale_filter_horizontal_rgba(const float *row,
+                                             const float *weights,
+                                             int taps,
+                                             float r_pixel[4])
+{
+#ifdef __SSE2__
+  __m128 sum = _mm_setzero_ps();
+  for (int k = 0; k < taps; k++) {
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(row + k * 4)));
+  }
+  _mm_storeu_ps(r_pixel, sum);
+#else
+  zero_v4(r_pixel);
+  for (int k = 0; k < taps; k++) {
+    madd_v4_v4fl(r_pixel, row + k * 4, weights[k]);
+  }
+#endif
+}
+
+static void scale_filter_row(void *__restrict userdata,
+                             const int y,
+                             const TaskParallelTLS *__restrict tls)
+{
+  const ScaleFilterData *data = userdata;
+  ScaleFilterTLS *filter_tls = tls->userdata_chunk;
+  const int taps = data->weights_x.taps;
+
+  if (filter_tls->row == NULL) {
+    filter_tls->row = MEM_mallocN(sizeof(float) * data->ibuf->x * max_ii(data->channels, 4),
+                                  "scale filter row");
+  }
+  float *row = filter_tls->row;
+
+  if (data->byte_buffer) {
+    unsigned char *dst = data->byte_buffer + (size_t)y * data->newx * 4;
+    scale_filter_vertical_byte(data, y, row);
+    for (int x = 0; x < data->newx; x++, dst += 4) {
+      const float *weights = data->weights_x.weights + (size_t)x * taps;
+      float pixel[4];
+      scale_filter_horizontal_rgba(row + data->weights_x.first[x] * 4, weights, taps, pixel);
+      for (int c = 0; c < 4; c++) {
+        /* Cubic and Lanczos filters overshoot. */
+        dst[c] = (unsigned char)clamp_f(pixel[c] + 0.5f, 0.0f, 255.0f);
+      }
+    }
+  }
+
+  if (data->float_buffer) {
+    const int channels = data->channels;
+    float *dst = data->float_buffer + (size_t)y * data->newx * channels;
+    scale_filter_vertical_float(data, y, row);
+    for (int x = 0; x < data->newx; x++, dst += channels) {
+      const float *weights = data->weights_x.weights + (size_t)x * taps;
+      const float *src = row + data->weights_x.first[x] * channels;
+      if (channels == 4) {
+        scale_filter_horizontal_rgba(src, weights, taps, dst);
+      }
+      else {
+        for (int c = 0; c < channels; c++) {
+          float sum = 0.0f;
+          for (int k = 0; k < taps; k++) {
+            sum += weights[k] * src[k * channels + c];
+          }
+          dst[c] = sum;
+        }
+      }
+    }
+  }
+}
+
+static void scale_filter_tls_free(const void *__restrict UNUSED(userdata),
+                                  void *__restrict chunk)
+{
+  ScaleFilterTLS *filter_tls = chunk;
+  MEM_SAFE_FREE(filter_tls->row);
+}
+
+/**
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scale_filter_ImBuf(struct ImBuf *ibuf,
+                            unsigned int newx,
+                            unsigned int newy,
+                            eIMBScaleFilter filter)
+{
+  if (ibuf == NULL) {
+    return false;
+  }
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return false;
+  }
+  if (newx == 0 || newy == 0 || ibuf->x <= 0 || ibuf->y <= 0) {
+    return false;
+  }
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
+  }
+
+  scalefast_Z_ImBuf(ibuf, newx, newy);
+
+  ScaleFilterData data = {NULL};
+  data.ibuf = ibuf;
+  data.newx = (int)newx;
+  data.channels = ibuf->channels;
+  scale_filter_weights_init(&data.weights_x, filter, ibuf->x, (int)newx);
+  scale_filter_weights_init(&data.weights_y, filter, ibuf->y, (int)newy);
+
+  if (ibuf->rect) {
+    data.byte_buffer = MEM_mallocN(sizeof(char) * 4 * newx * newy, "scale filter byte buffer");
+  }
+  if (ibuf->rect_float) {
+    data.float_buffer = MEM_mallocN(sizeof(float) * ibuf->channels * newx * newy,
+                                    "scale filter float buffer");
+  }
+
+  ScaleFilterTLS filter_tls = {NULL};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &filter_tls;
+  settings.userdata_chunk_size = sizeof(filter_tls);
+  settings.func_free = scale_filter_tls_free;
+  /* Keep enough rows per task so each one amortizes its row allocation. */
+  settings.min_iter_per_thread = 8;
+  BLI_task_parallel_range(0, (int)newy, &data, scale_filter_row, &settings);
+
+  scale_filter_weights_free(&data.weights_x);
+  scale_filter_weights_free(&data.weights_y);
+
+  ibuf->x = newx;
+  ibuf->y = newy;
+
+  if (data.byte_buffer) {
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = (unsigned int *)data.byte_buffer;
+  }
+  if (data.float_buffer) {
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = data.float_buffer;
+  }
+
+  return true;
+}
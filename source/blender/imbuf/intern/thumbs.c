@@ -447,7 +447,7 @@ static ImBuf *thumb_create_ex(const char *file_path,
         imb_freerectfloatImBuf(img);
       }
 
-      IMB_scaleImBuf(img, ex, ey);
+      IMB_scale_filter_ImBuf(img, ex, ey, IMB_SCALE_FILTER_BOX);
     }
     BLI_snprintf(desc, sizeof(desc), "Thumbnail for %s", uri);
     IMB_metadata_ensure(&img->metadata);
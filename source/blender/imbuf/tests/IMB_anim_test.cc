@@ -0,0 +1,207 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_threads.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
+
+#include "ffmpeg_compat.h"
+}
+
+namespace blender::imbuf::tests {
+
+static const int movie_width = 64;
+static const int movie_height = 48;
+static const int movie_frames = 30;
+/* Frames are uniformly gray, each a few luma levels brighter than the previous. */
+static const int movie_luma_step = 6;
+
+static void write_frame(AVFormatContext *format_ctx,
+                        AVCodecContext *codec_ctx,
+                        AVStream *stream,
+                        AVFrame *frame)
+{
+  ASSERT_GE(avcodec_send_frame(codec_ctx, frame), 0);
+  AVPacket packet = {nullptr};
+  av_init_packet(&packet);
+  while (avcodec_receive_packet(codec_ctx, &packet) == 0) {
+    av_packet_rescale_ts(&packet, codec_ctx->time_base, stream->time_base);
+    packet.stream_index = stream->index;
+    ASSERT_GE(av_interleaved_write_frame(format_ctx, &packet), 0);
+  }
+}
+
+/**
+ * Write an MPEG-4 movie with B-frames and a key frame every 8 frames, so seeking has to decode
+ * from earlier key frames and reorder frames.
+ */
+static void write_movie(const char *filepath)
+{
+  AVFormatContext *format_ctx = nullptr;
+  ASSERT_GE(avformat_alloc_output_context2(&format_ctx, nullptr, "matroska", filepath), 0);
+
+  AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+  ASSERT_NE(codec, nullptr);
+  AVCodecContext *codec_ctx = avcodec_alloc_context3(codec);
+  codec_ctx->width = movie_width;
+  codec_ctx->height = movie_height;
+  codec_ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+  codec_ctx->time_base = av_make_q(1, 25);
+  codec_ctx->framerate = av_make_q(25, 1);
+  codec_ctx->gop_size = 8;
+  codec_ctx->max_b_frames = 2;
+  codec_ctx->flags |= AV_CODEC_FLAG_QSCALE;
+  codec_ctx->global_quality = FF_QP2LAMBDA * 2;
+  if (format_ctx->oformat->flags & AVFMT_GLOBALHEADER) {
+    codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  }
+  ASSERT_GE(avcodec_open2(codec_ctx, codec, nullptr), 0);
+
+  AVStream *stream = avformat_new_stream(format_ctx, nullptr);
+  stream->time_base = codec_ctx->time_base;
+  ASSERT_GE(avcodec_parameters_from_context(stream->codecpar, codec_ctx), 0);
+  ASSERT_GE(avio_open(&format_ctx->pb, filepath, AVIO_FLAG_WRITE), 0);
+  ASSERT_GE(avformat_write_header(format_ctx, nullptr), 0);
+
+  AVFrame *frame = av_frame_alloc();
+  frame->format = codec_ctx->pix_fmt;
+  frame->width = movie_width;
+  frame->height = movie_height;
+  ASSERT_GE(av_frame_get_buffer(frame, 0), 0);
+  for (int i = 0; i < movie_frames; i++) {
+    ASSERT_GE(av_frame_make_writable(frame), 0);
+    for (int y = 0; y < movie_height; y++) {
+      memset(frame->data[0] + y * frame->linesize[0], 16 + i * movie_luma_step, movie_width);
+    }
+    for (int y = 0; y < movie_height / 2; y++) {
+      memset(frame->data[1] + y * frame->linesize[1], 128, movie_width / 2);
+      memset(frame->data[2] + y * frame->linesize[2], 128, movie_width / 2);
+    }
+    frame->pts = i;
+    frame->quality = codec_ctx->global_quality;
+    write_frame(format_ctx, codec_ctx, stream, frame);
+  }
+  write_frame(format_ctx, codec_ctx, stream, nullptr);
+
+  ASSERT_GE(av_write_trailer(format_ctx), 0);
+  av_frame_free(&frame);
+  avcodec_free_context(&codec_ctx);
+  avio_closep(&format_ctx->pb);
+  avformat_free_context(format_ctx);
+}
+
+class AnimMovieTest : public testing::Test {
+ protected:
+  std::string filepath_;
+  struct anim *anim_ = nullptr;
+
+ public:
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    IMB_init();
+    IMB_ffmpeg_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+    BLI_threadapi_exit();
+  }
+
+ protected:
+  void SetUp() override
+  {
+    char filepath[FILE_MAX];
+    BLI_join_dirfile(filepath, sizeof(filepath), testing::TempDir().c_str(), "imbuf_anim.mkv");
+    filepath_ = filepath;
+    write_movie(filepath);
+    ASSERT_FALSE(HasFatalFailure());
+
+    char colorspace[IM_MAX_SPACE] = "";
+    anim_ = IMB_open_anim(filepath, IB_rect, 0, colorspace);
+    ASSERT_NE(anim_, nullptr);
+  }
+
+  void TearDown() override
+  {
+    if (anim_) {
+      IMB_free_anim(anim_);
+    }
+    BLI_delete(filepath_.c_str(), false, false);
+  }
+
+  /* Index of the frame decoded into \a ibuf, from the gray level of its pixels. */
+  static int frame_index(const ImBuf *ibuf)
+  {
+    const unsigned char *pixel = (const unsigned char *)ibuf->rect +
+                                 ((ibuf->y / 2) * ibuf->x + ibuf->x / 2) * 4;
+    /* Full range RGB from limited range luma. */
+    const float luma = pixel[1] * (219.0f / 255.0f);
+    return (int)roundf(luma / movie_luma_step);
+  }
+
+  void expect_frame(const int position)
+  {
+    ImBuf *ibuf = IMB_anim_absolute(anim_, position, IMB_TC_NONE, IMB_PROXY_NONE);
+    ASSERT_NE(ibuf, nullptr) << "frame " << position;
+    EXPECT_EQ(ibuf->x, movie_width);
+    EXPECT_EQ(ibuf->y, movie_height);
+    EXPECT_EQ(frame_index(ibuf), position);
+    IMB_freeImBuf(ibuf);
+  }
+};
+
+TEST_F(AnimMovieTest, duration)
+{
+  EXPECT_EQ(IMB_anim_get_duration(anim_, IMB_TC_NONE), movie_frames);
+}
+
+/* Sequential playback, frames after the first ones come from the decode-ahead. */
+TEST_F(AnimMovieTest, decode_sequential)
+{
+  for (int i = 0; i < movie_frames; i++) {
+    expect_frame(i);
+  }
+  /* Repeating frames and playing again from the start. */
+  expect_frame(movie_frames - 1);
+  for (int i = 0; i < movie_frames; i++) {
+    expect_frame(i);
+  }
+}
+
+/* Seeking backward, forward over key frames and to frames between key frames. */
+TEST_F(AnimMovieTest, seek)
+{
+  const int positions[] = {25, 3, 17, 17, 0, 29, 12, 13, 11, 8, 7, 24, 1};
+  for (const int position : positions) {
+    expect_frame(position);
+  }
+}
+
+/* Seeking while decoding ahead, the movie is freed while it's still decoding ahead. */
+TEST_F(AnimMovieTest, seek_during_decode_ahead)
+{
+  for (int i = 0; i < 10; i++) {
+    expect_frame(i);
+  }
+  expect_frame(4);
+  for (int i = 20; i < 25; i++) {
+    expect_frame(i);
+  }
+}
+
+}  // namespace blender::imbuf::tests
@@ -0,0 +1,192 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "BLI_math_base.h"
+#include "BLI_rand.hh"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_vector.hh"
+
+#include "DNA_color_types.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+
+#include "intern/IMB_colormanagement_intern.h"
+
+namespace blender::imbuf::tests {
+
+/* Largest difference of display colors from a LUT to the exact transform, one byte level. */
+static const float lut_max_error = 1.0f / 255.0f;
+/* Pixels outside of the range of the LUT are evaluated exactly. */
+static const float exact_max_error = 1e-5f;
+
+/* End of the scene linear range of float LUTs. */
+static const float lut_range_max = 512.0f;
+
+static void lut_eval(void *userdata, float *rgb, int len)
+{
+  ColormanageProcessor *cm_processor = (ColormanageProcessor *)userdata;
+  IMB_colormanagement_processor_apply(cm_processor, rgb, len, 1, 3, false);
+}
+
+/* Premultiplied pixels, half of them with alpha. */
+static void append_pixel(Vector<float> &pixels, const float rgb[3], RandomNumberGenerator &rng)
+{
+  const float alpha = (pixels.size() % 8 == 0) ? 1.0f : 0.05f + 0.95f * rng.get_float();
+  pixels.extend({rgb[0] * alpha, rgb[1] * alpha, rgb[2] * alpha, alpha});
+}
+
+/* Display range and HDR pixels, including the linear toe of the LUT. */
+static Vector<float> lut_range_pixels()
+{
+  RandomNumberGenerator rng(1);
+  Vector<float> pixels;
+  for (int i = 0; i < 20000; i++) {
+    float rgb[3];
+    for (int c = 0; c < 3; c++) {
+      rgb[c] = (i % 2) ? rng.get_float() : powf(2.0f, -14.0f + 23.0f * rng.get_float());
+    }
+    append_pixel(pixels, rgb, rng);
+  }
+  /* Grays at whole stops, where views like Standard clip. */
+  for (int i = -12; i <= 9; i++) {
+    const float value = powf(2.0f, (float)i);
+    const float rgb[3] = {value, value, value};
+    append_pixel(pixels, rgb, rng);
+  }
+  return pixels;
+}
+
+/* Pixels with negative channels or channels above the range of the LUT. */
+static Vector<float> out_of_range_pixels()
+{
+  RandomNumberGenerator rng(2);
+  Vector<float> pixels;
+  for (int i = 0; i < 2000; i++) {
+    float rgb[3];
+    for (int c = 0; c < 3; c++) {
+      rgb[c] = rng.get_float();
+    }
+    const int c = i % 3;
+    rgb[c] = (i % 2) ? -1e-4f - rng.get_float() :
+                       lut_range_max * (1.0f + 200.0f * rng.get_float());
+    append_pixel(pixels, rgb, rng);
+  }
+  return pixels;
+}
+
+class DisplayLUTTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    BLI_task_scheduler_init();
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+    BLI_task_scheduler_exit();
+    BLI_threadapi_exit();
+  }
+
+ protected:
+  ColorManagedDisplaySettings display_settings_;
+  ColorManagedViewSettings view_settings_;
+  ColormanageProcessor *cm_processor_ = nullptr;
+  ColormanageDisplayLUT *lut_ = nullptr;
+
+  void TearDown() override
+  {
+    if (lut_) {
+      colormanage_display_lut_release(lut_);
+    }
+    if (cm_processor_) {
+      IMB_colormanagement_processor_free(cm_processor_);
+    }
+    colormanage_display_lut_free_all();
+  }
+
+  /* Bake a LUT for the view of the default display, false when the view doesn't exist. */
+  bool bake(const char *view, const float exposure, const float gamma)
+  {
+    BLI_strncpy(display_settings_.display_device,
+                IMB_colormanagement_display_get_default_name(),
+                sizeof(display_settings_.display_device));
+    if (!colormanage_view_get_named_for_display(display_settings_.display_device, view)) {
+      return false;
+    }
+
+    memset(&view_settings_, 0, sizeof(view_settings_));
+    BLI_strncpy(view_settings_.look, "None", sizeof(view_settings_.look));
+    BLI_strncpy(view_settings_.view_transform, view, sizeof(view_settings_.view_transform));
+    view_settings_.exposure = exposure;
+    view_settings_.gamma = gamma;
+    cm_processor_ = IMB_colormanagement_display_processor_new(&view_settings_, &display_settings_);
+
+    char key[256];
+    BLI_snprintf(key, sizeof(key), "test|%s|%f|%f", view, exposure, gamma);
+    lut_ = colormanage_display_lut_acquire(key, true, true, lut_eval, cm_processor_);
+    return lut_ != nullptr;
+  }
+
+  /* Compare display colors from the LUT with the exact transform, clamped to the display range
+   * like display buffers are. */
+  void expect_lut_equal_exact(const Vector<float> &pixels, const float max_error)
+  {
+    Vector<float> exact = pixels;
+    Vector<float> baked = pixels;
+    const int num_pixels = pixels.size() / 4;
+    IMB_colormanagement_processor_apply(cm_processor_, exact.data(), num_pixels, 1, 4, true);
+    colormanage_display_lut_apply_float(
+        lut_, baked.data(), num_pixels, 4, true, lut_eval, cm_processor_);
+
+    for (int i = 0; i < num_pixels; i++) {
+      for (int c = 0; c < 3; c++) {
+        EXPECT_NEAR(clamp_f(baked[i * 4 + c], 0.0f, 1.0f),
+                    clamp_f(exact[i * 4 + c], 0.0f, 1.0f),
+                    max_error)
+            << view_settings_.view_transform << " pixel (" << pixels[i * 4] << ", "
+            << pixels[i * 4 + 1] << ", " << pixels[i * 4 + 2] << ", " << pixels[i * 4 + 3]
+            << ") channel " << c;
+      }
+      EXPECT_EQ(baked[i * 4 + 3], pixels[i * 4 + 3]);
+    }
+  }
+};
+
+TEST_F(DisplayLUTTest, standard_view)
+{
+  if (!bake("Standard", 0.0f, 1.0f)) {
+    return;
+  }
+  expect_lut_equal_exact(lut_range_pixels(), lut_max_error);
+  expect_lut_equal_exact(out_of_range_pixels(), exact_max_error);
+}
+
+TEST_F(DisplayLUTTest, filmic_view)
+{
+  if (!bake("Filmic", 0.0f, 1.0f)) {
+    return;
+  }
+  expect_lut_equal_exact(lut_range_pixels(), lut_max_error);
+  expect_lut_equal_exact(out_of_range_pixels(), exact_max_error);
+}
+
+TEST_F(DisplayLUTTest, exposure_gamma)
+{
+  if (!bake("Filmic", 1.5f, 0.8f)) {
+    return;
+  }
+  expect_lut_equal_exact(lut_range_pixels(), lut_max_error);
+  expect_lut_equal_exact(out_of_range_pixels(), exact_max_error);
+}
+
+}  // namespace blender::imbuf::tests
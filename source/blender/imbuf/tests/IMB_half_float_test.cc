@@ -0,0 +1,177 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+
+namespace blender::imbuf::tests {
+
+/* Single values always use the scalar conversion, buffers of 4 or more values may be converted
+ * with F16C instructions. */
+static unsigned short half_from_float(const float value)
+{
+  unsigned short half;
+  IMB_buffer_half_from_float(&half, &value, 1);
+  return half;
+}
+
+static float float_from_half(const unsigned short half)
+{
+  float value;
+  IMB_buffer_float_from_half(&value, &half, 1);
+  return value;
+}
+
+static float float_from_bits(const uint32_t bits)
+{
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static bool half_is_nan(const unsigned short half)
+{
+  return (half & 0x7c00) == 0x7c00 && (half & 0x03ff) != 0;
+}
+
+/* Every half float value survives conversion to float and back. */
+TEST(imbuf_half_float, round_trip)
+{
+  for (int i = 0; i <= 0xffff; i++) {
+    const unsigned short half = (unsigned short)i;
+    const float value = float_from_half(half);
+    const unsigned short result = half_from_float(value);
+    if (half_is_nan(half)) {
+      EXPECT_TRUE(std::isnan(value)) << std::hex << i;
+      EXPECT_TRUE(half_is_nan(result)) << std::hex << i;
+      EXPECT_EQ(result & 0x8000, half & 0x8000) << std::hex << i;
+    }
+    else {
+      EXPECT_EQ(result, half) << std::hex << i;
+    }
+  }
+}
+
+TEST(imbuf_half_float, special_values)
+{
+  EXPECT_EQ(half_from_float(0.0f), 0x0000);
+  EXPECT_EQ(half_from_float(-0.0f), 0x8000);
+  EXPECT_EQ(half_from_float(1.0f), 0x3c00);
+  EXPECT_EQ(half_from_float(-2.0f), 0xc000);
+  EXPECT_EQ(half_from_float(65504.0f), 0x7bff);
+  EXPECT_EQ(half_from_float(INFINITY), 0x7c00);
+  EXPECT_EQ(half_from_float(-INFINITY), 0xfc00);
+  EXPECT_TRUE(half_is_nan(half_from_float(NAN)));
+
+  EXPECT_EQ(float_from_half(0x3c00), 1.0f);
+  EXPECT_EQ(float_from_half(0x7bff), 65504.0f);
+  EXPECT_EQ(float_from_half(0x7c00), INFINITY);
+  EXPECT_EQ(float_from_half(0xfc00), -INFINITY);
+  EXPECT_TRUE(std::signbit(float_from_half(0x8000)));
+  EXPECT_TRUE(std::isnan(float_from_half(0x7e00)));
+}
+
+/* Values too large for half float become infinite. */
+TEST(imbuf_half_float, overflow)
+{
+  /* Halfway between the largest half float and the next power of two rounds up. */
+  EXPECT_EQ(half_from_float(65519.0f), 0x7bff);
+  EXPECT_EQ(half_from_float(65520.0f), 0x7c00);
+  EXPECT_EQ(half_from_float(-65520.0f), 0xfc00);
+  EXPECT_EQ(half_from_float(65536.0f), 0x7c00);
+  EXPECT_EQ(half_from_float(1e10f), 0x7c00);
+  EXPECT_EQ(half_from_float(FLT_MAX), 0x7c00);
+  EXPECT_EQ(half_from_float(-FLT_MAX), 0xfc00);
+}
+
+TEST(imbuf_half_float, denormals)
+{
+  /* Smallest normal and denormal half float. */
+  EXPECT_EQ(half_from_float(ldexpf(1.0f, -14)), 0x0400);
+  EXPECT_EQ(half_from_float(ldexpf(1.0f, -24)), 0x0001);
+  EXPECT_EQ(half_from_float(-ldexpf(1.0f, -24)), 0x8001);
+  EXPECT_EQ(half_from_float(ldexpf(1023.0f, -24)), 0x03ff);
+  EXPECT_EQ(float_from_half(0x0001), ldexpf(1.0f, -24));
+  EXPECT_EQ(float_from_half(0x03ff), ldexpf(1023.0f, -24));
+  EXPECT_EQ(float_from_half(0x8001), -ldexpf(1.0f, -24));
+
+  /* Ties round to even, smaller values underflow to zero keeping the sign. */
+  EXPECT_EQ(half_from_float(ldexpf(1.0f, -25)), 0x0000);
+  EXPECT_EQ(half_from_float(ldexpf(3.0f, -25)), 0x0002);
+  EXPECT_EQ(half_from_float(ldexpf(5.0f, -26)), 0x0001);
+  EXPECT_EQ(half_from_float(1e-10f), 0x0000);
+  EXPECT_EQ(half_from_float(-1e-10f), 0x8000);
+  EXPECT_EQ(half_from_float(FLT_MIN), 0x0000);
+  EXPECT_EQ(half_from_float(float_from_bits(0x00000001)), 0x0000);
+  EXPECT_EQ(half_from_float(float_from_bits(0x80000001)), 0x8000);
+}
+
+/* Ties round to the even mantissa, everything else to the nearest half float. */
+TEST(imbuf_half_float, rounding)
+{
+  const float ulp = ldexpf(1.0f, -10);
+  EXPECT_EQ(half_from_float(1.0f + ulp * 0.5f), 0x3c00);
+  EXPECT_EQ(half_from_float(1.0f + ulp * 1.5f), 0x3c02);
+  EXPECT_EQ(half_from_float(1.0f + ulp * 0.5f + ldexpf(1.0f, -20)), 0x3c01);
+  EXPECT_EQ(half_from_float(1.0f + ulp * 0.49f), 0x3c00);
+  EXPECT_EQ(half_from_float(-1.0f - ulp * 1.5f), 0xbc02);
+  /* Rounding up the mantissa carries into the exponent. */
+  EXPECT_EQ(half_from_float(2.0f - ulp * 0.25f), 0x4000);
+
+  /* Sample all positive finite floats in the half float range, the result must be at least as
+   * close as its neighbors. */
+  for (uint32_t bits = 0; bits < 0x477ff000u; bits += 4099) {
+    const float value = float_from_bits(bits);
+    const unsigned short half = half_from_float(value);
+    const float error = fabsf(value - float_from_half(half));
+    if (half > 0) {
+      EXPECT_LE(error, fabsf(value - float_from_half(half - 1))) << std::hex << bits;
+    }
+    if (half < 0x7bff) {
+      EXPECT_LE(error, fabsf(value - float_from_half(half + 1))) << std::hex << bits;
+    }
+  }
+}
+
+/* Conversion of buffers gives the same result as the conversion of single values. */
+TEST(imbuf_half_float, buffer)
+{
+  const float values[] = {0.0f,
+                          -0.0f,
+                          0.18f,
+                          -1.5f,
+                          1.0f + ldexpf(1.0f, -11),
+                          ldexpf(3.0f, -25),
+                          ldexpf(1.0f, -20),
+                          65520.0f,
+                          -1e10f,
+                          INFINITY,
+                          NAN,
+                          12.3456f,
+                          1e-10f};
+  const int len = ARRAY_SIZE(values);
+  unsigned short halfs[ARRAY_SIZE(values)];
+  float result[ARRAY_SIZE(values)];
+  IMB_buffer_half_from_float(halfs, values, len);
+  IMB_buffer_float_from_half(result, halfs, len);
+
+  for (int i = 0; i < len; i++) {
+    if (std::isnan(values[i])) {
+      EXPECT_TRUE(half_is_nan(halfs[i]));
+      EXPECT_TRUE(std::isnan(result[i]));
+    }
+    else {
+      EXPECT_EQ(halfs[i], half_from_float(values[i])) << i;
+      EXPECT_EQ(result[i], float_from_half(halfs[i])) << i;
+    }
+  }
+}
+
+}  // namespace blender::imbuf::tests
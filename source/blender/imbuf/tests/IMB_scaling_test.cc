@@ -0,0 +1,78 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+namespace blender::imbuf::tests {
+
+static const eIMBScaleFilter filters[] = {
+    IMB_SCALE_FILTER_BOX,
+    IMB_SCALE_FILTER_BILINEAR,
+    IMB_SCALE_FILTER_BICUBIC,
+    IMB_SCALE_FILTER_LANCZOS,
+};
+
+static ImBuf *create_constant_imbuf(int width, int height, const float color[4])
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rect | IB_rectfloat);
+  unsigned char *rect = (unsigned char *)ibuf->rect;
+  for (int i = 0; i < width * height; i++) {
+    for (int c = 0; c < 4; c++) {
+      ibuf->rect_float[i * 4 + c] = color[c];
+      rect[i * 4 + c] = (unsigned char)(color[c] * 255.0f + 0.5f);
+    }
+  }
+  return ibuf;
+}
+
+/* Normalized weights keep a constant image constant, for every size and filter. */
+TEST(imbuf_scaling, filter_constant)
+{
+  const float color[4] = {0.2f, 0.4f, 0.6f, 1.0f};
+  const int sizes[][2] = {{1, 1}, {7, 3}, {50, 31}, {203, 97}};
+
+  for (const eIMBScaleFilter filter : filters) {
+    for (const auto &size : sizes) {
+      ImBuf *ibuf = create_constant_imbuf(67, 41, color);
+      EXPECT_TRUE(IMB_scale_filter_ImBuf(ibuf, size[0], size[1], filter));
+      EXPECT_EQ(ibuf->x, size[0]);
+      EXPECT_EQ(ibuf->y, size[1]);
+
+      const unsigned char *rect = (const unsigned char *)ibuf->rect;
+      for (int i = 0; i < ibuf->x * ibuf->y; i++) {
+        for (int c = 0; c < 4; c++) {
+          EXPECT_NEAR(ibuf->rect_float[i * 4 + c], color[c], 1e-5f);
+          EXPECT_EQ(rect[i * 4 + c], (unsigned char)(color[c] * 255.0f + 0.5f));
+        }
+      }
+      IMB_freeImBuf(ibuf);
+    }
+  }
+}
+
+/* Halving with the box filter averages each 2x2 block. */
+TEST(imbuf_scaling, filter_box_half)
+{
+  ImBuf *ibuf = IMB_allocImBuf(4, 2, 32, IB_rectfloat);
+  ibuf->channels = 1;
+  for (int i = 0; i < 8; i++) {
+    ibuf->rect_float[i] = (float)i;
+  }
+
+  EXPECT_TRUE(IMB_scale_filter_ImBuf(ibuf, 2, 1, IMB_SCALE_FILTER_BOX));
+  EXPECT_FLOAT_EQ(ibuf->rect_float[0], 2.5f);
+  EXPECT_FLOAT_EQ(ibuf->rect_float[1], 4.5f);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_scaling, filter_same_size)
+{
+  const float color[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+  ImBuf *ibuf = create_constant_imbuf(8, 8, color);
+  EXPECT_FALSE(IMB_scale_filter_ImBuf(ibuf, 8, 8, IMB_SCALE_FILTER_LANCZOS));
+  IMB_freeImBuf(ibuf);
+}
+
+}  // namespace blender::imbuf::tests
@@ -0,0 +1,121 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstdio>
+
+#include "PIL_time.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+/* Scale a full HD frame, like sequencer previews and thumbnails do. */
+#define FRAME_WIDTH 1920
+#define FRAME_HEIGHT 1080
+#define NUM_RUN_AVERAGED 5
+
+enum ScaleMethod {
+  SCALE_METHOD_DEFAULT,
+  SCALE_METHOD_THREADED,
+  SCALE_METHOD_FILTER_BOX,
+  SCALE_METHOD_FILTER_BILINEAR,
+  SCALE_METHOD_FILTER_BICUBIC,
+  SCALE_METHOD_FILTER_LANCZOS,
+  SCALE_METHOD_NUM,
+};
+
+static const char *scale_method_names[SCALE_METHOD_NUM] = {
+    "IMB_scaleImBuf",
+    "IMB_scaleImBuf_threaded",
+    "IMB_scale_filter_ImBuf box",
+    "IMB_scale_filter_ImBuf bilinear",
+    "IMB_scale_filter_ImBuf bicubic",
+    "IMB_scale_filter_ImBuf lanczos",
+};
+
+static ImBuf *create_frame(int flags)
+{
+  ImBuf *ibuf = IMB_allocImBuf(FRAME_WIDTH, FRAME_HEIGHT, 32, flags);
+  const size_t len = (size_t)FRAME_WIDTH * FRAME_HEIGHT * 4;
+  uint seed = 1;
+  for (size_t i = 0; i < len; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    if (ibuf->rect) {
+      ((unsigned char *)ibuf->rect)[i] = (unsigned char)(seed >> 24);
+    }
+    if (ibuf->rect_float) {
+      ibuf->rect_float[i] = (float)(seed >> 8) / (float)(1 << 24);
+    }
+  }
+  return ibuf;
+}
+
+static void scale(ImBuf *ibuf, ScaleMethod method, int newx, int newy)
+{
+  switch (method) {
+    case SCALE_METHOD_DEFAULT:
+      IMB_scaleImBuf(ibuf, newx, newy);
+      break;
+    case SCALE_METHOD_THREADED:
+      IMB_scaleImBuf_threaded(ibuf, newx, newy);
+      break;
+    case SCALE_METHOD_FILTER_BOX:
+      IMB_scale_filter_ImBuf(ibuf, newx, newy, IMB_SCALE_FILTER_BOX);
+      break;
+    case SCALE_METHOD_FILTER_BILINEAR:
+      IMB_scale_filter_ImBuf(ibuf, newx, newy, IMB_SCALE_FILTER_BILINEAR);
+      break;
+    case SCALE_METHOD_FILTER_BICUBIC:
+      IMB_scale_filter_ImBuf(ibuf, newx, newy, IMB_SCALE_FILTER_BICUBIC);
+      break;
+    case SCALE_METHOD_FILTER_LANCZOS:
+      IMB_scale_filter_ImBuf(ibuf, newx, newy, IMB_SCALE_FILTER_LANCZOS);
+      break;
+    case SCALE_METHOD_NUM:
+      break;
+  }
+}
+
+static void bench_scale(const char *id, int flags, int newx, int newy)
+{
+  double default_time = 0.0;
+
+  printf("\t%s (%dx%d to %dx%d):\n", id, FRAME_WIDTH, FRAME_HEIGHT, newx, newy);
+  for (int method = 0; method < SCALE_METHOD_NUM; method++) {
+    double averaged_timing = 0.0;
+    for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+      ImBuf *ibuf = create_frame(flags);
+      const double init_time = PIL_check_seconds_timer();
+      scale(ibuf, (ScaleMethod)method, newx, newy);
+      averaged_timing += PIL_check_seconds_timer() - init_time;
+      IMB_freeImBuf(ibuf);
+    }
+    averaged_timing /= NUM_RUN_AVERAGED;
+    if (method == SCALE_METHOD_DEFAULT) {
+      default_time = averaged_timing;
+    }
+
+    printf("\t\t%s: %.3fms on average over %d runs (%.2fx)\n",
+           scale_method_names[method],
+           averaged_timing * 1000.0,
+           NUM_RUN_AVERAGED,
+           default_time / averaged_timing);
+  }
+}
+
+TEST(imbuf_scaling, ScaleDown_Byte)
+{
+  bench_scale("byte, preview size", IB_rect, FRAME_WIDTH / 4, FRAME_HEIGHT / 4);
+  bench_scale("byte, thumbnail size", IB_rect, 256, 144);
+}
+
+TEST(imbuf_scaling, ScaleDown_Float)
+{
+  bench_scale("float, preview size", IB_rectfloat, FRAME_WIDTH / 4, FRAME_HEIGHT / 4);
+}
+
+TEST(imbuf_scaling, ScaleUp)
+{
+  bench_scale("byte", IB_rect, FRAME_WIDTH * 3 / 2, FRAME_HEIGHT * 3 / 2);
+  bench_scale("float", IB_rectfloat, FRAME_WIDTH * 3 / 2, FRAME_HEIGHT * 3 / 2);
+}
@@ -69,6 +69,9 @@ struct AlembicExportParams {
   int ngon_method;
 
   float global_scale;
+
+  /* Number of frames which are evaluated at the same time, each using its own dependency graph. */
+  int concurrent_frames;
 };
 
 /* The ABC_export and ABC_import functions both take a as_background_job
@@ -49,6 +49,7 @@ static CLG_LogRef LOG = {"io.alembic"};
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 struct ExportJobData {
   Main *bmain;
@@ -75,6 +76,85 @@ static void build_depsgraph(Depsgraph *depsgraph, const bool visible_objects_onl
   }
 }
 
+struct ExportFramesData {
+  ABCArchive *abc_archive;
+  ABCHierarchyIterator *iter;
+  std::vector<double> frames;
+
+  short *stop;
+  short *do_update;
+  float *progress;
+  float progress_per_frame;
+};
+
+static bool export_frame_cb(Depsgraph *depsgraph, const int frame_index, void *user_data)
+{
+  ExportFramesData *frames_data = static_cast<ExportFramesData *>(user_data);
+  if (G.is_break || (frames_data->stop != nullptr && *frames_data->stop)) {
+    return false;
+  }
+
+  const double frame = frames_data->frames[frame_index];
+  CLOG_INFO(&LOG, 2, "Exporting frame %.2f", frame);
+  ExportSubset export_subset = frames_data->abc_archive->export_subset_for_frame(frame);
+  frames_data->iter->set_depsgraph(depsgraph);
+  frames_data->iter->set_export_subset(export_subset);
+  frames_data->iter->iterate_and_write();
+
+  *frames_data->progress += frames_data->progress_per_frame;
+  *frames_data->do_update = true;
+  return true;
+}
+
+/* Evaluate multiple frames at the same time, each one using its own dependency graph. The frames
+ * are still written in order, as soon as they are evaluated. */
+static void export_frames_concurrently(ExportJobData *data,
+                                       ABCArchive *abc_archive,
+                                       ABCHierarchyIterator &iter,
+                                       short *stop,
+                                       short *do_update,
+                                       float *progress,
+                                       const float progress_per_frame)
+{
+  ExportFramesData frames_data;
+  frames_data.abc_archive = abc_archive;
+  frames_data.iter = &iter;
+  frames_data.frames.assign(abc_archive->frames_begin(), abc_archive->frames_end());
+  frames_data.stop = stop;
+  frames_data.do_update = do_update;
+  frames_data.progress = progress;
+  frames_data.progress_per_frame = progress_per_frame;
+
+  const std::vector<float> ctimes(frames_data.frames.begin(), frames_data.frames.end());
+  const int num_depsgraphs = std::min(data->params.concurrent_frames,
+                                      static_cast<int>(ctimes.size()));
+
+  /* The depsgraph of the job evaluates the first frame, others are built the same way. */
+  Scene *scene = DEG_get_input_scene(data->depsgraph);
+  ViewLayer *view_layer = DEG_get_input_view_layer(data->depsgraph);
+  std::vector<Depsgraph *> depsgraphs = {data->depsgraph};
+  for (int i = 1; i < num_depsgraphs; i++) {
+    Depsgraph *depsgraph = DEG_graph_new(data->bmain, scene, view_layer, DAG_EVAL_RENDER);
+    build_depsgraph(depsgraph, data->params.visible_objects_only);
+    /* Copy-on-write of the scene overwrites the frame of the evaluated scene with the one of the
+     * original scene. Do it now, so it doesn't happen while evaluating the first frame. */
+    BKE_scene_graph_update_tagged(depsgraph, data->bmain);
+    depsgraphs.push_back(depsgraph);
+  }
+
+  DEG_evaluate_frames(depsgraphs.data(),
+                      static_cast<int>(depsgraphs.size()),
+                      ctimes.data(),
+                      static_cast<int>(ctimes.size()),
+                      export_frame_cb,
+                      &frames_data);
+
+  iter.set_depsgraph(data->depsgraph);
+  for (int i = 1; i < num_depsgraphs; i++) {
+    DEG_graph_free(depsgraphs[i]);
+  }
+}
+
 static void export_startjob(void *customdata,
                             /* Cannot be const, this function implements wm_jobs_start_callback.
                              * NOLINTNEXTLINE: readability-non-const-parameter. */
@@ -138,28 +218,34 @@ static void export_startjob(void *customdata,
 
     /* Writing the animated frames is not 100% of the work, but it's our best guess. */
     const float progress_per_frame = 1.0f / std::max(size_t(1), abc_archive->total_frame_count());
-    ABCArchive::Frames::const_iterator frame_it = abc_archive->frames_begin();
-    const ABCArchive::Frames::const_iterator frames_end = abc_archive->frames_end();
+    if (data->params.concurrent_frames > 1) {
+      export_frames_concurrently(
+          data, abc_archive.get(), iter, stop, do_update, progress, progress_per_frame);
+    }
+    else {
+      ABCArchive::Frames::const_iterator frame_it = abc_archive->frames_begin();
+      const ABCArchive::Frames::const_iterator frames_end = abc_archive->frames_end();
 
-    for (; frame_it != frames_end; frame_it++) {
-      double frame = *frame_it;
+      for (; frame_it != frames_end; frame_it++) {
+        double frame = *frame_it;
 
-      if (G.is_break || (stop != nullptr && *stop)) {
-        break;
-      }
+        if (G.is_break || (stop != nullptr && *stop)) {
+          break;
+        }
 
-      /* Update the scene for the next frame to render. */
-      scene->r.cfra = static_cast<int>(frame);
-      scene->r.subframe = frame - scene->r.cfra;
-      BKE_scene_graph_update_for_newframe(data->depsgraph);
+        /* Update the scene for the next frame to render. */
+        scene->r.cfra = static_cast<int>(frame);
+        scene->r.subframe = frame - scene->r.cfra;
+        BKE_scene_graph_update_for_newframe(data->depsgraph);
 
-      CLOG_INFO(&LOG, 2, "Exporting frame %.2f", frame);
-      ExportSubset export_subset = abc_archive->export_subset_for_frame(frame);
-      iter.set_export_subset(export_subset);
-      iter.iterate_and_write();
+        CLOG_INFO(&LOG, 2, "Exporting frame %.2f", frame);
+        ExportSubset export_subset = abc_archive->export_subset_for_frame(frame);
+        iter.set_export_subset(export_subset);
+        iter.iterate_and_write();
 
-      *progress += progress_per_frame;
-      *do_update = true;
+        *progress += progress_per_frame;
+        *do_update = true;
+      }
     }
   }
   else {
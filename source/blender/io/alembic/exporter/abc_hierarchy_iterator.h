@@ -37,8 +37,9 @@ namespace blender::io::alembic {
 class ABCAbstractWriter;
 class ABCHierarchyIterator;
 
+/* Writers get the dependency graph from the hierarchy iterator, as it might change from frame to
+ * frame. */
 struct ABCWriterConstructorArgs {
-  Depsgraph *depsgraph;
   ABCArchive *abc_archive;
   Alembic::Abc::OObject abc_parent;
   std::string abc_name;
@@ -75,8 +75,9 @@ bool ABCHairWriter::check_is_animated(const HierarchyContext & /*context*/) cons
 
 void ABCHairWriter::do_write(HierarchyContext &context)
 {
-  Scene *scene_eval = DEG_get_evaluated_scene(args_.depsgraph);
-  Mesh *mesh = mesh_get_eval_final(args_.depsgraph, scene_eval, context.object, &CD_MASK_MESH);
+  Depsgraph *depsgraph = args_.hierarchy_iterator->get_depsgraph();
+  Scene *scene_eval = DEG_get_evaluated_scene(depsgraph);
+  Mesh *mesh = mesh_get_eval_final(depsgraph, scene_eval, context.object, &CD_MASK_MESH);
   BKE_mesh_tessface_ensure(mesh);
 
   std::vector<Imath::V3f> verts;
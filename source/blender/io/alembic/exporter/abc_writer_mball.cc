@@ -41,7 +41,7 @@ ABCMetaballWriter::ABCMetaballWriter(const ABCWriterConstructorArgs &args)
 
 bool ABCMetaballWriter::is_supported(const HierarchyContext *context) const
 {
-  Scene *scene = DEG_get_input_scene(args_.depsgraph);
+  Scene *scene = DEG_get_input_scene(args_.hierarchy_iterator->get_depsgraph());
   bool supported = is_basis_ball(scene, context->object) &&
                    ABCGenericMeshWriter::is_supported(context);
   return supported;
@@ -69,7 +69,8 @@ Mesh *ABCMetaballWriter::get_export_mesh(Object *object_eval, bool &r_needsfree)
     return mesh_eval;
   }
   r_needsfree = true;
-  return BKE_mesh_new_from_object(args_.depsgraph, object_eval, false);
+  return BKE_mesh_new_from_object(
+      args_.hierarchy_iterator->get_depsgraph(), object_eval, false);
 }
 
 void ABCMetaballWriter::free_export_mesh(Mesh *mesh)
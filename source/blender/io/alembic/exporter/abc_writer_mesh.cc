@@ -108,9 +108,6 @@ void ABCGenericMeshWriter::create_alembic_objects(const HierarchyContext *contex
     OBoolProperty type(typeContainer, "meshtype");
     type.set(subsurf_modifier_ == nullptr);
   }
-
-  Scene *scene_eval = DEG_get_evaluated_scene(args_.depsgraph);
-  liquid_sim_modifier_ = get_liquid_sim_modifier(scene_eval, context->object);
 }
 
 ABCGenericMeshWriter::~ABCGenericMeshWriter()
@@ -176,6 +173,11 @@ void ABCGenericMeshWriter::do_write(HierarchyContext &context)
   Object *object = context.object;
   bool needsfree = false;
 
+  /* The modifier belongs to the evaluated object, which might come from a different dependency
+   * graph every frame. */
+  Scene *scene_eval = DEG_get_evaluated_scene(args_.hierarchy_iterator->get_depsgraph());
+  liquid_sim_modifier_ = get_liquid_sim_modifier(scene_eval, object);
+
   Mesh *mesh = get_export_mesh(object, needsfree);
 
   if (mesh == nullptr) {
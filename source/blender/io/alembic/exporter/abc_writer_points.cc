@@ -96,8 +96,8 @@ void ABCPointsWriter::do_write(HierarchyContext &context)
   ParticleSystem *psys = context.particle_system;
   ParticleKey state;
   ParticleSimulationData sim;
-  sim.depsgraph = args_.depsgraph;
-  sim.scene = DEG_get_evaluated_scene(args_.depsgraph);
+  sim.depsgraph = args_.hierarchy_iterator->get_depsgraph();
+  sim.scene = DEG_get_evaluated_scene(sim.depsgraph);
   sim.ob = context.object;
   sim.psys = psys;
 
@@ -111,7 +111,7 @@ void ABCPointsWriter::do_write(HierarchyContext &context)
       continue;
     }
 
-    state.time = DEG_get_ctime(args_.depsgraph);
+    state.time = DEG_get_ctime(sim.depsgraph);
     if (psys_get_particle_state(&sim, p, &state, 0) == 0) {
       continue;
     }
@@ -250,6 +250,11 @@ class AbstractHierarchyIterator {
    * previous iteration. */
   void set_export_subset(ExportSubset export_subset_);
 
+  /* Iterate over a different dependency graph from now on. The graph is to be built for the same
+   * scene, for example when frames are evaluated by multiple graphs, see DEG_evaluate_frames(). */
+  void set_depsgraph(Depsgraph *depsgraph);
+  Depsgraph *get_depsgraph() const;
+
   /* Convert the given name to something that is valid for the exported file format.
    * This base implementation is a no-op; override in a concrete subclass. */
   virtual std::string make_valid_name(const std::string &name) const;
@@ -616,6 +616,10 @@ enum {
   /* RESET_AFTER_USE Used by undo system to tag unchanged IDs re-used from old Main (instead of
    * read from memfile). */
   LIB_TAG_UNDO_OLD_ID_REUSED = 1 << 19,
+
+  /* RESET_NEVER Empty placeholder, the contents of this data-block were not read from the file
+   * yet (see #BKE_main_lazy_load_ensure_id). */
+  LIB_TAG_LAZY_LOAD = 1 << 20,
 };
 
 /* Tag given ID for an update in all the dependency graphs. */
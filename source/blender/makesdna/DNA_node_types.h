@@ -472,7 +472,8 @@ typedef struct bNodeTree {
    * in case multiple different editors are used and make context ambiguous.
    */
   bNodeInstanceKey active_viewer_key;
-  char _pad[4];
+  /** Execution model of the compositor engine, see #eNodeTreeExecutionMode. */
+  int execution_mode;
 
   /** Execution data.
    *
@@ -515,6 +516,14 @@ typedef struct bNodeTree {
 /* tree is localized copy, free when deleting node groups */
 /* #define NTREE_IS_LOCALIZED           (1 << 5) */
 
+/* ntree->execution_mode */
+typedef enum eNodeTreeExecutionMode {
+  /** Pixels are evaluated one at a time, pulled through the operations of each chunk. */
+  NTREE_EXECUTION_MODE_TILED = 0,
+  /** Operations process whole buffers at once, see `NodeOperation::update_memory_buffer`. */
+  NTREE_EXECUTION_MODE_FULL_FRAME = 1,
+} eNodeTreeExecutionMode;
+
 /* ntree->update */
 typedef enum eNodeTreeUpdate {
   NTREE_UPDATE = 0xFFFF,             /* generic update flag (includes all others) */
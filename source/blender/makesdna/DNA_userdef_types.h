@@ -763,7 +763,11 @@ typedef struct UserDef {
   int prefetchframes;
   /** Control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use. */
   float pad_rot_angle;
-  char _pad12[4];
+  /** Memory limit of cached compositor results, in megabytes. 0 disables the cache. */
+  int compositor_cachelimit;
+  /** Memory limits of cached images and movie clips, in megabytes. 0 for only #memcachelimit. */
+  int memcachelimit_image;
+  int memcachelimit_clip;
   /** Rotating view icon size. */
   short rvisize;
   /** Rotating view icon brightness. */
@@ -890,10 +894,13 @@ typedef struct UserDef {
   int sequencer_disk_cache_compression; /* eUserpref_DiskCacheCompression */
   int sequencer_disk_cache_size_limit;
   short sequencer_disk_cache_flag;
-  char _pad5[2];
+  short sequencer_flag; /* eUserpref_SequencerFlag */
 
   float collection_instance_empty_size;
-  char _pad10[3];
+  /** Number of threads prefetching sequencer frames, 0 for automatic. */
+  char sequencer_prefetch_threads;
+  char colormanagement_flag; /* eUserpref_ColorManagementFlag */
+  char _pad10[1];
 
   char statusbar_flag; /* eUserpref_StatusBar_Flag */
 
@@ -951,7 +958,7 @@ typedef enum eUserPref_SpaceData_Flag {
 typedef enum eUserPref_Flag {
   USER_AUTOSAVE = (1 << 0),
   USER_FLAG_NUMINPUT_ADVANCED = (1 << 1),
-  USER_FLAG_UNUSED_2 = (1 << 2), /* cleared */
+  USER_FILE_INCREMENTAL = (1 << 2),
   USER_FLAG_UNUSED_3 = (1 << 3), /* cleared */
   USER_FLAG_UNUSED_4 = (1 << 4), /* cleared */
   USER_TRACKBALL = (1 << 5),
@@ -1083,6 +1090,11 @@ typedef enum eUserpref_GPU_Flag {
   USER_GPU_FLAG_OVERLAY_SMOOTH_WIRE = (1 << 2),
 } eUserpref_GPU_Flag;
 
+/** #UserDef.colormanagement_flag */
+typedef enum eUserpref_ColorManagementFlag {
+  USER_CM_BAKED_DISPLAY_TRANSFORM = (1 << 0),
+} eUserpref_ColorManagementFlag;
+
 /** #UserDef.tablet_api */
 typedef enum eUserpref_TableAPI {
   USER_TABLET_AUTOMATIC = 0,
@@ -1341,8 +1353,15 @@ typedef enum eUserpref_DiskCacheCompression {
   USER_SEQ_DISK_CACHE_COMPRESSION_NONE = 0,
   USER_SEQ_DISK_CACHE_COMPRESSION_LOW = 1,
   USER_SEQ_DISK_CACHE_COMPRESSION_HIGH = 2,
+  USER_SEQ_DISK_CACHE_COMPRESSION_FAST = 3,
 } eUserpref_DiskCacheCompression;
 
+/** #UserDef.sequencer_flag */
+typedef enum eUserpref_SequencerFlag {
+  /** Render the strips of a frame one after another, instead of at the same time. */
+  USER_SEQ_SERIAL_RENDER = (1 << 0),
+} eUserpref_SequencerFlag;
+
 /* Locale Ids. Auto will try to get local from OS. Our default is English though. */
 /** #UserDef.language */
 enum {
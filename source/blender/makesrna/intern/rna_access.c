@@ -44,6 +44,7 @@
 #include "BKE_collection.h"
 #include "BKE_context.h"
 #include "BKE_fcurve.h"
+#include "BKE_global.h"
 #include "BKE_idprop.h"
 #include "BKE_idtype.h"
 #include "BKE_main.h"
@@ -117,6 +118,33 @@ void RNA_main_pointer_create(struct Main *main, PointerRNA *r_ptr)
   r_ptr->data = main;
 }
 
+/**
+ * Read the contents of lazily loaded data-blocks when they are first accessed through RNA.
+ * Only the current file can have such data-blocks (see #BLO_READ_LAZY_DATA).
+ */
+BLI_INLINE void rna_id_lazy_load_ensure(ID *id)
+{
+  if (id != NULL && (id->tag & LIB_TAG_LAZY_LOAD)) {
+    BKE_main_lazy_load_ensure_id(G_MAIN, id);
+  }
+}
+
+/**
+ * Properties of the ID header (name, users, ...) are kept by the placeholder of a lazily loaded
+ * data-block, so listing data-blocks doesn't read them. Any other property reads the contents.
+ */
+static void rna_property_lazy_load_ensure(PointerRNA *ptr, PropertyRNA *prop)
+{
+  ID *id = ptr->owner_id;
+  if (id == NULL || (id->tag & LIB_TAG_LAZY_LOAD) == 0) {
+    return;
+  }
+  if (prop->magic == RNA_MAGIC && BLI_findindex(&RNA_ID.cont.properties, prop) != -1) {
+    return;
+  }
+  BKE_main_lazy_load_ensure_id(G_MAIN, id);
+}
+
 void RNA_id_pointer_create(ID *id, PointerRNA *r_ptr)
 {
   StructRNA *type, *idtype = NULL;
@@ -372,6 +400,8 @@ IDProperty *RNA_struct_idprops(PointerRNA *ptr, bool create)
   StructRNA *type = ptr->type;
 
   if (type && type->idproperties) {
+    /* ID-properties are read with the contents. */
+    rna_id_lazy_load_ensure(ptr->owner_id);
     return type->idproperties(ptr, create);
   }
 
@@ -418,7 +448,11 @@ static int rna_ensure_property_array_length(PointerRNA *ptr, PropertyRNA *prop)
 {
   if (prop->magic == RNA_MAGIC) {
     int arraylen[RNA_MAX_ARRAY_DIMENSION];
-    return (prop->getlength && ptr->data) ? prop->getlength(ptr, arraylen) : prop->totarraylength;
+    if (prop->getlength && ptr->data) {
+      rna_property_lazy_load_ensure(ptr, prop);
+      return prop->getlength(ptr, arraylen);
+    }
+    return prop->totarraylength;
   }
   IDProperty *idprop = (IDProperty *)prop;
 
@@ -562,6 +596,8 @@ void rna_property_rna_or_id_get(PropertyRNA *prop,
    * pointer to the IDProperty. */
   memset(r_prop_rna_or_id, 0, sizeof(*r_prop_rna_or_id));
 
+  rna_property_lazy_load_ensure(ptr, prop);
+
   r_prop_rna_or_id->ptr = *ptr;
   r_prop_rna_or_id->rawprop = prop;
 
@@ -7575,6 +7611,7 @@ int RNA_function_call(
     bContext *C, ReportList *reports, PointerRNA *ptr, FunctionRNA *func, ParameterList *parms)
 {
   if (func->call) {
+    rna_id_lazy_load_ensure(ptr->owner_id);
     func->call(C, reports, ptr, parms);
 
     return 0;
@@ -115,6 +115,21 @@ static const EnumPropertyItem node_chunksize_items[] = {
     {NTREE_CHUNKSIZE_1024, "1024", 0, "1024x1024", "Chunksize of 1024x1024"},
     {0, NULL, 0, NULL, NULL},
 };
+
+static const EnumPropertyItem node_execution_mode_items[] = {
+    {NTREE_EXECUTION_MODE_TILED,
+     "TILED",
+     0,
+     "Tiled",
+     "Evaluate pixels one at a time, for each tile"},
+    {NTREE_EXECUTION_MODE_FULL_FRAME,
+     "FULL_FRAME",
+     0,
+     "Full Frame",
+     "Let operations that support it process whole buffers at once, which is faster for "
+     "simple per pixel operations"},
+    {0, NULL, 0, NULL, NULL},
+};
 #endif
 
 const EnumPropertyItem rna_enum_mapping_type_items[] = {
@@ -9773,6 +9788,12 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
                            "Max size of a tile (smaller values gives better distribution "
                            "of multiple threads, but more overhead)");
 
+  prop = RNA_def_property(srna, "execution_mode", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_sdna(prop, NULL, "execution_mode");
+  RNA_def_property_enum_items(prop, node_execution_mode_items);
+  RNA_def_property_ui_text(prop, "Execution Mode", "Set how compositing is executed");
+  RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_NodeTree_update");
+
   prop = RNA_def_property(srna, "use_opencl", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_OPENCL);
   RNA_def_property_ui_text(prop, "OpenCL", "Enable GPU calculations");
@@ -1138,6 +1138,42 @@ static void rna_SequenceEditor_overlay_frame_set(PointerRNA *ptr, int value)
   }
 }
 
+static int rna_SequenceEditor_cache_hits_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics stats;
+  BKE_sequencer_cache_statistics_get((Scene *)ptr->owner_id, &stats);
+  return (int)MIN2(stats.hits, INT_MAX);
+}
+
+static int rna_SequenceEditor_cache_disk_hits_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics stats;
+  BKE_sequencer_cache_statistics_get((Scene *)ptr->owner_id, &stats);
+  return (int)MIN2(stats.disk_hits, INT_MAX);
+}
+
+static int rna_SequenceEditor_cache_misses_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics stats;
+  BKE_sequencer_cache_statistics_get((Scene *)ptr->owner_id, &stats);
+  return (int)MIN2(stats.misses, INT_MAX);
+}
+
+static float rna_SequenceEditor_cache_hit_ratio_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics stats;
+  BKE_sequencer_cache_statistics_get((Scene *)ptr->owner_id, &stats);
+  const uint64_t lookups = stats.hits + stats.disk_hits + stats.misses;
+  return (lookups) ? (float)(stats.hits + stats.disk_hits) / lookups : 0.0f;
+}
+
+static float rna_SequenceEditor_cache_lock_wait_time_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics stats;
+  BKE_sequencer_cache_statistics_get((Scene *)ptr->owner_id, &stats);
+  return (float)stats.lock_wait_time;
+}
+
 static int modifier_seq_cmp_fn(Sequence *seq, void *arg_pt)
 {
   SequenceSearchData *data = arg_pt;
@@ -2087,6 +2123,13 @@ static void rna_def_editor(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "cache_flag", SEQ_CACHE_STORE_FINAL_OUT);
   RNA_def_property_ui_text(prop, "Cache Final", "Cache final image for each frame");
 
+  prop = RNA_def_property(srna, "use_cache_half_float", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "cache_flag", SEQ_CACHE_STORE_HALF_FLOAT);
+  RNA_def_property_ui_text(prop,
+                           "Half Float Cache",
+                           "Store float images in the cache with half precision, so twice as "
+                           "many frames fit in memory");
+
   prop = RNA_def_property(srna, "use_prefetch", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "cache_flag", SEQ_CACHE_PREFETCH_ENABLE);
   RNA_def_property_ui_text(
@@ -2101,6 +2144,38 @@ static void rna_def_editor(BlenderRNA *brna)
   RNA_def_property_float_sdna(prop, NULL, "recycle_max_cost");
   RNA_def_property_ui_text(
       prop, "Recycle Up To Cost", "Only frames with cost lower than this value will be recycled");
+
+  /* cache statistics */
+
+  prop = RNA_def_property(srna, "cache_hits", PROP_INT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_hits_get", NULL, NULL);
+  RNA_def_property_ui_text(prop, "Cache Hits", "Number of images found in the RAM cache");
+
+  prop = RNA_def_property(srna, "cache_disk_hits", PROP_INT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_disk_hits_get", NULL, NULL);
+  RNA_def_property_ui_text(prop, "Disk Cache Hits", "Number of images found in the disk cache");
+
+  prop = RNA_def_property(srna, "cache_misses", PROP_INT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_misses_get", NULL, NULL);
+  RNA_def_property_ui_text(
+      prop, "Cache Misses", "Number of images that were not cached and had to be rendered");
+
+  prop = RNA_def_property(srna, "cache_hit_ratio", PROP_FLOAT, PROP_FACTOR);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_float_funcs(prop, "rna_SequenceEditor_cache_hit_ratio_get", NULL, NULL);
+  RNA_def_property_ui_text(
+      prop, "Cache Hit Ratio", "Fraction of cache lookups that found an image in RAM or on disk");
+
+  prop = RNA_def_property(srna, "cache_lock_wait_time", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_float_funcs(prop, "rna_SequenceEditor_cache_lock_wait_time_get", NULL, NULL);
+  RNA_def_property_ui_text(prop,
+                           "Cache Lock Wait Time",
+                           "Time in seconds rendering threads waited for each other to modify "
+                           "the cache");
 }
 
 static void rna_def_filter_video(StructRNA *srna)
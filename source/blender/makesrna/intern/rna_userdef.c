@@ -196,6 +196,9 @@ static const EnumPropertyItem rna_enum_userdef_viewport_aa_items[] = {
 
 #  include "BLI_path_util.h"
 
+#  include "IMB_colormanagement.h"
+#  include "IMB_moviecache.h"
+
 #  include "MEM_CacheLimiterC-Api.h"
 #  include "MEM_guardedalloc.h"
 
@@ -551,6 +554,19 @@ static void rna_Userdef_memcache_update(Main *UNUSED(bmain),
                                         PointerRNA *UNUSED(ptr))
 {
   MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+  IMB_moviecache_set_budget_limit(IMB_MOVIECACHE_BUDGET_IMAGE,
+                                  ((size_t)U.memcachelimit_image) * 1024 * 1024);
+  IMB_moviecache_set_budget_limit(IMB_MOVIECACHE_BUDGET_CLIP,
+                                  ((size_t)U.memcachelimit_clip) * 1024 * 1024);
+  USERDEF_TAG_DIRTY;
+}
+
+static void rna_userdef_display_lut_update(Main *UNUSED(bmain),
+                                           Scene *UNUSED(scene),
+                                           PointerRNA *UNUSED(ptr))
+{
+  IMB_colormanagement_display_lut_set_enabled(
+      (U.colormanagement_flag & USER_CM_BAKED_DISPLAY_TRANSFORM) != 0);
   USERDEF_TAG_DIRTY;
 }
 
@@ -5282,6 +5298,11 @@ static void rna_def_userdef_system(BlenderRNA *brna)
        0,
        "None",
        "Requires fast storage, but uses minimum CPU resources"},
+      {USER_SEQ_DISK_CACHE_COMPRESSION_FAST,
+       "FAST",
+       0,
+       "Fast",
+       "Requires fast storage, compresses and decompresses images with little CPU resources"},
       {USER_SEQ_DISK_CACHE_COMPRESSION_LOW,
        "LOW",
        0,
@@ -5337,6 +5358,50 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "memory_cache_limit_image", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "memcachelimit_image");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Image Cache Limit",
+                           "Part of the memory cache limit images can use, so they don't push "
+                           "movie clips out of the cache (in megabytes, 0 for no separate limit)");
+  RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
+
+  prop = RNA_def_property(srna, "memory_cache_limit_clip", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "memcachelimit_clip");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Movie Clip Cache Limit",
+                           "Part of the memory cache limit movie clips and motion tracking can "
+                           "use, so they don't push images out of the cache (in megabytes, 0 for "
+                           "no separate limit)");
+  RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
+
+  prop = RNA_def_property(srna, "compositor_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "compositor_cachelimit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(
+      prop,
+      "Compositor Cache Limit",
+      "Memory limit for keeping results of compositor nodes between updates, so only nodes "
+      "affected by a change are recalculated (in megabytes, 0 to disable)");
+  RNA_def_property_update(prop, 0, "rna_userdef_update");
+
+  prop = RNA_def_property(srna, "use_sequencer_parallel_render", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_negative_sdna(prop, NULL, "sequencer_flag", USER_SEQ_SERIAL_RENDER);
+  RNA_def_property_ui_text(prop,
+                           "Parallel Strip Rendering",
+                           "Render independent strips of a frame and the inputs of effect strips "
+                           "at the same time, using multiple threads");
+
+  prop = RNA_def_property(srna, "sequencer_prefetch_threads", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "sequencer_prefetch_threads");
+  RNA_def_property_range(prop, 0, 64);
+  RNA_def_property_ui_text(prop,
+                           "Prefetch Threads",
+                           "Number of threads rendering upcoming frames into the cache in the "
+                           "background (0 for automatic)");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
@@ -5385,6 +5450,15 @@ static void rna_def_userdef_system(BlenderRNA *brna)
                            "Enable Edit-Mode edge smoothing, reducing aliasing, requires restart");
   RNA_def_property_update(prop, 0, "rna_userdef_dpi_update");
 
+  prop = RNA_def_property(srna, "use_baked_display_transform", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(
+      prop, NULL, "colormanagement_flag", USER_CM_BAKED_DISPLAY_TRANSFORM);
+  RNA_def_property_ui_text(prop,
+                           "Baked Display Transform",
+                           "Use lookup tables for the view transform of large images, faster "
+                           "but not exact, views with hard edges like False Color are blurred");
+  RNA_def_property_update(prop, 0, "rna_userdef_display_lut_update");
+
   prop = RNA_def_property(srna, "use_region_overlap", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "uiflag2", USER_REGION_OVERLAP);
   RNA_def_property_ui_text(
@@ -6009,6 +6083,14 @@ static void rna_def_userdef_filepaths(BlenderRNA *brna)
   RNA_def_property_ui_text(
       prop, "Compress File", "Enable file compression when saving .blend files");
 
+  prop = RNA_def_property(srna, "use_file_incremental", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", USER_FILE_INCREMENTAL);
+  RNA_def_property_ui_text(prop,
+                           "Incremental Save",
+                           "Only write the data-blocks which changed when saving the same "
+                           "uncompressed file again, this keeps the data of the last save in "
+                           "memory (Linux only)");
+
   prop = RNA_def_property(srna, "use_load_ui", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_negative_sdna(prop, NULL, "flag", USER_FILENOUI);
   RNA_def_property_ui_text(prop, "Load UI", "Load user interface setup when loading .blend files");
@@ -308,6 +308,9 @@ void ntreeCompositTagRender(Scene *scene)
    * This is still rather weak though,
    * ideally render struct would store own main AND original G_MAIN. */
 
+  /* Render layer results of the scene changed. */
+  ntreeCompositTagIDChanged(&scene->id);
+
   for (Scene *sce_iter = G_MAIN->scenes.first; sce_iter; sce_iter = sce_iter->id.next) {
     if (sce_iter->nodetree) {
       bNode *node;
@@ -324,6 +327,16 @@ void ntreeCompositTagRender(Scene *scene)
   }
 }
 
+/* Invalidate cached compositor results using the ID. */
+void ntreeCompositTagIDChanged(const ID *id)
+{
+#ifdef WITH_COMPOSITOR
+  COM_tagIDChanged(id);
+#else
+  UNUSED_VARS(id);
+#endif
+}
+
 /* XXX after render animation system gets a refresh, this call allows composite to end clean */
 void ntreeCompositClearTags(bNodeTree *ntree)
 {
@@ -92,6 +92,7 @@ void BKE_sequence_iterator_end(SeqIterator *iter);
 
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /* Prefetch workers use consecutive IDs, starting with this one. */
   SEQ_TASK_PREFETCH_RENDER,
 } eSeqTaskId;
 
@@ -370,6 +371,19 @@ void BKE_sequencer_cache_iterate(struct Scene *scene,
                                                     float cost));
 bool BKE_sequencer_cache_is_full(struct Scene *scene);
 
+typedef struct SeqCacheStatistics {
+  /* Lookups found in RAM cache, in disk cache and not found at all. */
+  uint64_t hits;
+  uint64_t disk_hits;
+  uint64_t misses;
+  /* Time in seconds threads waited to modify the cache. */
+  double lock_wait_time;
+  int items_len;
+  size_t memory_used;
+} SeqCacheStatistics;
+
+void BKE_sequencer_cache_statistics_get(struct Scene *scene, SeqCacheStatistics *r_stats);
+
 /* **********************************************************************
  * seqprefetch.c
  *
@@ -20,10 +20,17 @@
  * \ingroup bke
  */
 
+#include <fcntl.h>
 #include <memory.h>
 #include <stddef.h>
 #include <time.h>
 
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
@@ -33,6 +40,7 @@
 #include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_metadata.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
@@ -40,15 +48,36 @@
 #include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_math_vector.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
 #include "BLI_path_util.h"
 #include "BLI_threads.h"
 
+#include "PIL_time.h"
+
 #include "BKE_global.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
 #include "BKE_sequencer.h"
 
+#include "atomic_ops.h"
+
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+#endif
+
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+/* Fastest regular level, decompression speed doesn't depend on the level. */
+#  define DCACHE_ZSTD_LEVEL 1
+#endif
+
 /**
  * Sequencer Cache Design Notes
  * ============================
@@ -73,6 +102,18 @@
  *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
  *
+ * Half float: With #SEQ_CACHE_STORE_HALF_FLOAT, permanent float images are stored with half
+ * precision. The item then owns an image without pixels, that keeps the properties of the
+ * original image, and the pixels in #SeqCacheItem.rect_half. Lookups return a new float image.
+ * The half float pixels are reference counted, so lookups only take references while the table
+ * is locked, and convert the pixels after unlocking it.
+ *
+ * Locking: Entries are spread over #SEQ_CACHE_SHARDS hash tables by the hash of their key.
+ * Lookups only lock a single table for reading, so they run in parallel with each other and
+ * with modifications of other tables. Modifications (putting, linking, recycling and removing
+ * entries) are serialized by the cache lock, and additionally lock the table they modify for
+ * writing. Linked entries can be in different tables, so recycling still considers all entries.
+ *
  *
  * Disk Cache Design Notes
  * =======================
@@ -81,8 +122,10 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
- * Images are written in order in which they are rendered.
+ * Image data can be stored uncompressed, or compressed by Zstd or LZO (fast) or Zlib with user
+ * definable level (per image). Files are memory-mapped for reading.
+ * Images are written in order in which they are rendered, by a separate thread, so rendering
+ * doesn't have to wait for compression and IO.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
  * size specified in user preferences.
@@ -94,11 +137,24 @@
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
+/* #DiskCacheHeaderEntry.codec */
+enum {
+  DCACHE_CODEC_ZLIB = 0,
+  DCACHE_CODEC_NONE = 1,
+  DCACHE_CODEC_LZO = 2,
+  DCACHE_CODEC_ZSTD = 3,
+};
+
+/* Images waiting to be written take memory in addition to the RAM cache, when writing is slower
+ * than rendering new images are not written to disk. */
+#define DCACHE_WRITE_QUEUE_MEMORY_MAX ((size_t)1024 * 1024 * 1024)
+
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char codec;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -116,8 +172,32 @@ typedef struct SeqDiskCache {
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+
+  /* Asynchronous writing of images, see #DiskCacheWriteItem.
+   * The queue is protected by read_write_mutex. */
+  ListBase write_thread;
+  ListBase write_queue;
+  ThreadCondition write_queue_cond;
+  size_t write_queue_memory;
+  /* Item taken from the queue, it is written without holding read_write_mutex. */
+  struct DiskCacheWriteItem *write_item_active;
+  bool write_thread_stop;
 } SeqDiskCache;
 
+typedef struct DiskCacheWriteItem {
+  struct DiskCacheWriteItem *next, *prev;
+  char path[FILE_MAX];
+  /* Same as #DiskCacheFile, to invalidate queued images like files. */
+  char dir[FILE_MAXDIR];
+  int cache_type;
+  int start_frame;
+  float nfra;
+  struct ImBuf *ibuf;
+  size_t memory;
+  /* Invalidated while being written, the written file is discarded. */
+  bool is_invalid;
+} DiskCacheWriteItem;
+
 typedef struct DiskCacheFile {
   struct DiskCacheFile *next, *prev;
   char path[FILE_MAX];
@@ -132,20 +212,55 @@ typedef struct DiskCacheFile {
   int start_frame;
 } DiskCacheFile;
 
+/* Number of hash tables of the RAM cache, see "Locking" above. */
+#define SEQ_CACHE_SHARDS_BITS 4
+#define SEQ_CACHE_SHARDS (1 << SEQ_CACHE_SHARDS_BITS)
+
+typedef struct SeqCacheShard {
+  struct GHash *hash;
+  ThreadRWMutex lock;
+} SeqCacheShard;
+
+/* Last stored key of the frame a render task is working on. Keys of a frame are linked to each
+ * other (see #SeqCacheKey.link_prev), every task has its own chain so frames rendered at the same
+ * time by prefetch workers are not linked together. */
+typedef struct SeqCacheLinkChain {
+  struct SeqCacheLinkChain *next, *prev;
+  int task_id;
+  float cfra;
+  struct SeqCacheKey *last_key;
+} SeqCacheLinkChain;
+
 typedef struct SeqCache {
   Main *bmain;
-  struct GHash *hash;
+  SeqCacheShard shards[SEQ_CACHE_SHARDS];
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  /* #SeqCacheLinkChain per render task. */
+  ListBase link_chains;
   size_t memory_used;
   SeqDiskCache *disk_cache;
+
+  /* Statistics, see #SeqCacheStatistics. Counters are updated atomically, wait time while
+   * holding the cache lock. */
+  uint64_t hits;
+  uint64_t disk_hits;
+  uint64_t misses;
+  double lock_wait_time;
 } SeqCache;
 
+/* Reference counted RGBA half float pixels, see #seq_cache_half_float_pack. */
+typedef struct SeqCacheHalfRect {
+  int refcounter;
+  unsigned short rect[];
+} SeqCacheHalfRect;
+
 typedef struct SeqCacheItem {
   struct SeqCache *cache_owner;
   struct ImBuf *ibuf;
+  /* Pixels of ibuf, when stored with half precision. */
+  SeqCacheHalfRect *rect_half;
 } SeqCacheItem;
 
 typedef struct SeqCacheKey {
@@ -177,6 +292,7 @@ static int seq_disk_cache_compression_level(void)
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
       return 0;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
       return 1;
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
@@ -186,6 +302,24 @@ static int seq_disk_cache_compression_level(void)
   return U.sequencer_disk_cache_compression;
 }
 
+static int seq_disk_cache_codec(void)
+{
+  switch (U.sequencer_disk_cache_compression) {
+    case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
+      return DCACHE_CODEC_NONE;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
+#if defined(WITH_ZSTD)
+      return DCACHE_CODEC_ZSTD;
+#elif defined(WITH_LZO)
+      return DCACHE_CODEC_LZO;
+#else
+      return DCACHE_CODEC_ZLIB;
+#endif
+  }
+
+  return DCACHE_CODEC_ZLIB;
+}
+
 static size_t seq_disk_cache_size_limit(void)
 {
   return (size_t)U.sequencer_disk_cache_size_limit * (1024 * 1024 * 1024);
@@ -309,7 +443,8 @@ static bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
   return true;
 }
 
-static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_cache, char *path)
+static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_cache,
+                                                            const char *path)
 {
   DiskCacheFile *cache_file = disk_cache->files.first;
 
@@ -323,7 +458,7 @@ static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_c
 }
 
 /* Update file size and timestamp. */
-static void seq_disk_cache_update_file(SeqDiskCache *disk_cache, char *path)
+static void seq_disk_cache_update_file(SeqDiskCache *disk_cache, const char *path)
 {
   DiskCacheFile *cache_file;
   int64_t size_before;
@@ -455,6 +590,59 @@ static void seq_disk_cache_delete_invalid_files(SeqDiskCache *disk_cache,
   }
 }
 
+static void seq_disk_cache_write_item_free(SeqDiskCache *disk_cache, DiskCacheWriteItem *item)
+{
+  disk_cache->write_queue_memory -= item->memory;
+  IMB_freeImBuf(item->ibuf);
+  MEM_freeN(item);
+}
+
+static bool seq_disk_cache_write_item_is_invalid(DiskCacheWriteItem *item,
+                                                 const char *cache_dir,
+                                                 Sequence *seq,
+                                                 int invalidate_types,
+                                                 int range_start,
+                                                 int range_end)
+{
+  if ((item->cache_type & invalidate_types) == 0 || !STREQ(cache_dir, item->dir)) {
+    return false;
+  }
+  int cfra_start = seq_cache_frame_index_to_cfra(seq, item->start_frame);
+  return cfra_start > range_start && cfra_start <= range_end;
+}
+
+/* Remove images waiting to be written that would be in the files deleted by
+ * #seq_disk_cache_delete_invalid_files. */
+static void seq_disk_cache_delete_invalid_writes(SeqDiskCache *disk_cache,
+                                                 Scene *scene,
+                                                 Sequence *seq,
+                                                 int invalidate_types,
+                                                 int range_start,
+                                                 int range_end)
+{
+  DiskCacheWriteItem *next_item, *item = disk_cache->write_queue.first;
+  char cache_dir[FILE_MAX];
+  seq_disk_cache_get_dir(disk_cache, scene, seq, cache_dir, sizeof(cache_dir));
+  BLI_path_slash_ensure(cache_dir);
+
+  while (item) {
+    next_item = item->next;
+    if (seq_disk_cache_write_item_is_invalid(
+            item, cache_dir, seq, invalidate_types, range_start, range_end)) {
+      BLI_remlink(&disk_cache->write_queue, item);
+      seq_disk_cache_write_item_free(disk_cache, item);
+    }
+    item = next_item;
+  }
+
+  /* The image being written is still owned by the write thread, which discards the file. */
+  item = disk_cache->write_item_active;
+  if (item && seq_disk_cache_write_item_is_invalid(
+                  item, cache_dir, seq, invalidate_types, range_start, range_end)) {
+    item->is_invalid = true;
+  }
+}
+
 static void seq_disk_cache_invalidate(Scene *scene,
                                       Sequence *seq,
                                       Sequence *seq_changed,
@@ -470,6 +658,7 @@ static void seq_disk_cache_invalidate(Scene *scene,
   end = seq_changed->enddisp;
 
   seq_disk_cache_delete_invalid_files(disk_cache, scene, seq, invalidate_types, start, end);
+  seq_disk_cache_delete_invalid_writes(disk_cache, scene, seq, invalidate_types, start, end);
 
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
@@ -479,31 +668,133 @@ static size_t deflate_imbuf_to_file(ImBuf *ibuf,
                                     int level,
                                     DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
+  void *data = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+  const size_t size_raw = header_entry->size_raw;
+
+#ifdef WITH_ZSTD
+  if (header_entry->codec == DCACHE_CODEC_ZSTD) {
+    const size_t size_bound = ZSTD_compressBound(size_raw);
+    void *data_compressed = MEM_mallocN(size_bound, "disk cache Zstd buffer");
+    const size_t size_compressed = ZSTD_compress(
+        data_compressed, size_bound, data, size_raw, DCACHE_ZSTD_LEVEL);
+
+    size_t bytes_written = 0;
+    if (!ZSTD_isError(size_compressed) && size_compressed < size_raw) {
+      fseek(file, header_entry->offset, 0);
+      if (fwrite(data_compressed, 1, size_compressed, file) == size_compressed) {
+        bytes_written = size_compressed;
+      }
+      MEM_freeN(data_compressed);
+      return bytes_written;
+    }
+    MEM_freeN(data_compressed);
+
+    /* Incompressible image data. */
+    header_entry->codec = DCACHE_CODEC_NONE;
+  }
+#endif
+
+#ifdef WITH_LZO
+  if (header_entry->codec == DCACHE_CODEC_LZO) {
+    lzo_uint size_compressed = LZO_OUT_LEN(size_raw);
+    unsigned char *data_compressed = MEM_mallocN(size_compressed, "disk cache LZO buffer");
+    void *wrkmem = MEM_mallocN(LZO1X_MEM_COMPRESS, "disk cache LZO work memory");
+    const int r = lzo1x_1_compress(data, size_raw, data_compressed, &size_compressed, wrkmem);
+    MEM_freeN(wrkmem);
+
+    size_t bytes_written = 0;
+    if (r == LZO_E_OK && size_compressed < size_raw) {
+      fseek(file, header_entry->offset, 0);
+      if (fwrite(data_compressed, 1, size_compressed, file) == size_compressed) {
+        bytes_written = size_compressed;
+      }
+      MEM_freeN(data_compressed);
+      return bytes_written;
+    }
+    MEM_freeN(data_compressed);
+
+    /* Incompressible image data. */
+    header_entry->codec = DCACHE_CODEC_NONE;
+  }
+#endif
+
+  if (header_entry->codec == DCACHE_CODEC_NONE) {
+    fseek(file, header_entry->offset, 0);
+    return (fwrite(data, 1, size_raw, file) == size_raw) ? size_raw : 0;
   }
 
-  return BLI_gzip_mem_to_file_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+  header_entry->codec = DCACHE_CODEC_ZLIB;
+  return BLI_gzip_mem_to_file_at_pos(data, size_raw, file, header_entry->offset, level);
 }
 
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+static size_t inflate_file_to_imbuf(ImBuf *ibuf,
+                                    BLI_mmap_file *mmap_file,
+                                    FILE **file,
+                                    const char *path,
+                                    DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
+  void *data = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+  const size_t size_raw = header_entry->size_raw;
+  const size_t size_file = BLI_mmap_get_length(mmap_file);
+
+  if (header_entry->offset > size_file ||
+      header_entry->size_compressed > size_file - header_entry->offset) {
+    return 0;
   }
 
-  return BLI_ungzip_file_to_mem_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
+  switch (header_entry->codec) {
+    case DCACHE_CODEC_NONE: {
+      if (header_entry->size_compressed != size_raw ||
+          !BLI_mmap_read(mmap_file, data, header_entry->offset, size_raw)) {
+        return 0;
+      }
+      return size_raw;
+    }
+#ifdef WITH_LZO
+    case DCACHE_CODEC_LZO: {
+      /* Decompress directly from the mapped file, without copying the compressed data. */
+      const unsigned char *data_compressed = POINTER_OFFSET(BLI_mmap_get_pointer(mmap_file),
+                                                            header_entry->offset);
+      lzo_uint size_decompressed = size_raw;
+      const int r = lzo1x_decompress_safe(
+          data_compressed, header_entry->size_compressed, data, &size_decompressed, NULL);
+      if (r != LZO_E_OK || BLI_mmap_any_io_error(mmap_file)) {
+        return 0;
+      }
+      return size_decompressed;
+    }
+#endif
+#ifdef WITH_ZSTD
+    case DCACHE_CODEC_ZSTD: {
+      /* Decompress directly from the mapped file, without copying the compressed data. */
+      const void *data_compressed = POINTER_OFFSET(BLI_mmap_get_pointer(mmap_file),
+                                                   header_entry->offset);
+      const size_t size_decompressed = ZSTD_decompress(
+          data, size_raw, data_compressed, header_entry->size_compressed);
+      if (ZSTD_isError(size_decompressed) || BLI_mmap_any_io_error(mmap_file)) {
+        return 0;
+      }
+      return size_decompressed;
+    }
+#endif
+    case DCACHE_CODEC_ZLIB: {
+      /* Zlib streams are read from the file. */
+      if (*file == NULL) {
+        *file = BLI_fopen(path, "rb");
+        if (*file == NULL) {
+          return 0;
+        }
+      }
+      return BLI_ungzip_file_to_mem_at_pos(data, size_raw, *file, header_entry->offset);
+    }
+  }
+
+  /* Unsupported codec, for example Zstd or LZO when building without it. */
+  return 0;
 }
 
-static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
+static void seq_disk_cache_header_endian_switch(DiskCacheHeader *header)
 {
-  fseek(file, 0, 0);
-  fread(header, sizeof(*header), 1, file);
-
   for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
     if ((ENDIAN_ORDER == B_ENDIAN) && header->entry[i].encoding == 0) {
       BLI_endian_switch_uint64(&header->entry[i].frameno);
@@ -514,13 +805,20 @@ static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
   }
 }
 
+static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
+{
+  fseek(file, 0, 0);
+  fread(header, sizeof(*header), 1, file);
+  seq_disk_cache_header_endian_switch(header);
+}
+
 static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
 {
   fseek(file, 0, 0);
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+static int seq_disk_cache_add_header_entry(float nfra, ImBuf *ibuf, DiskCacheHeader *header)
 {
   int i;
   uint64_t offset = sizeof(*header);
@@ -553,7 +851,8 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
   }
 
   header->entry[i].offset = offset;
-  header->entry[i].frameno = key->nfra;
+  header->entry[i].frameno = nfra;
+  header->entry[i].codec = seq_disk_cache_codec();
 
   /* Store colorspace name of ibuf. */
   const char *colorspace_name;
@@ -582,26 +881,30 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
-static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+/* Add the image to a copy of the file at \a path. Only the write thread changes files, so this
+ * doesn't need read_write_mutex. See #seq_disk_cache_write_file_commit. */
+static bool seq_disk_cache_write_temp_file(const char *path,
+                                           const char *path_temp,
+                                           float nfra,
+                                           ImBuf *ibuf)
 {
-  char path[FILE_MAX];
+  BLI_make_existing_file(path_temp);
 
-  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
-  BLI_make_existing_file(path);
-
-  FILE *file = BLI_fopen(path, "rb+");
+  FILE *file = NULL;
+  if (BLI_exists(path) && BLI_copy(path, path_temp) == 0) {
+    file = BLI_fopen(path_temp, "rb+");
+  }
   if (!file) {
-    file = BLI_fopen(path, "wb+");
+    file = BLI_fopen(path_temp, "wb+");
     if (!file) {
       return false;
     }
-    seq_disk_cache_add_file_to_list(disk_cache, path);
   }
 
   DiskCacheHeader header;
   memset(&header, 0, sizeof(header));
   seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
+  int entry_index = seq_disk_cache_add_header_entry(nfra, ibuf, &header);
   size_t bytes_written = deflate_imbuf_to_file(
       ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
 
@@ -611,34 +914,40 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
      */
     header.entry[entry_index].size_compressed = bytes_written;
     seq_disk_cache_write_header(file, &header);
-    seq_disk_cache_update_file(disk_cache, path);
-    fclose(file);
-
-    return true;
   }
 
-  return false;
+  fclose(file);
+  return bytes_written != 0;
 }
 
-static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
+/* Replace the file at \a path by the written copy, read_write_mutex must be locked. Readers
+ * see either the old or the new file, never a partially written one. */
+static void seq_disk_cache_write_file_commit(SeqDiskCache *disk_cache,
+                                             const char *path,
+                                             const char *path_temp)
 {
-  char path[FILE_MAX];
-  DiskCacheHeader header;
-
-  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
-  BLI_make_existing_file(path);
+  if (BLI_rename(path_temp, path) != 0) {
+    BLI_delete(path_temp, false, false);
+    return;
+  }
 
-  FILE *file = BLI_fopen(path, "rb");
-  if (!file) {
-    return NULL;
+  /* The file may also have been deleted to enforce the size limit while it was written. */
+  if (seq_disk_cache_get_file_entry_by_path(disk_cache, path) == NULL) {
+    seq_disk_cache_add_file_to_list(disk_cache, path);
   }
+  seq_disk_cache_update_file(disk_cache, path);
+}
 
-  seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_get_header_entry(key, &header);
+static ImBuf *seq_disk_cache_read_entry(SeqCacheKey *key,
+                                        BLI_mmap_file *mmap_file,
+                                        FILE **file,
+                                        const char *path,
+                                        DiskCacheHeader *header)
+{
+  int entry_index = seq_disk_cache_get_header_entry(key, header);
 
   /* Item not found. */
   if (entry_index < 0) {
-    fclose(file);
     return NULL;
   }
 
@@ -647,36 +956,146 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
   size_t expected_size;
 
-  if (header.entry[entry_index].size_raw == size_char) {
+  if (header->entry[entry_index].size_raw == size_char) {
     expected_size = size_char;
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
-    IMB_colormanagement_assign_rect_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+    IMB_colormanagement_assign_rect_colorspace(ibuf, header->entry[entry_index].colorspace_name);
   }
-  else if (header.entry[entry_index].size_raw == size_float) {
+  else if (header->entry[entry_index].size_raw == size_float) {
     expected_size = size_float;
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
-    IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+    IMB_colormanagement_assign_float_colorspace(ibuf, header->entry[entry_index].colorspace_name);
   }
   else {
-    fclose(file);
     return NULL;
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  size_t bytes_read = inflate_file_to_imbuf(
+      ibuf, mmap_file, file, path, &header->entry[entry_index]);
 
   /* Sanity check. */
   if (bytes_read != expected_size) {
-    fclose(file);
     IMB_freeImBuf(ibuf);
     return NULL;
   }
-  BLI_file_touch(path);
-  seq_disk_cache_update_file(disk_cache, path);
-  fclose(file);
 
   return ibuf;
 }
 
+static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
+{
+  char path[FILE_MAX];
+  DiskCacheHeader header;
+
+  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
+
+  const int fd = BLI_open(path, O_BINARY | O_RDONLY, 0);
+  if (fd == -1) {
+    return NULL;
+  }
+
+  BLI_mmap_file *mmap_file = BLI_mmap_open(fd);
+  if (mmap_file == NULL) {
+    close(fd);
+    return NULL;
+  }
+
+  FILE *file = NULL;
+  ImBuf *ibuf = NULL;
+
+  if (BLI_mmap_read(mmap_file, &header, 0, sizeof(header))) {
+    seq_disk_cache_header_endian_switch(&header);
+    ibuf = seq_disk_cache_read_entry(key, mmap_file, &file, path, &header);
+  }
+
+  if (file) {
+    fclose(file);
+  }
+  BLI_mmap_free(mmap_file);
+  close(fd);
+
+  if (ibuf) {
+    BLI_file_touch(path);
+    seq_disk_cache_update_file(disk_cache, path);
+  }
+
+  return ibuf;
+}
+
+/* Asynchronous writing. */
+
+static void *seq_disk_cache_write_thread(void *data)
+{
+  SeqDiskCache *disk_cache = data;
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  while (true) {
+    while (BLI_listbase_is_empty(&disk_cache->write_queue) && !disk_cache->write_thread_stop) {
+      BLI_condition_wait(&disk_cache->write_queue_cond, &disk_cache->read_write_mutex);
+    }
+    if (disk_cache->write_thread_stop) {
+      break;
+    }
+
+    /* Images invalidated while waiting to be written are removed from the queue. */
+    DiskCacheWriteItem *item = BLI_pophead(&disk_cache->write_queue);
+    disk_cache->write_item_active = item;
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+    /* Compression and IO are done without the lock, so reading from the cache isn't blocked. */
+    char path_temp[FILE_MAX];
+    BLI_snprintf(path_temp, sizeof(path_temp), "%s.tmp", item->path);
+    const bool written = seq_disk_cache_write_temp_file(
+        item->path, path_temp, item->nfra, item->ibuf);
+
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
+    disk_cache->write_item_active = NULL;
+    if (written && !item->is_invalid) {
+      seq_disk_cache_write_file_commit(disk_cache, item->path, path_temp);
+    }
+    else {
+      BLI_delete(path_temp, false, false);
+    }
+    seq_disk_cache_write_item_free(disk_cache, item);
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+    seq_disk_cache_enforce_limits(disk_cache);
+
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
+  }
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  return NULL;
+}
+
+static void seq_disk_cache_write_async(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+{
+  const size_t memory = IMB_get_size_in_memory(ibuf);
+
+  DiskCacheWriteItem *item = MEM_callocN(sizeof(DiskCacheWriteItem), "DiskCacheWriteItem");
+  /* The key is owned by the RAM cache, copy what is needed for writing. */
+  seq_disk_cache_get_file_path(disk_cache, key, item->path, sizeof(item->path));
+  seq_disk_cache_get_dir(disk_cache, key->context.scene, key->seq, item->dir, sizeof(item->dir));
+  BLI_path_slash_ensure(item->dir);
+  item->cache_type = key->type;
+  item->start_frame = ((int)key->nfra / DCACHE_IMAGES_PER_FILE) * DCACHE_IMAGES_PER_FILE;
+  item->nfra = key->nfra;
+  item->memory = memory;
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  if (disk_cache->write_queue_memory + memory > DCACHE_WRITE_QUEUE_MEMORY_MAX) {
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+    MEM_freeN(item);
+    return;
+  }
+  IMB_refImBuf(ibuf);
+  item->ibuf = ibuf;
+  disk_cache->write_queue_memory += memory;
+  BLI_addtail(&disk_cache->write_queue, item);
+  BLI_condition_notify_one(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+}
+
 #undef DCACHE_FNAME_FORMAT
 #undef DCACHE_IMAGES_PER_FILE
 #undef COLORSPACE_NAME_MAX
@@ -750,7 +1169,13 @@ static void seq_cache_lock(Scene *scene)
   SeqCache *cache = seq_cache_get_from_scene(scene);
 
   if (cache) {
+    if (BLI_mutex_trylock(&cache->iterator_mutex)) {
+      return;
+    }
+    /* Only measure time when the lock is contended, the timer isn't free. */
+    const double start = PIL_check_seconds_timer();
     BLI_mutex_lock(&cache->iterator_mutex);
+    cache->lock_wait_time += PIL_check_seconds_timer() - start;
   }
 }
 
@@ -774,44 +1199,248 @@ static void seq_cache_keyfree(void *val)
   BLI_mempool_free(key->cache_owner->keys_pool, key);
 }
 
+static size_t seq_cache_item_size_in_memory(SeqCacheItem *item)
+{
+  size_t size = IMB_get_size_in_memory(item->ibuf);
+  if (item->rect_half) {
+    size += sizeof(*item->rect_half->rect) * 4 * item->ibuf->x * item->ibuf->y;
+  }
+  return size;
+}
+
+static void seq_cache_half_rect_free(SeqCacheHalfRect *rect_half)
+{
+  if (atomic_sub_and_fetch_int32(&rect_half->refcounter, 1) == 0) {
+    MEM_freeN(rect_half);
+  }
+}
+
 static void seq_cache_valfree(void *val)
 {
   SeqCacheItem *item = (SeqCacheItem *)val;
   SeqCache *cache = item->cache_owner;
 
   if (item->ibuf) {
-    cache->memory_used -= IMB_get_size_in_memory(item->ibuf);
+    cache->memory_used -= seq_cache_item_size_in_memory(item);
     IMB_freeImBuf(item->ibuf);
   }
+  if (item->rect_half) {
+    seq_cache_half_rect_free(item->rect_half);
+  }
 
   BLI_mempool_free(item->cache_owner->items_pool, item);
 }
 
-static void seq_cache_put(SeqCache *cache, SeqCacheKey *key, ImBuf *ibuf)
+static bool seq_cache_half_float_supported(const ImBuf *ibuf)
+{
+  return ibuf->rect_float != NULL && ibuf->rect == NULL && ibuf->channels == 4 &&
+         ibuf->zbuf == NULL && ibuf->zbuf_float == NULL;
+}
+
+/* Returns an image without pixels with the properties of ibuf, and its pixels as half floats. */
+static ImBuf *seq_cache_half_float_pack(ImBuf *ibuf, SeqCacheHalfRect **r_rect_half)
+{
+  const size_t len = (size_t)ibuf->x * ibuf->y * 4;
+  SeqCacheHalfRect *rect_half = MEM_mallocN(sizeof(*rect_half) + sizeof(*rect_half->rect) * len,
+                                            "SeqCacheHalfRect");
+  rect_half->refcounter = 1;
+  IMB_buffer_half_from_float(rect_half->rect, ibuf->rect_float, len);
+
+  ImBuf *ibuf_packed = IMB_allocImBuf(ibuf->x, ibuf->y, ibuf->planes, 0);
+  ibuf_packed->channels = ibuf->channels;
+  ibuf_packed->flags |= ibuf->flags & ~(IB_rect | IB_rectfloat | IB_zbuf | IB_zbuffloat);
+  ibuf_packed->float_colorspace = ibuf->float_colorspace;
+  ibuf_packed->dither = ibuf->dither;
+  copy_v2_v2_db(ibuf_packed->ppm, ibuf->ppm);
+  IMB_metadata_copy(ibuf_packed, ibuf);
+
+  *r_rect_half = rect_half;
+  return ibuf_packed;
+}
+
+static ImBuf *seq_cache_half_float_unpack(ImBuf *ibuf_packed,
+                                          const SeqCacheHalfRect *rect_half)
+{
+  ImBuf *ibuf = IMB_dupImBuf(ibuf_packed);
+  IMB_metadata_copy(ibuf, ibuf_packed);
+  if (!imb_addrectfloatImBuf(ibuf)) {
+    IMB_freeImBuf(ibuf);
+    return NULL;
+  }
+  IMB_buffer_float_from_half(ibuf->rect_float, rect_half->rect, (size_t)ibuf->x * ibuf->y * 4);
+  return ibuf;
+}
+
+static SeqCacheShard *seq_cache_shard_get(SeqCache *cache, const SeqCacheKey *key)
+{
+  /* Multiplicative hashing, so all bits of the key hash affect the shard. */
+  const unsigned int hash = seq_cache_hashhash(key) * 0x9e3779b1u;
+  return &cache->shards[hash >> (32 - SEQ_CACHE_SHARDS_BITS)];
+}
+
+/* Cache must be locked. Returns the last key of the frame \a task_id is rendering. */
+static SeqCacheKey **seq_cache_last_key_get(SeqCache *cache, int task_id, float cfra)
 {
+  SeqCacheLinkChain *chain;
+  for (chain = cache->link_chains.first; chain; chain = chain->next) {
+    if (chain->task_id == task_id) {
+      break;
+    }
+  }
+  if (chain == NULL) {
+    chain = MEM_callocN(sizeof(*chain), __func__);
+    chain->task_id = task_id;
+    chain->cfra = cfra;
+    BLI_addtail(&cache->link_chains, chain);
+  }
+  /* Rendering of the previous frame was canceled. */
+  if (chain->cfra != cfra) {
+    chain->cfra = cfra;
+    chain->last_key = NULL;
+  }
+  return &chain->last_key;
+}
+
+/* Cache must be locked. */
+static void seq_cache_link_chains_reset(SeqCache *cache)
+{
+  LISTBASE_FOREACH (SeqCacheLinkChain *, chain, &cache->link_chains) {
+    chain->last_key = NULL;
+  }
+}
+
+/* Cache must be locked. With rect_half, the cache takes ownership of both ibuf and rect_half,
+ * see #seq_cache_half_float_pack. Returns false when an item with the same key was replaced. */
+static bool seq_cache_put(SeqCache *cache,
+                          SeqCacheKey *key,
+                          ImBuf *ibuf,
+                          SeqCacheHalfRect *rect_half)
+{
+  bool added = false;
+  SeqCacheShard *shard = seq_cache_shard_get(cache, key);
   SeqCacheItem *item;
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
   item->ibuf = ibuf;
+  item->rect_half = rect_half;
+
+  BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_WRITE);
+  if (BLI_ghash_reinsert(shard->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
+    if (rect_half == NULL) {
+      IMB_refImBuf(ibuf);
+    }
+    cache->memory_used += seq_cache_item_size_in_memory(item);
+    added = true;
+  }
+  BLI_rw_mutex_unlock(&shard->lock);
+  return added;
+}
+
+/* Cache must be locked. */
+static void seq_cache_remove(SeqCache *cache, SeqCacheKey *key)
+{
+  SeqCacheShard *shard = seq_cache_shard_get(cache, key);
 
-  if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
-    IMB_refImBuf(ibuf);
-    cache->last_key = key;
-    cache->memory_used += IMB_get_size_in_memory(ibuf);
+  LISTBASE_FOREACH (SeqCacheLinkChain *, chain, &cache->link_chains) {
+    if (chain->last_key == key) {
+      chain->last_key = NULL;
+    }
   }
+
+  BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_WRITE);
+  BLI_ghash_remove(shard->hash, key, seq_cache_keyfree, seq_cache_valfree);
+  BLI_rw_mutex_unlock(&shard->lock);
+}
+
+/* Cache must be locked. */
+static bool seq_cache_contains(SeqCache *cache, SeqCacheKey *key)
+{
+  return BLI_ghash_haskey(seq_cache_shard_get(cache, key)->hash, key);
 }
 
+/* Doesn't need the cache lock. */
 static ImBuf *seq_cache_get(SeqCache *cache, SeqCacheKey *key)
 {
-  SeqCacheItem *item = BLI_ghash_lookup(cache->hash, key);
+  SeqCacheShard *shard = seq_cache_shard_get(cache, key);
+  ImBuf *ibuf = NULL;
+  SeqCacheHalfRect *rect_half = NULL;
+
+  BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_READ);
+  SeqCacheItem *item = BLI_ghash_lookup(shard->hash, key);
 
   if (item && item->ibuf) {
     IMB_refImBuf(item->ibuf);
+    ibuf = item->ibuf;
+    if (item->rect_half) {
+      /* Keep the pixels alive when the item is freed meanwhile, and convert them unlocked. */
+      atomic_add_and_fetch_int32(&item->rect_half->refcounter, 1);
+      rect_half = item->rect_half;
+    }
+  }
+  BLI_rw_mutex_unlock(&shard->lock);
 
-    return item->ibuf;
+  if (rect_half) {
+    ImBuf *ibuf_packed = ibuf;
+    ibuf = seq_cache_half_float_unpack(ibuf_packed, rect_half);
+    IMB_freeImBuf(ibuf_packed);
+    seq_cache_half_rect_free(rect_half);
   }
 
-  return NULL;
+  return ibuf;
+}
+
+static int seq_cache_len(SeqCache *cache)
+{
+  int len = 0;
+  for (int i = 0; i < SEQ_CACHE_SHARDS; i++) {
+    len += BLI_ghash_len(cache->shards[i].hash);
+  }
+  return len;
+}
+
+/* Iteration over all entries, the cache must be locked. Like with #GHashIterator, only entries
+ * that were already visited may be removed while iterating. */
+typedef struct SeqCacheIterator {
+  SeqCache *cache;
+  int shard;
+  GHashIterator gh_iter;
+} SeqCacheIterator;
+
+static void seq_cache_iterator_skip_empty(SeqCacheIterator *iter)
+{
+  while (BLI_ghashIterator_done(&iter->gh_iter) && iter->shard < SEQ_CACHE_SHARDS - 1) {
+    iter->shard++;
+    BLI_ghashIterator_init(&iter->gh_iter, iter->cache->shards[iter->shard].hash);
+  }
+}
+
+static void seq_cache_iterator_init(SeqCacheIterator *iter, SeqCache *cache)
+{
+  iter->cache = cache;
+  iter->shard = 0;
+  BLI_ghashIterator_init(&iter->gh_iter, cache->shards[0].hash);
+  seq_cache_iterator_skip_empty(iter);
+}
+
+static void seq_cache_iterator_step(SeqCacheIterator *iter)
+{
+  BLI_ghashIterator_step(&iter->gh_iter);
+  seq_cache_iterator_skip_empty(iter);
+}
+
+static bool seq_cache_iterator_done(SeqCacheIterator *iter)
+{
+  return BLI_ghashIterator_done(&iter->gh_iter);
+}
+
+static SeqCacheKey *seq_cache_iterator_key(SeqCacheIterator *iter)
+{
+  return BLI_ghashIterator_getKey(&iter->gh_iter);
+}
+
+static SeqCacheItem *seq_cache_iterator_item(SeqCacheIterator *iter)
+{
+  return BLI_ghashIterator_getValue(&iter->gh_iter);
 }
 
 static void seq_cache_relink_keys(SeqCacheKey *link_next, SeqCacheKey *link_prev)
@@ -904,14 +1533,14 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
 
   while (base) {
     SeqCacheKey *prev = base->link_prev;
-    BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
+    seq_cache_remove(cache, base);
     base = prev;
   }
 
   base = next;
   while (base) {
     next = base->link_next;
-    BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
+    seq_cache_remove(cache, base);
     base = next;
   }
 }
@@ -926,21 +1555,21 @@ static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
   SeqCacheKey *rkey = NULL;
   SeqCacheKey *key = NULL;
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
+  SeqCacheIterator iter;
+  seq_cache_iterator_init(&iter, cache);
   int total_count = 0;
   int cheap_count = 0;
 
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    key = BLI_ghashIterator_getKey(&gh_iter);
-    SeqCacheItem *item = BLI_ghashIterator_getValue(&gh_iter);
-    BLI_ghashIterator_step(&gh_iter);
+  while (!seq_cache_iterator_done(&iter)) {
+    key = seq_cache_iterator_key(&iter);
+    SeqCacheItem *item = seq_cache_iterator_item(&iter);
+    seq_cache_iterator_step(&iter);
 
     /* This shouldn't happen, but better be safe than sorry. */
     if (!item->ibuf) {
       seq_cache_recycle_linked(scene, key);
       /* Can not continue iterating after linked remove. */
-      BLI_ghashIterator_init(&gh_iter, cache->hash);
+      seq_cache_iterator_init(&iter, cache);
       continue;
     }
 
@@ -1035,20 +1664,23 @@ static void seq_disk_cache_create(Main *bmain, Scene *scene)
   BLI_mutex_lock(&cache_create_lock);
   SeqCache *cache = seq_cache_get_from_scene(scene);
 
-  if (cache == NULL) {
+  if (cache == NULL || cache->disk_cache != NULL) {
+    BLI_mutex_unlock(&cache_create_lock);
     return;
   }
 
-  if (cache->disk_cache != NULL) {
-    return;
-  }
+  SeqDiskCache *disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
+  disk_cache->bmain = bmain;
+  BLI_mutex_init(&disk_cache->read_write_mutex);
+  seq_disk_cache_handle_versioning(disk_cache);
+  seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
+  disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+
+  BLI_condition_init(&disk_cache->write_queue_cond);
+  BLI_threadpool_init(&disk_cache->write_thread, seq_disk_cache_write_thread, 1);
+  BLI_threadpool_insert(&disk_cache->write_thread, disk_cache);
 
-  cache->disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
-  cache->disk_cache->bmain = bmain;
-  BLI_mutex_init(&cache->disk_cache->read_write_mutex);
-  seq_disk_cache_handle_versioning(cache->disk_cache);
-  seq_disk_cache_get_files(cache->disk_cache, seq_disk_cache_base_dir());
-  cache->disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+  cache->disk_cache = disk_cache;
   BLI_mutex_unlock(&cache_create_lock);
 }
 
@@ -1059,8 +1691,12 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     SeqCache *cache = MEM_callocN(sizeof(SeqCache), "SeqCache");
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
-    cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
+    for (int i = 0; i < SEQ_CACHE_SHARDS; i++) {
+      cache->shards[i].hash = BLI_ghash_new(
+          seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
+      BLI_rw_mutex_init(&cache->shards[i].lock);
+    }
+    BLI_listbase_clear(&cache->link_chains);
     cache->bmain = bmain;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
@@ -1083,15 +1719,15 @@ void BKE_sequencer_cache_free_temp_cache(Scene *scene, short id, int cfra)
 
   seq_cache_lock(scene);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
-    BLI_ghashIterator_step(&gh_iter);
+  SeqCacheIterator iter;
+  seq_cache_iterator_init(&iter, cache);
+  while (!seq_cache_iterator_done(&iter)) {
+    SeqCacheKey *key = seq_cache_iterator_key(&iter);
+    seq_cache_iterator_step(&iter);
 
     if (key->is_temp_cache && key->task_id == id &&
         seq_cache_frame_index_to_cfra(key->seq, key->nfra) != cfra) {
-      BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
+      seq_cache_remove(cache, key);
     }
   }
   seq_cache_unlock(scene);
@@ -1104,12 +1740,31 @@ void BKE_sequencer_cache_destruct(Scene *scene)
     return;
   }
 
-  BLI_ghash_free(cache->hash, seq_cache_keyfree, seq_cache_valfree);
+  for (int i = 0; i < SEQ_CACHE_SHARDS; i++) {
+    BLI_ghash_free(cache->shards[i].hash, seq_cache_keyfree, seq_cache_valfree);
+    BLI_rw_mutex_end(&cache->shards[i].lock);
+  }
   BLI_mempool_destroy(cache->keys_pool);
   BLI_mempool_destroy(cache->items_pool);
   BLI_mutex_end(&cache->iterator_mutex);
+  BLI_freelistN(&cache->link_chains);
 
   if (cache->disk_cache != NULL) {
+    SeqDiskCache *disk_cache = cache->disk_cache;
+
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
+    disk_cache->write_thread_stop = true;
+    BLI_condition_notify_one(&disk_cache->write_queue_cond);
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+    BLI_threadpool_end(&disk_cache->write_thread);
+    BLI_condition_end(&disk_cache->write_queue_cond);
+
+    /* Images waiting to be written are discarded. */
+    DiskCacheWriteItem *item;
+    while ((item = BLI_pophead(&disk_cache->write_queue))) {
+      seq_disk_cache_write_item_free(disk_cache, item);
+    }
+
     BLI_freelistN(&cache->disk_cache->files);
     BLI_mutex_end(&cache->disk_cache->read_write_mutex);
     MEM_freeN(cache->disk_cache);
@@ -1136,15 +1791,15 @@ void BKE_sequencer_cache_cleanup(Scene *scene)
 
   seq_cache_lock(scene);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
+  SeqCacheIterator iter;
+  seq_cache_iterator_init(&iter, cache);
+  while (!seq_cache_iterator_done(&iter)) {
+    SeqCacheKey *key = seq_cache_iterator_key(&iter);
 
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
+    seq_cache_iterator_step(&iter);
+    seq_cache_remove(cache, key);
   }
-  cache->last_key = NULL;
+  seq_cache_link_chains_reset(cache);
   seq_cache_unlock(scene);
 }
 
@@ -1182,11 +1837,11 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
   int invalidate_source = invalidate_types & (SEQ_CACHE_STORE_RAW | SEQ_CACHE_STORE_PREPROCESSED |
                                               SEQ_CACHE_STORE_COMPOSITE);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
-    BLI_ghashIterator_step(&gh_iter);
+  SeqCacheIterator iter;
+  seq_cache_iterator_init(&iter, cache);
+  while (!seq_cache_iterator_done(&iter)) {
+    SeqCacheKey *key = seq_cache_iterator_key(&iter);
+    seq_cache_iterator_step(&iter);
 
     int key_cfra = seq_cache_frame_index_to_cfra(key->seq, key->nfra);
 
@@ -1196,7 +1851,8 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
         seq_cache_relink_keys(key->link_next, key->link_prev);
       }
 
-      BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
+      seq_cache_remove(cache, key);
+      continue;
     }
 
     if (key->type & invalidate_source && key->seq == seq && key_cfra >= seq_changed->startdisp &&
@@ -1205,10 +1861,10 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
         seq_cache_relink_keys(key->link_next, key->link_prev);
       }
 
-      BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
+      seq_cache_remove(cache, key);
     }
   }
-  cache->last_key = NULL;
+  seq_cache_link_chains_reset(cache);
   seq_cache_unlock(scene);
 }
 
@@ -1236,7 +1892,6 @@ struct ImBuf *BKE_sequencer_cache_get(
     seq_cache_create(context->bmain, scene);
   }
 
-  seq_cache_lock(scene);
   SeqCache *cache = seq_cache_get_from_scene(scene);
   ImBuf *ibuf = NULL;
   SeqCacheKey key;
@@ -1250,9 +1905,9 @@ struct ImBuf *BKE_sequencer_cache_get(
 
     ibuf = seq_cache_get(cache, &key);
   }
-  seq_cache_unlock(scene);
 
   if (ibuf) {
+    atomic_add_and_fetch_uint64(&cache->hits, 1);
     return ibuf;
   }
 
@@ -1266,15 +1921,18 @@ struct ImBuf *BKE_sequencer_cache_get(
     ibuf = seq_disk_cache_read_file(cache->disk_cache, &key);
     BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
     if (ibuf) {
+      atomic_add_and_fetch_uint64(&cache->disk_hits, 1);
       if (key.type == SEQ_CACHE_STORE_FINAL_OUT) {
         BKE_sequencer_cache_put_if_possible(context, seq, cfra, type, ibuf, 0.0f, true);
       }
       else {
         BKE_sequencer_cache_put(context, seq, cfra, type, ibuf, 0.0f, true);
       }
+      return ibuf;
     }
   }
 
+  atomic_add_and_fetch_uint64(&cache->misses, 1);
   return ibuf;
 }
 
@@ -1303,8 +1961,14 @@ bool BKE_sequencer_cache_put_if_possible(const SeqRenderData *context,
     return true;
   }
 
-  seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-  scene->ed->cache->last_key = NULL;
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (cache) {
+    seq_cache_lock(scene);
+    SeqCacheKey **last_key = seq_cache_last_key_get(cache, context->task_id, cfra);
+    seq_cache_set_temp_cache_linked(scene, *last_key);
+    *last_key = NULL;
+    seq_cache_unlock(scene);
+  }
   return false;
 }
 
@@ -1329,20 +1993,10 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
     BLI_assert(seq != NULL);
   }
 
-  /* Prevent reinserting, it breaks cache key linking. */
-  ImBuf *test = BKE_sequencer_cache_get(context, seq, cfra, type, true);
-  if (test) {
-    IMB_freeImBuf(test);
-    return;
-  }
-
   if (!scene->ed->cache) {
     seq_cache_create(context->bmain, scene);
   }
 
-  seq_cache_lock(scene);
-
-  SeqCache *cache = seq_cache_get_from_scene(scene);
   int flag;
 
   if (seq->cache_flag & SEQ_CACHE_OVERRIDE) {
@@ -1356,6 +2010,33 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
     flag = scene->ed->cache_flag;
   }
 
+  /* Convert before locking, only images stored for later use. */
+  ImBuf *ibuf_stored = i;
+  SeqCacheHalfRect *rect_half = NULL;
+  if ((flag & type) && (scene->ed->cache_flag & SEQ_CACHE_STORE_HALF_FLOAT) &&
+      seq_cache_half_float_supported(i)) {
+    ibuf_stored = seq_cache_half_float_pack(i, &rect_half);
+  }
+
+  seq_cache_lock(scene);
+
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+
+  /* Prevent reinserting, it breaks cache key linking. */
+  SeqCacheKey test_key;
+  test_key.seq = seq;
+  test_key.context = *context;
+  test_key.nfra = seq_cache_cfra_to_frame_index(seq, cfra);
+  test_key.type = type;
+  if (seq_cache_contains(cache, &test_key)) {
+    seq_cache_unlock(scene);
+    if (rect_half) {
+      IMB_freeImBuf(ibuf_stored);
+      seq_cache_half_rect_free(rect_half);
+    }
+    return;
+  }
+
   if (cost > SEQ_CACHE_COST_MAX) {
     cost = SEQ_CACHE_COST_MAX;
   }
@@ -1374,29 +2055,24 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   key->task_id = context->task_id;
 
   /* Item stored for later use */
+  SeqCacheKey **last_key = seq_cache_last_key_get(cache, key->task_id, cfra);
   if (flag & type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = *last_key;
   }
 
-  SeqCacheKey *temp_last_key = cache->last_key;
-  seq_cache_put(cache, key, i);
-
-  /* Restore pointer to previous item as this one will be freed when stack is rendered. */
-  if (key->is_temp_cache) {
-    cache->last_key = temp_last_key;
-  }
-
-  /* Set last_key's reference to this key so we can look up chain backwards.
-   * Item is already put in cache, so cache->last_key points to current key.
-   */
-  if (flag & type && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+  /* Temporary items are not linked, they will be freed when the stack is rendered. */
+  if (seq_cache_put(cache, key, ibuf_stored, rect_half) && !key->is_temp_cache) {
+    /* Set the previous key's reference to this key so we can look up chain backwards. */
+    if (*last_key) {
+      (*last_key)->link_next = key;
+    }
+    *last_key = key;
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    *last_key = NULL;
   }
 
   seq_cache_unlock(scene);
@@ -1407,10 +2083,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
         seq_disk_cache_create(context->bmain, context->scene);
       }
 
-      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+      seq_disk_cache_write_async(cache->disk_cache, key, i);
     }
   }
 }
@@ -1427,19 +2100,19 @@ void BKE_sequencer_cache_iterate(
   }
 
   seq_cache_lock(scene);
-  bool interrupt = callback_init(userdata, BLI_ghash_len(cache->hash));
+  bool interrupt = callback_init(userdata, seq_cache_len(cache));
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
+  SeqCacheIterator iter;
+  seq_cache_iterator_init(&iter, cache);
 
-  while (!BLI_ghashIterator_done(&gh_iter) && !interrupt) {
-    SeqCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
-    BLI_ghashIterator_step(&gh_iter);
+  while (!seq_cache_iterator_done(&iter) && !interrupt) {
+    SeqCacheKey *key = seq_cache_iterator_key(&iter);
+    seq_cache_iterator_step(&iter);
 
     interrupt = callback_iter(userdata, key->seq, key->nfra, key->type, key->cost);
   }
 
-  cache->last_key = NULL;
+  seq_cache_link_chains_reset(cache);
   seq_cache_unlock(scene);
 }
 
@@ -1453,3 +2126,22 @@ bool BKE_sequencer_cache_is_full(Scene *scene)
 
   return memory_total < cache->memory_used;
 }
+
+void BKE_sequencer_cache_statistics_get(Scene *scene, SeqCacheStatistics *r_stats)
+{
+  memset(r_stats, 0, sizeof(*r_stats));
+
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (!cache) {
+    return;
+  }
+
+  seq_cache_lock(scene);
+  r_stats->hits = cache->hits;
+  r_stats->disk_hits = cache->disk_hits;
+  r_stats->misses = cache->misses;
+  r_stats->lock_wait_time = cache->lock_wait_time;
+  r_stats->items_len = seq_cache_len(cache);
+  r_stats->memory_used = cache->memory_used;
+  seq_cache_unlock(scene);
+}
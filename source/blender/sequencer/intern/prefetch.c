@@ -31,9 +31,11 @@
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
 #include "DNA_sequence_types.h"
+#include "DNA_userdef_types.h"
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -54,33 +56,55 @@
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
+/* Each worker renders different frames, so it needs its own evaluated scene. */
+typedef struct PrefetchWorker {
+  struct PrefetchJob *pfjob;
+
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+
+  /* Depsgraph is built by the worker thread before rendering its first frame. */
+  bool depsgraph_built;
+
+  /* context */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+
+  /* frame being rendered, followed by the rest of the range taken by this worker */
+  int cfra;
+  int cfra_end;
+} PrefetchWorker;
+
+/* Number of consecutive frames taken by a worker at once. Movie strips are decoded sequentially
+ * and the evaluated scene of the worker changes by a single frame at a time. */
+#define SEQ_PREFETCH_WORKER_FRAMES 8
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
   struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
+  /* Protects prefetch area and worker counters. */
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
   ListBase threads;
+  PrefetchWorker *workers;
+  int num_workers;
 
-  /* context */
+  /* context of the preview frames are prefetched for */
   struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
-  struct ListBase *seqbasep;
-  struct ListBase *seqbasep_cpy;
 
-  /* prefetch area */
+  /* prefetch area, frames up to cfra + num_frames_prefetched are taken by workers */
   float cfra;
   int num_frames_prefetched;
 
   /* control */
+  int num_workers_running;
+  int num_workers_waiting;
   bool running;
-  bool waiting;
   bool stop;
 } PrefetchJob;
 
@@ -132,7 +156,8 @@ static bool seq_prefetch_job_is_waiting(Scene *scene)
     return false;
   }
 
-  return pfjob->waiting;
+  /* Suspended when there is nothing left to prefetch for all workers. */
+  return pfjob->running && pfjob->num_workers_waiting == pfjob->num_workers_running;
 }
 
 static Sequence *sequencer_prefetch_get_original_sequence(Sequence *seq, ListBase *seqbase)
@@ -164,8 +189,10 @@ Sequence *BKE_sequencer_prefetch_get_original_sequence(Sequence *seq, Scene *sce
 SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *context)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
+  const int worker_index = context->task_id - SEQ_TASK_PREFETCH_RENDER;
 
-  return &pfjob->context;
+  BLI_assert(worker_index >= 0 && worker_index < pfjob->num_workers);
+  return &pfjob->workers[worker_index].context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -179,13 +206,14 @@ static bool seq_prefetch_is_cache_full(Scene *scene)
   return BKE_sequencer_cache_recycle_item(pfjob->scene) == false;
 }
 
+/* First frame not taken by any of the workers. */
 static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
   return pfjob->cfra + pfjob->num_frames_prefetched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
+static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchWorker *worker)
 {
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  return BKE_animsys_eval_context_construct(worker->depsgraph, worker->cfra);
 }
 
 void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
@@ -196,37 +224,46 @@ void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
   *end = seq_prefetch_cfra(pfjob);
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  worker->depsgraph = NULL;
+  worker->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  DEG_evaluate_on_framechange(worker->depsgraph, worker->cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+/* Creating the graph registers it globally, this is done in the main thread. */
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
+  PrefetchJob *pfjob = worker->pfjob;
   Main *bmain = pfjob->bmain_eval;
   Scene *scene = pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
+  worker->depsgraph_built = false;
+}
 
+/* Building and evaluating is done in the worker thread, and only by workers that get frames to
+ * render, so restarting prefetch doesn't block the main thread. */
+static void seq_prefetch_build_depsgraph(PrefetchWorker *worker)
+{
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  seq_prefetch_update_depsgraph(worker);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
+  worker->depsgraph_built = true;
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -274,61 +311,50 @@ void BKE_sequencer_prefetch_stop(Scene *scene)
   pfjob->stop = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
-static void seq_prefetch_update_context(const SeqRenderData *context)
+static void seq_prefetch_update_context(PrefetchWorker *worker)
 {
-  PrefetchJob *pfjob;
-  pfjob = seq_prefetch_job_get(context->scene);
+  PrefetchJob *pfjob = worker->pfjob;
+  const SeqRenderData *context = &pfjob->context;
+  const int worker_index = (int)(worker - pfjob->workers);
 
   BKE_sequencer_new_render_data(pfjob->bmain_eval,
-                                pfjob->depsgraph,
-                                pfjob->scene_eval,
+                                worker->depsgraph,
+                                worker->scene_eval,
                                 context->rectx,
                                 context->recty,
                                 context->preview_render_size,
                                 false,
-                                &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
+                                &worker->context_cpy);
+  worker->context_cpy.is_prefetch_render = true;
+  worker->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER + worker_index;
 
   BKE_sequencer_new_render_data(pfjob->bmain,
-                                pfjob->depsgraph,
+                                worker->depsgraph,
                                 pfjob->scene,
                                 context->rectx,
                                 context->recty,
                                 context->preview_render_size,
                                 false,
-                                &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
+                                &worker->context);
+  worker->context.is_prefetch_render = false;
 
   /* Same ID as prefetch context, because context will be swapped, but we still
    * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
+   * This is to allow "temp cache" work correctly for all threads.
    */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
-}
-
-static void seq_prefetch_update_scene(Scene *scene)
-{
-  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
-
-  if (!pfjob) {
-    return;
-  }
-
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  worker->context.task_id = worker->context_cpy.task_id;
 }
 
 static void seq_prefetch_resume(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  if (pfjob && pfjob->num_workers_waiting > 0) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -341,24 +367,28 @@ void BKE_sequencer_prefetch_free(Scene *scene)
 
   BKE_sequencer_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+  }
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->workers[i]);
+  }
   BKE_main_free(pfjob->bmain_eval);
+  MEM_freeN(pfjob->workers);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
 }
 
-static bool seq_prefetch_do_skip_frame(Scene *scene)
+static bool seq_prefetch_do_skip_frame(PrefetchWorker *worker)
 {
-  Editing *ed = scene->ed;
-  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
-  float cfra = seq_prefetch_cfra(pfjob);
+  Editing *ed = worker->pfjob->scene->ed;
+  float cfra = worker->cfra;
   Sequence *seq_arr[MAXSEQ + 1];
   int count = BKE_sequencer_get_shown_sequences(ed->seqbasep, cfra, 0, seq_arr);
-  SeqRenderData *ctx = &pfjob->context_cpy;
+  SeqRenderData *ctx = &worker->context_cpy;
   ImBuf *ibuf = NULL;
 
   /* Disable prefetching 3D scene strips, but check for disk cache. */
@@ -411,37 +441,91 @@ static bool seq_prefetch_do_skip_frame(Scene *scene)
   return false;
 }
 
-static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
+/* Workers wait while the cache is full or the user is scrubbing, also in the middle of their
+ * range. New ranges can only be taken while there are frames left. */
+static bool seq_prefetch_need_suspend(PrefetchJob *pfjob, const bool in_range)
 {
-  return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+  if (seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain)) {
+    return true;
+  }
+  return !in_range && (seq_prefetch_cfra(pfjob) > pfjob->scene->r.efra);
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+static bool seq_prefetch_is_enabled(PrefetchJob *pfjob)
+{
+  return (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop;
+}
+
+/* Take the next frame of the range of this worker. When the range is done, take a new range
+ * starting at the frame closest to the playhead that is not taken by any other worker.
+ * The worker is suspended while there is nothing to be prefetched.
+ * Returns false when the worker should stop.
+ */
+static bool seq_prefetch_claim_frame(PrefetchWorker *worker)
 {
+  PrefetchJob *pfjob = worker->pfjob;
+  bool claimed = false;
+
   BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-  while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
-    pfjob->waiting = true;
+  seq_prefetch_update_area(pfjob);
+
+  /* Frames of the range that playback passed already are not needed anymore. */
+  worker->cfra = max_ii(worker->cfra + 1, (int)pfjob->cfra);
+
+  while (seq_prefetch_is_enabled(pfjob) &&
+         seq_prefetch_need_suspend(pfjob, worker->cfra < worker->cfra_end)) {
+    pfjob->num_workers_waiting++;
     BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+    pfjob->num_workers_waiting--;
     seq_prefetch_update_area(pfjob);
+    worker->cfra = max_ii(worker->cfra, (int)pfjob->cfra);
+  }
+
+  if (!seq_prefetch_is_enabled(pfjob)) {
+    BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+    return false;
+  }
+
+  if (worker->cfra < worker->cfra_end) {
+    BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+    return true;
+  }
+
+  /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+  const bool collision = pfjob->num_frames_prefetched > 5 &&
+                         (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2;
+
+  if (!collision) {
+    const int num_frames = min_ii(SEQ_PREFETCH_WORKER_FRAMES,
+                                  pfjob->scene->r.efra - (int)seq_prefetch_cfra(pfjob) + 1);
+    worker->cfra = seq_prefetch_cfra(pfjob);
+    worker->cfra_end = worker->cfra + num_frames;
+    pfjob->num_frames_prefetched += num_frames;
+    claimed = true;
   }
-  pfjob->waiting = false;
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  return claimed;
 }
 
 static void *seq_prefetch_frames(void *job)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  PrefetchWorker *worker = (PrefetchWorker *)job;
+  PrefetchJob *pfjob = worker->pfjob;
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+  while (seq_prefetch_claim_frame(worker)) {
+    if (!worker->depsgraph_built) {
+      seq_prefetch_build_depsgraph(worker);
+      seq_prefetch_update_context(worker);
+    }
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
+    worker->scene_eval->ed->prefetch_job = NULL;
+
+    seq_prefetch_update_depsgraph(worker);
+    AnimData *adt = BKE_animdata_from_id(&worker->context_cpy.scene->id);
+    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(worker);
     BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+        &worker->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
 
     /* This is quite hacky solution:
      * We need cross-reference original scene with copy for cache.
@@ -449,53 +533,59 @@ static void *seq_prefetch_frames(void *job)
      * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
      * Set to NULL before return!
      */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+    worker->scene_eval->ed->prefetch_job = pfjob;
 
-    if (seq_prefetch_do_skip_frame(pfjob->scene)) {
-      pfjob->num_frames_prefetched++;
+    if (seq_prefetch_do_skip_frame(worker)) {
       continue;
     }
 
-    ImBuf *ibuf = BKE_sequencer_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    BKE_sequencer_cache_free_temp_cache(
-        pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
+    ImBuf *ibuf = BKE_sequencer_give_ibuf(&worker->context_cpy, worker->cfra, 0);
+    BKE_sequencer_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
     IMB_freeImBuf(ibuf);
+  }
 
-    /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
-
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 &&
-        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
-      break;
-    }
-
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
-
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+  if (worker->depsgraph_built) {
+    BKE_sequencer_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
+    worker->scene_eval->ed->prefetch_job = NULL;
   }
 
-  BKE_sequencer_cache_free_temp_cache(
-      pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->num_workers_running--;
+  if (pfjob->num_workers_running == 0) {
+    pfjob->running = false;
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return NULL;
 }
 
+static int seq_prefetch_num_workers_get(void)
+{
+  if (U.sequencer_prefetch_threads > 0) {
+    return U.sequencer_prefetch_threads;
+  }
+  /* Every worker has its own copy of the scene, and frames are rendered using multiple threads
+   * already, so half of the threads is enough to keep ahead of playback. */
+  return clamp_i(BLI_system_thread_count() / 2, 1, 8);
+}
+
 static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
+  const int num_workers = seq_prefetch_num_workers_get();
+
+  /* Number of threads changed in preferences. */
+  if (pfjob && pfjob->num_workers != num_workers) {
+    BKE_sequencer_prefetch_free(context->scene);
+    pfjob = NULL;
+  }
 
   if (!pfjob) {
     if (context->scene->ed) {
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, num_workers);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
@@ -503,21 +593,41 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
       pfjob->bmain_eval = BKE_main_new();
 
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+
+      pfjob->workers = (PrefetchWorker *)MEM_callocN(sizeof(PrefetchWorker) * num_workers,
+                                                     "PrefetchWorker");
+      pfjob->num_workers = num_workers;
+      for (int i = 0; i < num_workers; i++) {
+        pfjob->workers[i].pfjob = pfjob;
+      }
     }
   }
-  seq_prefetch_update_scene(context->scene);
-  seq_prefetch_update_context(context);
 
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
+  pfjob->context = *context;
+
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
 
-  pfjob->waiting = false;
+    /* Make sure the thread of the previous run has finished before changing its data. */
+    BLI_threadpool_remove(&pfjob->threads, worker);
+
+    /* Empty range, the first range is taken when the worker starts. */
+    worker->cfra = cfra;
+    worker->cfra_end = cfra;
+    seq_prefetch_free_depsgraph(worker);
+    seq_prefetch_init_depsgraph(worker);
+  }
+
+  pfjob->num_workers_waiting = 0;
+  pfjob->num_workers_running = pfjob->num_workers;
   pfjob->stop = false;
   pfjob->running = true;
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_insert(&pfjob->threads, &pfjob->workers[i]);
+  }
 
   return pfjob;
 }
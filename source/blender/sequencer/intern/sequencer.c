@@ -40,9 +40,11 @@
 #include "DNA_sequence_types.h"
 #include "DNA_sound_types.h"
 #include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_fileops.h"
+#include "BLI_ghash.h"
 #include "BLI_linklist.h"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
@@ -50,6 +52,7 @@
 #include "BLI_session_uuid.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -123,6 +126,12 @@ static ImBuf *seq_render_strip(const SeqRenderData *context,
                                float cfra);
 static void seq_free_animdata(Scene *scene, Sequence *seq);
 static ImBuf *seq_render_mask(const SeqRenderData *context, Mask *mask, float nr, bool make_float);
+static void seq_render_strips_parallel(const SeqRenderData *context,
+                                       SeqRenderState *state,
+                                       Sequence **seqs,
+                                       int count,
+                                       float cfra,
+                                       ImBuf **r_ibufs);
 static int seq_num_files(Scene *scene, char views_format, const bool is_multiview);
 static void seq_anim_add_suffix(Scene *scene, struct anim *anim, const int view_id);
 
@@ -2966,6 +2975,10 @@ static ImBuf *seq_render_effect_strip_impl(const SeqRenderData *context,
       out = sh.execute(context, seq, cfra, fac, facf, NULL, NULL, NULL);
       break;
     case EARLY_DO_EFFECT:
+      if (seq->type != SEQ_TYPE_SPEED) {
+        seq_render_strips_parallel(context, state, input, 3, cfra, ibuf);
+      }
+
       for (i = 0; i < 3; i++) {
         /* Speed effect requires time remapping of `cfra` for input(s). */
         if (input[0] && seq->type == SEQ_TYPE_SPEED) {
@@ -2973,7 +2986,7 @@ static ImBuf *seq_render_effect_strip_impl(const SeqRenderData *context,
           ibuf[i] = seq_render_strip(context, state, input[0], target_frame);
         }
         else { /* Other effects. */
-          if (input[i]) {
+          if (input[i] && ibuf[i] == NULL) {
             ibuf[i] = seq_render_strip(context, state, input[i], cfra);
           }
         }
@@ -3925,6 +3938,162 @@ static ImBuf *seq_render_strip(const SeqRenderData *context,
   return ibuf;
 }
 
+/*********************** parallel strip rendering functions *************************/
+
+/**
+ * Add \a seq and all strips rendered as part of it to \a strips.
+ * Returns false when \a seq can't be rendered at the same time as other strips: scene strips use
+ * the render pipeline, text strips share the font state, adjustment and multi-camera strips
+ * render the strips of other channels.
+ */
+static bool seq_render_strip_dependencies_get(Sequence *seq, GSet *strips)
+{
+  if (!BLI_gset_add(strips, seq)) {
+    return true;
+  }
+
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    if (smd->mask_sequence && !seq_render_strip_dependencies_get(smd->mask_sequence, strips)) {
+      return false;
+    }
+  }
+
+  switch (seq->type) {
+    case SEQ_TYPE_IMAGE:
+    case SEQ_TYPE_MOVIE:
+    case SEQ_TYPE_MOVIECLIP:
+    case SEQ_TYPE_MASK:
+    case SEQ_TYPE_SOUND_RAM:
+    case SEQ_TYPE_SOUND_HD:
+      return true;
+    case SEQ_TYPE_META:
+      LISTBASE_FOREACH (Sequence *, seq_child, &seq->seqbase) {
+        if (!seq_render_strip_dependencies_get(seq_child, strips)) {
+          return false;
+        }
+      }
+      return true;
+    case SEQ_TYPE_SCENE:
+    case SEQ_TYPE_TEXT:
+    case SEQ_TYPE_ADJUSTMENT:
+    case SEQ_TYPE_MULTICAM:
+      return false;
+  }
+
+  if ((seq->type & SEQ_TYPE_EFFECT) == 0) {
+    return false;
+  }
+
+  Sequence *inputs[3] = {seq->seq1, seq->seq2, seq->seq3};
+  for (int i = 0; i < ARRAY_SIZE(inputs); i++) {
+    if (inputs[i] && !seq_render_strip_dependencies_get(inputs[i], strips)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+typedef struct RenderStripsParallelData {
+  const SeqRenderData *context;
+  SeqRenderState *state;
+  Sequence **seqs;
+  float cfra;
+  ImBuf **r_ibufs;
+} RenderStripsParallelData;
+
+static void seq_render_strips_parallel_task(TaskPool *__restrict pool, void *taskdata)
+{
+  RenderStripsParallelData *data = BLI_task_pool_user_data(pool);
+  const int index = POINTER_AS_INT(taskdata);
+  SeqRenderState state = *data->state;
+
+  data->r_ibufs[index] = seq_render_strip(data->context, &state, data->seqs[index], data->cfra);
+}
+
+/**
+ * Render the strips in \a seqs at the same time, using the task scheduler.
+ *
+ * Strips that can't be rendered at the same time as others, or that share strips with a strip
+ * rendered before them in \a seqs, are skipped. Their images are left NULL in \a r_ibufs, to be
+ * rendered by the caller.
+ */
+static void seq_render_strips_parallel(const SeqRenderData *context,
+                                       SeqRenderState *state,
+                                       Sequence **seqs,
+                                       int count,
+                                       float cfra,
+                                       ImBuf **r_ibufs)
+{
+  memset(r_ibufs, 0, sizeof(*r_ibufs) * count);
+
+  if ((U.sequencer_flag & USER_SEQ_SERIAL_RENDER) || BLI_system_thread_count() < 2) {
+    return;
+  }
+
+  BLI_assert(count <= MAXSEQ + 1);
+  int task_indices[MAXSEQ + 1];
+  int tasks_num = 0;
+  GSet *strips_used = BLI_gset_ptr_new(__func__);
+  GSet *strips = BLI_gset_ptr_new(__func__);
+
+  for (int i = 0; i < count; i++) {
+    if (seqs[i] == NULL) {
+      continue;
+    }
+
+    BLI_gset_clear(strips, NULL);
+    if (!seq_render_strip_dependencies_get(seqs[i], strips)) {
+      continue;
+    }
+
+    /* A strip can't be rendered by multiple threads at the same time. */
+    bool is_shared = false;
+    GSET_FOREACH_BEGIN (Sequence *, seq, strips) {
+      if (BLI_gset_haskey(strips_used, seq)) {
+        is_shared = true;
+        break;
+      }
+    }
+    GSET_FOREACH_END();
+    if (is_shared) {
+      continue;
+    }
+
+    GSET_FOREACH_BEGIN (Sequence *, seq, strips) {
+      BLI_gset_add(strips_used, seq);
+    }
+    GSET_FOREACH_END();
+    task_indices[tasks_num++] = i;
+  }
+
+  BLI_gset_free(strips, NULL);
+  BLI_gset_free(strips_used, NULL);
+
+  /* A single strip is rendered by the caller. */
+  if (tasks_num < 2) {
+    return;
+  }
+
+  RenderStripsParallelData data = {
+      .context = context,
+      .state = state,
+      .seqs = seqs,
+      .cfra = cfra,
+      .r_ibufs = r_ibufs,
+  };
+
+  TaskPool *task_pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+  for (int i = 0; i < tasks_num; i++) {
+    BLI_task_pool_push(task_pool,
+                       seq_render_strips_parallel_task,
+                       POINTER_FROM_INT(task_indices[i]),
+                       false,
+                       NULL);
+  }
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+}
+
 /*********************** strip stack rendering functions *************************/
 
 static bool seq_must_swap_input_in_blend_mode(Sequence *seq)
@@ -3999,6 +4168,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      int chanshown)
 {
   Sequence *seq_arr[MAXSEQ + 1];
+  Sequence *render_arr[MAXSEQ + 1];
+  ImBuf *ibuf_arr[MAXSEQ + 1];
   int count;
   int i;
   ImBuf *out = NULL;
@@ -4010,8 +4181,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
     return NULL;
   }
 
+  /* Find the lowest strip that contributes to the result. */
   for (i = count - 1; i >= 0; i--) {
-    int early_out;
     Sequence *seq = seq_arr[i];
 
     out = BKE_sequencer_cache_get(context, seq, cfra, SEQ_CACHE_STORE_COMPOSITE, false);
@@ -4019,29 +4190,48 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
     if (out) {
       break;
     }
-    if (seq->blend_mode == SEQ_BLEND_REPLACE) {
-      out = seq_render_strip(context, state, seq, cfra);
+    if (i == 0 || seq->blend_mode == SEQ_BLEND_REPLACE ||
+        ELEM(seq_get_early_out_for_blend_mode(seq), EARLY_NO_INPUT, EARLY_USE_INPUT_2)) {
       break;
     }
+  }
 
-    early_out = seq_get_early_out_for_blend_mode(seq);
+  /* Render the strips of which the image is used at the same time, they are composited in
+   * channel order below. */
+  for (int j = i; j < count; j++) {
+    Sequence *seq = seq_arr[j];
+    const int early_out = (seq->blend_mode == SEQ_BLEND_REPLACE) ?
+                              EARLY_USE_INPUT_2 :
+                              seq_get_early_out_for_blend_mode(seq);
+    if (j == i) {
+      render_arr[j] = (out == NULL && early_out != EARLY_USE_INPUT_1) ? seq : NULL;
+    }
+    else {
+      render_arr[j] = (early_out == EARLY_DO_EFFECT) ? seq : NULL;
+    }
+  }
+  seq_render_strips_parallel(context, state, render_arr + i, count - i, cfra, ibuf_arr + i);
 
-    switch (early_out) {
-      case EARLY_NO_INPUT:
-      case EARLY_USE_INPUT_2:
-        out = seq_render_strip(context, state, seq, cfra);
-        break;
-      case EARLY_USE_INPUT_1:
-        if (i == 0) {
+  if (out == NULL) {
+    Sequence *seq = seq_arr[i];
+
+    if (seq->blend_mode == SEQ_BLEND_REPLACE) {
+      out = ibuf_arr[i] ? ibuf_arr[i] : seq_render_strip(context, state, seq, cfra);
+    }
+    else {
+      switch (seq_get_early_out_for_blend_mode(seq)) {
+        case EARLY_NO_INPUT:
+        case EARLY_USE_INPUT_2:
+          out = ibuf_arr[i] ? ibuf_arr[i] : seq_render_strip(context, state, seq, cfra);
+          break;
+        case EARLY_USE_INPUT_1:
           out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-        }
-        break;
-      case EARLY_DO_EFFECT:
-        if (i == 0) {
+          break;
+        case EARLY_DO_EFFECT: {
           begin = seq_estimate_render_cost_begin();
 
           ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-          ImBuf *ibuf2 = seq_render_strip(context, state, seq, cfra);
+          ImBuf *ibuf2 = ibuf_arr[i] ? ibuf_arr[i] : seq_render_strip(context, state, seq, cfra);
 
           out = seq_render_strip_stack_apply_effect(context, seq, cfra, ibuf1, ibuf2);
 
@@ -4051,11 +4241,9 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
 
           IMB_freeImBuf(ibuf1);
           IMB_freeImBuf(ibuf2);
+          break;
         }
-        break;
-    }
-    if (out) {
-      break;
+      }
     }
   }
 
@@ -4066,7 +4254,7 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
 
     if (seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
       ImBuf *ibuf1 = out;
-      ImBuf *ibuf2 = seq_render_strip(context, state, seq, cfra);
+      ImBuf *ibuf2 = ibuf_arr[i] ? ibuf_arr[i] : seq_render_strip(context, state, seq, cfra);
 
       out = seq_render_strip_stack_apply_effect(context, seq, cfra, ibuf1, ibuf2);
 
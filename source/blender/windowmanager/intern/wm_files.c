@@ -97,8 +97,10 @@
 #include "RNA_access.h"
 #include "RNA_define.h"
 
+#include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
 #include "IMB_thumbs.h"
 
 #include "ED_datafiles.h"
@@ -414,6 +416,12 @@ static void wm_init_userdef(Main *bmain)
   }
 
   MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+  IMB_moviecache_set_budget_limit(IMB_MOVIECACHE_BUDGET_IMAGE,
+                                  ((size_t)U.memcachelimit_image) * 1024 * 1024);
+  IMB_moviecache_set_budget_limit(IMB_MOVIECACHE_BUDGET_CLIP,
+                                  ((size_t)U.memcachelimit_clip) * 1024 * 1024);
+  IMB_colormanagement_display_lut_set_enabled(
+      (U.colormanagement_flag & USER_CM_BAKED_DISPLAY_TRANSFORM) != 0);
   BKE_sound_init(bmain);
 
   /* Update the temporary directory from the preferences or fallback to the system default. */
@@ -730,7 +738,8 @@ bool WM_file_read(bContext *C, const char *filepath, ReportList *reports)
          * Further it's just confusing if a user loads a file and various preferences change. */
         &(const struct BlendFileReadParams){
             .is_startup = false,
-            .skip_flags = BLO_READ_SKIP_USERDEF,
+            .skip_flags = BLO_READ_SKIP_USERDEF |
+                          ((G.fileflags & G_FILE_LAZY_LOAD) ? BLO_READ_LAZY_DATA : 0),
         },
         reports);
 
@@ -1509,6 +1518,7 @@ static bool wm_file_write(bContext *C,
                          .remap_mode = remap_mode,
                          .use_save_versions = true,
                          .use_save_as_copy = use_save_as_copy,
+                         .use_incremental = (U.flag & USER_FILE_INCREMENTAL) != 0,
                          .thumb = thumb,
                      },
                      reports)) {
@@ -1523,6 +1533,7 @@ static bool wm_file_write(bContext *C,
     }
 
     SET_FLAG_FROM_TEST(G.fileflags, fileflags & G_FILE_COMPRESS, G_FILE_COMPRESS);
+    SET_FLAG_FROM_TEST(G.fileflags, fileflags & G_FILE_COMPRESS_ZSTD, G_FILE_COMPRESS_ZSTD);
 
     /* prevent background mode scripts from clobbering history */
     if (do_history_file_update) {
@@ -1643,7 +1654,13 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
     ED_editors_flush_edits(bmain);
 
     /* Error reporting into console. */
-    BLO_write_file(bmain, filepath, fileflags, &(const struct BlendFileWriteParams){0}, NULL);
+    BLO_write_file(bmain,
+                   filepath,
+                   fileflags,
+                   &(const struct BlendFileWriteParams){
+                       .use_incremental = (U.flag & USER_FILE_INCREMENTAL) != 0,
+                   },
+                   NULL);
   }
   /* do timer after file write, just in case file write takes a long time */
   wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
@@ -2669,6 +2686,17 @@ static void wm_filepath_default(char *filepath)
   }
 }
 
+static const EnumPropertyItem save_compress_method_items[] = {
+    {0, "GZIP", 0, "Gzip", "Compatible with all Blender versions"},
+    {G_FILE_COMPRESS_ZSTD,
+     "ZSTD",
+     0,
+     "Zstandard",
+     "Faster to save and load, files can't be opened by Blender versions without Zstandard "
+     "support"},
+    {0, NULL, 0, NULL, NULL},
+};
+
 static void save_set_compress(wmOperator *op)
 {
   PropertyRNA *prop;
@@ -2682,6 +2710,16 @@ static void save_set_compress(wmOperator *op)
       RNA_property_boolean_set(op->ptr, prop, (U.flag & USER_FILECOMPRESS) != 0);
     }
   }
+
+  prop = RNA_struct_find_property(op->ptr, "compress_method");
+  if (!RNA_property_is_set(op->ptr, prop)) {
+    /* Keep the method of an existing file, new files use gzip so older versions can read them. */
+    RNA_property_enum_set(op->ptr,
+                          prop,
+                          (G.save_over && (G.fileflags & G_FILE_COMPRESS_ZSTD)) ?
+                              G_FILE_COMPRESS_ZSTD :
+                              0);
+  }
 }
 
 static void save_set_filepath(bContext *C, wmOperator *op)
@@ -2747,6 +2785,9 @@ static int wm_save_as_mainfile_exec(bContext *C, wmOperator *op)
 
   /* set compression flag */
   SET_FLAG_FROM_TEST(fileflags, RNA_boolean_get(op->ptr, "compress"), G_FILE_COMPRESS);
+  SET_FLAG_FROM_TEST(fileflags,
+                     RNA_enum_get(op->ptr, "compress_method") == G_FILE_COMPRESS_ZSTD,
+                     G_FILE_COMPRESS_ZSTD);
 
   const bool ok = wm_file_write(C, path, fileflags, remap_mode, use_save_as_copy, op->reports);
 
@@ -2806,6 +2847,12 @@ void WM_OT_save_as_mainfile(wmOperatorType *ot)
                                  FILE_DEFAULTDISPLAY,
                                  FILE_SORT_ALPHA);
   RNA_def_boolean(ot->srna, "compress", false, "Compress", "Write compressed .blend file");
+  RNA_def_enum(ot->srna,
+               "compress_method",
+               save_compress_method_items,
+               0,
+               "Compression Method",
+               "Compression used when writing a compressed .blend file");
   RNA_def_boolean(ot->srna,
                   "relative_remap",
                   true,
@@ -2876,6 +2923,12 @@ void WM_OT_save_mainfile(wmOperatorType *ot)
                                  FILE_DEFAULTDISPLAY,
                                  FILE_SORT_ALPHA);
   RNA_def_boolean(ot->srna, "compress", false, "Compress", "Write compressed .blend file");
+  RNA_def_enum(ot->srna,
+               "compress_method",
+               save_compress_method_items,
+               0,
+               "Compression Method",
+               "Compression used when writing a compressed .blend file");
   RNA_def_boolean(ot->srna,
                   "relative_remap",
                   false,
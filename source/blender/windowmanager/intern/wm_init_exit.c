@@ -646,6 +646,8 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
   GHOST_DisposeSystemPaths();
 
+  BLO_write_file_incremental_free();
+
   DNA_sdna_current_free();
 
   BLI_threadapi_exit();
@@ -595,6 +595,8 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-build");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-tag");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-no-threads");
+  BLI_argsPrintArgDoc(ba, "--debug-depsgraph-no-priority");
+  BLI_argsPrintArgDoc(ba, "--debug-depsgraph-validate-incremental");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-time");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-pretty");
   BLI_argsPrintArgDoc(ba, "--debug-gpu");
@@ -619,6 +621,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--app-template");
   BLI_argsPrintArgDoc(ba, "--factory-startup");
   BLI_argsPrintArgDoc(ba, "--enable-event-simulate");
+  BLI_argsPrintArgDoc(ba, "--lazy-load");
   printf("\n");
   BLI_argsPrintArgDoc(ba, "--env-system-datafiles");
   BLI_argsPrintArgDoc(ba, "--env-system-scripts");
@@ -994,6 +997,14 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_eval[] =
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_no_threads[] =
     "\n\t"
     "Switch dependency graph to a single threaded evaluation.";
+static const char arg_handle_debug_mode_generic_set_doc_depsgraph_no_priority[] =
+    "\n\t"
+    "Evaluate dependency graph operations in the order they become ready,\n\t"
+    "instead of starting the longest chains of operations first.";
+static const char arg_handle_debug_mode_generic_set_doc_depsgraph_validate_incremental[] =
+    "\n\t"
+    "Compare every incremental dependency graph relations update against a full build,\n\t"
+    "and print the differences.";
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_pretty[] =
     "\n\t"
     "Enable colors for dependency graph debug messages.";
@@ -1138,6 +1149,19 @@ static int arg_handle_factory_startup_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_lazy_load_set_doc[] =
+    "\n\t"
+    "Only read meshes, images and volumes of blend-files when they are needed\n"
+    "\t(faster loading for scripts which only inspect or re-link data).\n"
+    "\tSaving and undo steps read all of them.";
+static int arg_handle_lazy_load_set(int UNUSED(argc),
+                                    const char **UNUSED(argv),
+                                    void *UNUSED(data))
+{
+  G.fileflags |= G_FILE_LAZY_LOAD;
+  return 0;
+}
+
 static const char arg_handle_enable_event_simulate_doc[] =
     "\n\t"
     "Enable event simulation testing feature 'bpy.types.Window.event_simulate'.";
@@ -2204,6 +2228,18 @@ void main_args_setup(bContext *C, bArgs *ba)
               "--debug-depsgraph-no-threads",
               CB_EX(arg_handle_debug_mode_generic_set, depsgraph_no_threads),
               (void *)G_DEBUG_DEPSGRAPH_NO_THREADS);
+  BLI_argsAdd(ba,
+              1,
+              NULL,
+              "--debug-depsgraph-no-priority",
+              CB_EX(arg_handle_debug_mode_generic_set, depsgraph_no_priority),
+              (void *)G_DEBUG_DEPSGRAPH_NO_PRIORITY);
+  BLI_argsAdd(ba,
+              1,
+              NULL,
+              "--debug-depsgraph-validate-incremental",
+              CB_EX(arg_handle_debug_mode_generic_set, depsgraph_validate_incremental),
+              (void *)G_DEBUG_DEPSGRAPH_VALIDATE_INCREMENTAL);
   BLI_argsAdd(ba,
               1,
               NULL,
@@ -2241,6 +2277,7 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_argsAdd(ba, 1, NULL, "--app-template", CB(arg_handle_app_template), NULL);
   BLI_argsAdd(ba, 1, NULL, "--factory-startup", CB(arg_handle_factory_startup_set), NULL);
   BLI_argsAdd(ba, 1, NULL, "--enable-event-simulate", CB(arg_handle_enable_event_simulate), NULL);
+  BLI_argsAdd(ba, 1, NULL, "--lazy-load", CB(arg_handle_lazy_load_set), NULL);
 
   /* TODO, add user env vars? */
   BLI_argsAdd(